@@ -93,6 +93,17 @@ def addCommonOptions(parser):
     parser.add_option("--mem-size", action="store", type="string",
                       default="512MB",
                       help="Specify the physical memory size (single memory)")
+    parser.add_option("--mem-backing-pages", type="choice",
+                      default="small_pages",
+                      choices=["small_pages", "transparent_huge_pages",
+                               "explicit_huge_pages"],
+                      help="Host pages backing the simulated memory")
+    parser.add_option("--mem-numa-nodes", action="store", type="string",
+                      default="",
+                      help="Comma separated host NUMA nodes to bind the "
+                      "memory to, -1 for the node of the simulator")
+    parser.add_option("--mem-prefault", action="store_true",
+                      help="Fault in the host memory at startup")
 
     parser.add_option("-l", "--lpae", action="store_true")
     parser.add_option("-V", "--virtualisation", action="store_true")
@@ -101,6 +112,12 @@ def addCommonOptions(parser):
     parser.add_option("--caches", action="store_true")
     parser.add_option("--l2cache", action="store_true")
     parser.add_option("--fastmem", action="store_true")
+    parser.add_option("--decode-blocks", action="store_true",
+                      help="Execute pre-decoded basic blocks on the "
+                      "atomic CPU (ARM, needs --fastmem)")
+    parser.add_option("--cache-checkpoints", action="store_true",
+                      help="Save the contents of the classic caches in "
+                      "checkpoints and restore them warm")
     parser.add_option("--num-dirs", type="int", default=1)
     parser.add_option("--num-l2caches", type="int", default=1)
     parser.add_option("--num-l3caches", type="int", default=1)
@@ -116,6 +133,12 @@ def addCommonOptions(parser):
 
     # Enable Ruby
     parser.add_option("--ruby", action="store_true")
+    parser.add_option("--garnet-partitions", type="int", default=1,
+                      help="Simulate the garnet mesh as N regions, each on "
+                      "its own event queue and thread")
+    parser.add_option("--garnet-power-trace", type="int", default=0,
+                      help="Write garnet dynamic/static power to "
+                      "noc_power.trace every N network cycles")
 
     # Run duration options
     parser.add_option("-m", "--abs-max-tick", type="int", default=m5.MaxTick,
@@ -202,6 +225,25 @@ def addCommonOptions(parser):
     parser.add_option("--at-instruction", action="store_true", default=False,
         help="""Treat value of --checkpoint-restore or --take-checkpoint as a
                 number of instructions.""")
+
+    # Sampled simulation
+    parser.add_option("--sample-interval", action="store", type="string",
+        default=None,
+        help="""Sampled run: fast-forward on --cpu-type (atomic or kvm) for
+                this long between detailed O3 samples""")
+    parser.add_option("--sample-warmup", action="store", type="string",
+        default="10us",
+        help="Detailed warm-up before each sample window")
+    parser.add_option("--sample-detail", action="store", type="string",
+        default="50us", help="Length of each detailed sample window")
+    parser.add_option("--sample-count", action="store", type="int",
+        default=0, help="Stop after <N> samples (0 = until the workload ends)")
+    parser.add_option("--sample-error", action="store", type="float",
+        default=0.0,
+        help="Stop once the IPC confidence interval is within this fraction "
+             "of the mean")
+    parser.add_option("--sample-confidence", action="store", type="float",
+        default=0.95, help="Confidence level of the sampled IPC")
     parser.add_option("--spec-input", default="ref", type="choice",
                       choices=["ref", "test", "train", "smred", "mdred",
                                "lgred"],
@@ -219,17 +261,34 @@ def addCommonOptions(parser):
     parser.add_option("--ip_freq", type="int", default=500, help="IP Freq in MHz.")
     parser.add_option("--core_freq", type="int", default=1000, help="CPU Freq in MHz.")
     parser.add_option("--mem_freq", type="int", default=800, help="Mem Freq in MHz.")
+    parser.add_option("--core_model", type="int", default=0, help="GemDroid core model: 0 - InOrder; 1 - Legacy OoO; 2 - ROB-based OoO")
+    parser.add_option("--issue_width", type="int", default=1, help="Issue width of the GemDroid cores.")
+    parser.add_option("--commit_width", type="int", default=0, help="Commit width of the GemDroid cores (0 - same as issue width).")
+    parser.add_option("--rob_size", type="int", default=32, help="ROB size in instructions for core model 2.")
+    parser.add_option("--mlp_limit", type="int", default=8, help="Max outstanding memory requests per core for core model 2.")
     parser.add_option("--cpu_trace1", action="store", type="string", default="none", help="Path to the CPU trace file1.")
     parser.add_option("--cpu_trace2", action="store", type="string", default="none", help="Path to the CPU trace file2.")
     parser.add_option("--cpu_trace3", action="store", type="string", default="none", help="Path to the CPU trace file3.")
     parser.add_option("--cpu_trace4", action="store", type="string", default="none", help="Path to the CPU trace file4.")
     parser.add_option("--gpu_trace", action="store", type="string", default="none.txt", help="Path to the GPU trace file.")    
+    parser.add_option("--ip_catalog", action="store", type="string", default="ipcatalog.txt", help="Path to the IP catalog file.")
     parser.add_option("--perfect_memory", action="store_true", help="Enable perfect memory.")
+    parser.add_option("--pipelined_flows", action="store_true", help="Estimate flow time from the slowest pipelined stage.")
+    parser.add_option("--stream_buffer_size", type="int", default=0, help="SA scratchpad in KB for IP-to-IP streaming (0 disables).")
+    parser.add_option("--stream_tile_size", type="int", default=64, help="Cache lines a streaming producer writes before its consumer starts.")
+    parser.add_option("--slc_size", type="int", default=0, help="System-level cache size in KB (0 disables).")
+    parser.add_option("--slc_ways", type="int", default=16, help="System-level cache associativity.")
+    parser.add_option("--slc_hit_latency", type="int", default=10, help="System-level cache hit latency in SA cycles.")
+    parser.add_option("--slc_partition", type="string", default="", help="SLC ways per sender type, e.g. GPU:4,DC:2.")
+    parser.add_option("--slc_no_allocate", type="string", default="", help="Sender types that do not allocate in the SLC, e.g. NW,MMC_IN.")
+    parser.add_option("--slc_stream_threshold", type="int", default=32, help="Sequential misses before a streaming sender bypasses the SLC (0 disables).")
     parser.add_option("--no_periodic_stats", action="store_true", help="Disable periodic stats from GemDroid code.")
     parser.add_option("--sweep_val1", type="float", default=1, help="Value to use for the current sweep variable1.")    
     parser.add_option("--sweep_val2", type="float", default=1, help="Value to use for the current sweep variable2.")    
     parser.add_option("--device_config", type="string", default="ini/LPDDR3_micron_32M_8B_x8_sg15.ini", help="Mem Device configuration.")
     parser.add_option("--system_config", type="string", default="gemdroid.ini", help="Mem System configuration.")
+    parser.add_option("--gemdroid_mem_backend", type="choice", default="dramsim2", choices=["dramsim2", "port"], help="GemDroid memory: DRAMSim2 or a gem5 DRAM controller on a port.")
+    parser.add_option("--gemdroid_mem_type", type="choice", default="LPDDR3_1600_x32", choices=MemConfig.mem_names(), help="gem5 memory type behind the GemDroid port.")
 
 def addSEOptions(parser):
     # Benchmark options
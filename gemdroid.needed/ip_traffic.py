@@ -0,0 +1,283 @@
+# Copyright (c) 2014 The Pennsylvania State University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+# Turns the GemDroid IP catalog into TrafficGen profiles, so that the
+# memory traffic of the accelerators and devices can be played against
+# any gem5 memory system without the GemDroid SoC model.
+#
+# For every IP asked for, the frame sizes, buffer addresses and
+# processing rate follow what GemDroid does for that IP type, and the
+# script writes a TrafficGen config file <out>/<ip>.cfg. By default the
+# config uses a FRAME state: every frame period the IP reads its input
+# and writes its output at its processing rate, with the GemDroid frame
+# deadline. With --trace it instead writes a packet trace <out>/<ip>.trc.gz
+# of --frames frames in the proto/packet.proto format and a config
+# replaying it with a TRACE state. The trace needs the Python bindings
+# of packet.proto, e.g. from "protoc --python_out=. packet.proto".
+#
+# Example, a video decoder and the display on their own generators:
+#   ip_traffic.py --catalog ipcatalog.txt --ips VD,DC --out profiles
+
+from __future__ import print_function
+
+import gzip
+import os
+import struct
+import sys
+from optparse import OptionParser
+
+# Frame sizes and coding ratios, as in gemdroid_defines.hh
+CACHE_LINE_SIZE = 64
+FRAME_SIZE = (4096 * 2160 * 24) // 8
+AUD_FRAME_SIZE = 16 * 1024
+VID_CODING_RATIO = 16
+AUD_CODING_RATIO = 8
+
+# Buffer addresses, as in gemdroid_ip.hh
+ADDR_START = {
+    "DC": 2160000000, "CAM": 2180000000, "VD": 2200000000,
+    "VE": 2220000000, "IMG": 2240000000, "AE": 2260000000,
+    "NW": 2280000000, "SND": 2300000000, "AD": 2320000000,
+    "MMC_IN": 2340000000, "MIC": 2360000000, "MMC_OUT": 2380000000,
+    "GPU": 2420000000,
+}
+LOWEST_ADDR = min(ADDR_START.values())
+
+# Bytes read and written per frame by each IP type. Decoders read the
+# compressed frame and write the raw one, encoders the other way round,
+# the display only reads and the camera only writes.
+FRAME_BYTES = {
+    "VD": (FRAME_SIZE // VID_CODING_RATIO, FRAME_SIZE),
+    "VE": (FRAME_SIZE, FRAME_SIZE // VID_CODING_RATIO),
+    "AD": (AUD_FRAME_SIZE // AUD_CODING_RATIO, AUD_FRAME_SIZE),
+    "AE": (AUD_FRAME_SIZE, AUD_FRAME_SIZE // AUD_CODING_RATIO),
+    "IMG": (FRAME_SIZE // 2, FRAME_SIZE),
+    "GPU": (FRAME_SIZE, FRAME_SIZE),
+    "DC": (FRAME_SIZE, 0),
+    "CAM": (0, FRAME_SIZE),
+    "MMC_IN": (0, FRAME_SIZE // VID_CODING_RATIO),
+    "MMC_OUT": (FRAME_SIZE // VID_CODING_RATIO, 0),
+}
+
+# Tick frequency of gem5, 1 ps
+TICKS_PER_SEC = 10 ** 12
+TICKS_PER_MS = 10 ** 9
+
+# MemCmd::ReadReq and MemCmd::WriteReq
+CMD_READ = 1
+CMD_WRITE = 4
+
+# ProtoOutputStream magic number, "gem5"
+PROTO_MAGIC = 0x356d6567
+
+def parse_catalog(filename):
+    """Return the first instance of every IP type in the catalog as a
+    dict of kind, freq_mhz and proc_time."""
+    ips = {}
+    for line in open(filename):
+        fields = line.split()
+        if not fields or fields[0] != "ip":
+            continue
+        ip_type, kind, freq, proc_time = fields[1], fields[3], fields[4], \
+            fields[5]
+        if ip_type not in ips:
+            ips[ip_type] = { "kind": kind, "freq_mhz": int(freq),
+                             "proc_time": int(proc_time) }
+    return ips
+
+class Profile(object):
+    """Per-frame traffic of one IP."""
+
+    def __init__(self, name, ip, options):
+        if name not in FRAME_BYTES:
+            sys.exit("No frame model for IP %s" % name)
+
+        self.name = name
+        self.read_bytes, self.write_bytes = FRAME_BYTES[name]
+        self.blocksize = options.blocksize
+
+        # GemDroid keeps the output right after the input buffer
+        base = ADDR_START[name] - LOWEST_ADDR + options.base
+        self.read_base = base
+        self.write_base = base + \
+            (AUD_FRAME_SIZE if name in ("AD", "AE") else FRAME_SIZE)
+
+        self.frame_period = TICKS_PER_SEC // options.fps
+        if options.deadline_ms is not None:
+            self.deadline = int(options.deadline_ms * TICKS_PER_MS)
+        else:
+            # FPS_DEADLINE: whole ms of the frame minus the safety net
+            self.deadline = (1000 // options.fps - 1) * TICKS_PER_MS
+
+        # The IP processes a cache line every proc_time cycles, on the
+        # larger of its input and output; the requests of a frame are
+        # spread evenly over that time
+        freq = ip["freq_mhz"]
+        if freq == 0:
+            freq = options.dev_freq if ip["kind"] == "device" \
+                else options.ip_freq
+        cycle = 10 ** 6 // freq
+        lines = max(self.read_bytes, self.write_bytes) // CACHE_LINE_SIZE
+        busy = lines * max(ip["proc_time"], 1) * cycle
+        self.period = busy // max(self.packets(), 1)
+
+    def packets(self):
+        return (self.read_bytes + self.blocksize - 1) // self.blocksize + \
+            (self.write_bytes + self.blocksize - 1) // self.blocksize
+
+    def frame_requests(self):
+        """Requests of a frame as (offset tick, cmd, addr, size), with
+        the same read and write interleaving as the FRAME state."""
+        read_done = write_done = 0
+        tick = 0
+        while read_done < self.read_bytes or write_done < self.write_bytes:
+            is_read = read_done < self.read_bytes and \
+                (write_done == self.write_bytes or
+                 write_done * self.read_bytes >= read_done * self.write_bytes)
+            if is_read:
+                size = min(self.blocksize, self.read_bytes - read_done)
+                yield (tick, CMD_READ, self.read_base + read_done, size)
+                read_done += size
+            else:
+                size = min(self.blocksize, self.write_bytes - write_done)
+                yield (tick, CMD_WRITE, self.write_base + write_done, size)
+                write_done += size
+            tick += self.period
+
+def varint(value):
+    out = bytearray()
+    while True:
+        bits = value & 0x7f
+        value >>= 7
+        if value:
+            out.append(bits | 0x80)
+        else:
+            out.append(bits)
+            return bytes(out)
+
+def write_trace(profile, filename, frames):
+    try:
+        import packet_pb2
+    except ImportError:
+        sys.exit("--trace needs packet_pb2, generate it with "
+                 "protoc --python_out=. packet.proto")
+
+    out = gzip.open(filename, "wb")
+    out.write(struct.pack("<I", PROTO_MAGIC))
+
+    def write_msg(msg):
+        data = msg.SerializeToString()
+        out.write(varint(len(data)))
+        out.write(data)
+
+    header = packet_pb2.PacketHeader()
+    header.obj_id = "GemDroid IP %s" % profile.name
+    header.tick_freq = TICKS_PER_SEC
+    write_msg(header)
+
+    # Back to back frames keep their period, the deadline is not
+    # checked by the trace player
+    for frame in range(frames):
+        start = frame * profile.frame_period
+        for tick, cmd, addr, size in profile.frame_requests():
+            pkt = packet_pb2.Packet()
+            pkt.tick = start + tick
+            pkt.cmd = cmd
+            pkt.addr = addr
+            pkt.size = size
+            write_msg(pkt)
+
+    out.close()
+
+def main():
+    parser = OptionParser(usage="%prog [options]")
+    parser.add_option("--catalog", default="ipcatalog.txt",
+                      help="GemDroid IP catalog [default: %default]")
+    parser.add_option("--ips", default="VD,VE,DC,CAM,GPU",
+                      help="Comma separated IP types [default: %default]")
+    parser.add_option("--out", default="ip_profiles",
+                      help="Output directory [default: %default]")
+    parser.add_option("--fps", type="int", default=60,
+                      help="Frames per second [default: %default]")
+    parser.add_option("--deadline_ms", type="float", default=None,
+                      help="Frame deadline in ms [default: GemDroid's]")
+    parser.add_option("--ip_freq", type="int", default=500,
+                      help="Accelerator MHz when the catalog has 0 "
+                      "[default: %default]")
+    parser.add_option("--dev_freq", type="int", default=400,
+                      help="Device MHz when the catalog has 0 "
+                      "[default: %default]")
+    parser.add_option("--blocksize", type="int", default=CACHE_LINE_SIZE,
+                      help="Request size in bytes [default: %default]")
+    parser.add_option("--base", type="int", default=0,
+                      help="Address the lowest GemDroid buffer maps to "
+                      "[default: %default]")
+    parser.add_option("--duration_ms", type="int", default=1000,
+                      help="Duration of the generator state "
+                      "[default: %default]")
+    parser.add_option("--trace", action="store_true",
+                      help="Write a packet trace instead of a FRAME state")
+    parser.add_option("--frames", type="int", default=60,
+                      help="Frames in the trace [default: %default]")
+    (options, args) = parser.parse_args()
+
+    catalog = parse_catalog(options.catalog)
+    if not os.path.isdir(options.out):
+        os.makedirs(options.out)
+
+    duration = options.duration_ms * TICKS_PER_MS
+
+    for name in options.ips.split(","):
+        if name not in catalog:
+            sys.exit("IP %s is not in %s" % (name, options.catalog))
+
+        profile = Profile(name, catalog[name], options)
+        cfg = open(os.path.join(options.out, name + ".cfg"), "w")
+        print("# GemDroid %s: %d B read, %d B written every %d ticks" %
+              (name, profile.read_bytes, profile.write_bytes,
+               profile.frame_period), file=cfg)
+
+        if options.trace:
+            trace = os.path.abspath(os.path.join(options.out,
+                                                 name + ".trc.gz"))
+            write_trace(profile, trace, options.frames)
+            print("STATE 0 %d TRACE %s 0" % (duration, trace), file=cfg)
+        else:
+            print("STATE 0 %d FRAME %d %d %d %d %d %d %d %d" %
+                  (duration, profile.frame_period, profile.deadline,
+                   profile.read_base, profile.read_bytes,
+                   profile.write_base, profile.write_bytes,
+                   profile.blocksize, profile.period), file=cfg)
+
+        print("INIT 0", file=cfg)
+        print("TRANSITION 0 0 1", file=cfg)
+        cfg.close()
+
+        print("%s: %d requests per frame, one every %d ticks" %
+              (name, profile.packets(), profile.period))
+
+if __name__ == "__main__":
+    main()
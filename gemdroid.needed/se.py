@@ -172,6 +172,11 @@ system = System(cpu = [CPUClass(cpu_id=i) for i in xrange(np)],
                   governor_timing = options.governor_timing,
                   mem_freq = options.mem_freq,
                   core_freq = options.core_freq,
+                  core_model = options.core_model,
+                  issue_width = options.issue_width,
+                  commit_width = options.commit_width,
+                  rob_size = options.rob_size,
+                  mlp_limit = options.mlp_limit,
                   ip_freq = options.ip_freq,
                   num_cpu_traces = options.num_cpu_traces,
                   cpu_trace1 = options.cpu_trace1,
@@ -179,12 +184,28 @@ system = System(cpu = [CPUClass(cpu_id=i) for i in xrange(np)],
                   cpu_trace3 = options.cpu_trace3,
                   cpu_trace4 = options.cpu_trace4,
                   gpu_trace = options.gpu_trace,
+                  ip_catalog = options.ip_catalog,
                   no_periodic_stats = options.no_periodic_stats,
                   perfect_memory = options.perfect_memory,
+                  pipelined_flows = options.pipelined_flows,
+                  stream_buffer_size = options.stream_buffer_size,
+                  stream_tile_size = options.stream_tile_size,
+                  slc_size = options.slc_size,
+                  slc_ways = options.slc_ways,
+                  slc_hit_latency = options.slc_hit_latency,
+                  slc_partition = options.slc_partition,
+                  slc_no_allocate = options.slc_no_allocate,
+                  slc_stream_threshold = options.slc_stream_threshold,
                   sweep_val1 = options.sweep_val1,
                   sweep_val2 = options.sweep_val2))
 #GemDroid added last line
 
+# Host backing store of the simulated memory
+system.mem_backing_pages = options.mem_backing_pages
+if options.mem_numa_nodes:
+    system.mem_numa_nodes = [int(n) for n in options.mem_numa_nodes.split(",")]
+system.mem_prefault = options.mem_prefault
+
 # Create a top-level voltage domain
 system.voltage_domain = VoltageDomain(voltage = options.sys_voltage)
 
@@ -212,6 +233,9 @@ if options.fastmem:
     if (options.caches or options.l2cache):
         fatal("You cannot use fastmem in combination with caches!")
 
+if options.decode_blocks and not options.fastmem:
+    fatal("Decoded blocks are read straight from memory, use --fastmem")
+
 if options.simpoint_profile:
     if not options.fastmem:
         # Atomic CPU checked with fastmem option already
@@ -230,6 +254,9 @@ for i in xrange(np):
     if options.fastmem:
         system.cpu[i].fastmem = True
 
+    if options.decode_blocks:
+        system.cpu[i].decode_blocks = True
+
     if options.simpoint_profile:
         system.cpu[i].simpoint_profile = True
         system.cpu[i].simpoint_interval = options.simpoint_interval
@@ -253,6 +280,11 @@ if options.ruby:
     Ruby.create_system(options, system)
     assert(options.num_cpus == len(system.ruby._cpu_ports))
 
+    if options.garnet_partitions > 1:
+        system.ruby.network.num_partitions = options.garnet_partitions
+    if options.garnet_power_trace > 0:
+        system.ruby.network.power_trace_cycles = options.garnet_power_trace
+
     for i in xrange(np):
         ruby_port = system.ruby._cpu_ports[i]
 
@@ -276,6 +308,67 @@ else:
     system.system_port = system.membus.slave
     CacheConfig.config_cache(options, system)
     MemConfig.config_mem(options, system)
+    if options.cache_checkpoints:
+        for obj in system.descendants():
+            if isinstance(obj, BaseCache):
+                obj.checkpoint_contents = True
+
+# GemDroid on gem5's own DRAM model: a controller of its own, outside
+# the global address map and not storing any data.
+if options.gemdroid and options.gemdroid_mem_backend == "port":
+    system.gemdroid.mem_backend = "port"
+    system.gemdroid_mem = MemConfig.get(options.gemdroid_mem_type)(
+        range = system.gemdroid.range, null = True, in_addr_map = False,
+        conf_table_reported = False)
+    system.gemdroid.mem_port = system.gemdroid_mem.port
+    system.gemdroid.dram_ctrl = system.gemdroid_mem
+
+# Sampled simulation: system.cpu fast-forwards, switch_cpus are the
+# detailed O3 cores the SamplingController swaps in for every sample.
+if options.sample_interval:
+    if options.ruby:
+        fatal("Sampling needs the classic memory system")
+    if CPUClass.memory_mode() == 'timing':
+        fatal("Sampling fast-forwards on an atomic or kvm --cpu-type")
+
+    switch_cpus = [DerivO3CPU(switched_out = True, cpu_id = i)
+                   for i in xrange(np)]
+    for i in xrange(np):
+        switch_cpus[i].system = system
+        switch_cpus[i].workload = system.cpu[i].workload
+        switch_cpus[i].clk_domain = system.cpu[i].clk_domain
+        if options.checker:
+            switch_cpus[i].addCheckerCpu()
+        switch_cpus[i].createThreads()
+    system.switch_cpus = switch_cpus
+
+    system.sampler = SamplingController(detailed_cpus = switch_cpus,
+                        fast_forward = options.sample_interval,
+                        warmup = options.sample_warmup,
+                        detail = options.sample_detail,
+                        max_samples = options.sample_count,
+                        target_error = options.sample_error,
+                        confidence = options.sample_confidence)
 
 root = Root(full_system = False, system = system)
-Simulation.run(options, root, system, FutureClass)
+
+if not options.sample_interval:
+    Simulation.run(options, root, system, FutureClass)
+else:
+    m5.instantiate()
+
+    functional = [ (system.cpu[i], switch_cpus[i]) for i in xrange(np) ]
+    detailed = [ (switch_cpus[i], system.cpu[i]) for i in xrange(np) ]
+
+    while True:
+        exit_event = m5.simulate()
+        exit_cause = exit_event.getCause()
+
+        if exit_cause == "sampling: switch to detailed":
+            m5.switchCpus(system, functional, verbose = False)
+        elif exit_cause == "sampling: switch to fast-forward":
+            m5.switchCpus(system, detailed, verbose = False)
+        else:
+            break
+
+    print 'Exiting @ tick %i because %s' % (m5.curTick(), exit_cause)
@@ -128,6 +128,16 @@ class Decoder
         fpscrStride = fpscr.stride;
     }
 
+    /**
+     * State set through setContext that decoding depends on, so that
+     * instructions decoded ahead of time are only reused under the same
+     * one.
+     */
+    uint64_t contextKey() const
+    {
+        return fpscrLen | ((uint64_t)fpscrStride << 16);
+    }
+
     void takeOverFrom(Decoder *old) {}
 
   protected:
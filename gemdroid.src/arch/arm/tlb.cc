@@ -54,6 +54,7 @@
 #include "arch/arm/tlb.hh"
 #include "arch/arm/utility.hh"
 #include "base/inifile.hh"
+#include "base/intmath.hh"
 #include "base/str.hh"
 #include "base/trace.hh"
 #include "cpu/base.hh"
@@ -73,9 +74,13 @@ TLB::TLB(const ArmTLBParams *p)
     : BaseTLB(p), table(new TlbEntry[p->size]), size(p->size),
     isStage2(p->is_stage2), tableWalker(p->walker), stage2Tlb(NULL),
     stage2Mmu(NULL), rangeMRU(1), bootUncacheability(false),
-    miscRegValid(false), curTranType(NormalTran)
+    miscRegValid(false), curTranType(NormalTran),
+    slotSpan(p->size, 0), slotPage(p->size, 0), slotAsid(p->size, 0),
+    slotIndexed(p->size, false), lruPrev(p->size), lruNext(p->size),
+    lruHead(-1), lruTail(-1), lruStamp(p->size), nextStamp(0)
 {
     tableWalker->setTlb(this);
+    rebuildIndex();
 
     // Cache system-level properties
     haveLPAE = tableWalker->haveLPAE();
@@ -130,29 +135,45 @@ TlbEntry*
 TLB::lookup(Addr va, uint16_t asn, uint8_t vmid, bool hyp, bool secure,
             bool functional, bool ignore_asn, uint8_t target_el)
 {
+    // Of all the matching entries the one nearest the MRU position
+    // wins, as it did when the table was scanned in order
+    int hit = -1;
+
+    for (int i = 0; i < pageIndex.size(); ++i) {
+        const PageIndex &index = pageIndex[i];
+        if (index.entries == 0)
+            continue;
+
+        unordered_map<Addr, vector<int> >::const_iterator page =
+            index.pages.find(va & ~(index.span - 1));
+        if (page == index.pages.end())
+            continue;
+
+        const vector<int> &slots = page->second;
+        for (int j = 0; j < slots.size(); ++j) {
+            int slot = slots[j];
+            if (table[slot].match(va, asn, vmid, hyp, secure, ignore_asn,
+                                  target_el) &&
+                (hit < 0 || lruStamp[slot] > lruStamp[hit]))
+                hit = slot;
+        }
+    }
 
-    TlbEntry *retval = NULL;
+    for (int j = 0; j < irregularSlots.size(); ++j) {
+        int slot = irregularSlots[j];
+        if (table[slot].match(va, asn, vmid, hyp, secure, ignore_asn,
+                              target_el) &&
+            (hit < 0 || lruStamp[slot] > lruStamp[hit]))
+            hit = slot;
+    }
 
-    // Maintaining LRU array
-    int x = 0;
-    while (retval == NULL && x < size) {
-        if ((!ignore_asn && table[x].match(va, asn, vmid, hyp, secure, false,
-             target_el)) ||
-            (ignore_asn && table[x].match(va, vmid, hyp, secure, target_el))) {
-            // We only move the hit entry ahead when the position is higher
-            // than rangeMRU
-            if (x > rangeMRU && !functional) {
-                TlbEntry tmp_entry = table[x];
-                for(int i = x; i > 0; i--)
-                    table[i] = table[i - 1];
-                table[0] = tmp_entry;
-                retval = &table[0];
-            } else {
-                retval = &table[x];
-            }
-            break;
-        }
-        ++x;
+    TlbEntry *retval = NULL;
+    if (hit >= 0) {
+        // We only move the hit entry ahead when the position is higher
+        // than rangeMRU
+        if (!functional && !inRangeMRU(hit))
+            moveToMRU(hit);
+        retval = &table[hit];
     }
 
     DPRINTF(TLBVerbose, "Lookup %#x, asn %#x -> %s vmn 0x%x hyp %d secure %d "
@@ -168,6 +189,151 @@ TLB::lookup(Addr va, uint16_t asn, uint8_t vmid, bool hyp, bool secure,
     return retval;
 }
 
+void
+TLB::resetLRU()
+{
+    for (int i = 0; i < size; ++i) {
+        lruPrev[i] = i - 1;
+        lruNext[i] = i + 1 < size ? i + 1 : -1;
+        lruStamp[i] = size - i;
+    }
+    lruHead = size ? 0 : -1;
+    lruTail = size - 1;
+    nextStamp = size + 1;
+}
+
+void
+TLB::moveToMRU(int slot)
+{
+    lruStamp[slot] = nextStamp++;
+    if (slot == lruHead)
+        return;
+
+    // unlink
+    lruNext[lruPrev[slot]] = lruNext[slot];
+    if (lruNext[slot] >= 0)
+        lruPrev[lruNext[slot]] = lruPrev[slot];
+    else
+        lruTail = lruPrev[slot];
+
+    // and put in front
+    lruPrev[slot] = -1;
+    lruNext[slot] = lruHead;
+    lruPrev[lruHead] = slot;
+    lruHead = slot;
+}
+
+bool
+TLB::inRangeMRU(int slot) const
+{
+    int x = lruHead;
+    for (int pos = 0; pos <= rangeMRU && x >= 0; ++pos, x = lruNext[x]) {
+        if (x == slot)
+            return true;
+    }
+    return false;
+}
+
+void
+TLB::removeSlot(vector<int> &slots, int slot)
+{
+    for (int i = 0; i < slots.size(); ++i) {
+        if (slots[i] == slot) {
+            slots[i] = slots.back();
+            slots.pop_back();
+            return;
+        }
+    }
+    panic("TLB slot %d missing from its index\n", slot);
+}
+
+void
+TLB::indexSlot(int slot)
+{
+    assert(!slotIndexed[slot]);
+    const TlbEntry &te = table[slot];
+    if (!te.valid)
+        return;
+
+    // An entry matches [vpn << N, (vpn << N) + size], which is a
+    // whole page of size + 1 bytes for everything the table walker
+    // inserts
+    Addr base = te.vpn << te.N;
+    Addr span = te.size + 1;
+    if (span != 0 && isPowerOf2(span) && (base & (span - 1)) == 0) {
+        int i = 0;
+        while (i < pageIndex.size() && pageIndex[i].span != span)
+            ++i;
+        if (i == pageIndex.size()) {
+            pageIndex.push_back(PageIndex());
+            pageIndex[i].span = span;
+            pageIndex[i].entries = 0;
+        }
+        pageIndex[i].pages[base].push_back(slot);
+        ++pageIndex[i].entries;
+        slotSpan[slot] = span;
+        slotPage[slot] = base;
+    } else {
+        irregularSlots.push_back(slot);
+        slotSpan[slot] = 0;
+    }
+
+    asidIndex[te.asid].push_back(slot);
+    slotAsid[slot] = te.asid;
+    slotIndexed[slot] = true;
+}
+
+void
+TLB::unindexSlot(int slot)
+{
+    if (!slotIndexed[slot])
+        return;
+
+    if (slotSpan[slot] == 0) {
+        removeSlot(irregularSlots, slot);
+    } else {
+        int i = 0;
+        while (pageIndex[i].span != slotSpan[slot])
+            ++i;
+        unordered_map<Addr, vector<int> >::iterator page =
+            pageIndex[i].pages.find(slotPage[slot]);
+        assert(page != pageIndex[i].pages.end());
+        removeSlot(page->second, slot);
+        if (page->second.empty())
+            pageIndex[i].pages.erase(page);
+        --pageIndex[i].entries;
+    }
+
+    unordered_map<uint16_t, vector<int> >::iterator asid_slots =
+        asidIndex.find(slotAsid[slot]);
+    removeSlot(asid_slots->second, slot);
+    if (asid_slots->second.empty())
+        asidIndex.erase(asid_slots);
+
+    slotIndexed[slot] = false;
+}
+
+void
+TLB::rebuildIndex()
+{
+    pageIndex.clear();
+    irregularSlots.clear();
+    asidIndex.clear();
+    for (int i = 0; i < size; ++i)
+        slotIndexed[i] = false;
+
+    resetLRU();
+    for (int i = 0; i < size; ++i)
+        indexSlot(i);
+}
+
+void
+TLB::invalidateSlot(int slot)
+{
+    unindexSlot(slot);
+    table[slot].valid = false;
+}
+
 // insert a new TLB entry
 void
 TLB::insert(Addr addr, TlbEntry &entry)
@@ -180,20 +346,20 @@ TLB::insert(Addr addr, TlbEntry &entry)
             entry.ap, static_cast<uint8_t>(entry.domain), entry.ns, entry.nstid,
             entry.isHyp);
 
-    if (table[size - 1].valid)
+    TlbEntry &victim = table[lruTail];
+    if (victim.valid)
         DPRINTF(TLB, " - Replacing Valid entry %#x, asn %d vmn %d ppn %#x "
                 "size: %#x ap:%d ns:%d nstid:%d g:%d isHyp:%d el: %d\n",
-                table[size-1].vpn << table[size-1].N, table[size-1].asid,
-                table[size-1].vmid, table[size-1].pfn << table[size-1].N,
-                table[size-1].size, table[size-1].ap, table[size-1].ns,
-                table[size-1].nstid, table[size-1].global, table[size-1].isHyp,
-                table[size-1].el);
+                victim.vpn << victim.N, victim.asid, victim.vmid,
+                victim.pfn << victim.N, victim.size, victim.ap, victim.ns,
+                victim.nstid, victim.global, victim.isHyp, victim.el);
 
     //inserting to MRU position and evicting the LRU one
-
-    for (int i = size - 1; i > 0; --i)
-        table[i] = table[i-1];
-    table[0] = entry;
+    int slot = lruTail;
+    unindexSlot(slot);
+    table[slot] = entry;
+    indexSlot(slot);
+    moveToMRU(slot);
 
     inserts++;
 }
@@ -201,14 +367,11 @@ TLB::insert(Addr addr, TlbEntry &entry)
 void
 TLB::printTlb() const
 {
-    int x = 0;
-    TlbEntry *te;
     DPRINTF(TLB, "Current TLB contents:\n");
-    while (x < size) {
-        te = &table[x];
+    for (int x = lruHead; x >= 0; x = lruNext[x]) {
+        const TlbEntry *te = &table[x];
         if (te->valid)
             DPRINTF(TLB, " *  %s\n", te->print());
-        ++x;
     }
 }
 
@@ -217,19 +380,16 @@ TLB::flushAllSecurity(bool secure_lookup, uint8_t target_el, bool ignore_el)
 {
     DPRINTF(TLB, "Flushing all TLB entries (%s lookup)\n",
             (secure_lookup ? "secure" : "non-secure"));
-    int x = 0;
-    TlbEntry *te;
-    while (x < size) {
-        te = &table[x];
+    for (int x = lruHead; x >= 0; x = lruNext[x]) {
+        TlbEntry *te = &table[x];
         if (te->valid && secure_lookup == !te->nstid &&
             (te->vmid == vmid || secure_lookup) &&
             checkELMatch(target_el, te->el, ignore_el)) {
 
             DPRINTF(TLB, " -  %s\n", te->print());
-            te->valid = false;
+            invalidateSlot(x);
             flushedEntries++;
         }
-        ++x;
     }
 
     flushTlb++;
@@ -246,18 +406,15 @@ TLB::flushAllNs(bool hyp, uint8_t target_el, bool ignore_el)
 {
     DPRINTF(TLB, "Flushing all NS TLB entries (%s lookup)\n",
             (hyp ? "hyp" : "non-hyp"));
-    int x = 0;
-    TlbEntry *te;
-    while (x < size) {
-        te = &table[x];
+    for (int x = lruHead; x >= 0; x = lruNext[x]) {
+        TlbEntry *te = &table[x];
         if (te->valid && te->nstid && te->isHyp == hyp &&
             checkELMatch(target_el, te->el, ignore_el)) {
 
             DPRINTF(TLB, " -  %s\n", te->print());
             flushedEntries++;
-            te->valid = false;
+            invalidateSlot(x);
         }
-        ++x;
     }
 
     flushTlb++;
@@ -284,20 +441,26 @@ TLB::flushAsid(uint64_t asn, bool secure_lookup, uint8_t target_el)
     DPRINTF(TLB, "Flushing TLB entries with asid: %#x (%s lookup)\n", asn,
             (secure_lookup ? "secure" : "non-secure"));
 
-    int x = 0 ;
-    TlbEntry *te;
+    // Only the entries of this ASID need to be looked at; copy the
+    // slots as invalidating them updates the index
+    vector<int> slots;
+    if (asn == (uint16_t)asn) {
+        unordered_map<uint16_t, vector<int> >::const_iterator asid_slots =
+            asidIndex.find(asn);
+        if (asid_slots != asidIndex.end())
+            slots = asid_slots->second;
+    }
 
-    while (x < size) {
-        te = &table[x];
+    for (int i = 0; i < slots.size(); ++i) {
+        TlbEntry *te = &table[slots[i]];
         if (te->valid && te->asid == asn && secure_lookup == !te->nstid &&
             (te->vmid == vmid || secure_lookup) &&
             checkELMatch(target_el, te->el, false)) {
 
-            te->valid = false;
+            invalidateSlot(slots[i]);
             DPRINTF(TLB, " -  %s\n", te->print());
             flushedEntries++;
         }
-        ++x;
     }
     flushTlbAsid++;
 }
@@ -323,7 +486,7 @@ TLB::_flushMva(Addr mva, uint64_t asn, bool secure_lookup, bool hyp,
     while (te != NULL) {
         if (secure_lookup == !te->nstid) {
             DPRINTF(TLB, " -  %s\n", te->print());
-            te->valid = false;
+            invalidateSlot(te - table);
             flushedEntries++;
         }
         te = lookup(mva, asn, vmid, hyp, secure_lookup, false, ignore_asn,
@@ -388,11 +551,14 @@ TLB::serialize(ostream &os)
     SERIALIZE_SCALAR(stage2Req);
     SERIALIZE_SCALAR(bootUncacheability);
 
+    // Entries are saved in LRU order, MRU first, as in the table
+    // before it was indexed
     int num_entries = size;
     SERIALIZE_SCALAR(num_entries);
-    for(int i = 0; i < size; i++){
+    int i = 0;
+    for (int x = lruHead; x >= 0; x = lruNext[x], ++i) {
         nameOut(os, csprintf("%s.TlbEntry%d", name(), i));
-        table[i].serialize(os);
+        table[x].serialize(os);
     }
 }
 
@@ -412,6 +578,7 @@ TLB::unserialize(Checkpoint *cp, const string &section)
     for(int i = 0; i < min(size, num_entries); i++){
         table[i].unserialize(cp, csprintf("%s.TlbEntry%d", section, i));
     }
+    rebuildIndex();
 }
 
 void
@@ -43,6 +43,8 @@
 #ifndef __ARCH_ARM_TLB_HH__
 #define __ARCH_ARM_TLB_HH__
 
+#include <unordered_map>
+#include <vector>
 
 #include "arch/arm/isa_traits.hh"
 #include "arch/arm/pagetable.hh"
@@ -133,6 +135,64 @@ class TLB : public BaseTLB
 
     int rangeMRU; //On lookup, only move entries ahead when outside rangeMRU
 
+    /**
+     * The entries stay in their slot of the table for as long as they
+     * are cached. Their LRU order, which used to be kept by shifting
+     * the table, is a list of slots, and the valid entries are found
+     * through a hash of their page for every page size in use, so a
+     * lookup only compares the entries of the pages it could hit. A
+     * list of slots per ASID does the same for ASID flushes.
+     */
+    struct PageIndex
+    {
+        /** Page size of the entries, a power of two. */
+        Addr span;
+        /** Number of entries indexed for this page size. */
+        int entries;
+        /** Slots of the valid entries, by page base address. */
+        std::unordered_map<Addr, std::vector<int> > pages;
+    };
+
+    std::vector<PageIndex> pageIndex;
+    /** Valid entries that do not cover an aligned power of two page. */
+    std::vector<int> irregularSlots;
+    /** Slots of the valid entries of each ASID. */
+    std::unordered_map<uint16_t, std::vector<int> > asidIndex;
+
+    /** Page size and base the slot is indexed under, span 0 if none. */
+    std::vector<Addr> slotSpan;
+    std::vector<Addr> slotPage;
+    std::vector<uint16_t> slotAsid;
+    std::vector<bool> slotIndexed;
+
+    /** LRU order of the slots, MRU first. */
+    std::vector<int> lruPrev;
+    std::vector<int> lruNext;
+    int lruHead;
+    int lruTail;
+    /**
+     * Stamp of the last move to the MRU position; of two slots the one
+     * with the larger stamp is nearer the MRU end.
+     */
+    std::vector<uint64_t> lruStamp;
+    uint64_t nextStamp;
+
+    /** Put the slots back in table order, slot 0 most recent. */
+    void resetLRU();
+    void moveToMRU(int slot);
+    /** Whether the slot is within the first rangeMRU + 1 positions. */
+    bool inRangeMRU(int slot) const;
+
+    /** Add the entry in the slot to the indices if it is valid. */
+    void indexSlot(int slot);
+    void unindexSlot(int slot);
+    /** Rebuild all the lookup state from the table. */
+    void rebuildIndex();
+    /** Invalidate the entry in a slot and drop it from the indices. */
+    void invalidateSlot(int slot);
+
+    static void removeSlot(std::vector<int> &slots, int slot);
+
     bool bootUncacheability;
 
   public:
@@ -166,9 +166,12 @@ findMsbSet(uint64_t val) {
  */
 inline int
 findLsbSet(uint64_t val) {
-    int lsb = 0;
     if (!val)
         return sizeof(val) * 8;
+#if defined(__GNUC__)
+    return __builtin_ctzll(val);
+#else
+    int lsb = 0;
     if (!bits(val, 31,0)) { lsb += 32; val >>= 32; }
     if (!bits(val, 15,0)) { lsb += 16; val >>= 16; }
     if (!bits(val, 7,0))  { lsb += 8;  val >>= 8;  }
@@ -176,6 +179,22 @@ findLsbSet(uint64_t val) {
     if (!bits(val, 1,0))  { lsb += 2;  val >>= 2;  }
     if (!bits(val, 0,0))  { lsb += 1; }
     return lsb;
+#endif
+}
+
+/**
+ * Returns the number of set bits in the input
+ */
+inline int
+popCount(uint64_t val) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(val);
+#else
+    int count = 0;
+    for (; val; val &= val - 1)
+        count++;
+    return count;
+#endif
 }
 
 #endif // __BASE_BITFIELD_HH__
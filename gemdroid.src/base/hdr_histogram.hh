@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2014 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Fixed size histogram with a bounded relative error, for latency
+ * percentiles over arbitrarily long runs.
+ */
+
+#ifndef __BASE_HDR_HISTOGRAM_HH__
+#define __BASE_HDR_HISTOGRAM_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/types.hh"
+
+/**
+ * Log-linear histogram in the style of HdrHistogram. Values below
+ * 2^subBits get a bucket each; above that every power of two is split
+ * in 2^(subBits - 1) equal buckets, so any value is known to within a
+ * relative error of 2^(1 - subBits) whatever its magnitude. The memory
+ * is fixed when the histogram is set up, values beyond the highest one
+ * go to the top bucket, and the exact minimum, maximum and mean are
+ * kept on the side.
+ */
+class HdrHistogram
+{
+  public:
+    HdrHistogram()
+        : subBits(0), half(0), highest(0)
+    {
+        reset();
+    }
+
+    /**
+     * @param sub_bucket_bits Precision, values are within 2^(1-bits),
+     *                        1.6% for 7
+     * @param highest_value Highest value told apart from the larger ones
+     */
+    void
+    init(unsigned sub_bucket_bits, uint64_t highest_value)
+    {
+        assert(sub_bucket_bits >= 1 && sub_bucket_bits <= 24);
+        subBits = sub_bucket_bits;
+        half = ULL(1) << (subBits - 1);
+        highest = std::max(highest_value, ULL(1) << subBits);
+        counts.assign(index(highest) + 1, 0);
+        reset();
+    }
+
+    void
+    sample(uint64_t value, uint64_t n = 1)
+    {
+        counts[index(std::min(value, highest))] += n;
+        total += n;
+        sum += (double)value * n;
+        minValue = std::min(minValue, value);
+        maxValue = std::max(maxValue, value);
+    }
+
+    void
+    reset()
+    {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        sum = 0;
+        minValue = std::numeric_limits<uint64_t>::max();
+        maxValue = 0;
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t min() const { return total ? minValue : 0; }
+    uint64_t max() const { return maxValue; }
+    double mean() const { return total ? sum / total : 0; }
+
+    /** Number of buckets, i.e. the memory used. */
+    size_t size() const { return counts.size(); }
+
+    /**
+     * Value at a quantile: the highest value of the bucket that holds
+     * the q * count-th sample, but never above the maximum seen. The
+     * top bucket holds everything beyond the highest value and gives
+     * the maximum.
+     */
+    uint64_t
+    quantile(double q) const
+    {
+        if (total == 0)
+            return 0;
+
+        uint64_t rank = std::max((uint64_t)std::ceil(q * total), ULL(1));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                if (i == counts.size() - 1)
+                    return maxValue;
+                return std::min(highestEquivalent(i), maxValue);
+            }
+        }
+        return maxValue;
+    }
+
+  private:
+    size_t
+    index(uint64_t value) const
+    {
+        if (value < (half << 1))
+            return value;
+
+        // value >> shift is in [half, 2 * half)
+        unsigned shift = floorLog2(value) - subBits + 1;
+        return shift * half + (value >> shift);
+    }
+
+    uint64_t
+    highestEquivalent(size_t idx) const
+    {
+        if (idx < (half << 1))
+            return idx;
+
+        unsigned shift = idx / half - 1;
+        uint64_t sub = idx - shift * half;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    unsigned subBits;
+    uint64_t half;
+    uint64_t highest;
+
+    std::vector<uint64_t> counts;
+    uint64_t total;
+    double sum;
+    uint64_t minValue;
+    uint64_t maxValue;
+};
+
+#endif // __BASE_HDR_HISTOGRAM_HH__
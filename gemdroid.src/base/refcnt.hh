@@ -163,6 +163,11 @@ class RefCountingPtr
     /// one.  Adds a reference.
     RefCountingPtr(const RefCountingPtr &r) { copy(r.data); }
 
+    /// Take over the reference of a pointer that is going away, which
+    /// saves the increment/decrement pair when a pointer is returned
+    /// or shuffled around inside an STL container.
+    RefCountingPtr(RefCountingPtr &&r) : data(r.data) { r.data = 0; }
+
     /// Destroy the pointer and any reference it may hold.
     ~RefCountingPtr() { del(); }
 
@@ -186,6 +191,21 @@ class RefCountingPtr
     const RefCountingPtr &operator=(const RefCountingPtr &r)
     { return operator=(r.data); }
 
+    /// Take over the reference of a pointer that is going away
+    const RefCountingPtr &
+    operator=(RefCountingPtr &&r)
+    {
+        // Detach r before dropping our reference in case r lives
+        // inside the object that reference keeps alive.
+        if (this != &r) {
+            T *d = r.data;
+            r.data = 0;
+            del();
+            data = d;
+        }
+        return *this;
+    }
+
     /// Check if the pointer is empty
     bool operator!() const { return data == 0; }
 
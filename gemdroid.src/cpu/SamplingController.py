@@ -0,0 +1,49 @@
+# Copyright (c) 2014 The Pennsylvania State University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+from m5.SimObject import SimObject
+from m5.params import *
+
+# Paces a sampled run: fast-forward on the functional CPUs, then switch
+# to the detailed CPUs for a warm-up period and a measurement window,
+# and back. The controller leaves the simulation loop with the causes
+# below and the run script does the actual CPU switch.
+class SamplingController(SimObject):
+    type = 'SamplingController'
+    cxx_header = "cpu/sampling_controller.hh"
+
+    detailed_cpus = VectorParam.BaseCPU("CPUs that are measured")
+    fast_forward = Param.Latency("Functional simulation between samples")
+    warmup = Param.Latency("0ns",
+        "Detailed simulation before each window to warm the pipeline")
+    detail = Param.Latency("Detailed measurement window")
+    max_samples = Param.Unsigned(0,
+        "Stop after this many samples (0 = no limit)")
+    confidence = Param.Float(0.95, "Confidence level of the IPC interval")
+    target_error = Param.Float(0.0,
+        "Stop once the IPC interval is within this fraction of the mean")
+    min_samples = Param.Unsigned(30,
+        "Samples needed before target_error can end the run")
@@ -47,6 +47,7 @@
 #include "arch/isa_traits.hh"
 #include "config/the_isa.hh"
 #include "cpu/o3/cpu.hh"
+#include "cpu/o3/dyn_inst_pool.hh"
 #include "cpu/o3/isa_specific.hh"
 #include "cpu/base_dyn_inst.hh"
 #include "cpu/inst_seq.hh"
@@ -93,6 +94,15 @@ class BaseO3DynInst : public BaseDynInst<Impl>
 
     ~BaseO3DynInst();
 
+    /** Instructions are recycled through a free list instead of going
+     *  to the heap on every fetch.
+     */
+    static void *operator new(size_t size)
+    { return DynInstPool<BaseO3DynInst>::allocate(size); }
+
+    static void operator delete(void *ptr, size_t size)
+    { DynInstPool<BaseO3DynInst>::release(ptr, size); }
+
     /** Executes the instruction.*/
     Fault execute();
 
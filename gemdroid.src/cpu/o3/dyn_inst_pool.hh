@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2014 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_O3_DYN_INST_POOL_HH__
+#define __CPU_O3_DYN_INST_POOL_HH__
+
+#include <cstddef>
+#include <new>
+
+/**
+ * Free list allocator for the dynamic instructions of the O3 CPU. Fetch
+ * builds an instruction for every fetched micro-op and most of them die
+ * a few hundred cycles later on commit or squash, so going through
+ * malloc for each one is a measurable part of the run time. The pool
+ * carves instructions out of large blocks and recycles freed ones LIFO,
+ * which also keeps the instructions in flight close together in the
+ * cache.
+ *
+ * Blocks are never returned to the heap; the pool only grows to the
+ * largest number of instructions the CPUs ever had alive at once.
+ * There is one pool per instruction type and simulation thread, shared
+ * by the CPUs of that type on the thread's event queue. CPUs on other
+ * event queues, in parallel mode, get their own free list and never
+ * touch it, so the pool needs no locking.
+ */
+template <class T>
+class DynInstPool
+{
+  public:
+    /** Instructions carved out of the heap at a time. */
+    static const size_t BLOCK_INSTS = 256;
+
+    static void *
+    allocate(size_t size)
+    {
+        // A derived instruction type is bigger than the chunks
+        if (size > CHUNK_SIZE)
+            return ::operator new(size);
+
+        if (!freeList)
+            refill();
+
+        FreeChunk *chunk = freeList;
+        freeList = chunk->next;
+        return chunk;
+    }
+
+    static void
+    release(void *ptr, size_t size)
+    {
+        if (!ptr)
+            return;
+
+        if (size > CHUNK_SIZE) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        FreeChunk *chunk = static_cast<FreeChunk *>(ptr);
+        chunk->next = freeList;
+        freeList = chunk;
+    }
+
+  private:
+    struct FreeChunk
+    {
+        FreeChunk *next;
+    };
+
+    /** Chunk size, rounded up to keep every chunk aligned like new. */
+    static const size_t ALIGN = 16;
+    static const size_t CHUNK_SIZE =
+        (sizeof(T) + ALIGN - 1) / ALIGN * ALIGN;
+
+    static void
+    refill()
+    {
+        char *block =
+            static_cast<char *>(::operator new(BLOCK_INSTS * CHUNK_SIZE));
+
+        for (size_t i = BLOCK_INSTS; i > 0; --i) {
+            FreeChunk *chunk =
+                reinterpret_cast<FreeChunk *>(block + (i - 1) * CHUNK_SIZE);
+            chunk->next = freeList;
+            freeList = chunk;
+        }
+    }
+
+    /** Free chunks of the calling thread. */
+    static __thread FreeChunk *freeList;
+};
+
+template <class T>
+__thread typename DynInstPool<T>::FreeChunk *DynInstPool<T>::freeList = NULL;
+
+#endif // __CPU_O3_DYN_INST_POOL_HH__
@@ -51,7 +51,9 @@
 
 #include "base/statistics.hh"
 #include "base/types.hh"
+#include "config/o3_iq_age_matrix.hh"
 #include "cpu/o3/dep_graph.hh"
+#include "cpu/o3/iq_age_matrix.hh"
 #include "cpu/inst_seq.hh"
 #include "cpu/op_class.hh"
 #include "cpu/timebuf.hh"
@@ -308,6 +310,13 @@ class InstructionQueue
      */
     std::list<DynInstPtr> deferredMemInsts;
 
+#if O3_IQ_AGE_MATRIX
+    /** Ready instructions of all op classes, selected oldest first
+     *  through an age matrix instead of the per op class heaps and the
+     *  age order list.
+     */
+    IQAgeMatrix<DynInstPtr> readySelect;
+#else
     /**
      * Struct for comparing entries to be added to the priority queue.
      * This gives reverse ordering to the instructions in terms of
@@ -329,6 +338,7 @@ class InstructionQueue
      *  class to allow for easy mapping to FUs.
      */
     ReadyInstQueue readyInsts[Num_OpClasses];
+#endif
 
     /** List of non-speculative instructions that will be scheduled
      *  once the IQ gets a signal from commit.  While it's redundant to
@@ -341,6 +351,7 @@ class InstructionQueue
 
     typedef typename std::map<InstSeqNum, DynInstPtr>::iterator NonSpecMapIt;
 
+#if !O3_IQ_AGE_MATRIX
     /** Entry for the list age ordering by op class. */
     struct ListOrderEntry {
         OpClass queueType;
@@ -374,6 +385,7 @@ class InstructionQueue
      * this places that ready queue into the proper spot in the age order list.
      */
     void moveToYoungerInst(ListOrderIt age_order_it);
+#endif
 
     DependencyGraph<DynInstPtr> dependGraph;
 
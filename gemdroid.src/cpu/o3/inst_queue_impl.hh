@@ -108,6 +108,10 @@ InstructionQueue<Impl>::InstructionQueue(O3CPU *cpu_ptr, IEW *iew_ptr,
     // Resize the register scoreboard.
     regScoreboard.resize(numPhysRegs);
 
+#if O3_IQ_AGE_MATRIX
+    readySelect.init(numEntries);
+#endif
+
     //Initialize Mem Dependence Units
     for (ThreadID tid = 0; tid < numThreads; tid++) {
         memDepUnit[tid].init(params, tid);
@@ -404,14 +408,18 @@ InstructionQueue<Impl>::resetState()
         squashedSeqNum[tid] = 0;
     }
 
+#if O3_IQ_AGE_MATRIX
+    readySelect.clear();
+#else
     for (int i = 0; i < Num_OpClasses; ++i) {
         while (!readyInsts[i].empty())
             readyInsts[i].pop();
         queueOnList[i] = false;
         readyIt[i] = listOrder.end();
     }
-    nonSpecInsts.clear();
     listOrder.clear();
+#endif
+    nonSpecInsts.clear();
     deferredMemInsts.clear();
 }
 
@@ -531,6 +539,9 @@ template <class Impl>
 bool
 InstructionQueue<Impl>::hasReadyInsts()
 {
+#if O3_IQ_AGE_MATRIX
+    return !readySelect.empty();
+#else
     if (!listOrder.empty()) {
         return true;
     }
@@ -542,6 +553,7 @@ InstructionQueue<Impl>::hasReadyInsts()
     }
 
     return false;
+#endif
 }
 
 template <class Impl>
@@ -649,6 +661,7 @@ InstructionQueue<Impl>::getInstToExecute()
     return inst;
 }
 
+#if !O3_IQ_AGE_MATRIX
 template <class Impl>
 void
 InstructionQueue<Impl>::addToOrderList(OpClass op_class)
@@ -701,6 +714,7 @@ InstructionQueue<Impl>::moveToYoungerInst(ListOrderIt list_order_it)
 
     readyIt[op_class] = listOrder.insert(next_it, queue_entry);
 }
+#endif
 
 template <class Impl>
 void
@@ -751,24 +765,44 @@ InstructionQueue<Impl>::scheduleReadyInsts()
     // Increment the iterator.
     // This will avoid trying to schedule a certain op class if there are no
     // FUs that handle it.
+    // With the age matrix the same order falls out of always selecting
+    // the oldest ready instruction whose op class has not found its FUs
+    // busy this cycle.
+#if O3_IQ_AGE_MATRIX
+    readySelect.beginSelect();
+    int slot = -1;
+#else
     ListOrderIt order_it = listOrder.begin();
     ListOrderIt order_end_it = listOrder.end();
+#endif
     int total_issued = 0;
 
     while (total_issued < (totalWidth - total_deferred_mem_issued) &&
            iewStage->canIssue() &&
+#if O3_IQ_AGE_MATRIX
+           (slot = readySelect.selectOldest()) != -1) {
+        OpClass op_class = readySelect.opClass(slot);
+
+        DynInstPtr issuing_inst = readySelect.inst(slot);
+#else
            order_it != order_end_it) {
         OpClass op_class = (*order_it).queueType;
 
         assert(!readyInsts[op_class].empty());
 
         DynInstPtr issuing_inst = readyInsts[op_class].top();
+#endif
 
         issuing_inst->isFloating() ? fpInstQueueReads++ : intInstQueueReads++;
 
+#if !O3_IQ_AGE_MATRIX
         assert(issuing_inst->seqNum == (*order_it).oldestInst);
+#endif
 
         if (issuing_inst->isSquashed()) {
+#if O3_IQ_AGE_MATRIX
+            readySelect.remove(slot);
+#else
             readyInsts[op_class].pop();
 
             if (!readyInsts[op_class].empty()) {
@@ -779,6 +813,7 @@ InstructionQueue<Impl>::scheduleReadyInsts()
             }
 
             listOrder.erase(order_it++);
+#endif
 
             ++iqSquashedInstsIssued;
 
@@ -833,6 +868,9 @@ InstructionQueue<Impl>::scheduleReadyInsts()
                     tid, issuing_inst->pcState(),
                     issuing_inst->seqNum);
 
+#if O3_IQ_AGE_MATRIX
+            readySelect.remove(slot);
+#else
             readyInsts[op_class].pop();
 
             if (!readyInsts[op_class].empty()) {
@@ -841,6 +879,7 @@ InstructionQueue<Impl>::scheduleReadyInsts()
                 readyIt[op_class] = listOrder.end();
                 queueOnList[op_class] = false;
             }
+#endif
 
             issuing_inst->setIssued();
             ++total_issued;
@@ -859,13 +898,19 @@ InstructionQueue<Impl>::scheduleReadyInsts()
                 memDepUnit[tid].issue(issuing_inst);
             }
 
+#if !O3_IQ_AGE_MATRIX
             listOrder.erase(order_it++);
+#endif
             statIssuedInstType[tid][op_class]++;
             iewStage->incrWb(issuing_inst->seqNum);
         } else {
             statFuBusy[op_class]++;
             fuBusy[tid]++;
+#if O3_IQ_AGE_MATRIX
+            readySelect.block(op_class);
+#else
             ++order_it;
+#endif
         }
     }
 
@@ -1017,6 +1062,9 @@ InstructionQueue<Impl>::addReadyMemInst(DynInstPtr &ready_inst)
 {
     OpClass op_class = ready_inst->opClass();
 
+#if O3_IQ_AGE_MATRIX
+    readySelect.push(ready_inst, op_class);
+#else
     readyInsts[op_class].push(ready_inst);
 
     // Will need to reorder the list if either a queue is not on the list,
@@ -1028,6 +1076,7 @@ InstructionQueue<Impl>::addReadyMemInst(DynInstPtr &ready_inst)
         listOrder.erase(readyIt[op_class]);
         addToOrderList(op_class);
     }
+#endif
 
     DPRINTF(IQ, "Instruction is ready to issue, putting it onto "
             "the ready list, PC %s opclass:%i [sn:%lli].\n",
@@ -1347,6 +1396,9 @@ InstructionQueue<Impl>::addIfReady(DynInstPtr &inst)
                 "the ready list, PC %s opclass:%i [sn:%lli].\n",
                 inst->pcState(), op_class, inst->seqNum);
 
+#if O3_IQ_AGE_MATRIX
+        readySelect.push(inst, op_class);
+#else
         readyInsts[op_class].push(inst);
 
         // Will need to reorder the list if either a queue is not on the list,
@@ -1358,6 +1410,7 @@ InstructionQueue<Impl>::addIfReady(DynInstPtr &inst)
             listOrder.erase(readyIt[op_class]);
             addToOrderList(op_class);
         }
+#endif
     }
 }
 
@@ -1402,7 +1455,11 @@ void
 InstructionQueue<Impl>::dumpLists()
 {
     for (int i = 0; i < Num_OpClasses; ++i) {
+#if O3_IQ_AGE_MATRIX
+        cprintf("Ready list %i size: %i\n", i, readySelect.size(OpClass(i)));
+#else
         cprintf("Ready list %i size: %i\n", i, readyInsts[i].size());
+#endif
 
         cprintf("\n");
     }
@@ -1422,6 +1479,7 @@ InstructionQueue<Impl>::dumpLists()
 
     cprintf("\n");
 
+#if !O3_IQ_AGE_MATRIX
     ListOrderIt list_order_it = listOrder.begin();
     ListOrderIt list_order_end_it = listOrder.end();
     int i = 1;
@@ -1437,6 +1495,7 @@ InstructionQueue<Impl>::dumpLists()
     }
 
     cprintf("\n");
+#endif
 }
 
 
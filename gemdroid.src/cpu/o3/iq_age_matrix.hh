@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2014 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __CPU_O3_IQ_AGE_MATRIX_HH__
+#define __CPU_O3_IQ_AGE_MATRIX_HH__
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "base/bitfield.hh"
+#include "cpu/inst_seq.hh"
+#include "cpu/op_class.hh"
+
+/**
+ * Ready list of the instruction queue kept as an age matrix. Every ready
+ * instruction sits in a slot; each slot has a row with a bit set for
+ * every other ready slot holding an older instruction, and every op
+ * class has a bitmask of its ready slots. Selecting the oldest ready
+ * instruction among the op classes that still have a free FU checks
+ * the row of each candidate against the candidate mask, one AND per
+ * word, until it finds the candidate with no older one: O(candidates x
+ * words) in the worst case, and one word per candidate with up to 64
+ * slots. This replaces a walk over a sorted list of per-class heaps.
+ *
+ * Slots are handed out from a free list and the matrix starts with one
+ * slot per IQ entry. Squashed instructions stay on the ready list until
+ * select reaches them, exactly as with the heaps, so the matrix grows a
+ * word at a time in the rare case where they overflow it.
+ */
+template <class DynInstPtr>
+class IQAgeMatrix
+{
+  public:
+    IQAgeMatrix() : numSlots(0), numWords(0), numReady(0) { clear(); }
+
+    /** Sizes the matrix for the given number of instructions. */
+    void
+    init(int capacity)
+    {
+        numSlots = 0;
+        numWords = 0;
+        older.clear();
+        ready.clear();
+        candidates.clear();
+        for (int i = 0; i < Num_OpClasses; ++i)
+            classReady[i].clear();
+        insts.clear();
+        seqNums.clear();
+        classes.clear();
+        freeSlots.clear();
+        while (numSlots < capacity)
+            grow();
+        clear();
+    }
+
+    /** Empties the ready list, keeping the allocated slots. */
+    void
+    clear()
+    {
+        std::fill(ready.begin(), ready.end(), 0);
+        for (int i = 0; i < Num_OpClasses; ++i) {
+            std::fill(classReady[i].begin(), classReady[i].end(), 0);
+            classCount[i] = 0;
+        }
+        for (int i = 0; i < numSlots; ++i)
+            insts[i] = NULL;
+        freeSlots.clear();
+        for (int i = numSlots - 1; i >= 0; --i)
+            freeSlots.push_back(i);
+        numReady = 0;
+    }
+
+    bool empty() const { return numReady == 0; }
+
+    int size(OpClass op_class) const { return classCount[op_class]; }
+
+    /** Puts an instruction whose operands are ready on the list. */
+    void
+    push(const DynInstPtr &inst, OpClass op_class)
+    {
+        if (freeSlots.empty())
+            grow();
+
+        int slot = freeSlots.back();
+        freeSlots.pop_back();
+
+        InstSeqNum seq_num = inst->seqNum;
+        uint64_t *row = &older[slot * numWords];
+        uint64_t slot_bit = bit(slot);
+        int slot_word = slot / WORD_BITS;
+
+        // Fill in the new row and the new column: a slot is older than
+        // this one if its sequence number is lower, or equal and it was
+        // put on the list first.
+        for (int w = 0; w < numWords; ++w) {
+            uint64_t pending = ready[w];
+            uint64_t older_bits = 0;
+            while (pending) {
+                int other = w * WORD_BITS + findLsbSet(pending);
+                pending &= pending - 1;
+                uint64_t &other_word = older[other * numWords + slot_word];
+                if (seqNums[other] <= seq_num) {
+                    older_bits |= bit(other);
+                    other_word &= ~slot_bit;
+                } else {
+                    other_word |= slot_bit;
+                }
+            }
+            row[w] = older_bits;
+        }
+
+        insts[slot] = inst;
+        seqNums[slot] = seq_num;
+        classes[slot] = op_class;
+        ready[slot_word] |= slot_bit;
+        classReady[op_class][slot_word] |= slot_bit;
+        ++classCount[op_class];
+        ++numReady;
+    }
+
+    /**
+     * Starts a select pass: every op class with a ready instruction is a
+     * candidate until it is blocked.
+     */
+    void
+    beginSelect()
+    {
+        candidates = ready;
+    }
+
+    /**
+     * Drops an op class from the current select pass, for when its FUs
+     * are all busy.
+     */
+    void
+    block(OpClass op_class)
+    {
+        const std::vector<uint64_t> &mask = classReady[op_class];
+        for (int w = 0; w < numWords; ++w)
+            candidates[w] &= ~mask[w];
+    }
+
+    /**
+     * The slot of the oldest candidate of the current select pass, or -1
+     * if there is none. It is the only candidate with no older candidate
+     * in its row.
+     */
+    int
+    selectOldest() const
+    {
+        for (int w = 0; w < numWords; ++w) {
+            uint64_t pending = candidates[w];
+            while (pending) {
+                int slot = w * WORD_BITS + findLsbSet(pending);
+                pending &= pending - 1;
+                const uint64_t *row = &older[slot * numWords];
+                uint64_t blocking = 0;
+                for (int v = 0; v < numWords; ++v)
+                    blocking |= row[v] & candidates[v];
+                if (!blocking)
+                    return slot;
+            }
+        }
+        return -1;
+    }
+
+    const DynInstPtr &inst(int slot) const { return insts[slot]; }
+
+    OpClass opClass(int slot) const { return classes[slot]; }
+
+    /** Takes a selected instruction off the list. */
+    void
+    remove(int slot)
+    {
+        assert(ready[slot / WORD_BITS] & bit(slot));
+
+        int slot_word = slot / WORD_BITS;
+        uint64_t slot_bit = bit(slot);
+        OpClass op_class = classes[slot];
+
+        ready[slot_word] &= ~slot_bit;
+        candidates[slot_word] &= ~slot_bit;
+        classReady[op_class][slot_word] &= ~slot_bit;
+        --classCount[op_class];
+        --numReady;
+
+        insts[slot] = NULL;
+        freeSlots.push_back(slot);
+    }
+
+  private:
+    static const int WORD_BITS = 64;
+
+    static uint64_t bit(int slot)
+    { return (uint64_t)1 << (slot % WORD_BITS); }
+
+    /** Adds another word's worth of slots. */
+    void
+    grow()
+    {
+        int new_words = numWords + 1;
+        int new_slots = new_words * WORD_BITS;
+
+        std::vector<uint64_t> new_older(new_slots * new_words, 0);
+        for (int s = 0; s < numSlots; ++s)
+            for (int w = 0; w < numWords; ++w)
+                new_older[s * new_words + w] = older[s * numWords + w];
+        older.swap(new_older);
+
+        ready.resize(new_words, 0);
+        candidates.resize(new_words, 0);
+        for (int i = 0; i < Num_OpClasses; ++i)
+            classReady[i].resize(new_words, 0);
+        insts.resize(new_slots);
+        seqNums.resize(new_slots, 0);
+        classes.resize(new_slots, No_OpClass);
+
+        // Slots are handed out from the back. The new slots go under
+        // the free ones already there, lowest nearest the back.
+        std::vector<int> added;
+        for (int s = new_slots - 1; s >= numSlots; --s)
+            added.push_back(s);
+        freeSlots.insert(freeSlots.begin(), added.begin(), added.end());
+
+        numSlots = new_slots;
+        numWords = new_words;
+    }
+
+    int numSlots;
+    int numWords;
+    int numReady;
+
+    /** Row per slot, numWords words each: bits of older ready slots. */
+    std::vector<uint64_t> older;
+    std::vector<uint64_t> ready;
+    std::vector<uint64_t> candidates;
+    std::vector<uint64_t> classReady[Num_OpClasses];
+    int classCount[Num_OpClasses];
+
+    std::vector<DynInstPtr> insts;
+    std::vector<InstSeqNum> seqNums;
+    std::vector<OpClass> classes;
+    std::vector<int> freeSlots;
+};
+
+#endif // __CPU_O3_IQ_AGE_MATRIX_HH__
@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2014 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+
+#include "base/misc.hh"
+#include "cpu/base.hh"
+#include "cpu/sampling_controller.hh"
+#include "debug/Sampling.hh"
+#include "sim/sim_exit.hh"
+
+using namespace std;
+
+const char *const SamplingController::switchToDetailed =
+    "sampling: switch to detailed";
+const char *const SamplingController::switchToFastForward =
+    "sampling: switch to fast-forward";
+const char *const SamplingController::samplingDone =
+    "sampling: done";
+
+SamplingController::SamplingController(const Params *p)
+    : SimObject(p),
+      fastForwardEvent(this), warmupEvent(this), detailEvent(this),
+      detailedCPUs(p->detailed_cpus),
+      fastForwardTicks(p->fast_forward),
+      warmupTicks(p->warmup),
+      detailTicks(p->detail),
+      maxSamples(p->max_samples),
+      confidence(p->confidence),
+      targetError(p->target_error),
+      minSamples(p->min_samples),
+      windowStart(0), windowStartInsts(0)
+{
+    fatal_if(detailedCPUs.empty(), "%s: no detailed CPUs to measure\n",
+             name());
+    fatal_if(detailTicks == 0, "%s: measurement window is empty\n", name());
+    fatal_if(confidence <= 0 || confidence >= 1,
+             "%s: confidence must be between 0 and 1\n", name());
+}
+
+void
+SamplingController::startup()
+{
+    schedule(fastForwardEvent, curTick() + fastForwardTicks);
+}
+
+void
+SamplingController::endFastForward()
+{
+    DPRINTF(Sampling, "Sample %d: fast-forward done\n", numSamples());
+
+    // Warm-up and measurement are timed from here; the switch itself
+    // happens in the script before simulation resumes at this tick.
+    schedule(warmupEvent, curTick() + warmupTicks);
+    exitSimLoop(switchToDetailed);
+}
+
+void
+SamplingController::endWarmup()
+{
+    windowStart = curTick();
+    windowStartInsts = detailedInsts();
+    schedule(detailEvent, curTick() + detailTicks);
+}
+
+void
+SamplingController::endDetail()
+{
+    Counter insts = detailedInsts() - windowStartInsts;
+    Tick ticks = curTick() - windowStart;
+    double cycles = (double)ticks / detailedCPUs[0]->clockPeriod();
+    double ipc = insts / cycles;
+
+    sampleIPC.push_back(ipc);
+
+    double avg = mean();
+    double half = halfWidth();
+
+    samples = numSamples();
+    detailedTicks += ticks;
+    ipcMean = avg;
+    ipcHalfWidth = half;
+    ipcRelativeError = avg > 0 ? half / avg : 0;
+    ipcStdev = stdev();
+    ipcDist.sample(ipc);
+
+    DPRINTF(Sampling, "Sample %d: %d insts in %.0f cycles, IPC %.4f, "
+            "mean %.4f +- %.4f\n", numSamples() - 1, insts, cycles, ipc,
+            avg, half);
+
+    if (done()) {
+        inform("%s: %d samples, IPC %.4f +- %.4f (%.0f%% confidence)\n",
+               name(), numSamples(), avg, half, confidence * 100);
+        exitSimLoop(samplingDone);
+        return;
+    }
+
+    schedule(fastForwardEvent, curTick() + fastForwardTicks);
+    exitSimLoop(switchToFastForward);
+}
+
+Counter
+SamplingController::detailedInsts() const
+{
+    Counter total = 0;
+    for (int i = 0; i < detailedCPUs.size(); i++)
+        total += detailedCPUs[i]->totalInsts();
+    return total;
+}
+
+bool
+SamplingController::done() const
+{
+    if (maxSamples && numSamples() >= maxSamples)
+        return true;
+
+    return targetError > 0 && numSamples() >= max(minSamples, 2u) &&
+        halfWidth() <= targetError * mean();
+}
+
+double
+SamplingController::mean() const
+{
+    if (sampleIPC.empty())
+        return 0;
+
+    double sum = 0;
+    for (int i = 0; i < sampleIPC.size(); i++)
+        sum += sampleIPC[i];
+    return sum / sampleIPC.size();
+}
+
+double
+SamplingController::stdev() const
+{
+    int n = sampleIPC.size();
+    if (n < 2)
+        return 0;
+
+    double avg = mean();
+    double sq = 0;
+    for (int i = 0; i < n; i++)
+        sq += (sampleIPC[i] - avg) * (sampleIPC[i] - avg);
+    return sqrt(sq / (n - 1));
+}
+
+double
+SamplingController::halfWidth() const
+{
+    if (numSamples() < 2)
+        return 0;
+
+    return normalQuantile(confidence) * stdev() / sqrt((double)numSamples());
+}
+
+double
+SamplingController::normalQuantile(double confidence)
+{
+    // Acklam's rational approximation of the inverse normal CDF,
+    // accurate to about 1e-9, evaluated at the upper tail point.
+    static const double a[] = {
+        -3.969683028665376e+01, 2.209460984245205e+02,
+        -2.759285104469687e+02, 1.383577518672690e+02,
+        -3.066479806614716e+01, 2.506628277459239e+00 };
+    static const double b[] = {
+        -5.447609879822406e+01, 1.615858368580409e+02,
+        -1.556989798598866e+02, 6.680131188771972e+01,
+        -1.328068155288572e+01 };
+    static const double c[] = {
+        -7.784894002430293e-03, -3.223964580411365e-01,
+        -2.400758277161838e+00, -2.549732539343734e+00,
+        4.374664141464968e+00, 2.938163982698783e+00 };
+    static const double d[] = {
+        7.784695709041462e-03, 3.224671290700398e-01,
+        2.445134137142996e+00, 3.754408661907416e+00 };
+
+    double p = 1 - (1 - confidence) / 2;
+
+    if (p > 1 - 0.02425) {
+        double q = sqrt(-2 * log(1 - p));
+        return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) *
+                 q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) *
+                              q + 1);
+    }
+
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r +
+            a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r +
+                          b[4]) * r + 1);
+}
+
+void
+SamplingController::regStats()
+{
+    using namespace Stats;
+
+    samples
+        .name(name() + ".samples")
+        .desc("Number of detailed measurement windows")
+        ;
+
+    detailedTicks
+        .name(name() + ".detailedTicks")
+        .desc("Ticks measured in detailed windows")
+        ;
+
+    ipcMean
+        .name(name() + ".ipcMean")
+        .desc("Mean IPC over the samples")
+        ;
+
+    ipcStdev
+        .name(name() + ".ipcStdev")
+        .desc("Standard deviation of the sample IPC")
+        ;
+
+    ipcHalfWidth
+        .name(name() + ".ipcHalfWidth")
+        .desc("Half width of the confidence interval of the mean IPC")
+        ;
+
+    ipcRelativeError
+        .name(name() + ".ipcRelativeError")
+        .desc("Confidence interval half width relative to the mean IPC")
+        ;
+
+    ipcDist
+        .init(20)
+        .name(name() + ".ipcDist")
+        .desc("IPC of the samples")
+        .flags(pdf)
+        ;
+}
+
+SamplingController *
+SamplingControllerParams::create()
+{
+    return new SamplingController(this);
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2014 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Controller for SMARTS style sampled simulation.
+ */
+
+#ifndef __CPU_SAMPLING_CONTROLLER_HH__
+#define __CPU_SAMPLING_CONTROLLER_HH__
+
+#include <vector>
+
+#include "base/statistics.hh"
+#include "params/SamplingController.hh"
+#include "sim/eventq.hh"
+#include "sim/sim_object.hh"
+
+class BaseCPU;
+
+/**
+ * Alternates fast-forward periods on the functional CPUs with sampled
+ * windows on the detailed CPUs. Each period is ended by leaving the
+ * simulation loop with one of the causes below; the run script
+ * switches CPUs and calls simulate() again. The controller times the
+ * phases from the tick it exits on, takes the committed instruction
+ * counts of the detailed CPUs around each measurement window, and keeps
+ * the mean IPC over the samples with its confidence interval.
+ *
+ * A sample is: fast_forward ticks of functional simulation, which
+ * keeps caches and TLBs warm if the functional CPUs go through them,
+ * then warmup ticks on the detailed CPUs to fill the pipeline and
+ * train the predictors, then detail ticks of measurement.
+ */
+class SamplingController : public SimObject
+{
+  public:
+    typedef SamplingControllerParams Params;
+
+    /** Exit causes, the run script switches CPUs on the first two. */
+    static const char *const switchToDetailed;
+    static const char *const switchToFastForward;
+    static const char *const samplingDone;
+
+    SamplingController(const Params *p);
+
+    void startup();
+    void regStats();
+
+    /** Samples taken so far. */
+    unsigned numSamples() const { return sampleIPC.size(); }
+
+    /** Mean IPC over the samples. */
+    double mean() const;
+
+    /** Sample standard deviation of the IPC. */
+    double stdev() const;
+
+    /**
+     * Half width of the confidence interval of the mean IPC, or 0 with
+     * fewer than two samples.
+     */
+    double halfWidth() const;
+
+    /**
+     * Two-sided quantile of the standard normal distribution for the
+     * given confidence level, e.g. 1.96 for 0.95.
+     */
+    static double normalQuantile(double confidence);
+
+  private:
+    /** Fast-forward period is over, switch to the detailed CPUs. */
+    void endFastForward();
+    EventWrapper<SamplingController,
+                 &SamplingController::endFastForward> fastForwardEvent;
+
+    /** Warm-up is over, start measuring. */
+    void endWarmup();
+    EventWrapper<SamplingController,
+                 &SamplingController::endWarmup> warmupEvent;
+
+    /** Measurement window is over, record the sample. */
+    void endDetail();
+    EventWrapper<SamplingController,
+                 &SamplingController::endDetail> detailEvent;
+
+    /** Committed instructions of all the detailed CPUs. */
+    Counter detailedInsts() const;
+
+    /** True once the run has enough samples. */
+    bool done() const;
+
+    const std::vector<BaseCPU *> detailedCPUs;
+    const Tick fastForwardTicks;
+    const Tick warmupTicks;
+    const Tick detailTicks;
+    const unsigned maxSamples;
+    const double confidence;
+    const double targetError;
+    const unsigned minSamples;
+
+    /** Start of the current measurement window. */
+    Tick windowStart;
+    Counter windowStartInsts;
+
+    /** IPC of every sample taken. */
+    std::vector<double> sampleIPC;
+
+    Stats::Scalar samples;
+    Stats::Scalar detailedTicks;
+    Stats::Scalar ipcMean;
+    Stats::Scalar ipcStdev;
+    Stats::Scalar ipcHalfWidth;
+    Stats::Scalar ipcRelativeError;
+    Stats::Histogram ipcDist;
+};
+
+#endif // __CPU_SAMPLING_CONTROLLER_HH__
@@ -61,6 +61,12 @@ class AtomicSimpleCPU(BaseSimpleCPU):
     simulate_data_stalls = Param.Bool(False, "Simulate dcache stall cycles")
     simulate_inst_stalls = Param.Bool(False, "Simulate icache stall cycles")
     fastmem = Param.Bool(False, "Access memory directly")
+    decode_blocks = Param.Bool(False,
+        "Execute pre-decoded basic blocks (ARM, needs fastmem)")
+    decode_block_insts = Param.Unsigned(32,
+        "Maximum instructions in a decoded block")
+    decode_block_cache_size = Param.Unsigned(65536,
+        "Decoded blocks kept before the cache is flushed")
     simpoint_profile = Param.Bool(False, "Generate SimPoint BBVs")
     simpoint_interval = Param.UInt64(100000000, "SimPoint Interval Size (insts)")
     simpoint_profile_file = Param.String("simpoint.bb.gz", "SimPoint BBV file")
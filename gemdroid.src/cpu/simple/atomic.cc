@@ -101,6 +101,37 @@ AtomicSimpleCPU::init()
     ifetch_req.setThreadContext(_cpuId, 0); // Add thread ID if we add MT
     data_read_req.setThreadContext(_cpuId, 0); // Add thread ID here too
     data_write_req.setThreadContext(_cpuId, 0); // Add thread ID here too
+
+    if (decodeBlocks)
+        backingStore = system->getPhysMem().getBackingStore();
+}
+
+void
+AtomicSimpleCPU::regStats()
+{
+    using namespace Stats;
+
+    BaseSimpleCPU::regStats();
+
+    numBlockBuilds
+        .name(name() + ".decodeBlocks.builds")
+        .desc("Number of blocks decoded")
+        ;
+
+    numBlockHits
+        .name(name() + ".decodeBlocks.hits")
+        .desc("Number of blocks found decoded")
+        ;
+
+    numBlockStale
+        .name(name() + ".decodeBlocks.stale")
+        .desc("Number of decoded blocks dropped as their memory changed")
+        ;
+
+    numBlockInsts
+        .name(name() + ".decodeBlocks.insts")
+        .desc("Number of instructions taken from decoded blocks")
+        ;
 }
 
 AtomicSimpleCPU::AtomicSimpleCPU(AtomicSimpleCPUParams *p)
@@ -117,13 +148,27 @@ AtomicSimpleCPU::AtomicSimpleCPU(AtomicSimpleCPUParams *p)
       intervalDrift(0),
       simpointStream(NULL),
       currentBBV(0, 0),
-      currentBBVInstCount(0)
+      currentBBVInstCount(0),
+      decodeBlocks(NULL),
+      decodeBlockInsts(p->decode_block_insts),
+      curBlock(NULL),
+      blockPos(0)
 {
     _status = Idle;
 
     if (simpoint) {
         simpointStream = simout.create(p->simpoint_profile_file, false);
     }
+
+    if (p->decode_blocks) {
+#if THE_ISA != ARM_ISA
+        fatal("%s: decoded blocks are only supported on ARM\n", name());
+#endif
+        fatal_if(!fastmem, "%s: decoded blocks need fastmem\n", name());
+        fatal_if(decodeBlockInsts == 0 || p->decode_block_cache_size == 0,
+                 "%s: decoded blocks need room for instructions\n", name());
+        decodeBlocks = new DecodeBlockCache(p->decode_block_cache_size);
+    }
 }
 
 
@@ -135,6 +180,7 @@ AtomicSimpleCPU::~AtomicSimpleCPU()
     if (simpointStream) {
         simout.close(simpointStream);
     }
+    delete decodeBlocks;
 }
 
 unsigned int
@@ -168,6 +214,9 @@ AtomicSimpleCPU::drainResume()
     DPRINTF(SimpleCPU, "Resume\n");
     verifyMemoryMode();
 
+    // Memory may have been restored or written while drained
+    curBlock = NULL;
+
     assert(!threadContexts.empty());
     if (threadContexts.size() > 1)
         fatal("The atomic CPU only supports one thread.\n");
@@ -210,6 +259,8 @@ AtomicSimpleCPU::switchOut()
     assert(!tickEvent.scheduled());
     assert(_status == BaseSimpleCPU::Running || _status == Idle);
     assert(isDrained());
+
+    curBlock = NULL;
 }
 
 
@@ -221,6 +272,8 @@ AtomicSimpleCPU::takeOverFrom(BaseCPU *oldCPU)
     // The tick event should have been descheduled by drain()
     assert(!tickEvent.scheduled());
 
+    curBlock = NULL;
+
     ifetch_req.setThreadContext(_cpuId, 0); // Add thread ID if we add MT
     data_read_req.setThreadContext(_cpuId, 0); // Add thread ID here too
     data_write_req.setThreadContext(_cpuId, 0); // Add thread ID here too
@@ -533,7 +586,15 @@ AtomicSimpleCPU::tick()
 
         bool needToFetch = !isRomMicroPC(pcState.microPC()) &&
                            !curMacroStaticInst;
+
+        // The rest of a decoded block is on the page it was entered on
+        // and needs no translation or fetch
+        if (needToFetch && curBlock && fetchOffset == 0 &&
+            nextBlockInst(pcState))
+            needToFetch = false;
+
         if (needToFetch) {
+            curBlock = NULL;
             ifetch_req.taskId(taskId());
             setupFetchRequest(&ifetch_req);
             fault = thread->itb->translateAtomic(&ifetch_req, tc,
@@ -545,6 +606,11 @@ AtomicSimpleCPU::tick()
             bool icache_access = false;
             dcache_access = false; // assume no dcache access
 
+            if (needToFetch && decodeBlocks && fetchOffset == 0 &&
+                system->isMemAddr(ifetch_req.getPaddr()) &&
+                enterBlock(ifetch_req.getPaddr(), pcState))
+                needToFetch = false;
+
             if (needToFetch) {
                 // This is commented out because the decoder would act like
                 // a tiny cache otherwise. It wouldn't be flushed when needed
@@ -628,6 +694,145 @@ AtomicSimpleCPU::tick()
         schedule(tickEvent, curTick() + latency);
 }
 
+bool
+AtomicSimpleCPU::nextBlockInst(const TheISA::PCState &pc)
+{
+    assert(curBlock);
+    if (blockPos == curBlock->insts.size() ||
+        !(curBlock->insts[blockPos].before == pc)) {
+        curBlock = NULL;
+        return false;
+    }
+
+    const DecodedBlock::Entry &entry = curBlock->insts[blockPos++];
+    predecodedInst = entry.inst;
+    predecodedPC = entry.after;
+    ++numBlockInsts;
+    return true;
+}
+
+bool
+AtomicSimpleCPU::enterBlock(Addr fetch_paddr, const TheISA::PCState &pc)
+{
+    Addr offset = pc.instAddr() - (pc.instAddr() & PCMask);
+    uint8_t *host = hostAddr(fetch_paddr, sizeof(MachInst));
+    if (!host)
+        return false;
+
+#if THE_ISA == ARM_ISA
+    uint64_t context = thread->decoder.contextKey();
+#else
+    uint64_t context = 0;
+#endif
+
+    bool stale;
+    DecodedBlock *block = decodeBlocks->lookup(fetch_paddr + offset,
+                                               context, pc, host + offset,
+                                               stale);
+    if (stale)
+        ++numBlockStale;
+
+    if (block) {
+        ++numBlockHits;
+    } else {
+        block = buildBlock(fetch_paddr, pc);
+        if (!block)
+            return false;
+        decodeBlocks->insert(block);
+        ++numBlockBuilds;
+    }
+
+    curBlock = block;
+    blockPos = 0;
+    return nextBlockInst(pc);
+}
+
+DecodedBlock *
+AtomicSimpleCPU::buildBlock(Addr fetch_paddr, const TheISA::PCState &start)
+{
+#if THE_ISA == ARM_ISA
+    TheISA::Decoder *decoder = &(thread->decoder);
+
+    // Blocks stay on one page, where the physical addresses follow the
+    // virtual ones
+    Addr fetch_vaddr = start.instAddr() & PCMask;
+    Addr page_end = (fetch_paddr & ~(PageBytes - 1)) + PageBytes;
+    Addr end_paddr = fetch_paddr;
+
+    DecodedBlock *block = new DecodedBlock;
+    block->fetchOffset = start.instAddr() - fetch_vaddr;
+    block->paddr = fetch_paddr + block->fetchOffset;
+    block->context = decoder->contextKey();
+    block->next = NULL;
+
+    decoder->reset();
+    TheISA::PCState pc = start;
+    while (block->insts.size() < decodeBlockInsts) {
+        DecodedBlock::Entry entry;
+        entry.before = pc;
+
+        // Feed the decoder words until it has a whole instruction
+        Addr word_vaddr = pc.instAddr() & PCMask;
+        Addr word_end = end_paddr;
+        StaticInstPtr inst = NULL;
+        while (!inst) {
+            Addr paddr = fetch_paddr + (word_vaddr - fetch_vaddr);
+            uint8_t *host = paddr + sizeof(MachInst) <= page_end ?
+                hostAddr(paddr, sizeof(MachInst)) : NULL;
+            if (!host)
+                break;
+
+            MachInst word;
+            memcpy(&word, host, sizeof(word));
+            decoder->moreBytes(pc, word_vaddr, gtoh(word));
+            inst = decoder->decode(pc);
+
+            word_end = std::max(word_end, paddr + sizeof(MachInst));
+            word_vaddr += sizeof(MachInst);
+        }
+        if (!inst)
+            break;
+
+        entry.after = pc;
+        entry.inst = inst;
+        block->insts.push_back(entry);
+        end_paddr = word_end;
+
+        // Stop where the control flow or the decoding of what follows
+        // may change, an IT block included
+        if (inst->isControl() || inst->isSerializing() ||
+            inst->isNonSpeculative() || inst->isSquashAfter() ||
+            inst->isQuiesce() || inst->isSyscall() || inst->isIprAccess() ||
+            pc.itstate() || pc.nextItstate())
+            break;
+
+        TheISA::advancePC(pc, inst);
+    }
+    decoder->reset();
+
+    if (block->insts.empty()) {
+        delete block;
+        return NULL;
+    }
+
+    uint8_t *host = hostAddr(fetch_paddr, end_paddr - fetch_paddr);
+    block->bytes.assign(host, host + (end_paddr - fetch_paddr));
+    return block;
+#else
+    return NULL;
+#endif
+}
+
+uint8_t *
+AtomicSimpleCPU::hostAddr(Addr paddr, unsigned size) const
+{
+    for (size_t i = 0; i < backingStore.size(); ++i) {
+        const AddrRange &range = backingStore[i].first;
+        if (range.contains(paddr) && range.contains(paddr + size - 1))
+            return backingStore[i].second + (paddr - range.start());
+    }
+    return NULL;
+}
 
 void
 AtomicSimpleCPU::printAddr(Addr a)
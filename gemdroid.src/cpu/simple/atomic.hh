@@ -45,6 +45,7 @@
 
 #include "base/hashmap.hh"
 #include "cpu/simple/base.hh"
+#include "cpu/simple/decode_blocks.hh"
 #include "params/AtomicSimpleCPU.hh"
 
 /**
@@ -76,6 +77,7 @@ class AtomicSimpleCPU : public BaseSimpleCPU
     virtual ~AtomicSimpleCPU();
 
     virtual void init();
+    virtual void regStats();
 
   private:
 
@@ -244,6 +246,56 @@ class AtomicSimpleCPU : public BaseSimpleCPU
      *  End of data structures for SimPoints BBV generation
      */
 
+    /** Decoded basic blocks
+     *  @{
+     */
+
+    /** Blocks of decoded instructions, NULL if they are not used */
+    DecodeBlockCache *decodeBlocks;
+    /** Maximum instructions in a block */
+    const unsigned decodeBlockInsts;
+
+    /** Block being executed and the next instruction in it */
+    DecodedBlock *curBlock;
+    unsigned blockPos;
+
+    /** Host memory of the system, where blocks are decoded from */
+    std::vector<std::pair<AddrRange, uint8_t*> > backingStore;
+
+    Stats::Scalar numBlockBuilds;
+    Stats::Scalar numBlockHits;
+    Stats::Scalar numBlockStale;
+    Stats::Scalar numBlockInsts;
+
+    /**
+     * Take the next instruction of the current block if execution
+     * carries on with it.
+     *
+     * @param pc PC state of the instruction to fetch
+     * @return true if the instruction was taken from the block
+     */
+    bool nextBlockInst(const TheISA::PCState &pc);
+
+    /**
+     * Start executing the block of an instruction, decoding it if
+     * needed.
+     *
+     * @param fetch_paddr Physical address the instruction is fetched from
+     * @param pc PC state of the instruction
+     * @return true if the instruction was taken from a block
+     */
+    bool enterBlock(Addr fetch_paddr, const TheISA::PCState &pc);
+
+    /** Decode a new block, NULL if no instruction could be decoded. */
+    DecodedBlock *buildBlock(Addr fetch_paddr, const TheISA::PCState &pc);
+
+    /** Host address of physical memory, NULL if it is not all there. */
+    uint8_t *hostAddr(Addr paddr, unsigned size) const;
+
+    /** @}
+     *  End of decoded basic blocks
+     */
+
   protected:
 
     /** Return a reference to the data port. */
@@ -418,25 +418,34 @@ BaseSimpleCPU::preExecute()
         //We're not in the middle of a macro instruction
         StaticInstPtr instPtr = NULL;
 
-        TheISA::Decoder *decoder = &(thread->decoder);
-
-        //Predecode, ie bundle up an ExtMachInst
-        //If more fetch data is needed, pass it in.
-        Addr fetchPC = (pcState.instAddr() & PCMask) + fetchOffset;
-        //if(decoder->needMoreBytes())
-            decoder->moreBytes(pcState, fetchPC, inst);
-        //else
-        //    decoder->process();
-
-        //Decode an instruction if one is ready. Otherwise, we'll have to
-        //fetch beyond the MachInst at the current pc.
-        instPtr = decoder->decode(pcState);
-        if (instPtr) {
+        if (predecodedInst) {
+            //The instruction was decoded ahead of time, skip the decoder
+            instPtr = predecodedInst;
+            predecodedInst = NULL;
+            pcState = predecodedPC;
             stayAtPC = false;
             thread->pcState(pcState);
         } else {
-            stayAtPC = true;
-            fetchOffset += sizeof(MachInst);
+            TheISA::Decoder *decoder = &(thread->decoder);
+
+            //Predecode, ie bundle up an ExtMachInst
+            //If more fetch data is needed, pass it in.
+            Addr fetchPC = (pcState.instAddr() & PCMask) + fetchOffset;
+            //if(decoder->needMoreBytes())
+                decoder->moreBytes(pcState, fetchPC, inst);
+            //else
+            //    decoder->process();
+
+            //Decode an instruction if one is ready. Otherwise, we'll have to
+            //fetch beyond the MachInst at the current pc.
+            instPtr = decoder->decode(pcState);
+            if (instPtr) {
+                stayAtPC = false;
+                thread->pcState(pcState);
+            } else {
+                stayAtPC = true;
+                fetchOffset += sizeof(MachInst);
+            }
         }
 
         //If we decoded an instruction and it's microcoded, start pulling
@@ -163,6 +163,12 @@ class BaseSimpleCPU : public BaseCPU
     //instructions which go beyond MachInst boundaries.
     bool stayAtPC;
 
+    //An instruction decoded ahead of time, e.g. from a decoded block,
+    //and the PC state decoding it left. When set, preExecute takes it
+    //instead of decoding inst.
+    StaticInstPtr predecodedInst;
+    TheISA::PCState predecodedPC;
+
     void checkForInterrupts();
     void setupFetchRequest(Request *req);
     void preExecute();
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2014 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Cache of pre-decoded basic blocks for the simple CPUs.
+ */
+
+#ifndef __CPU_SIMPLE_DECODE_BLOCKS_HH__
+#define __CPU_SIMPLE_DECODE_BLOCKS_HH__
+
+#include <cstring>
+#include <vector>
+
+#include "arch/types.hh"
+#include "base/hashmap.hh"
+#include "base/types.hh"
+#include "cpu/static_inst.hh"
+
+/**
+ * A straight-line run of decoded instructions, from an instruction to
+ * the first one that may change the control flow or the way the
+ * following ones decode, and never across a page. Every instruction
+ * keeps the PC state it was decoded under and the one decoding left,
+ * so the CPU only takes it while execution follows the same path.
+ */
+struct DecodedBlock
+{
+    struct Entry
+    {
+        TheISA::PCState before;
+        TheISA::PCState after;
+        StaticInstPtr inst;
+    };
+
+    /** Physical address of the first instruction */
+    Addr paddr;
+
+    /** Decoder state the instructions were decoded in */
+    uint64_t context;
+
+    /**
+     * The bytes the block was decoded from, which start fetchOffset
+     * bytes before the first instruction.
+     */
+    unsigned fetchOffset;
+    std::vector<uint8_t> bytes;
+
+    std::vector<Entry> insts;
+
+    /** Next block at the same address, with another context or mode */
+    DecodedBlock *next;
+};
+
+/**
+ * Pre-decoded blocks by physical address. A block is checked against
+ * the memory it was decoded from whenever it is entered, so writes by
+ * the CPU itself, other CPUs or devices never leave stale instructions
+ * behind. The cache holds a bounded number of blocks and is flushed
+ * when it is full.
+ */
+class DecodeBlockCache
+{
+  public:
+    DecodeBlockCache(unsigned max_blocks)
+        : numBlocks(0), maxBlocks(max_blocks)
+    { }
+
+    ~DecodeBlockCache() { clear(); }
+
+    /**
+     * Find the block for an instruction.
+     *
+     * @param paddr Physical address of the instruction
+     * @param context Decoder state
+     * @param pc PC state of the instruction
+     * @param host Host address of the instruction
+     * @param stale Set if a block was dropped as memory changed
+     * @return The block, NULL if there is none
+     */
+    DecodedBlock *
+    lookup(Addr paddr, uint64_t context, const TheISA::PCState &pc,
+           const uint8_t *host, bool &stale)
+    {
+        stale = false;
+        Map::iterator it = blocks.find(paddr);
+        if (it == blocks.end())
+            return NULL;
+
+        DecodedBlock **link = &it->second;
+        for (DecodedBlock *block = *link; block;
+             link = &block->next, block = *link) {
+            if (block->context != context || !(block->insts[0].before == pc))
+                continue;
+
+            if (memcmp(host - block->fetchOffset, &block->bytes[0],
+                       block->bytes.size()) == 0)
+                return block;
+
+            // memory changed since it was decoded
+            *link = block->next;
+            if (!it->second)
+                blocks.erase(it);
+            delete block;
+            --numBlocks;
+            stale = true;
+            return NULL;
+        }
+
+        return NULL;
+    }
+
+    void
+    insert(DecodedBlock *block)
+    {
+        if (numBlocks >= maxBlocks)
+            clear();
+
+        DecodedBlock *&head = blocks[block->paddr];
+        block->next = head;
+        head = block;
+        ++numBlocks;
+    }
+
+    void
+    clear()
+    {
+        for (Map::iterator it = blocks.begin(); it != blocks.end(); ++it) {
+            DecodedBlock *block = it->second;
+            while (block) {
+                DecodedBlock *next = block->next;
+                delete block;
+                block = next;
+            }
+        }
+        blocks.clear();
+        numBlocks = 0;
+    }
+
+    unsigned size() const { return numBlocks; }
+
+  private:
+    typedef m5::hash_map<Addr, DecodedBlock *> Map;
+    Map blocks;
+
+    unsigned numBlocks;
+    const unsigned maxBlocks;
+};
+
+#endif // __CPU_SIMPLE_DECODE_BLOCKS_HH__
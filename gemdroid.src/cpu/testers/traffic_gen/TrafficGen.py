@@ -54,10 +54,11 @@ from MemObject import MemObject
 # the traffic generator is specified in a configuration file, and this
 # file describes a state transition graph where each state is a
 # specific generator behaviour. Examples include idling, generating
-# linear address sequences, random sequences and replay of captured
-# traces. By describing these behaviours as states, it is straight
-# forward to create very complex behaviours, simply by arranging them
-# in graphs. The graph transitions can also be annotated with
+# linear address sequences, random sequences, frame-periodic
+# accelerator traffic with deadlines and replay of captured traces. By
+# describing these behaviours as states, it is straight forward to
+# create very complex behaviours, simply by arranging them in
+# graphs. The graph transitions can also be annotated with
 # probabilities, effectively making it a Markov Chain.
 class TrafficGen(MemObject):
     type = 'TrafficGen'
@@ -291,6 +291,112 @@ RandomGen::nextPacketTick(bool elastic, Tick delay) const
     }
 }
 
+void
+FrameGen::enter()
+{
+    // the first frame starts right away
+    frameStart = curTick();
+    readDone = 0;
+    writeDone = 0;
+}
+
+PacketPtr
+FrameGen::getNextPacket()
+{
+    // write when the output is behind the input, i.e. when the share
+    // of the frame written is smaller than the share read, and once
+    // all the input is read
+    bool isRead = readDone < readBytes &&
+        (writeDone == writeBytes ||
+         writeDone * readBytes >= readDone * writeBytes);
+
+    Addr addr;
+    Addr size;
+    if (isRead) {
+        addr = readBase + readDone;
+        size = std::min(blocksize, readBytes - readDone);
+        readDone += size;
+    } else {
+        addr = writeBase + writeDone;
+        size = std::min(blocksize, writeBytes - writeDone);
+        writeDone += size;
+    }
+
+    DPRINTF(TrafficGen, "FrameGen::getNextPacket: %c to addr %x, size %d\n",
+            isRead ? 'r' : 'w', addr, size);
+
+    PacketPtr pkt = getPacket(addr, size,
+                              isRead ? MemCmd::ReadReq : MemCmd::WriteReq);
+
+    if (readDone == readBytes && writeDone == writeBytes)
+        nextFrame();
+
+    return pkt;
+}
+
+void
+FrameGen::nextFrame()
+{
+    Tick frame_time = curTick() - frameStart;
+
+    ++frames;
+    totFrameTime += frame_time;
+    if (frame_time > deadline) {
+        ++lateFrames;
+        DPRINTF(TrafficGen, "FrameGen: frame late by %d ticks\n",
+                frame_time - deadline);
+    }
+
+    frameStart = std::max(frameStart + framePeriod, curTick());
+    readDone = 0;
+    writeDone = 0;
+}
+
+Tick
+FrameGen::nextPacketTick(bool elastic, Tick delay) const
+{
+    // the first request of a frame goes out when the frame starts
+    if (readDone == 0 && writeDone == 0)
+        return std::max(frameStart, curTick());
+
+    Tick wait = period;
+
+    // compensate for the delay experienced to not be elastic
+    if (!elastic) {
+        if (wait < delay)
+            wait = 0;
+        else
+            wait -= delay;
+    }
+
+    return curTick() + wait;
+}
+
+void
+FrameGen::regStats()
+{
+    using namespace Stats;
+
+    frames
+        .name(name() + ".frames")
+        .desc("Number of frames completed");
+
+    lateFrames
+        .name(name() + ".lateFrames")
+        .desc("Number of frames that missed their deadline");
+
+    totFrameTime
+        .name(name() + ".totFrameTime")
+        .desc("Total time to issue the requests of the frames (ticks)");
+
+    avgFrameTime
+        .name(name() + ".avgFrameTime")
+        .desc("Average time to issue the requests of a frame (ticks)")
+        .precision(0);
+
+    avgFrameTime = totFrameTime / frames;
+}
+
 TraceGen::InputStream::InputStream(const std::string& filename)
     : trace(filename)
 {
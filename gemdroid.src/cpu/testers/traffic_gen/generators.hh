@@ -52,6 +52,7 @@
 
 #include "base/bitfield.hh"
 #include "base/intmath.hh"
+#include "base/statistics.hh"
 #include "mem/packet.hh"
 #include "proto/protoio.hh"
 
@@ -133,6 +134,11 @@ class BaseGen
      */
     virtual Tick nextPacketTick(bool elastic, Tick delay) const = 0;
 
+    /**
+     * Register the statistics of this state, if it keeps any.
+     */
+    virtual void regStats() { }
+
 };
 
 /**
@@ -400,6 +406,87 @@ class DramGen : public RandomGen
     unsigned int addrMapping;
 };
 
+/**
+ * The frame generator mimics an accelerator or a device working on
+ * frames, e.g. a video decoder or a display controller: every frame
+ * period it reads an input buffer and writes an output buffer, both
+ * linearly, at a fixed packet rate. Reads and writes are interleaved
+ * so that the output keeps pace with the input, like an IP streaming
+ * through its line buffers. A frame that takes longer than the
+ * deadline to issue is counted as late, and the next one starts as
+ * soon as the late one is done.
+ */
+class FrameGen : public BaseGen
+{
+
+  public:
+
+    /**
+     * Create a frame generator.
+     *
+     * @param _name Name to use for status, debug and stats
+     * @param master_id MasterID set on each request
+     * @param _duration duration of this state before transitioning
+     * @param frame_period Time between the starts of two frames
+     * @param _deadline Time a frame has to issue all its requests,
+     *                  0 for the frame period
+     * @param read_base Start address of the input buffer
+     * @param read_bytes Bytes read per frame
+     * @param write_base Start address of the output buffer
+     * @param write_bytes Bytes written per frame
+     * @param _blocksize Size used for transactions injected
+     * @param _period Time between two requests of a frame
+     */
+    FrameGen(const std::string& _name, MasterID master_id, Tick _duration,
+             Tick frame_period, Tick _deadline,
+             Addr read_base, Addr read_bytes,
+             Addr write_base, Addr write_bytes,
+             Addr _blocksize, Tick _period)
+        : BaseGen(_name, master_id, _duration),
+          framePeriod(frame_period),
+          deadline(_deadline ? _deadline : frame_period),
+          readBase(read_base), readBytes(read_bytes),
+          writeBase(write_base), writeBytes(write_bytes),
+          blocksize(_blocksize), period(_period),
+          frameStart(0), readDone(0), writeDone(0)
+    { }
+
+    void enter();
+
+    PacketPtr getNextPacket();
+
+    Tick nextPacketTick(bool elastic, Tick delay) const;
+
+    void regStats();
+
+  private:
+
+    /** Start the next frame, on time or as soon as possible. */
+    void nextFrame();
+
+    /** Frame parameters */
+    const Tick framePeriod;
+    const Tick deadline;
+    const Addr readBase;
+    const Addr readBytes;
+    const Addr writeBase;
+    const Addr writeBytes;
+    const Addr blocksize;
+    const Tick period;
+
+    /** Tick when the current frame started, or is due to start */
+    Tick frameStart;
+
+    /** Bytes of the current frame read and written so far */
+    Addr readDone;
+    Addr writeDone;
+
+    Stats::Scalar frames;
+    Stats::Scalar lateFrames;
+    Stats::Scalar totFrameTime;
+    Stats::Formula avgFrameTime;
+};
+
 /**
  * The trace replay generator reads a trace file and plays
  * back the transactions. The trace is offset with respect to
@@ -255,6 +255,46 @@ TrafficGen::parseConfig()
                     states[id] = new TraceGen(name(), masterID, duration,
                                               traceFile, addrOffset);
                     DPRINTF(TrafficGen, "State: %d TraceGen\n", id);
+                } else if (mode == "FRAME") {
+                    Tick frame_period;
+                    Tick deadline;
+                    Addr read_base;
+                    Addr read_bytes;
+                    Addr write_base;
+                    Addr write_bytes;
+                    Addr blocksize;
+                    Tick period;
+
+                    is >> frame_period >> deadline >> read_base >>
+                        read_bytes >> write_base >> write_bytes >>
+                        blocksize >> period;
+
+                    DPRINTF(TrafficGen, "FRAME, every %d ticks, read %d "
+                            "from %x, write %d to %x, size %d, period %d\n",
+                            frame_period, read_bytes, read_base,
+                            write_bytes, write_base, blocksize, period);
+
+                    if (blocksize > system->cacheLineSize())
+                        fatal("TrafficGen %s block size (%d) is larger than "
+                              "cache line size (%d)\n", name(),
+                              blocksize, system->cacheLineSize());
+
+                    if (frame_period == 0 || blocksize == 0)
+                        fatal("%s: frame state %d needs a frame period and "
+                              "a block size\n", name(), id);
+
+                    if (read_bytes == 0 && write_bytes == 0)
+                        fatal("%s: frame state %d reads and writes nothing\n",
+                              name(), id);
+
+                    states[id] = new FrameGen(csprintf("%s.state%d",
+                                                       name(), id),
+                                              masterID, duration,
+                                              frame_period, deadline,
+                                              read_base, read_bytes,
+                                              write_base, write_bytes,
+                                              blocksize, period);
+                    DPRINTF(TrafficGen, "State: %d FrameGen\n", id);
                 } else if (mode == "IDLE") {
                     states[id] = new IdleGen(name(), masterID, duration);
                     DPRINTF(TrafficGen, "State: %d IdleGen\n", id);
@@ -492,6 +532,11 @@ TrafficGen::regStats()
     retryTicks
         .name(name() + ".retryTicks")
         .desc("Time spent waiting due to back-pressure (ticks)");
+
+    // states keeping stats of their own, e.g. frame deadlines
+    for (m5::hash_map<uint32_t, BaseGen*>::iterator s = states.begin();
+         s != states.end(); ++s)
+        s->second->regStats();
 }
 
 bool
@@ -27,11 +27,12 @@
 #
 # Contact: Shulin Zhao (suz53@cse.psu.edu)
 
-from ClockedObject import ClockedObject
+from MemObject import MemObject
 from m5.params import *
+from m5.proxy import *
 #from AbstractMemory import *
 
-class GemDroid(ClockedObject):
+class GemDroid(MemObject):
     type = 'GemDroid'
     cxx_header = "gemdroid/gemdroid.hh"
     enable_gemdroid = Param.Bool(False, "GemDroid functionalities enabled or disabled?")
@@ -40,6 +41,10 @@ class GemDroid(ClockedObject):
     governor_timing = Param.Int(1, "When to do DVFS")
     core_freq = Param.Int(900, "Core Freq in MHz")
     issue_width = Param.Int(1, "Issue Width of the cores")
+    commit_width = Param.Int(0, "Commit Width of the cores (0: same as issue width)")
+    core_model = Param.Int(0, "Core model: 0 in-order, 1 legacy OoO, 2 ROB-based OoO")
+    rob_size = Param.Int(32, "ROB size in instructions (core model 2)")
+    mlp_limit = Param.Int(8, "Max memory requests in flight per core (core model 2)")
     mem_freq = Param.Int(500, "Mem Freq in MHz")
     dev_freq = Param.Int(400, "IP Freq in MHz")
     ip_freq = Param.Int(300, "IP Freq in MHz")
@@ -49,7 +54,17 @@ class GemDroid(ClockedObject):
     cpu_trace3 = Param.String("none", "file from which cpu mem trace3 is read")
     cpu_trace4 = Param.String("none", "file from which cpu mem trace4 is read")
     gpu_trace = Param.String("none", "file from which gpu mem trace is read")
+    ip_catalog = Param.String("ipcatalog.txt", "file listing the IP instances and their characteristics")
     perfect_memory = Param.Bool(False, "Use a perfect memory")
+    pipelined_flows = Param.Bool(False, "Flow stages overlap frames; slack uses the slowest stage")
+    stream_buffer_size = Param.Int(0, "SA scratchpad in KB for streaming between IPs of a flow (0 = all hops go through DRAM)")
+    stream_tile_size = Param.Int(64, "Cache lines a streaming producer writes before its consumer starts")
+    slc_size = Param.Int(0, "System-level cache between the SA and DRAM in KB (0 = no SLC)")
+    slc_ways = Param.Int(16, "SLC associativity")
+    slc_hit_latency = Param.Int(10, "SLC hit latency in SA cycles")
+    slc_partition = Param.String("", "Ways each sender type allocates in, e.g. GPU:4,DC:2; unlisted types share the rest")
+    slc_no_allocate = Param.String("", "Sender types whose misses are not allocated in the SLC, e.g. NW,MMC_IN")
+    slc_stream_threshold = Param.Int(32, "Sequential misses after which a sender with a low hit rate bypasses the SLC (0 = never)")
     no_periodic_stats = Param.Bool(False, "Print periodic stats from GemDroid")
     sweep_val1 = Param.Float(1, "Value to use for the current sweep variable1")
     sweep_val2 = Param.Float(1, "Value to use for the current sweep variable2")
@@ -63,3 +78,14 @@ class GemDroid(ClockedObject):
     traceFile = Param.String("", "Output file for trace generation")
     enableDebug = Param.Bool(True, "Enable DRAMSim2 debug output")
     range = Param.AddrRange('4096MB', "Address range (potentially interleaved)")
+
+    # Memory the SA requests go to: DRAMSim2, or any gem5 memory system
+    # through mem_port (the addresses are folded into range)
+    mem_backend = Param.String("dramsim2", "GemDroid memory backend: dramsim2 or port")
+    mem_port = MasterPort("Port to the gem5 memory system with mem_backend=port")
+    mem_port_max_outstanding = Param.Int(64, "Max requests in flight on mem_port")
+    dram_ctrl = Param.DRAMCtrl(NULL, "DRAM controller behind mem_port, for DVFS, bandwidth and power")
+    mem_port_act_energy = Param.Float(2.0, "nJ per DRAM activate (port backend power model)")
+    mem_port_burst_energy = Param.Float(1.0, "nJ per 64B DRAM burst (port backend power model)")
+    mem_port_bg_power = Param.Float(0.1, "DRAM background power in W at the max mem freq (port backend)")
+    system = Param.System(Parent.any, "System the memory requests are attributed to")
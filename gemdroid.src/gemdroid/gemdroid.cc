@@ -137,15 +137,21 @@ bool GemDroid::has2ndFlow(int appID)
 
 
 GemDroid::GemDroid(const Params *p):
-		ClockedObject(p),
+		MemObject(p),
 		tickEvent(this),
-		gemdroid_memory(0, p->deviceConfigFile, p->systemConfigFile, p->filePath,
-		            p->traceFile, p->range.size() / 1024 / 1024, p->perfect_memory, p->enableDebug, this),
-		gemdroid_sa(0, this)
+		gemdroid_memory(0, p, this),
+		gemdroid_sa(0, this),
+		gemdroid_slc(this)
 {
     ticks = 0;
     desc = "GemDroid";
 
+    gemdroid_gpu = NULL;
+    gpuDisplayId = -1;
+    for(int i=0; i<IP_TYPE_END; i++)
+        for(int j=0; j<MAX_IPS; j++)
+            ipTable[i][j] = NULL;
+
 	gemdroid_enable = p->enable_gemdroid;
 	std::cout << "Gemdroid Enable: " << gemdroid_enable << std::endl;
 
@@ -157,6 +163,9 @@ GemDroid::GemDroid(const Params *p):
     framenum_motivationgraphs = 0;
 
 	perfectMemory = p->perfect_memory;
+	pipelinedFlows = p->pipelined_flows;
+	gemdroid_sa.initStreaming(p->stream_buffer_size * 1024 / CACHE_LINE_SIZE, p->stream_tile_size);
+	gemdroid_slc.init(p->slc_size, p->slc_ways, p->slc_hit_latency, p->slc_partition, p->slc_no_allocate, p->slc_stream_threshold);
     powerCalcLastTick = 0;
     periodicStatsLastTick = 0;
     slackLastTick = 0;
@@ -210,82 +219,217 @@ GemDroid::GemDroid(const Params *p):
     for(int i=0; i<num_cpus; i++) {
         cpuLastTick[i] = 0;
         app_id[i] = getAppIdWithName(em_trace_file_name[i]);
-    	gemdroid_core[i].init(i, em_trace_file_name[i], app_id[i], p->core_freq, optimal_freqs[IP_TYPE_CPU], p->issue_width, this);
+    	gemdroid_core[i].init(i, em_trace_file_name[i], app_id[i], p->core_freq, optimal_freqs[IP_TYPE_CPU], p->issue_width,
+    							p->commit_width, p->core_model, p->rob_size, p->mlp_limit, this);
     }
 
     ipIdRoundRobin = IP_TYPE_NW;
     cpuIdRoundRobin = 0;
-    for(int i=0; i<num_ip_inst; i++) {
-    	gemdroid_ip_dc[i].init(IP_TYPE_DC, i, true, DC_PROCESSING_TIME, p->dev_freq, optimal_freqs[IP_TYPE_DC],  this);
-		gemdroid_ip_nw[i].init(IP_TYPE_NW, i, true,NW_PROCESSING_TIME, p->dev_freq, optimal_freqs[IP_TYPE_NW], this);
-		gemdroid_ip_snd[i].init(IP_TYPE_SND, i, true, SND_PROCESSING_TIME, p->dev_freq, optimal_freqs[IP_TYPE_SND], this);
-		gemdroid_ip_mic[i].init(IP_TYPE_MIC, i, true, MIC_PROCESSING_TIME, p->dev_freq, optimal_freqs[IP_TYPE_MIC], this);
-		gemdroid_ip_cam[i].init(IP_TYPE_CAM, i, true, CAM_PROCESSING_TIME, p->dev_freq, optimal_freqs[IP_TYPE_CAM], this);
-        gemdroid_ip_mmc_in[i].init(IP_TYPE_MMC_IN, i, true, MMC_PROCESSING_TIME, p->dev_freq, optimal_freqs[IP_TYPE_MMC_IN], this);
-        gemdroid_ip_mmc_out[i].init(IP_TYPE_MMC_OUT, i, true, MMC_PROCESSING_TIME, p->dev_freq, optimal_freqs[IP_TYPE_MMC_OUT], this);
-
-		gemdroid_ip_vd[i].init(IP_TYPE_VD, i, false, VD_PROCESSING_TIME, 24, 64, VID_CODING_RATIO, 1, true, p->ip_freq, optimal_freqs[IP_TYPE_VD], this);
-        gemdroid_ip_ve[i].init(IP_TYPE_VE, i, false, VE_PROCESSING_TIME, 24, 64, VID_CODING_RATIO, PROCESSING_CHUNK, false, p->ip_freq, optimal_freqs[IP_TYPE_VE], this);
-        gemdroid_ip_ad[i].init(IP_TYPE_AD, i, false, AD_PROCESSING_TIME, 24, 64, AUD_CODING_RATIO, 1, true, p->ip_freq, optimal_freqs[IP_TYPE_AD], this);
-        gemdroid_ip_ae[i].init(IP_TYPE_AE, i, false, AE_PROCESSING_TIME, 24, 64, AUD_CODING_RATIO, PROCESSING_CHUNK, false, p->ip_freq, optimal_freqs[IP_TYPE_AE], this);
-        gemdroid_ip_img[i].init(IP_TYPE_IMG, i, false, IMG_PROCESSING_TIME, 16, PROCESSING_CHUNK*2, 1, PROCESSING_CHUNK, false, p->ip_freq, optimal_freqs[IP_TYPE_IMG], this);
+
+    std::vector<GemDroidIPConfig> catalog;
+    loadIPCatalog(p->ip_catalog, catalog);
+
+    // The GPU comes first so that its display controller can be skipped without a trace
+    for(int k=0; k<catalog.size(); k++) {
+        if(catalog[k].kind == IP_KIND_GPU && catalog[k].id < num_ip_inst)
+            createIP(catalog[k], p);
+    }
+    for(int k=0; k<catalog.size(); k++) {
+        if(catalog[k].kind == IP_KIND_GPU)
+            continue;
+        if(catalog[k].gpuOnly) {
+            if(!isGPUEnabled())
+                continue;
+            // GPU-only instances sit right after the regular ones
+            GemDroidIPConfig cfg = catalog[k];
+            cfg.id = num_ip_inst;
+            gpuDisplayId = cfg.id;
+            createIP(cfg, p);
+            continue;
+        }
+        if(catalog[k].id >= num_ip_inst)
+            continue;
+        createIP(catalog[k], p);
     }
-	gemdroid_ip_gpu[0].init(IP_TYPE_GPU, 0, false, em_gputrace_file_name /* GPU trace file*/, p->ip_freq, optimal_freqs[IP_TYPE_GPU], this);
-    if (gemdroid_ip_gpu[0].isEnabled())
-    	gemdroid_ip_dc[num_ip_inst].init(IP_TYPE_DC, num_ip_inst, true, DC_PROCESSING_TIME, p->dev_freq, optimal_freqs[IP_TYPE_DC], this);
 
 	initDVFS();
+	checkIPCatalog(p->ip_catalog);
 }
 
-void GemDroid::loadFlows(string fileName)
+/*
+ * Flows always go to instance 0 of an IP type and the DVFS governors time
+ * the devices' memory traffic at the frequency of DC 0, so a catalog that
+ * leaves any of them out would only show up later as a NULL IP.
+ */
+void GemDroid::checkIPCatalog(const string &catalog_file)
 {
-    ifstream flowsFile;
-    string line;
-    int app_id, ip_id;
-    int flowId = 0;
-    int last_app_id = -1;
-
-    flowsFile.open(fileName);
-
-    for(int i=0; i<APP_ID_END; i++) {
-        for(int j=0; j<MAX_FLOWS_IN_APP; j++) {
-            for(int k=0; k<MAX_IPS_IN_FLOW; k++) {
-                flowTable[i][j][k] = -1;
+    for(int i=0; i<num_cpus; i++) {
+        int app = app_id[i];
+        if(app < 0 || app >= APP_ID_END)
+            continue;
+        for(int f=0; f<gemdroid_flows.numFlows(app); f++) {
+            const vector<int> &flow = gemdroid_flows.getFlow(app, f);
+            for(int k=0; k<flow.size(); k++) {
+                int ip_type = flow[k];
+                if(ip_type != IP_TYPE_CPU && getIPInstance(ip_type) == NULL)
+                    fatal("GemDroid: flow %d of app %d uses IP %s 0, which is not in the IP catalog %s\n",
+                          f, app, ipTypeToString(ip_type), catalog_file);
             }
         }
     }
 
-    while(getline(flowsFile, line)) {
-        istringstream iss(line);
-        if (line == "")
-            break;
-
-        iss >> app_id;
-        if (app_id != last_app_id)
-            flowId = 0;
-        int pos = 0;
-        do {
-            iss >> ip_id;
-            flowTable[app_id][flowId][pos++] = ip_id;
-        } while (ip_id != -1);
-        flowId++;
-        last_app_id = app_id;
+    if(enableDVFS && getIPInstance(IP_TYPE_DC) == NULL)
+        fatal("GemDroid: DVFS needs IP DC 0 for the memory bandwidth of the devices, but the IP catalog %s has none\n",
+              catalog_file);
+}
+
+/*
+ * Instantiate one IP from its catalog entry and register it in the IP table.
+ */
+GemDroidIP *GemDroid::createIP(const GemDroidIPConfig &cfg, const GemDroidParams *p)
+{
+    GemDroidIP *inst = NULL;
+    int freq = cfg.freq;
+
+    if(freq == 0)
+        freq = (cfg.kind == IP_KIND_DEVICE) ? p->dev_freq : p->ip_freq;
+
+    if(ipTable[cfg.ip_type][cfg.id] != NULL) {
+        cout << "FATAL: IP " << ipTypeToString(cfg.ip_type) << " " << cfg.id << " is listed twice in the IP catalog" << endl;
+        assert(0);
+    }
+
+    if(cfg.kind == IP_KIND_GPU) {
+        gemdroid_gpu = new GemDroidIPGPU;
+        gemdroid_gpu->init(cfg, em_gputrace_file_name, freq, optimal_freqs[cfg.ip_type], this);
+        inst = gemdroid_gpu;
+    }
+    else {
+        if(cfg.kind == IP_KIND_DECODER)
+            inst = new GemDroidIPDecoder;
+        else if(cfg.kind == IP_KIND_ENCODER)
+            inst = new GemDroidIPEncoder;
+        else if(cfg.kind == IP_KIND_NOCODER)
+            inst = new GemDroidIPNocoder;
+        else
+            inst = new GemDroidIP;
+        inst->init(cfg, freq, optimal_freqs[cfg.ip_type], this);
     }
 
-    flowsFile.close();
+    ipTable[cfg.ip_type][cfg.id] = inst;
+    ipInstances.push_back(inst);
+    if(inst != gemdroid_gpu || gemdroid_gpu->isEnabled())
+        tickedIPs.push_back(inst);
 
-    cout << "Flow information" << endl;
-    for(int i=0; i<APP_ID_END; i++) {
-        cout << i << endl;
-        for(int j=0; j<MAX_FLOWS_IN_APP; j++) {
-            cout << j << ": ";
-            for(int k=0; k<MAX_IPS_IN_FLOW; k++) {
-                cout << flowTable[i][j][k] << " ";
+    return inst;
+}
+
+/*
+ * The IP catalog lists one IP instance per "ip" line:
+ *   ip <type> <id> <kind> <freq> <proc_time> <in_buf> <out_buf> <coding_ratio> <chunk> <max_scale> <static_w> <dynamic_w> [gpu]
+ * type is the name used in the stats (DC, VD, ...), kind one of device,
+ * decoder, encoder, nocoder or gpu, and freq the initial MHz (0 picks the
+ * dev_freq/ip_freq param). max_scale may be written as a fraction (1/44).
+ * A trailing "gpu" marks an instance that only exists with a GPU trace;
+ * it takes the first id after the regular instances.
+ * "vf <v0> <f0> ... " sets the voltage/GHz table for the "ip" lines that
+ * follow it. Everything after '#' is a comment.
+ */
+static double parseCatalogNumber(const string &tok)
+{
+    size_t slash = tok.find('/');
+    if(slash == string::npos)
+        return atof(tok.c_str());
+
+    return atof(tok.substr(0, slash).c_str()) / atof(tok.substr(slash+1).c_str());
+}
+
+void GemDroid::loadIPCatalog(string filename, std::vector<GemDroidIPConfig> &catalog)
+{
+    ifstream catalogFile;
+    string line;
+    double vfTable[IP_DVFS_STATES][2];
+    bool vfSet = false;
+    int lineNum = 0;
+
+    catalogFile.open(filename);
+
+    if (!catalogFile.good()) {
+        cout << "Cannot open IP catalog file " << filename << endl;
+        assert(0);
+    }
+
+    while(getline(catalogFile, line)) {
+        lineNum++;
+        size_t comment = line.find('#');
+        if (comment != string::npos)
+            line.erase(comment);
+
+        istringstream iss(line);
+        string key;
+        if (!(iss >> key))
+            continue;
+
+        if (key == "vf") {
+            for(int i=0; i<IP_DVFS_STATES; i++)
+                iss >> vfTable[i][0] >> vfTable[i][1];
+            if (iss.fail()) {
+                cout << "FATAL: " << filename << ":" << lineNum << ": vf needs " << IP_DVFS_STATES << " voltage/freq pairs" << endl;
+                assert(0);
             }
-            cout << endl;
+            vfSet = true;
+            continue;
+        }
+
+        if (key != "ip") {
+            cout << "FATAL: " << filename << ":" << lineNum << ": unknown entry " << key << endl;
+            assert(0);
         }
+
+        GemDroidIPConfig cfg;
+        string type, kind, maxScale, flag;
+        iss >> type >> cfg.id >> kind >> cfg.freq >> cfg.processingTime >> cfg.inBufferSize >> cfg.outBufferSize
+            >> cfg.codingRatio >> cfg.chunkSize >> maxScale >> cfg.staticPower >> cfg.dynamicPower;
+        if (iss.fail()) {
+            cout << "FATAL: " << filename << ":" << lineNum << ": malformed ip entry" << endl;
+            assert(0);
+        }
+        cfg.maxScale = parseCatalogNumber(maxScale);
+        cfg.gpuOnly = (iss >> flag) && flag == "gpu";
+
+        cfg.ip_type = -1;
+        for(int i=IP_TYPE_DC; i<IP_TYPE_END; i++)
+            if (ipTypeToString(i) == type)
+                cfg.ip_type = i;
+
+        const char *kinds[IP_KIND_END] = { "device", "decoder", "encoder", "nocoder", "gpu" };
+        cfg.kind = -1;
+        for(int i=0; i<IP_KIND_END; i++)
+            if (kind == kinds[i])
+                cfg.kind = i;
+
+        if (cfg.ip_type == -1 || cfg.kind == -1 || cfg.id < 0 || cfg.id >= MAX_IPS || cfg.processingTime <= 0 || !vfSet) {
+            cout << "FATAL: " << filename << ":" << lineNum << ": invalid ip entry (type, kind, id, proc_time or missing vf table)" << endl;
+            assert(0);
+        }
+
+        for(int i=0; i<IP_DVFS_STATES; i++) {
+            cfg.voltage_freq_table[i][0] = vfTable[i][0];
+            cfg.voltage_freq_table[i][1] = vfTable[i][1];
+        }
+
+        catalog.push_back(cfg);
     }
-    cout << endl;
+
+    catalogFile.close();
+
+    cout << "Loaded " << catalog.size() << " IPs from catalog " << filename << endl;
+}
+
+void GemDroid::loadFlows(string fileName)
+{
+    gemdroid_flows.load(fileName);
+    gemdroid_flows.print();
 }
 
 void GemDroid::initDVFS()
@@ -306,11 +450,10 @@ void GemDroid::initDVFS()
     else if (governor == GOVERNOR_TYPE_OPTIMAL) { // Optimal Freqs
         for(int i=0; i<num_cpus; i++)
     	    gemdroid_core[i].setOptCoreFreq();
-   	    for(int i=IP_TYPE_VD; i<IP_TYPE_DMA; i++) {
-   	        for(int j=0; j<num_ip_inst; j++) {
-                GemDroidIP *inst = getIPInstance(i, j);
+   	    for(int k=0; k<ipInstances.size(); k++) {
+            GemDroidIP *inst = ipInstances[k];
+            if(inst->getIPType() >= IP_TYPE_VD)
                 inst->setOptIPFreq();
-            }
         }
         gemdroid_memory.setMemFreq(0.5);
         enableDVFS = false;
@@ -318,11 +461,10 @@ void GemDroid::initDVFS()
     else if (governor == GOVERNOR_TYPE_PERFORMANCE) { // Performance
         for(int i=0; i<num_cpus; i++)
     	    gemdroid_core[i].setMaxCoreFreq();
-   	    for(int i=IP_TYPE_VD; i<IP_TYPE_DMA; i++) {
-   	        for(int j=0; j<num_ip_inst; j++) {
-                GemDroidIP *inst = getIPInstance(i, j);
+   	    for(int k=0; k<ipInstances.size(); k++) {
+            GemDroidIP *inst = ipInstances[k];
+            if(inst->getIPType() >= IP_TYPE_VD)
                 inst->setMaxIPFreq();
-            }
         }
         gemdroid_memory.setMaxMemFreq();
         enableDVFS = false;
@@ -330,11 +472,10 @@ void GemDroid::initDVFS()
     else if (governor == GOVERNOR_TYPE_POWERSAVE) { // Power Saving
         for(int i=0; i<num_cpus; i++)
     	    gemdroid_core[i].setCoreFreq(0.5);
-   	    for(int i=IP_TYPE_VD; i<IP_TYPE_DMA; i++) {
-   	        for(int j=0; j<num_ip_inst; j++){
-                GemDroidIP *inst = getIPInstance(i, j);
+   	    for(int k=0; k<ipInstances.size(); k++) {
+            GemDroidIP *inst = ipInstances[k];
+            if(inst->getIPType() >= IP_TYPE_VD)
                 inst->setIPFreq(0.2);
-            }
         }
         gemdroid_memory.setMemFreq(0.5);
         enableDVFS = false;
@@ -342,11 +483,10 @@ void GemDroid::initDVFS()
     else if (governor == GOVERNOR_TYPE_ONDEMAND || governor == GOVERNOR_TYPE_INTERACTIVE || governor == GOVERNOR_TYPE_BUILDING || governor == GOVERNOR_TYPE_CORE_ORACLE) {
         for(int i=0; i<num_cpus; i++)
     	    gemdroid_core[i].setMaxCoreFreq();
-   	    for(int i=IP_TYPE_VD; i<IP_TYPE_DMA; i++) {
-   	        for(int j=0; j<num_ip_inst; j++) {
-                GemDroidIP *inst = getIPInstance(i, j);
+   	    for(int k=0; k<ipInstances.size(); k++) {
+            GemDroidIP *inst = ipInstances[k];
+            if(inst->getIPType() >= IP_TYPE_VD)
                 inst->setMaxIPFreq();
-            }
         }
         gemdroid_memory.setMemFreq(0.9);
     }
@@ -359,11 +499,10 @@ void GemDroid::initDVFS()
     		      governor == GOVERNOR_TYPE_SLACK_MAXENERGYPERTIME_CONSUMER ) { // Slack Governor
         for(int i=0; i<num_cpus; i++)
     	    gemdroid_core[i].setOptCoreFreq();
-   	    for(int i=IP_TYPE_VD; i<IP_TYPE_DMA; i++) {
-   	        for(int j=0; j<num_ip_inst; j++){
-                GemDroidIP *inst = getIPInstance(i, j);
+   	    for(int k=0; k<ipInstances.size(); k++) {
+            GemDroidIP *inst = ipInstances[k];
+            if(inst->getIPType() >= IP_TYPE_VD)
                 inst->setOptIPFreq();
-            }
         }
         gemdroid_memory.setOptMemFreq();
     }
@@ -406,11 +545,9 @@ void GemDroid::initDVFS()
     for(int i=0; i<num_cpus; i++)
         cpuFreqMultipliers[i] = GEMDROID_FREQ / gemdroid_core[i].getCoreFreq();
 
-    for(int i=IP_TYPE_DC; i<IP_TYPE_DMA; i++) {
-    	for(int j=0; j<num_ip_inst; j++) {
-    		GemDroidIP *inst = getIPInstance(i, j);
-            ipFreqMultipliers[i][j] = GEMDROID_FREQ / inst->getIPFreq();
-        }
+    for(int k=0; k<ipInstances.size(); k++) {
+        GemDroidIP *inst = ipInstances[k];
+        ipFreqMultipliers[inst->getIPType()][inst->getIPId()] = GEMDROID_FREQ / inst->getIPFreq();
     }
 
     memFreqMultiplier = GEMDROID_FREQ / gemdroid_memory.getMemFreq();
@@ -512,10 +649,21 @@ void GemDroid::loadIPChars(string filename)
 
 GemDroid::~GemDroid()
 {
+    for(int k=0; k<ipInstances.size(); k++)
+        delete ipInstances[k];
 }
 
 void GemDroid::init()
 {
+	if(gemdroid_enable)
+		gemdroid_memory.init();
+}
+
+BaseMasterPort &GemDroid::getMasterPort(const std::string &if_name, PortID idx)
+{
+	if(if_name == "mem_port" && gemdroid_memory.usesPort())
+		return gemdroid_memory.getMasterPort();
+	return MemObject::getMasterPort(if_name, idx);
 }
 
 void GemDroid::startup()
@@ -534,18 +682,11 @@ void GemDroid::regStats()
 		gemdroid_core[i].regStats();
 
 	gemdroid_sa.regStats();
+	gemdroid_slc.regStats();
 	gemdroid_memory.regStats();
  
-    for(int i=IP_TYPE_DC; i<IP_TYPE_DMA; i++) {
-        for(int j=0; j<num_ip_inst; j++) {
-	        GemDroidIP *inst = getIPInstance(i, j);
-            inst->regStats();
-        }
-	}
-	if (gemdroid_ip_gpu[0].isEnabled()) {
-		// gemdroid_ip_gpu[0].regStats();
-		gemdroid_ip_dc[1].regStats();
-	}
+    for(int k=0; k<ipInstances.size(); k++)
+        ipInstances[k]->regStats();
 
     // Local stats
     m_totalCommittedInsns
@@ -577,9 +718,9 @@ void GemDroid::regStats()
 			// m_avgPowerInFrame[i][j].name(str.str()).desc("GemDroid: Avg Power");
 		}
 	}
-	if (gemdroid_ip_gpu[0].isEnabled()) {
-		idleStreaksinActivePState[IP_TYPE_DC][num_ip_inst].init(1, 1000, 10).name("idleStreaksinActivePState_DC_1").desc("GemDroid: Idle Cycle Streaks in IP DC_1").flags(Stats::nozero);
-		m_cyclesPerFrame[IP_TYPE_DC][num_ip_inst].name("cyclesPerFrame_DC_1").desc("GemDroid: Number of cycles spent in this frame").flags(Stats::display);
+	if (isGPUEnabled()) {
+		idleStreaksinActivePState[IP_TYPE_DC][gpuDisplayId].init(1, 1000, 10).name("idleStreaksinActivePState_DC_1").desc("GemDroid: Idle Cycle Streaks in IP DC_1").flags(Stats::nozero);
+		m_cyclesPerFrame[IP_TYPE_DC][gpuDisplayId].name("cyclesPerFrame_DC_1").desc("GemDroid: Number of cycles spent in this frame").flags(Stats::display);
 		m_ipCallDrops[num_ip_inst].name("DC_1.m_ipCallDrops").desc("GemDroid: Number of ip calls rejected").flags(Stats::display);
 	}
 
@@ -591,7 +732,7 @@ void GemDroid::regStats()
 			str << ipTypeToString(i);
 			str << "_";
 			str << j;
-			if (gemdroid_ip_gpu[0].isEnabled() && i == IP_TYPE_DC && j == 1)
+			if (isGPUEnabled() && i == IP_TYPE_DC && j == gpuDisplayId)
 				; // DC 1 already initialized
 			else {
 				idleStreaksinActivePState[i][j].init(1, 1000, 10).name(str1 + str.str()).desc("GemDroid: Idle Cycle Streaks in IP"+str.str()).flags(Stats::nozero);
@@ -646,18 +787,11 @@ void GemDroid::resetStats()
 		gemdroid_core[i].resetStats();
 
 	gemdroid_sa.resetStats();
+	gemdroid_slc.resetStats();
 	gemdroid_memory.resetStats();
 
-    for(int i=IP_TYPE_DC; i<IP_TYPE_DMA; i++) {
-        for(int j=0; j<num_ip_inst; j++) {
-	        GemDroidIP *inst = getIPInstance(i, j);
-            inst->resetStats();
-        }
-    }
-
-	if (gemdroid_ip_gpu[0].isEnabled()) {
-		gemdroid_ip_dc[1].resetStats();
-    }
+    for(int k=0; k<ipInstances.size(); k++)
+        ipInstances[k]->resetStats();
 
 	m_totalCommittedInsns = 0;
 	for(int i=0; i<num_ip_inst; i++)
@@ -681,142 +815,30 @@ void GemDroid::printPeriodicStats()
 	gemdroid_sa.printPeriodicStats();
 	// gemdroid_memory.printPeriodicStats();
 
-    for(int i=IP_TYPE_DC; i<IP_TYPE_DMA; i++) {
-        if(i == IP_TYPE_NW || i == IP_TYPE_SND  || i == IP_TYPE_MIC || i == IP_TYPE_MMC_IN  || i == IP_TYPE_MMC_OUT)
-            continue;
-        for(int j=0; j<num_ip_inst; j++) {
-	        //GemDroidIP *inst = getIPInstance(i, j);
-            switch(i)
-            {
-                case IP_TYPE_VD:
-                    gemdroid_ip_vd[j].printPeriodicStats();
-                    break;
-                case IP_TYPE_VE:
-                    gemdroid_ip_ve[j].printPeriodicStats();
-                    break;
-                case IP_TYPE_AD:
-                    gemdroid_ip_ad[j].printPeriodicStats();
-                    break;
-                case IP_TYPE_AE:
-                    gemdroid_ip_ae[j].printPeriodicStats();
-                    break;
-                case IP_TYPE_IMG:
-                    gemdroid_ip_img[j].printPeriodicStats();
-                    break;
-                case IP_TYPE_GPU:
-                    gemdroid_ip_gpu[j].printPeriodicStats();
-                    break;
-            }
-/*            inst->printPeriodicStats();*/
-        }
+    // Accelerators and GPU only, plus the display controller the GPU renders to
+    for(int k=0; k<ipInstances.size(); k++) {
+        GemDroidIP *inst = ipInstances[k];
+        if(inst->getIPType() >= IP_TYPE_VD || (inst->getIPType() == IP_TYPE_DC && inst->getIPId() == gpuDisplayId))
+            inst->printPeriodicStats();
     }
-
-	if (gemdroid_ip_gpu[0].isEnabled()) {
-		gemdroid_ip_dc[num_ip_inst].printPeriodicStats();
-	}
-}
-
-void GemDroid::tickIP(int type, int id)
-{
-    switch (type) {
-    case IP_TYPE_DC:
-        gemdroid_ip_dc[id].tick();
-        break;
-    case IP_TYPE_NW:
-        gemdroid_ip_nw[id].tick();
-        break;
-    case IP_TYPE_SND:
-        gemdroid_ip_snd[id].tick();
-        break;
-    case IP_TYPE_MIC:
-        gemdroid_ip_mic[id].tick();
-        break;
-    case IP_TYPE_CAM:
-        gemdroid_ip_cam[id].tick();
-        break;
-    case IP_TYPE_MMC_IN:
-        gemdroid_ip_mmc_in[id].tick();
-        break;
-    case IP_TYPE_MMC_OUT:
-        gemdroid_ip_mmc_out[id].tick();
-        break;
-    case IP_TYPE_VD:
-        gemdroid_ip_vd[id].tick();
-        break;
-    case IP_TYPE_VE:
-        gemdroid_ip_ve[id].tick();
-        break;
-    case IP_TYPE_AD:
-        gemdroid_ip_ad[id].tick();
-        break;
-    case IP_TYPE_AE:
-        gemdroid_ip_ae[id].tick();
-        break;
-    case IP_TYPE_IMG:
-        gemdroid_ip_img[id].tick();
-        break;
-    case IP_TYPE_GPU:
-        gemdroid_ip_gpu[id].tick();
-        break;
-    case IP_TYPE_DMA:
-    case IP_TYPE_CACHE:
-        break;
-    default: 
-        cout<<"FATAL: Unknown IP ticked!"<<endl;
-        assert (1);
-    }
-}
-
-inline GemDroidIP *GemDroid::getIPInstance(int type, int id)
-{
-    switch (type) {
-    case IP_TYPE_DC:
-        return &gemdroid_ip_dc[id];
-    case IP_TYPE_NW:
-        return &gemdroid_ip_nw[id];
-    case IP_TYPE_SND:
-        return &gemdroid_ip_snd[id];
-    case IP_TYPE_MIC:
-        return &gemdroid_ip_mic[id];
-    case IP_TYPE_CAM:
-        return &gemdroid_ip_cam[id];
-    case IP_TYPE_MMC_IN:
-        return &gemdroid_ip_mmc_in[id];
-    case IP_TYPE_MMC_OUT:
-        return &gemdroid_ip_mmc_out[id];
-    case IP_TYPE_VD:
-        return &gemdroid_ip_vd[id];
-    case IP_TYPE_VE:
-        return &gemdroid_ip_ve[id];
-    case IP_TYPE_AD:
-        return &gemdroid_ip_ad[id];
-    case IP_TYPE_AE:
-        return &gemdroid_ip_ae[id];
-    case IP_TYPE_IMG:
-        return &gemdroid_ip_img[id];
-    case IP_TYPE_GPU:
-        return &gemdroid_ip_gpu[id];
-    case IP_TYPE_DMA:
-    case IP_TYPE_CACHE:
-    default: 
-        cout<<"FATAL: getIPInstance(): Unknown IP instance asked:" << type <<endl;
-        assert (0);
-    }
-
-    return NULL;
 }
 
 double GemDroid::getLastTimeForFlow(int app_id, int flow_id)
 {
-    int i = 0;
-    int ip = -1;
     double time = 0;
 
-    while ((ip = flowTable[app_id][flow_id][i++]) != -1)
-        time += lastTimeTook[ip];
-
-    // if(flowTable[app_id][0][IP_TYPE_CPU] != 0)
-        // time += lastTimeTook[IP_TYPE_CPU];
+    if (flow_id >= gemdroid_flows.numFlows(app_id))
+        return 0;
+
+    // Pipelined stages work on different frames at once, so the slowest
+    // stage bounds the frame time instead of the sum of all stages.
+    const vector<int> &flow = gemdroid_flows.getFlow(app_id, flow_id);
+    for(int i=0; i<flow.size(); i++) {
+        if (pipelinedFlows)
+            time = max(time, lastTimeTook[flow[i]]);
+        else
+            time += lastTimeTook[flow[i]];
+    }
 
     return time;
 }
@@ -843,6 +865,7 @@ void GemDroid::tick()
             printPeriodicStats();
 
         gemdroid_memory.printPeriodicStats();
+        gemdroid_slc.printPeriodicStats();
        
         assert(PERIODIC_STATS == POWER_CALC_PERIOD);
 
@@ -897,11 +920,10 @@ void GemDroid::tick()
 	    for(int i=0; i<num_cpus; i++)
             cpuFreqMultipliers[i] = GEMDROID_FREQ / gemdroid_core[i].getCoreFreq();
 
-	    for(int i=IP_TYPE_DC; i<IP_TYPE_DMA; i++)
-   	    	for(int j=0; j<num_ip_inst; j++) {
-   	    		GemDroidIP *inst = getIPInstance(i, j);
-                ipFreqMultipliers[i][j] = GEMDROID_FREQ / inst->getIPFreq();
-            }
+	    for(int k=0; k<ipInstances.size(); k++) {
+	        GemDroidIP *inst = ipInstances[k];
+	        ipFreqMultipliers[inst->getIPType()][inst->getIPId()] = GEMDROID_FREQ / inst->getIPFreq();
+	    }
 
         memFreqMultiplier = GEMDROID_FREQ / gemdroid_memory.getMemFreq();
 
@@ -923,28 +945,16 @@ void GemDroid::tick()
         }
     }
 
- 	for(int i=IP_TYPE_DC; i<IP_TYPE_GPU; i++){
-   		for(int j=0; j<num_ip_inst; j++){
-  			// if(ticks % ipFreqMultipliers[i][j] == 0) {
-  			if(ticks - ipLastTick[i][j] >= ipFreqMultipliers[i][j]) {
-  				// inst->tick();
-   				tickIP(i, j);
-
-                ipLastTick[i][j] = ticks;
-   			}
+ 	for(int k=0; k<tickedIPs.size(); k++) {
+ 		GemDroidIP *inst = tickedIPs[k];
+ 		int i = inst->getIPType();
+ 		int j = inst->getIPId();
+  		if(ticks - ipLastTick[i][j] >= ipFreqMultipliers[i][j]) {
+   			inst->tick();
+            ipLastTick[i][j] = ticks;
    		}
    	}
 
-  	if (gemdroid_ip_gpu[0].isEnabled()) {
-        // if(ticks % ipFreqMultipliers[IP_TYPE_GPU][0] == 0) {
-        if(ticks - ipLastTick[IP_TYPE_GPU][0] >= ipFreqMultipliers[IP_TYPE_GPU][0]) {
-  			gemdroid_ip_gpu[0].tick();
-		    gemdroid_ip_dc[num_ip_inst].tick();
-
-            ipLastTick[IP_TYPE_GPU][0] = ticks;
-  		}
-  	}
-
 	// if(ticks % memFreqMultiplier == 0) {
 	if(ticks - memLastTick >= memFreqMultiplier) {
 		gemdroid_sa.tick();
@@ -960,30 +970,10 @@ bool GemDroid::memIPResponse(int ip_type, int ip_id, uint64_t addr, bool isRead)
 {
 	assert (ip_type != IP_TYPE_CPU);
 
-	if (ip_type == IP_TYPE_DC)
-		gemdroid_ip_dc[ip_id].memResponse(addr, isRead);
-	else if (ip_type == IP_TYPE_SND)
-		gemdroid_ip_snd[ip_id].memResponse(addr, isRead);
-	else if (ip_type == IP_TYPE_MIC)
-		gemdroid_ip_mic[ip_id].memResponse(addr, isRead);
-	else if (ip_type == IP_TYPE_NW)
-		gemdroid_ip_nw[ip_id].memResponse(addr, isRead);
-	else if (ip_type == IP_TYPE_CAM)
-		gemdroid_ip_cam[ip_id].memResponse(addr, isRead);
-	else if (ip_type == IP_TYPE_MMC_IN)
-		gemdroid_ip_mmc_in[ip_id].memResponse(addr, isRead);
-	else if (ip_type == IP_TYPE_MMC_OUT)
-		gemdroid_ip_mmc_out[ip_id].memResponse(addr, isRead);
-	else if (ip_type == IP_TYPE_VD)
-		gemdroid_ip_vd[ip_id].memResponse(addr, isRead);
-	else if (ip_type == IP_TYPE_VE)
-		gemdroid_ip_ve[ip_id].memResponse(addr, isRead);
-	else if (ip_type == IP_TYPE_AD)
-		gemdroid_ip_ad[ip_id].memResponse(addr, isRead);
-	else if (ip_type == IP_TYPE_AE)
-		gemdroid_ip_ae[ip_id].memResponse(addr, isRead);
-	else if (ip_type == IP_TYPE_IMG)
-		gemdroid_ip_img[ip_id].memResponse(addr, isRead);
+	GemDroidIP *inst = getIPInstance(ip_type, ip_id);
+	panic_if(inst == NULL, "GemDroid: memory response for IP %s %d, which does not exist\n",
+	         ipTypeToString(ip_type), ip_id);
+	inst->memResponse(addr, isRead);
 
 	return true;
 }
@@ -1007,84 +997,35 @@ bool GemDroid::memCoreResponse(int type, int core_id, uint64_t addr, bool isRead
 bool GemDroid::enqueueIPReq(int sender_type, int sender_id, int core_id, int ip_type, uint64_t addr, int size, bool isRead, int frameNum, int flowType, int flowId)
 {
 	// TODO: Add scheduling between multiple IP instances (instead of always instance 0)
-	switch(ip_type)	{
-	case IP_TYPE_DC:
-		if (sender_type == IP_TYPE_GPU) // core writing to Framebuffer mmap'ed area
-			return gemdroid_ip_dc[1].enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
-		else	//Another IP (GPU or Video-dec) writing to Framebuffer mmap'ed area
-			return gemdroid_ip_dc[0].enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
-		break;
-	case IP_TYPE_NW:
-		return gemdroid_ip_nw[0].enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
-		break;
-	case IP_TYPE_SND:
-		return gemdroid_ip_snd[0].enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
-		break;
-	case IP_TYPE_MIC:
-		return gemdroid_ip_mic[0].enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
-		break;
-	case IP_TYPE_CAM:
-		return gemdroid_ip_cam[0].enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
-		break;
-	case IP_TYPE_MMC_IN:
-		return gemdroid_ip_mmc_in[0].enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
-		break;
-	case IP_TYPE_MMC_OUT:
-		return gemdroid_ip_mmc_out[0].enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
-		break;
-	case IP_TYPE_VD:
-		return gemdroid_ip_vd[0].enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
-		break;
-	case IP_TYPE_VE:
-		return gemdroid_ip_ve[0].enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
-		break;
-	case IP_TYPE_AD:
-		return gemdroid_ip_ad[0].enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
-		break;
-	case IP_TYPE_AE:
-		return gemdroid_ip_ae[0].enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
-		break;
-	case IP_TYPE_IMG:
-		return gemdroid_ip_img[0].enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
-		break;
-/*	case IP_TYPE_DMA:
-		return gemdroid_ip_dma[0].enqueueIPReq(core_id, addr, DC0_ADDR_START, size, frameNum, flowId);
-		break;*/
-	case IP_TYPE_GPU:
-		return gemdroid_ip_gpu[0].enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
-		break;
-	default:
+	int ip_id = 0;
+	if (ip_type == IP_TYPE_DC && sender_type == IP_TYPE_GPU) // GPU writing to its Framebuffer mmap'ed area
+		ip_id = gpuDisplayId;
+
+	GemDroidIP *inst = (ip_type > IP_TYPE_CPU && ip_type < IP_TYPE_END && ip_id >= 0) ? getIPInstance(ip_type, ip_id) : NULL;
+	if (inst == NULL) {
 		cout << "Wrong IP Type" << ip_type << "Addr: "<<addr<<endl;
-		break;
+		assert(0);
+		return false;
 	}
-	assert(0);
-	return false;
-}
-
-int GemDroid::flowType(int array[])
-{
-    int j;
-
-    for(j=0; j<MAX_IPS_IN_FLOW; j++) {
-        if (array[j] == -1)
-            break;
-    }
 
-    return array[j-1];
+	return inst->enqueueIPReq(core_id, addr, size, isRead, frameNum, flowType, flowId);
 }
 
 int GemDroid::getIPAccsInFlow(int core_id, int flow_id, int (&ips)[MAX_IPS_IN_FLOW])
 {
     int appid = app_id[core_id];
-    int i, j=0;
+    int j=0;
 
     for(int i=0; i<MAX_IPS_IN_FLOW; i++)
         ips[i] = -1;
 
-    for(i=0; i<MAX_IPS_IN_FLOW; i++) {
-        if (flowTable[appid][flow_id][i] != -1 && !isDevice(flowTable[appid][flow_id][i])) {
-            ips[j++] = flowTable[appid][flow_id][i];
-        }
+    if (flow_id >= gemdroid_flows.numFlows(appid))
+        return 0;
+
+    const vector<int> &flow = gemdroid_flows.getFlow(appid, flow_id);
+    for(int i=0; i<flow.size(); i++) {
+        if (!isDevice(flow[i]))
+            ips[j++] = flow[i];
     }
 
     return j;
@@ -1093,15 +1034,18 @@ int GemDroid::getIPAccsInFlow(int core_id, int flow_id, int (&ips)[MAX_IPS_IN_FL
 int GemDroid::getIPDevsInFlow(int core_id, int flow_id, int (&ips)[MAX_IPS_IN_FLOW])
 {
     int appid = app_id[core_id];
-    int i, j=0;
+    int j=0;
 
     for(int i=0; i<MAX_IPS_IN_FLOW; i++)
         ips[i] = -1;
 
-    for(i=0; i<MAX_IPS_IN_FLOW; i++) {
-        if (flowTable[appid][flow_id][i] != -1 && isDevice(flowTable[appid][flow_id][i])) {
-            ips[j++] = flowTable[appid][flow_id][i];
-        }
+    if (flow_id >= gemdroid_flows.numFlows(appid))
+        return 0;
+
+    const vector<int> &flow = gemdroid_flows.getFlow(appid, flow_id);
+    for(int i=0; i<flow.size(); i++) {
+        if (isDevice(flow[i]))
+            ips[j++] = flow[i];
     }
 
     return j;
@@ -1112,135 +1056,34 @@ int GemDroid::getIPsInFlow(int core_id, int flow_id, int (&ips)[MAX_IPS_IN_FLOW]
     int appid = app_id[core_id];
     int i;
 
-    for(int i=0; i<MAX_IPS_IN_FLOW; i++)
+    for(i=0; i<MAX_IPS_IN_FLOW; i++)
         ips[i] = -1;
 
-    for(i=0; i<MAX_IPS_IN_FLOW; i++) {
-        if (flowTable[appid][flow_id][i] == -1)
-            break;
-        ips[i] = flowTable[appid][flow_id][i];
-    }
+    if (flow_id >= gemdroid_flows.numFlows(appid))
+        return 0;
+
+    const vector<int> &flow = gemdroid_flows.getFlow(appid, flow_id);
+    for(i=0; i<flow.size(); i++)
+        ips[i] = flow[i];
 
     return i;
 }
 
 int GemDroid::getFlowId(int core_id, int ip_id)
 {
-    int appid = app_id[core_id];
+    const vector<int> &flows = gemdroid_flows.getFlowsOfIP(app_id[core_id], ip_id);
 
-    for(int i=0; i<MAX_FLOWS_IN_APP; i++) {
-        for(int j=0; j<MAX_IPS_IN_FLOW; j++) {
-            if (flowTable[appid][i][i] == ip_id)
-                return i;
-        }
-    }
+    if (flows.empty())
+        return -1;
 
-    return -1;
+    return flows[0];
 }
 
 void GemDroid::nextIPtoCall(int curr_ip_active, int core_id, int flow_type, int (&ips)[MAX_IPS_IN_FLOW])
 {
-    int appid = app_id[core_id];
-    int count = 0;
-
-    for(int i=0; i<MAX_IPS_IN_FLOW; i++)
-        ips[i] = -1;
-
-    for(int i=0; i<MAX_FLOWS_IN_APP; i++) {
-        if (flowTable[appid][i][0] == -1)
-            break;
-
-        for(int j=0; j<MAX_IPS_IN_FLOW-1; j++) {
-            if (flowTable[appid][i][j] == curr_ip_active && flow_type == flowType(flowTable[appid][i]))
-                ips[count++] = flowTable[appid][i][j+1];
-        }
-    }
+    gemdroid_flows.nextStages(app_id[core_id], curr_ip_active, flow_type, ips, MAX_IPS_IN_FLOW);
 
     // cout << "Next IP after " << ipTypeToString(curr_ip_active) << " " << ipTypeToString(ips[0]) << " " << ipTypeToString(ips[1]) << endl;
-
-	/* if(curr_ip_active == IP_TYPE_CPU) {
-
-		if(flow_type == IP_TYPE_SND) {
-			if(em_trace_file_name[core_id].find("video-record") != string::npos) {
-				return -1;
-            }
-            else if(em_trace_file_name[core_id].find("video-play") != string::npos) {
-				return IP_TYPE_MMC_IN;
-			}
-		}
-
-		if((em_trace_file_name[core_id].find("gallery") != string::npos) || (em_trace_file_name[core_id].find("video-play") != string::npos) || (em_trace_file_name[core_id].find("audio-play") != string::npos))
-			return IP_TYPE_MMC_IN;
-		else if(em_trace_file_name[core_id].find("youtube") != string::npos)
-			return IP_TYPE_VD;
-		else if(em_trace_file_name[core_id].find("skype") != string::npos)
-			return IP_TYPE_VD;
-		else if(em_trace_file_name[core_id].find("video-record") != string::npos)
-			return -1;
-		else if(em_trace_file_name[core_id].find("DISP") != string::npos)
-			return IP_TYPE_DC;
-	}
-	else if(curr_ip_active == IP_TYPE_VE) {
-		if(em_trace_file_name[core_id].find("skype") != string::npos)
-			return IP_TYPE_NW;
-	}	
-	else if(curr_ip_active == IP_TYPE_AE) {
-		if(em_trace_file_name[core_id].find("skype") != string::npos)
-			return IP_TYPE_NW;
-	}
-	else if(curr_ip_active == IP_TYPE_MIC) {
-		if(em_trace_file_name[core_id].find("skype") != string::npos)
-			return IP_TYPE_AE;
-	}
-	else if(curr_ip_active == IP_TYPE_AD) {
-		if(em_trace_file_name[core_id].find("skype") != string::npos)
-			return IP_TYPE_SND;
-	}	
-	else if(curr_ip_active == IP_TYPE_VD) {
-		if(em_trace_file_name[core_id].find("skype") != string::npos)
-			return IP_TYPE_DC;
-	}	
-
-	else if(curr_ip_active == IP_TYPE_CAM) {
-		if(flow_type == IP_TYPE_DC) {
-			if(em_trace_file_name[core_id].find("argame") != string::npos)
-				return IP_TYPE_IMG;
-			if(em_trace_file_name[core_id].find("video-record") != string::npos)
-				return IP_TYPE_IMG;
-			if(em_trace_file_name[core_id].find("photo-capture") != string::npos)
-				return IP_TYPE_IMG;
-		}
-		else if(flow_type == IP_TYPE_CAM) {
-			if(em_trace_file_name[core_id].find("argame") != string::npos)
-				return IP_TYPE_IMG;
-			if(em_trace_file_name[core_id].find("video-record") != string::npos)
-				return IP_TYPE_VE;
-			if(em_trace_file_name[core_id].find("skype") != string::npos)
-				return IP_TYPE_VE;
-		}
-	}
-	else if(curr_ip_active == IP_TYPE_IMG) {
-		if(em_trace_file_name[core_id].find("photo-capture") != string::npos)
-			return IP_TYPE_MMC_OUT;
-	}
-	else if(curr_ip_active == IP_TYPE_MMC_IN) {
-
-		if(flow_type == IP_TYPE_SND) {
-			if(em_trace_file_name[core_id].find("video-play") != string::npos) {
-				return IP_TYPE_AD;
-			}
-		}
-
-		if(em_trace_file_name[core_id].find("gallery") != string::npos)
-			return IP_TYPE_IMG;
-		else if(em_trace_file_name[core_id].find("video-play") != string::npos)
-			return IP_TYPE_VD;
-		else if(em_trace_file_name[core_id].find("audio-play") != string::npos)
-			return IP_TYPE_AD;
-	}
-
-	// assert(0);
-	return -1; */
 }
 
 /* bool GemDroid::isIPCallDrop(int ip_type, long timeTook)
@@ -1315,167 +1158,13 @@ bool GemDroid::isFlowDrop(int flow_id, long timeTook)
 
 void GemDroid::flow_identification(int core_id, int ip_type, int (&flows)[MAX_FLOWS_IN_APP])
 {
-    int appid = app_id[core_id];
-    int count = 0;
+    const vector<int> &ipFlows = gemdroid_flows.getFlowsOfIP(app_id[core_id], ip_type);
 
     for(int i=0; i<MAX_FLOWS_IN_APP; i++) {
-	    flows[i] = -1;
-    }
-
-    for(int i=0; i<MAX_FLOWS_IN_APP; i++) {
-        if (flowTable[appid][i][0] == -1)
-            break;
-
-        for(int j=0; j<MAX_IPS_IN_FLOW; j++) {
-            if (flowTable[appid][i][j] == ip_type) {
-                flows[count++] = i;
-            }
-        }
+	    flows[i] = (i < ipFlows.size()) ? ipFlows[i] : -1;
     }
 
     // cout << "GemDroid::flow_identification " << ipTypeToString(ip_type) << " " << flows[0] << " " << flows[1] << endl;
-
-	/* if(em_trace_file_name[core_id].find("youtube") != string::npos) {
-		if(ip_type == IP_TYPE_VD)
-			flow_id1 = 1;
-		if(ip_type == IP_TYPE_AD)
-			flow_id1 = 2;
-		if(ip_type == IP_TYPE_DC)
-			flow_id1 = 1;
-	}
-	else if(em_trace_file_name[core_id].find("video-record") != string::npos) {
-		if(ip_type == IP_TYPE_CAM) {
-			flow_id1 = 3;
-			flow_id2 = 4;
-		}
-		// not else if
-		if(ip_type == IP_TYPE_IMG)
-			flow_id1 = 3;
-		if(ip_type == IP_TYPE_VE)
-			flow_id1 = 4;
-
-		if(ip_type == IP_TYPE_MIC)
-			flow_id1 = 5;
-		if(ip_type == IP_TYPE_AE)
-			flow_id1 = 5;
-
-		if(ip_type == IP_TYPE_DC)
-			flow_id1 = 3;
-		if(ip_type == IP_TYPE_SND)
-			flow_id1 = 4;
-	}
-	else if(em_trace_file_name[core_id].find("photo") != string::npos) {
-		if(ip_type == IP_TYPE_CAM) {
-			flow_id1 = 6;
-			flow_id2 = 7;
-		}
-		if(ip_type == IP_TYPE_IMG) {
-			flow_id1 = 6;
-			flow_id2 = 7;
-		}
-
-		if(ip_type == IP_TYPE_DC)
-			flow_id1 = 6;
-		if(ip_type == IP_TYPE_MMC_OUT)
-			flow_id1 = 7;
-	}
-	else if(em_trace_file_name[core_id].find("audio-play") != string::npos) {
-		if(ip_type == IP_TYPE_MMC_IN || ip_type == IP_TYPE_AD) {
-			flow_id1 = 8;
-		}
-		if(ip_type == IP_TYPE_SND)
-			flow_id1 = 8;
-	}
-	else if(em_trace_file_name[core_id].find("argame") != string::npos) {
-		if(ip_type == IP_TYPE_CAM || ip_type == IP_TYPE_IMG) {
-			flow_id1 = 9;
-		}
-		if(ip_type == IP_TYPE_AD || ip_type == IP_TYPE_SND) {
-			flow_id1 = 10;
-		}
-		if(ip_type == IP_TYPE_GPU)
-		 	flow_id1 = 20;
-
-		if(ip_type == IP_TYPE_DC)
-			flow_id1 = 9;
-		if(ip_type == IP_TYPE_SND)
-			flow_id1 = 10;
-	}
-	else if(em_trace_file_name[core_id].find("angry") != string::npos) {
-		if(ip_type == IP_TYPE_GPU)
-		 	flow_id1 = 15;
-		if(ip_type == IP_TYPE_AD || ip_type == IP_TYPE_SND) {
-			flow_id1 = 10;
-		}
-
-		if(ip_type == IP_TYPE_DC)
-			flow_id1 = 15;
-	}
-	else if(em_trace_file_name[core_id].find("gallery") != string::npos) {
-		if(ip_type == IP_TYPE_MMC_IN || ip_type == IP_TYPE_IMG) {
-			flow_id1 = 11;
-		}
-
-		if(ip_type == IP_TYPE_DC)
-			flow_id1 = 11;
-	}
-	else if(em_trace_file_name[core_id].find("audio-record") != string::npos) {
-		if(ip_type == IP_TYPE_MIC || ip_type == IP_TYPE_AE) {
-			flow_id1 = 12;
-		}
-		if(ip_type == IP_TYPE_MMC_OUT)
-			flow_id1 = 11;
-	}
-	else if(em_trace_file_name[core_id].find("video-play") != string::npos) {
-		if(ip_type == IP_TYPE_MMC_IN) {
-			flow_id1 = 13;
-			flow_id2 = 14;
-		}
-
-		if(ip_type == IP_TYPE_VD) {
-			flow_id1 = 13;
-		}
-
-		if(ip_type == IP_TYPE_AD) {
-			flow_id1 = 14;
-		}
-
-		if(ip_type == IP_TYPE_DC) {
-			flow_id1 = 13;
-		}
-
-		if(ip_type == IP_TYPE_SND) {
-			flow_id1 = 14;
-		}
-	}
-	else if(em_trace_file_name[core_id].find("skype") != string::npos) {
-		if(ip_type == IP_TYPE_CAM) {
-			flow_id1 = 16;
-			flow_id2 = 16;
-		}
-		if(ip_type == IP_TYPE_VE)
-			flow_id1 = 16;
-		if(ip_type == IP_TYPE_VD)
-			flow_id1 = 17;
-		if(ip_type == IP_TYPE_MIC)
-			flow_id1 = 18;
-		if(ip_type == IP_TYPE_AE)
-			flow_id1 = 18;
-		if(ip_type == IP_TYPE_AD)
-			flow_id1 = 19;
-
-		if(ip_type == IP_TYPE_DC)
-			flow_id1 = 17;
-
-		if(ip_type == IP_TYPE_SND)
-			flow_id1 = 19;
-	}
-	else 
-	{
-		cout<<"\n Incorrect trace file name.. "<<endl;
-		assert(0);
-    } */
-   // assert (flow_id1 != -1);  // Network IP calls this.
 }
 
 /* int GemDroid::getLastIPInFlow(int flowId)
@@ -1691,26 +1380,16 @@ void GemDroid::powerCalculator1us()
         }
 	}
 
-	for(int type=IP_TYPE_DC; type<IP_TYPE_DMA; type++) {
-		for(int j=0; j<num_ip_inst; j++) {
-            GemDroidIP *inst = getIPInstance(type, j);
-            power = inst->powerIn1us();
-	        if (frameStarted[type][j]) {
-                if (type == IP_TYPE_GPU) {
-                    power = gemdroid_ip_gpu[0].powerIn1us();
-                }
-                m_avgPowerInFrameSum[type][j] += power;
-                m_avgPowerInFrameCount[type][j]++;
-                // if (type == IP_TYPE_VD)
-                    // cout << "BBB VD us" << power << endl;
-            }
+	for(int k=0; k<ipInstances.size(); k++) {
+        GemDroidIP *inst = ipInstances[k];
+        int type = inst->getIPType();
+        int j = inst->getIPId();
+        power = inst->powerIn1us();
+	    if (frameStarted[type][j]) {
+            m_avgPowerInFrameSum[type][j] += power;
+            m_avgPowerInFrameCount[type][j]++;
         }
     }
-
-    if (gemdroid_ip_gpu[0].isEnabled()) {
-        m_avgPowerInFrameSum[IP_TYPE_DC][1] += gemdroid_ip_dc[1].powerIn1us();
-        m_avgPowerInFrameCount[IP_TYPE_DC][1]++;
-    }
 }
 
 void GemDroid::powerCalculator()
@@ -1735,23 +1414,20 @@ void GemDroid::powerCalculator()
 			// m_avgPowerInFrame[IP_TYPE_CPU][i] = power;
 		}
 
-		for(int type=IP_TYPE_DC; type<IP_TYPE_DMA; type++) {
-			for(int j=0; j<num_ip_inst; j++) {
-                GemDroidIP *inst = getIPInstance(type, j);
-                double power = inst->powerIn1ms();
+		for(int k=0; k<ipInstances.size(); k++) {
+            GemDroidIP *inst = ipInstances[k];
+            int type = inst->getIPType();
+            double power = inst->powerIn1ms();
 
-                if (type == IP_TYPE_GPU)
-                    gpu_power += power;
-                else if (type > IP_TYPE_MMC_OUT)
-                    ip_power += power;
-                else
-                    dev_power += power;
+            if (type == IP_TYPE_GPU)
+                gpu_power += power;
+            else if (type > IP_TYPE_MMC_OUT)
+                ip_power += power;
+            else
+                dev_power += power;
 
-                m_totalIPEnergy[type] += power;
-   			}
+            m_totalIPEnergy[type] += power;
 		}
-        if (gemdroid_ip_gpu[0].isEnabled())
-            ip_power += gemdroid_ip_dc[1].powerIn1ms();
 
 		sa_power = gemdroid_sa.powerIn1ms();
 		memory_power = gemdroid_memory.powerIn1ms();
@@ -1810,11 +1486,8 @@ double GemDroid::getCoordinatedPower()
         powerUsed += gemdroid_core[i].getPowerEst();
 	}
 
-   	for(int i=IP_TYPE_DC; i<=IP_TYPE_GPU; i++)
-   	    for(int j=0; j<num_ip_inst; j++) {
-            GemDroidIP *inst = getIPInstance(i, j);
-            powerUsed += inst->getPowerEst();
-        }
+   	for(int k=0; k<ipInstances.size(); k++)
+        powerUsed += ipInstances[k]->getPowerEst();
 
     return (POWERCAP - powerUsed - 1.5); // 2 for memory + sa + blackbox + screen */
 }
@@ -32,7 +32,7 @@
 #define __GEMDROID_HH__
 
 #include "mem/abstract_mem.hh"
-#include "sim/clocked_object.hh"
+#include "mem/mem_object.hh"
 #include "base/statistics.hh"
 #include "params/GemDroid.hh"
 
@@ -46,14 +46,13 @@
 #include "gemdroid/gemdroid_ip_decoder.hh"
 #include "gemdroid/gemdroid_ip_nocoder.hh"
 #include "gemdroid/gemdroid_ip_dma.hh"
+#include "gemdroid/gemdroid_flow.hh"
+#include "gemdroid/gemdroid_slc.hh"
 
 #define PERIODIC_STATS (1000000 * (int) GEMDROID_FREQ) // 1ms
 #define DVFS_PERIOD (1000000 * (int) GEMDROID_FREQ) // 1ms
 #define POWER_CALC_PERIOD (1000000 * (int) GEMDROID_FREQ) // 1ms
 
-#define MAX_FLOWS_IN_APP 5
-#define MAX_IPS_IN_FLOW 5
-
 #define DVFS_POWERCAP 7 // in Watts
 #define DVFS_PRIORITIZE_CORE 1
 #define MOTIVATION_GRAPHS 0
@@ -71,7 +70,7 @@ int findMin(double array[], int n);
 bool isAllZeroes(double array[], int n);
 void printArray(int array[], int n);
 
-class GemDroid : public ClockedObject
+class GemDroid : public MemObject
 {
 private:
 	 /**
@@ -97,6 +96,7 @@ private:
      double sweep_val1;
      double sweep_val2;
      bool perfectMemory;
+     bool pipelinedFlows;
 
      long powerCalcLastTick;
      long periodicStatsLastTick;
@@ -110,9 +110,6 @@ private:
      string em_gputrace_file_name;
 	 string em_trace_file_name[MAX_CPUS];
      int app_id[MAX_CPUS];
-     //3D table;
-     //AppID (#defined in gemdroid_defines.h), flows, IPs in the flow.
-     int flowTable[APP_ID_END][MAX_FLOWS_IN_APP][MAX_IPS_IN_FLOW];
 
 	 long flowStartCycle[MAX_FLOWS][10000];
 	 long ipProcessStartCycle[IP_TYPE_END][MAX_IPS];
@@ -147,13 +144,17 @@ private:
      int framenum_motivationgraphs;
      void powerCalculator1us();
 	 void powerCalculator();
-     GemDroidIP *getIPInstance(int ip_type, int id=0);
+     inline GemDroidIP *getIPInstance(int ip_type, int id=0) { return ipTable[ip_type][id]; }
+     std::vector<GemDroidIP *> tickedIPs;	// ipInstances minus a disabled GPU
 
 	//DVFS Related
      void initDVFS();
      void updateDVFS();
      void loadFlows(string fileName);
      void loadIPChars(string filename);
+     void loadIPCatalog(string filename, std::vector<GemDroidIPConfig> &catalog);
+     GemDroidIP *createIP(const GemDroidIPConfig &cfg, const GemDroidParams *p);
+     void checkIPCatalog(const string &catalog_file);
      double getLastSlack(int core_id, int flow_id);
      double getIPProcessingSize(int typeOfIP);
      double getIPProcessingLatency(int typeOfIP);
@@ -182,22 +183,14 @@ public:
 	GemDroidCore gemdroid_core[MAX_CPUS];
 	GemDroidMemory gemdroid_memory;
 	GemDroidSA gemdroid_sa;
-	GemDroidIP gemdroid_ip_dc[MAX_IPS];
-	GemDroidIP gemdroid_ip_nw[MAX_IPS];
-	GemDroidIP gemdroid_ip_snd[MAX_IPS];
-	GemDroidIP gemdroid_ip_mic[MAX_IPS];
-	GemDroidIP gemdroid_ip_cam[MAX_IPS];
-	GemDroidIP gemdroid_ip_mmc_in[MAX_IPS];
-	GemDroidIP gemdroid_ip_mmc_out[MAX_IPS];
-	GemDroidIPDecoder gemdroid_ip_vd[MAX_IPS];
-	GemDroidIPEncoder gemdroid_ip_ve[MAX_IPS];
-	GemDroidIPDecoder gemdroid_ip_ad[MAX_IPS];
-	GemDroidIPEncoder gemdroid_ip_ae[MAX_IPS];
-    GemDroidIPNocoder gemdroid_ip_img[MAX_IPS];
-
-    GemDroidIPGPU gemdroid_ip_gpu[MAX_IPS];
-    // GemDroidIPDMA gemdroid_ip_dma[MAX_IPS];
-    
+	GemDroidSLC gemdroid_slc;
+	GemDroidFlowGraph gemdroid_flows;
+	// IP instances from the catalog, indexed by type and id (NULL when absent)
+	GemDroidIP *ipTable[IP_TYPE_END][MAX_IPS];
+	std::vector<GemDroidIP *> ipInstances;
+	GemDroidIPGPU *gemdroid_gpu;
+	int gpuDisplayId;	// DC instance the GPU renders to
+
     long appMemReqs[MAX_CPUS];
     long ipMemReqs[IP_TYPE_END];
     double ip_time_table[IP_TYPE_END][IP_DVFS_STATES];
@@ -213,6 +206,8 @@ public:
     GemDroid(const Params *p);
     ~GemDroid();
     void init();
+    BaseMasterPort &getMasterPort(const std::string &if_name,
+                                  PortID idx = InvalidPortID);
     void startup();
     void regStats();
     void resetStats();
@@ -225,9 +220,7 @@ public:
     bool enqueueCoreIPReq(int id, int ip_type, uint64_t addr, int size, bool isRead, int frameNum);
     bool memIPResponse(int ip_type, int ip_id, uint64_t addr, bool isRead);
     bool memCoreResponse(int type, int core_id, uint64_t addr, bool isRead);
-    void tickIP(int type, int id);
     bool isIPCallDrop(int ip_type, long timeTook);
-    int flowType(int array[]);
     void flow_identification(int core_id, int ip_type, int (&flows)[MAX_FLOWS_IN_APP]);
     int getLastIPInFlow(int flowId);
     int getFirstIPInFlow(int flowId);
@@ -236,12 +229,14 @@ public:
     inline double getSweepVal1() { return sweep_val1; }
     inline double getSweepVal2() { return sweep_val2; }
     inline bool isPerfectMemory() {return perfectMemory;}
+    inline bool isGPUEnabled() { return gemdroid_gpu != NULL && gemdroid_gpu->isEnabled(); }
 
     bool has2ndFlow(int appID);
     int getIPAccsInFlow(int core_id, int flow_id, int (&ips)[MAX_IPS_IN_FLOW]);
     int getIPDevsInFlow(int core_id, int flow_id, int (&ips)[MAX_IPS_IN_FLOW]);
     int getIPsInFlow(int core_id, int flow_id, int (&ips)[MAX_IPS_IN_FLOW]);
     int getAppIdWithName(string appName);
+    inline int getAppId(int core_id) { return app_id[core_id]; }
     // double getCoreFreq() { if (core_freq == -1) return (GEMDROID_FREQ/GEMDROID_TO_CORE); else return (double) core_freq/1000; } // in GHz
     // double getIPFreq() { if (ip_freq == -1) return (GEMDROID_FREQ/CORE_TO_ACC_FREQ); else return (double) ip_freq/1000; } // in GHz
     inline int getGovernor() { return governor; }
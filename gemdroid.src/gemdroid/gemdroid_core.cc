@@ -39,6 +39,7 @@ GemDroidCore::GemDroidCore()
 	number_of_instr_executed_OoO = 0;
 	deadlocks_faced = 0;
 	outstanding_transactions_size = 0;
+	m_robPendingInsns = 0;
 	type_of_application = CORE_BOUND;
 	needToLookAhead = true;
 
@@ -74,6 +75,10 @@ GemDroidCore::GemDroidCore()
 	m_thisFrameRobFullStalls = 0;
 	m_thisFrameMemFullStalls = 0;
 /*	m_memFullStalls = 0;*/
+	m_loadsForwarded = 0;
+	m_memReqsCoalesced = 0;
+	m_memOrderStalls = 0;
+	m_mlpLimitStalls = 0;
 
 	m_activePStateCycles = 0;
 	m_lowpowerPStateCycles = 0;
@@ -174,6 +179,12 @@ void GemDroidCore::regStats()
 	m_thisFrameMemFullStalls.name(desc + ".m_thisFrameMemFullStalls").desc("GemDroid: For this frame, number of cycles stalled for Mem full").flags(Stats::display);
 	m_thisFrameIPFullStalls.name(desc + ".m_thisFrameIPFullStalls").desc("GemDroid: For this frame, number of cycles stalled for IP full").flags(Stats::display);
 
+	m_loadsForwarded.name(desc + ".loadsForwarded").desc("GemDroid: Number of loads forwarded from an in-flight store").flags(Stats::display);
+	m_memReqsCoalesced.name(desc + ".memReqsCoalesced").desc("GemDroid: Number of memory ops merged with an in-flight op to the same address").flags(Stats::display);
+	m_memOrderStalls.name(desc + ".memOrderStalls").desc("GemDroid: Number of cycles a store waited for an older load to the same address").flags(Stats::display);
+	m_mlpLimitStalls.name(desc + ".mlpLimitStalls").desc("GemDroid: Number of cycles memory issue stalled for the MLP limit").flags(Stats::display);
+	m_outstandingMemReqs.init(0, mlp_limit, 1).name(desc + ".outstandingMemReqs").desc("GemDroid: Number of memory requests in flight per active cycle").flags(Stats::nozero);
+
 	m_activePStateCycles.name(desc + ".m_activePStateCycles").desc("GemDroid: Number of cycles spent in active state").flags(Stats::display);
 	m_lowpowerPStateCycles.name(desc + ".m_lowpowerPStateCycles").desc("GemDroid: Number of cycles spent in lowpower state").flags(Stats::display);
 	m_idlePStateCycles.name(desc + ".m_idlePStateCycles").desc("GemDroid: Number of cycles spent in idle state").flags(Stats::display);
@@ -208,16 +219,31 @@ void GemDroidCore::resetStats()
 	m_thisFrameRobFullStalls = 0;
 	m_thisFrameMemFullStalls = 0;
 
+	m_loadsForwarded = 0;
+	m_memReqsCoalesced = 0;
+	m_memOrderStalls = 0;
+	m_mlpLimitStalls = 0;
+	m_outstandingMemReqs.reset();
+
 	m_activePStateCycles = 0;
 	m_lowpowerPStateCycles = 0;
 	m_idlePStateCycles = 0;
 }
 
-void GemDroidCore::init(int id, std::string trace_file, int app_id, int core_freq, int optDVFSState, int issue_width, GemDroid *gemDroid)
+void GemDroidCore::init(int id, std::string trace_file, int app_id, int core_freq, int optDVFSState, int issue_width,
+						int commit_width, int core_model, int rob_size, int mlp_limit, GemDroid *gemDroid)
 {
 	core_id=id;
 	this->gemDroid = gemDroid;
 	this->issue_width = issue_width;
+	this->commit_width = (commit_width > 0) ? commit_width : issue_width;
+	this->core_model = core_model;
+	this->rob_size = rob_size;
+	this->mlp_limit = mlp_limit;
+	assert(core_model >= CORE_MODEL_IN_ORDER && core_model <= CORE_MODEL_OOO);
+	assert(issue_width > 0 && rob_size > 0 && mlp_limit > 0);
+	if(core_model == CORE_MODEL_OOO)
+		rob.init(rob_size);
     this->app_id = app_id;
 	desc="GemDroid.Core_";
 	desc += (char)(id+'0');
@@ -559,8 +585,127 @@ void GemDroidCore::inOrderProcess()
 }
 
 
+/*
+ * CORE_MODEL_OOO: each cycle commits up to commit_width instructions from the
+ * ROB head, issues up to issue_width memory ops (in program order among
+ * themselves, bounded by mlp_limit in flight), and dispatches up to issue_width
+ * new instructions from the trace into the free ROB space. A memory op at the
+ * head only blocks commit; younger work keeps dispatching until the ROB fills.
+ */
+void GemDroidCore::ooOProcess()
+{
+	long committed = 0;
+	while(committed < commit_width && !rob.empty() && rob.front().state == ROB_ENTRY_DONE)
+		committed += rob.commitHead(commit_width - committed);
+
+	if(committed > 0) {
+		idleCycles = 0;
+		streakCalculator();
+		updateStatInstructionCommit(committed);
+	}
+	else if(!rob.empty()) {
+		// Head is waiting on memory.
+		m_thisFrameRobFullStalls++;
+		if(flagProfile)
+			m_profileRobFullStalls++;
+
+		m_thisMicroSecRobFullStalls++;
+		m_thisMilliSecRobFullStalls++;
+
+		idleCycles++;
+		idleStreak++;
+	}
+	else {
+		idleCycles++;
+		idleStreak++;
+	}
+
+	for(int issued = 0; issued < issue_width && rob.hasPendingIssue(); issued++) {
+		if(rob.getInFlight() >= mlp_limit) {
+			m_mlpLimitStalls++;
+			break;
+		}
+
+		int slot = rob.nextToIssue();
+		GemDroidROB::Entry &entry = rob.at(slot);
+		if(rob.isBlocked(entry)) {
+			m_memOrderStalls++;
+			break;
+		}
+
+		if(!gemDroid->gemdroid_sa.enqueueCoreMemRequest(core_id, entry.addr, entry.type == INSTR_MMU_LD)) {
+			m_thisFrameMemFullStalls++;
+			if(flagProfile)
+				m_profileMemFullStalls++;
+			break;
+		}
+		rob.markIssued(slot, ticks);
+	}
+	m_outstandingMemReqs.sample(rob.getInFlight());
+
+	// Dispatch. Trace reads stop as soon as a line asks the core to stall.
+	long dispatched = 0;
+	int linesRead = 0;
+	while(dispatched < issue_width && rob.getFreeSpace() > 0) {
+		if(m_robPendingInsns > 0) {
+			long long n = rob.pushCompute(min(m_robPendingInsns, (long long)(issue_width - dispatched)));
+			m_robPendingInsns -= n;
+			dispatched += n;
+			continue;
+		}
+
+		if(linesRead == issue_width || idleStalls > 0 || fpsStalls > 0 || audFpsStalls > 0 || !isPStateActive())
+			break;
+
+		long occupancy = rob.getOccupancy();
+		readLine();
+		linesRead++;
+		dispatched += rob.getOccupancy() - occupancy;
+	}
+}
+
+void GemDroidCore::dispatchMMURequest(bool isRead, uint64_t addr)
+{
+	int type = isRead ? INSTR_MMU_LD : INSTR_MMU_ST;
+	int slot = rob.lookup(addr);
+
+	if(slot == -1) {
+		m_memReqs++;
+		rob.pushMem(type, addr, false, -1);
+		return;
+	}
+
+	GemDroidROB::Entry &older = rob.at(slot);
+	if(isRead) {
+		// Data comes from the older store (forward) or the older load's response (coalesce)
+		if(older.type == INSTR_MMU_ST)
+			m_loadsForwarded++;
+		else
+			m_memReqsCoalesced++;
+		rob.pushMem(type, addr, true, -1);
+	}
+	else if(older.type == INSTR_MMU_ST) {
+		m_memReqsCoalesced++;
+		rob.pushMem(type, addr, true, -1);
+	}
+	else {
+		// WAR on an older load: the store goes out once the load is back
+		m_memReqs++;
+		rob.pushMem(type, addr, false, slot);
+	}
+}
+
 void GemDroidCore::checkDeadlock()
 {
+	if(core_model == CORE_MODEL_OOO) {
+		if(!rob.empty() && rob.front().state == ROB_ENTRY_ISSUED && ticks - rob.front().issuedTick > DEADLOCK_PERIOD) {
+			cout<<"FATAL: number:"<<deadlocks_faced<<" for address "<<rob.front().addr <<" is at the head of ROB for > DEADLOCK_PERIOD"<<endl;
+			rob.forceCompleteHead();
+			deadlocks_faced++;
+		}
+		return;
+	}
+
 	if(outstanding_transactions_size > 0 && outstanding_transactions[0].getTransactionType() != INSTR_CPU && outstanding_transactions[0].isIssuedToMem() && !outstanding_transactions[0].isTransactionReadyToCommit()) {
 		if(ticks - outstanding_transactions[0].getInsertedTick() > DEADLOCK_PERIOD) {
 			cout<<"FATAL: number:"<<deadlocks_faced<<" for address "<<outstanding_transactions[0].getAddr() <<" is at the head of ROB for > DEADLOCK_PERIOD"<<endl;
@@ -842,7 +987,12 @@ void GemDroidCore::tick()
 		flagProfile = false;
     }
 
-	if(IN_ORDER)
+	if(core_model == CORE_MODEL_OOO) {
+		ooOProcess();
+		return;
+	}
+
+	if(core_model == CORE_MODEL_IN_ORDER)
 		inOrderProcess();
     else
 		process();
@@ -866,6 +1016,9 @@ int GemDroidCore::searchInROB(uint64_t addr)
 
 int GemDroidCore::markTransactionCompleted(uint64_t addr)
 {
+	if(core_model == CORE_MODEL_OOO)
+		return rob.complete(addr);
+
 	// assert(outstanding_transactions.size() <= MAX_TRANSACTIONS);
 
 	for(int i=0; i<outstanding_transactions_size && i < MAX_TRANSACTIONS; i++) {
@@ -893,18 +1046,23 @@ void GemDroidCore::commitHeadTransaction()
 	}
 }
 
-void GemDroidCore::updateStatInstructionCommit()
+void GemDroidCore::updateStatInstructionCommit(long insns)
 {
-	m_committedInsns++;
-	gemDroid->m_totalCommittedInsns++;
+	m_committedInsns += insns;
+	gemDroid->m_totalCommittedInsns += insns;
 
-	m_thisMilliSecInstructionsCommitted++;
-	m_thisDVFSEpochInstructionsCommitted++;
-	m_thisMicroSecInstructionsCommitted++;
+	m_thisMilliSecInstructionsCommitted += insns;
+	m_thisDVFSEpochInstructionsCommitted += insns;
+	m_thisMicroSecInstructionsCommitted += insns;
 }
 
 void GemDroidCore::addInstructions(long insns)
 {
+	if(core_model == CORE_MODEL_OOO) {
+		m_robPendingInsns += insns;
+		return;
+	}
+
 	GemDroidOoOTransaction new_entry(INSTR_CPU, insns, -1);
 	outstanding_transactions.push_back(new_entry);
 	outstanding_transactions_size++;
@@ -1040,7 +1198,6 @@ void GemDroidCore::setIdleRatio()
 
 void GemDroidCore::processMMURequest(string op, uint64_t addr)
 {
-	int index = searchInROB(addr);
 	int is_read = false;
 
 	if(op == "MMU_ld")
@@ -1050,6 +1207,13 @@ void GemDroidCore::processMMURequest(string op, uint64_t addr)
 	else
 		cout<<"\n FATAL! Incorrect MMU Request sent\n";
 
+	if(core_model == CORE_MODEL_OOO) {
+		dispatchMMURequest(is_read, addr);
+		return;
+	}
+
+	int index = searchInROB(addr);
+
 	// cout << "CPU tried: " << ticks << " enqueued " << addr << endl;
 
 	if( index == -1 || index == -2) {
@@ -1217,9 +1381,8 @@ void GemDroidCore::processIPCall(string op, uint64_t addr, int size)
 	frameNum = m_frameNumber[ip_master]++;
 
    	// if(!gemDroid->enqueueCoreIPReq(core_id, ip_master, addr, size, isRead, frameNum)) {
-    int flows[MAX_FLOWS_IN_APP];
-	gemDroid->flow_identification(core_id, ip_master, flows);
-	if(!gemDroid->gemdroid_sa.enqueueCoreIPRequest(core_id, ip_master, addr, size, isRead, frameNum, flowType, flows[0])) {
+	// Calls from the core do not come in over a flow edge
+	if(!gemDroid->gemdroid_sa.enqueueCoreIPRequest(core_id, ip_master, addr, size, isRead, frameNum, flowType, -1)) {
    		cout << "FATAL: Core unable to inject " << ip_master << "ip request" << endl;
 	}
 }
@@ -66,10 +66,14 @@
 #define CORE_CAPACITANCE (1.0) //   1.0 => for 3 watts
 #define CORE_STATIC_PWR (0.35)
 
-#define IN_ORDER true
-
 using namespace std;
 
+enum CORE_MODEL {
+	CORE_MODEL_IN_ORDER,		// head-blocking, one transaction at a time
+	CORE_MODEL_OOO_LEGACY,		// linear ROB scan, only the entry behind the head goes OoO
+	CORE_MODEL_OOO				// circular ROB with issue/commit width and bounded MLP
+};
+
 enum CPU_PSTATE {
 	CPU_PSTATE_ACTIVE,
 	CPU_PSTATE_LOWPOWER,
@@ -91,6 +95,10 @@ private:
 	int core_id;
 	int app_id;
 	int issue_width;
+	int commit_width;
+	int core_model;
+	int rob_size;
+	int mlp_limit;
 	long ticks;
 	int idleCycles;
 	int cyclesToWake;
@@ -133,6 +141,9 @@ private:
 	int number_of_instr_executed_OoO;
 	int deadlocks_faced;
 
+	GemDroidROB rob;
+	long long m_robPendingInsns;	// compute insns read from the trace, not yet dispatched
+
     double voltage_freq_table[CORE_DVFS_STATES][4]; // voltage, freq, static, dynamic
 
     // double coreFreq;
@@ -159,10 +170,12 @@ private:
 	*/
     void addInstructions(long insns);
 	void commitHeadTransaction();
-	void updateStatInstructionCommit();
+	void updateStatInstructionCommit(long insns=1);
 	void checkDeadlock();
 	void process();
 	void inOrderProcess();
+	void ooOProcess();
+	void dispatchMMURequest(bool isRead, uint64_t addr);
 	bool isFrameDrop();
 	bool isAudioFrameDrop();
 
@@ -178,7 +191,8 @@ private:
 
 public:
 	GemDroidCore();
-	void init(int id, std::string trace_file, int app_id, int core_freq, int opt_freq, int issue_width, GemDroid *gemDroid);
+	void init(int id, std::string trace_file, int app_id, int core_freq, int opt_freq, int issue_width,
+			  int commit_width, int core_model, int rob_size, int mlp_limit, GemDroid *gemDroid);
 	void tick();
 	void regStats();
 	void resetStats();
@@ -234,6 +248,12 @@ public:
 	Stats::Scalar m_thisFrameMemFullStalls;
 	Stats::Scalar m_thisFrameIPFullStalls;
 
+	Stats::Scalar m_loadsForwarded;
+	Stats::Scalar m_memReqsCoalesced;
+	Stats::Scalar m_memOrderStalls;
+	Stats::Scalar m_mlpLimitStalls;
+	Stats::Distribution m_outstandingMemReqs;
+
     Stats::Scalar m_idleStallsCount;
 	Stats::Scalar m_fpsStallsCount;
 	Stats::Scalar m_framesDisplayed;
@@ -31,7 +31,11 @@
 #ifndef GEMDROID_CORE_UTIL_HH_
 #define GEMDROID_CORE_UTIL_HH_
 
+#include <deque>
 #include <iomanip>
+#include <vector>
+
+#include "base/hashmap.hh"
 
 using namespace std;
 
@@ -98,4 +102,252 @@ public:
 	}
 };
 
+enum ROB_ENTRY_STATE
+{
+	ROB_ENTRY_WAITING,	// memory op dispatched, not yet accepted by the SA
+	ROB_ENTRY_ISSUED,	// memory op in flight
+	ROB_ENTRY_DONE		// ready to commit
+};
+
+/*
+ * Circular reorder buffer used by the CORE_MODEL_OOO trace core.
+ *
+ * Capacity is counted in instructions (rob_size), the same unit the legacy
+ * model uses for number_of_instr_executed_OoO. Consecutive compute
+ * instructions of a CPU trace line share one entry, so the number of entries
+ * never exceeds the instruction capacity.
+ *
+ * Memory ops that have not completed are indexed by address in addrToSlot so
+ * that memory responses are matched in O(1) instead of scanning the ROB. At
+ * most one memory op per address is ever in flight: a younger load to an
+ * address with a pending store is forwarded, a younger access of the same type
+ * is coalesced, and a store behind a pending load waits for the load (its
+ * dependsOn) before it is issued.
+ */
+class GemDroidROB
+{
+public:
+	struct Entry
+	{
+		int type;
+		long long insns;
+		uint64_t addr;
+		int state;
+		long issuedTick;
+		long long seqNum;
+		int dependsOn;			// slot of the older load a store waits for
+		long long dependsOnSeq;	// seqNum of that load, guards slot reuse
+	};
+
+private:
+	std::vector<Entry> entries;
+	int head;
+	int tail;
+	int numEntries;
+	long occupancy;		// instructions held in the ROB
+	int inFlight;		// memory ops issued and not completed
+	long long nextSeqNum;
+
+	m5::hash_map<uint64_t, int> addrToSlot;
+	std::deque<int> issueQueue;	// memory ops waiting to be issued, program order
+	m5::hash_map<uint64_t, int> lateResponses;	// per address, responses still owed to force-completed ops
+
+	inline int nextSlot(int slot) { return (slot + 1 == (int) entries.size()) ? 0 : slot + 1; }
+
+public:
+	GemDroidROB() : head(0), tail(0), numEntries(0), occupancy(0), inFlight(0), nextSeqNum(0) { }
+
+	void init(int capacity)
+	{
+		assert(capacity > 0);
+		entries.resize(capacity);
+		head = tail = numEntries = 0;
+		occupancy = 0;
+		inFlight = 0;
+		addrToSlot.clear();
+		addrToSlot.reserve(capacity);
+		issueQueue.clear();
+		lateResponses.clear();
+	}
+
+	inline int capacity() { return entries.size(); }
+	inline bool empty() { return numEntries == 0; }
+	inline long getOccupancy() { return occupancy; }
+	inline long getFreeSpace() { return entries.size() - occupancy; }
+	inline int getInFlight() { return inFlight; }
+	inline Entry &front() { assert(!empty()); return entries[head]; }
+	inline Entry &at(int slot) { return entries[slot]; }
+
+	/*
+	 * Add compute instructions at the tail, merging into the tail entry when
+	 * it is a compute entry as well. Returns the number actually added.
+	 */
+	long long pushCompute(long long insns)
+	{
+		insns = std::min(insns, (long long) getFreeSpace());
+		if (insns <= 0)
+			return 0;
+
+		int last = (tail == 0 ? entries.size() : tail) - 1;
+		if (!empty() && entries[last].type == INSTR_CPU) {
+			entries[last].insns += insns;
+		}
+		else {
+			Entry &e = entries[tail];
+			e.type = INSTR_CPU;
+			e.insns = insns;
+			e.addr = -1;
+			e.state = ROB_ENTRY_DONE;
+			e.issuedTick = -1;
+			e.seqNum = nextSeqNum++;
+			e.dependsOn = -1;
+			e.dependsOnSeq = -1;
+			tail = nextSlot(tail);
+			numEntries++;
+		}
+		occupancy += insns;
+		return insns;
+	}
+
+	/*
+	 * Add a memory op at the tail. A forwarded load is inserted already done.
+	 * Returns the slot.
+	 */
+	int pushMem(int type, uint64_t addr, bool forwarded, int dependsOn)
+	{
+		assert(getFreeSpace() > 0);
+		assert(type == INSTR_MMU_LD || type == INSTR_MMU_ST);
+
+		int slot = tail;
+		Entry &e = entries[slot];
+		e.type = type;
+		e.insns = 1;
+		e.addr = addr;
+		e.state = forwarded ? ROB_ENTRY_DONE : ROB_ENTRY_WAITING;
+		e.issuedTick = -1;
+		e.seqNum = nextSeqNum++;
+		e.dependsOn = dependsOn;
+		e.dependsOnSeq = (dependsOn == -1) ? -1 : entries[dependsOn].seqNum;
+		tail = nextSlot(tail);
+		numEntries++;
+		occupancy++;
+
+		if (!forwarded) {
+			addrToSlot[addr] = slot;
+			issueQueue.push_back(slot);
+		}
+		return slot;
+	}
+
+	/*
+	 * Retire up to maxInsns instructions of the head entry. The head must be
+	 * done. Returns the number of instructions retired.
+	 */
+	long long commitHead(long long maxInsns)
+	{
+		Entry &e = front();
+		assert(e.state == ROB_ENTRY_DONE);
+
+		long long n = std::min(e.insns, maxInsns);
+		e.insns -= n;
+		occupancy -= n;
+		if (e.insns == 0) {
+			head = nextSlot(head);
+			numEntries--;
+		}
+		return n;
+	}
+
+	/*
+	 * Slot of the youngest incomplete memory op to addr, or -1.
+	 */
+	inline int lookup(uint64_t addr)
+	{
+		m5::hash_map<uint64_t, int>::iterator it = addrToSlot.find(addr);
+		return (it == addrToSlot.end()) ? -1 : it->second;
+	}
+
+	/*
+	 * True when the older load a store waits on has not completed yet.
+	 */
+	inline bool isBlocked(Entry &e)
+	{
+		if (e.dependsOn == -1)
+			return false;
+		Entry &p = entries[e.dependsOn];
+		return (p.seqNum == e.dependsOnSeq && p.state != ROB_ENTRY_DONE);
+	}
+
+	inline bool hasPendingIssue() { return !issueQueue.empty(); }
+	inline int nextToIssue() { return issueQueue.front(); }
+
+	void markIssued(int slot, long tick)
+	{
+		assert(issueQueue.front() == slot);
+		issueQueue.pop_front();
+		entries[slot].state = ROB_ENTRY_ISSUED;
+		entries[slot].issuedTick = tick;
+		inFlight++;
+	}
+
+	/*
+	 * Memory response for addr. Returns the completed slot, -1 when nothing
+	 * is waiting on the address and -2 when the ROB is empty. The late
+	 * response of a force-completed op is swallowed (-1) so that it cannot
+	 * complete a younger op to the same address.
+	 */
+	int complete(uint64_t addr)
+	{
+		m5::hash_map<uint64_t, int>::iterator late = lateResponses.find(addr);
+		if (late != lateResponses.end()) {
+			if (--late->second == 0)
+				lateResponses.erase(late);
+			return -1;
+		}
+
+		if (empty())
+			return -2;
+
+		m5::hash_map<uint64_t, int>::iterator it = addrToSlot.find(addr);
+		if (it == addrToSlot.end())
+			return -1;
+
+		int slot = it->second;
+		Entry &e = entries[slot];
+		if (e.state == ROB_ENTRY_ISSUED) {
+			e.state = ROB_ENTRY_DONE;
+			inFlight--;
+			addrToSlot.erase(it);
+			return slot;
+		}
+
+		// A store waiting behind a load owns the mapping; the response is the load's
+		if (e.state == ROB_ENTRY_WAITING && isBlocked(e)) {
+			Entry &p = entries[e.dependsOn];
+			assert(p.state == ROB_ENTRY_ISSUED);
+			p.state = ROB_ENTRY_DONE;
+			inFlight--;
+			return e.dependsOn;
+		}
+
+		return -1;
+	}
+
+	/*
+	 * Force the head memory op to complete (deadlock recovery). Its response
+	 * is still owed and is swallowed by complete() when it arrives.
+	 */
+	void forceCompleteHead()
+	{
+		Entry &e = front();
+		assert(e.state == ROB_ENTRY_ISSUED);
+		e.state = ROB_ENTRY_DONE;
+		inFlight--;
+		lateResponses[e.addr]++;
+		m5::hash_map<uint64_t, int>::iterator it = addrToSlot.find(e.addr);
+		if (it != addrToSlot.end() && it->second == head)
+			addrToSlot.erase(it);
+	}
+};
+
 #endif /* GEMDROID_CORE_UTIL_HH_ */
@@ -35,6 +35,8 @@
 
 #define CACHE_LINE_SIZE 64
 #define MAX_FLOWS 21
+#define MAX_FLOWS_IN_APP 5
+#define MAX_IPS_IN_FLOW IP_TYPE_END  // a flow visits each IP type at most once
 #define MAX_IPS 4   //MAX 4 IP instances of each type
 #define MAX_CPUS 4
 
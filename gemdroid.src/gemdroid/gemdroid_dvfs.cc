@@ -94,7 +94,7 @@ bool GemDroid::isAtOptimal(int typeOfIP)
     }
     else if( typeOfIP >= IP_TYPE_VD) { // Device
         GemDroidIP *inst = getIPInstance(typeOfIP);
-        if(inst->getIPFreqInd() ==  inst->getOptIPFreqInd())
+        if(inst == NULL || inst->getIPFreqInd() ==  inst->getOptIPFreqInd())
             return true;
     }
     else
@@ -105,32 +105,20 @@ bool GemDroid::isAtOptimal(int typeOfIP)
 
 double GemDroid::getIPProcessingLatency(int typeOfIP)
 {
-	if(typeOfIP == IP_TYPE_VD)
-		return VD_PROCESSING_TIME;
-	else if (typeOfIP == IP_TYPE_VE)
-		return VE_PROCESSING_TIME;
-	else if (typeOfIP == IP_TYPE_AE)
-		return AE_PROCESSING_TIME;
-	else if (typeOfIP == IP_TYPE_AD)
-		return AD_PROCESSING_TIME;
-	else if (typeOfIP == IP_TYPE_IMG)
-		return IMG_PROCESSING_TIME;
-	else if (typeOfIP == IP_TYPE_CAM)
-		return CAM_PROCESSING_TIME;
-	else if (typeOfIP == IP_TYPE_MMC_OUT || typeOfIP == IP_TYPE_MMC_IN)
-		return MMC_PROCESSING_TIME;
-	else
-		return 1;	
+	GemDroidIP *inst = getIPInstance(typeOfIP);
+	if(inst == NULL)
+		return 1;
+
+	return inst->getProcessingTime();
 }
 
 double GemDroid::getIPProcessingSize(int typeOfIP)
 {
-	if(typeOfIP == IP_TYPE_VD || typeOfIP == IP_TYPE_VE)
-		return VID_CODING_RATIO+1;
-	else if (typeOfIP == IP_TYPE_AE || typeOfIP == IP_TYPE_AD)
-		return AUD_CODING_RATIO + 1;
-	else
-		return 1;	
+	GemDroidIP *inst = getIPInstance(typeOfIP);
+	if(inst == NULL || inst->getCodingRatio() <= 1)
+		return 1;
+
+	return inst->getCodingRatio() + 1;
 }
 
 double GemDroid::memScaledTimeCPU(int core_id, double oldMemFreq, double newMemFreq)
@@ -169,6 +157,9 @@ double GemDroid::memScaledTime(int typeOfIP, int core_id, double availableBW, in
         double newTime = computeTime + memTime * (gemdroid_memory.getMemFreq()/gemdroid_memory.getFreqForBandwidth(availableBW));
         return newTime;
     }
+    else if (inst == NULL) { // Not in the IP catalog
+        return lastTimeTook[typeOfIP];
+    }
     else { //From IP_TYPE_VD to end
     	int ipProcessingLatency = getIPProcessingLatency(typeOfIP);
     	double dataAccessed = getIPProcessingSize(typeOfIP);
@@ -275,11 +266,8 @@ void GemDroid::updateDVFS()
 
 	for(int i=0; i<num_cpus; i++)
         gemdroid_core[i].updateDVFS();
-   	for(int i=IP_TYPE_DC; i<IP_TYPE_DMA; i++)
-   	    for(int j=0; j<num_ip_inst; j++) {
-            GemDroidIP *inst = getIPInstance(i, j);
-            inst->updateDVFS();
-        }
+   	for(int k=0; k<ipInstances.size(); k++)
+        ipInstances[k]->updateDVFS();
     
     if (governor == GOVERNOR_TYPE_PERFORMANCE || governor == GOVERNOR_TYPE_POWERSAVE || governor == GOVERNOR_TYPE_OPTIMAL) {
         return;
@@ -548,6 +536,8 @@ void GemDroid::dvfsLoadBased(double slack)
             if (lastEnergyTook[i] == 0)
                 continue;
             GemDroidIP *inst = getIPInstance(i, j);
+            if (inst == NULL)
+                continue;
             double load = 0;
 
             // if(!inst->isPStateIdle()) {
@@ -601,6 +591,8 @@ void GemDroid::dvfsMemScale(double slack)
     for(int i=IP_TYPE_VD; i<=IP_TYPE_GPU; i++) {
         for(int j=0; j<num_ip_inst; j++) {
             GemDroidIP *inst = getIPInstance(i, j);
+            if (inst == NULL)
+                continue;
             double load = 0;
 
             // if(!inst->isPStateIdle()) {
@@ -1075,6 +1067,8 @@ void GemDroid::dvfsCoScale(double slack)
     for(int i=IP_TYPE_VD; i<=IP_TYPE_GPU; i++) {
         for(int j=0; j<num_ip_inst; j++) {
             GemDroidIP *inst = getIPInstance(i, j);
+            if (inst == NULL)
+                continue;
             double load = 0;
 
             // if(!inst->isPStateIdle()) {
@@ -1613,7 +1607,7 @@ void GemDroid::dvfsDynamicProg1(double slack, int ip_accs[MAX_IPS_IN_FLOW], int
 
         for(int i=0; i<num_devs; i++) {
             // dev_time += lastTimeTook[ip_devs[i]];
-            dev_time += memScaledTime(ip_devs[i], 0, gemdroid_memory.getMaxBandwidth(mem), gemdroid_ip_dc[0].getIPFreqInd());
+            dev_time += memScaledTime(ip_devs[i], 0, gemdroid_memory.getMaxBandwidth(mem), getIPInstance(IP_TYPE_DC)->getIPFreqInd());
             dev_energy += lastEnergyTook[ip_devs[i]];
         }
         cout << "DVFS  Mem @ " << mem << " - Dev Time: " << dev_time << " Dev Energy: " << dev_energy << endl;
@@ -1699,7 +1693,7 @@ void GemDroid::dvfsDynamicProg2(double slack, int ip_accs[MAX_IPS_IN_FLOW], int
 
         for(int i=0; i<num_devs; i++) {
             // dev_time += lastTimeTook[ip_devs[i]];
-            dev_time += memScaledTime(ip_devs[i], 0, gemdroid_memory.getMaxBandwidth(mem), gemdroid_ip_dc[0].getIPFreqInd());
+            dev_time += memScaledTime(ip_devs[i], 0, gemdroid_memory.getMaxBandwidth(mem), getIPInstance(IP_TYPE_DC)->getIPFreqInd());
             dev_energy += lastEnergyTook[ip_devs[i]];
         }
         cout << "DVFS  Mem @ " << mem << " - Dev Time: " << dev_time << " Dev Energy: " << dev_energy << endl;
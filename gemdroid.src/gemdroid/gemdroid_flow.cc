@@ -0,0 +1,274 @@
+/**
+ * Copyright (c) 2016 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contact: Shulin Zhao (suz53@cse.psu.edu)
+*/
+
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "gemdroid/gemdroid_flow.hh"
+#include "gemdroid/gemdroid_ip.hh"
+
+string ipTypeToString(int type);
+
+GemDroidFlowGraph::GemDroidFlowGraph()
+{
+    for(int i=0; i<APP_ID_END; i++)
+        for(int j=0; j<IP_TYPE_END; j++)
+            for(int k=0; k<IP_TYPE_END; k++)
+                edgeIndex[i][j][k] = -1;
+}
+
+/*
+ * Buffer an IP hands to the next stage of the flow. These are the sizes
+ * the SA used to hard-code per IP pair; any other pair reads a frame out
+ * of the source's output buffer.
+ */
+void GemDroidFlowGraph::defaultTransfer(int src, int dst, uint64_t &addr, int &size, bool &isRead)
+{
+    isRead = true;
+
+    if (src == IP_TYPE_CAM) {
+        addr = CAM_ADDR_START;
+        size = (dst == IP_TYPE_IMG) ? 4*FRAME_SIZE/2 : 4*FRAME_SIZE;
+    } else if (src == IP_TYPE_MIC) {
+        addr = MIC_ADDR_START;
+        size = 4*AUD_FRAME_SIZE;
+    } else if (src == IP_TYPE_MMC_IN) {
+        addr = MMC_IN_ADDR_START;
+        if (dst == IP_TYPE_AD)
+            size = 4*AUD_FRAME_SIZE / AUD_CODING_RATIO;
+        else if (dst == IP_TYPE_VD)
+            size = 4*FRAME_SIZE / VID_CODING_RATIO;
+        else
+            size = 4*FRAME_SIZE/2;
+    } else if (src == IP_TYPE_VE && dst == IP_TYPE_MMC_OUT) {
+        addr = VE_ADDR_START + FRAME_SIZE;
+        size = FRAME_SIZE / VID_CODING_RATIO;
+        isRead = false;
+    } else if (src == IP_TYPE_AE && dst == IP_TYPE_MMC_OUT) {
+        addr = AE_ADDR_START + AUD_FRAME_SIZE;
+        size = AUD_FRAME_SIZE / AUD_CODING_RATIO;
+        isRead = false;
+    } else if (src == IP_TYPE_IMG && dst == IP_TYPE_MMC_OUT) {
+        addr = IMG_ADDR_START + FRAME_SIZE;
+        size = FRAME_SIZE;
+        isRead = false;
+    } else if (src == IP_TYPE_AD || src == IP_TYPE_AE || src == IP_TYPE_SND) {
+        addr = (src == IP_TYPE_AD ? AD_ADDR_START : (src == IP_TYPE_AE ? AE_ADDR_START : SND_ADDR_START)) + AUD_FRAME_SIZE;
+        size = 4*AUD_FRAME_SIZE;
+    } else {
+        switch(src) {
+            case IP_TYPE_VD: addr = VD_ADDR_START; break;
+            case IP_TYPE_VE: addr = VE_ADDR_START; break;
+            case IP_TYPE_IMG: addr = IMG_ADDR_START; break;
+            case IP_TYPE_GPU: addr = DC1_ADDR_START; break;
+            case IP_TYPE_NW: addr = NW_ADDR_START; break;
+            case IP_TYPE_MMC_OUT: addr = MMC_OUT_ADDR_START; break;
+            default: addr = DC0_ADDR_START; break;
+        }
+        addr += FRAME_SIZE;
+        size = 4*FRAME_SIZE;
+    }
+}
+
+int GemDroidFlowGraph::addEdge(int app, int src, int dst, int flowId)
+{
+    int e = edgeIndex[app][src][dst];
+
+    if (e != -1)
+        return e;
+
+    GemDroidFlowEdge edge;
+    edge.src = src;
+    edge.dst = dst;
+    edge.flowId = flowId;
+    edge.flowMask = 0;
+    edge.depth = 0;
+    edge.inFlight = 0;
+    edge.outPos = outEdges[app][src].size();
+    assert(edge.outPos < 32);
+    // NW is driven from the CPU trace and the GPU from its own trace
+    edge.triggered = (src != IP_TYPE_CPU && dst != IP_TYPE_NW && dst != IP_TYPE_GPU);
+    defaultTransfer(src, dst, edge.addr, edge.size, edge.isRead);
+
+    e = edges[app].size();
+    edges[app].push_back(edge);
+    outEdges[app][src].push_back(e);
+    edgeIndex[app][src][dst] = e;
+
+    return e;
+}
+
+void GemDroidFlowGraph::setEdgeDepth(int app, int src, int dst, int depth, int size, int isRead)
+{
+    for(int i=0; i<APP_ID_END; i++) {
+        if (app != -1 && app != i)
+            continue;
+
+        int e = edgeIndex[i][src][dst];
+        if (e == -1) {
+            if (app != -1)
+                cout << "WARNING: flow edge " << ipTypeToString(src) << "->" << ipTypeToString(dst) << " is not used by app " << app << endl;
+            continue;
+        }
+
+        edges[i][e].depth = depth;
+        if (size > 0)
+            edges[i][e].size = size;
+        if (isRead != -1)
+            edges[i][e].isRead = isRead;
+    }
+}
+
+/*
+ * Flow file lines, up to the first blank line:
+ *   <app_id> <ip> <ip> ... -1          one flow of the app, in stage order
+ *   edge <app_id> <src> <dst> <depth> [<size> <r|w>]
+ * The edge lines set how many frames the source may have in flight into
+ * the destination (0 = unbounded) and optionally the buffer handed over;
+ * app_id -1 applies to every app using that edge. Edge lines come after
+ * the flows they refer to.
+ */
+void GemDroidFlowGraph::load(string fileName)
+{
+    ifstream flowsFile;
+    string line;
+    int lineNum = 0;
+
+    flowsFile.open(fileName);
+
+    if (!flowsFile.good()) {
+        cout << "Cannot open flows file " << fileName << endl;
+        assert(0);
+    }
+
+    while(getline(flowsFile, line)) {
+        istringstream iss(line);
+        string first;
+        lineNum++;
+
+        if (line == "")
+            break;
+
+        iss >> first;
+
+        if (first == "edge") {
+            int app, src, dst, depth, size = 0, isRead = -1;
+            string rw;
+
+            iss >> app >> src >> dst >> depth;
+            if (iss.fail() || app < -1 || app >= APP_ID_END || src < 0 || src >= IP_TYPE_END || dst < 0 || dst >= IP_TYPE_END || depth < 0) {
+                cout << "FATAL: " << fileName << ":" << lineNum << ": malformed edge entry" << endl;
+                assert(0);
+            }
+            if (iss >> size >> rw)
+                isRead = (rw == "r");
+            setEdgeDepth(app, src, dst, depth, size, isRead);
+            continue;
+        }
+
+        int app_id = atoi(first.c_str());
+        if (app_id < 0 || app_id >= APP_ID_END) {
+            cout << "WARNING: " << fileName << ":" << lineNum << ": no app with id " << app_id << ", flow ignored" << endl;
+            continue;
+        }
+
+        vector<int> flow;
+        int ip_id;
+        while (iss >> ip_id && ip_id != -1) {
+            assert(ip_id >= 0 && ip_id < IP_TYPE_END);
+            flow.push_back(ip_id);
+        }
+        if (flow.empty())
+            continue;
+        assert(flow.size() <= MAX_IPS_IN_FLOW);
+
+        int flowId = flows[app_id].size();
+        flows[app_id].push_back(flow);
+
+        // A flow is selected by its first real stage or by its last stage
+        int firstStage = (flow[0] == IP_TYPE_CPU && flow.size() > 1) ? flow[1] : flow[0];
+        uint32_t mask = (1u << firstStage) | (1u << flow.back());
+
+        for(int i=0; i<flow.size(); i++) {
+            vector<int> &ipFlows = flowsOfIP[app_id][flow[i]];
+            if (ipFlows.empty() || ipFlows.back() != flowId)
+                ipFlows.push_back(flowId);
+
+            if (i+1 < flow.size()) {
+                int e = addEdge(app_id, flow[i], flow[i+1], flowId);
+                edges[app_id][e].flowMask |= mask;
+            }
+        }
+    }
+
+    flowsFile.close();
+}
+
+/*
+ * Stages fed by curr_ip for frames of the given flow type, in flow order.
+ * Returns the number of stages written to ips (the rest are -1).
+ */
+int GemDroidFlowGraph::nextStages(int app, int curr_ip, int flowType, int *ips, int maxIPs)
+{
+    const vector<int> &out = outEdges[app][curr_ip];
+    int count = 0;
+
+    for(int i=0; i<maxIPs; i++)
+        ips[i] = -1;
+
+    for(int i=0; i<out.size() && count < maxIPs; i++) {
+        if (edgeCarries(edges[app][out[i]], flowType))
+            ips[count++] = edges[app][out[i]].dst;
+    }
+
+    return count;
+}
+
+void GemDroidFlowGraph::print()
+{
+    cout << "Flow information" << endl;
+    for(int i=0; i<APP_ID_END; i++) {
+        cout << i << endl;
+        for(int j=0; j<flows[i].size(); j++) {
+            cout << j << ": ";
+            for(int k=0; k<flows[i][j].size(); k++)
+                cout << flows[i][j][k] << " ";
+            cout << endl;
+        }
+        for(int j=0; j<edges[i].size(); j++) {
+            GemDroidFlowEdge &edge = edges[i][j];
+            if (edge.depth > 0)
+                cout << "  " << ipTypeToString(edge.src) << "->" << ipTypeToString(edge.dst) << " depth " << edge.depth << endl;
+        }
+    }
+    cout << endl;
+}
@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2016 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contact: Shulin Zhao (suz53@cse.psu.edu)
+*/
+
+#ifndef GEMDROID_FLOW_HH_
+#define GEMDROID_FLOW_HH_
+
+#include <stdint.h>
+#include <deque>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "base/hashmap.hh"
+#include "gemdroid/gemdroid_defines.hh"
+
+using namespace std;
+
+// A frame that finished at an edge's source but has no credit on the edge yet
+struct GemDroidFlowFrame
+{
+    int coreId;
+    int senderId;
+    int frameNum;
+    int flowType;
+
+    GemDroidFlowFrame(int coreId, int senderId, int frameNum, int flowType) { this->coreId = coreId; this->senderId = senderId; this->frameNum = frameNum; this->flowType = flowType; }
+};
+
+/*
+ * One stage-to-stage hop of an application's flow graph. flowMask has a bit
+ * for the first stage and the last stage of every flow using this edge; a
+ * frame travels over the edge when its flow type is in the mask.
+ */
+struct GemDroidFlowEdge
+{
+    int src;
+    int dst;
+    int flowId;         // first flow of the app that uses this edge
+    uint32_t flowMask;
+    int depth;          // frames in flight into dst, 0 means unbounded
+    uint64_t addr;      // buffer handed to dst
+    int size;
+    bool isRead;
+    bool triggered;     // false when dst is driven by its own trace (NW, GPU)
+    int outPos;         // position among the out edges of src
+
+    int inFlight;
+    deque<GemDroidFlowFrame> parked;
+};
+
+// A consumer read of a streamed line the producer has not written yet
+struct GemDroidFlowWaiter
+{
+    int ipType;
+    int ipId;
+    int coreId;
+    uint64_t addr;
+    int outPos;
+
+    GemDroidFlowWaiter(int ipType, int ipId, int coreId, uint64_t addr, int outPos) { this->ipType = ipType; this->ipId = ipId; this->coreId = coreId; this->addr = addr; this->outPos = outPos; }
+};
+
+/*
+ * Output of one producer IP while it streams to its consumers through the
+ * SA scratchpad. Each on-chip line keeps a mask of the out edges (by
+ * outPos) that still have to read it.
+ */
+struct GemDroidFlowStream
+{
+    bool open;              // producer is still writing the current frame
+    int app;
+    int frameNum;
+    int flowType;
+    int linesWritten;
+    uint64_t producedEnd;   // lines below this address have been written
+    uint32_t forwarded;     // out edges whose consumer already started on this frame
+    m5::hash_map<uint64_t, uint32_t> lines;
+    list<GemDroidFlowWaiter> waiting;
+
+    GemDroidFlowStream() : open(false), app(-1), frameNum(0), flowType(-1), linesWritten(0), producedEnd(0), forwarded(0) { }
+};
+
+/*
+ * Flow graphs of all apps. Every flows.txt chain adds its consecutive IP
+ * pairs as edges, so chains sharing a stage fan out and fan in instead of
+ * being walked one chain at a time. Stage and edge lookups are table
+ * indexed by app and IP type.
+ */
+class GemDroidFlowGraph
+{
+private:
+    vector<GemDroidFlowEdge> edges[APP_ID_END];
+    vector<int> outEdges[APP_ID_END][IP_TYPE_END];
+    vector<int> flowsOfIP[APP_ID_END][IP_TYPE_END];
+    vector< vector<int> > flows[APP_ID_END];
+    int edgeIndex[APP_ID_END][IP_TYPE_END][IP_TYPE_END];
+
+    int addEdge(int app, int src, int dst, int flowId);
+    void setEdgeDepth(int app, int src, int dst, int depth, int size, int isRead);
+    static void defaultTransfer(int src, int dst, uint64_t &addr, int &size, bool &isRead);
+
+public:
+    GemDroidFlowGraph();
+    void load(string fileName);
+    void print();
+
+    inline int numFlows(int app) { return flows[app].size(); }
+    inline const vector<int> &getFlow(int app, int flowId) { return flows[app][flowId]; }
+    inline const vector<int> &getFlowsOfIP(int app, int ip_type) { return flowsOfIP[app][ip_type]; }
+    inline const vector<int> &getOutEdges(int app, int ip_type) { return outEdges[app][ip_type]; }
+    inline GemDroidFlowEdge &getEdge(int app, int edgeId) { return edges[app][edgeId]; }
+    inline int numEdges(int app) { return edges[app].size(); }
+    inline bool edgeCarries(const GemDroidFlowEdge &edge, int flowType) { return flowType >= 0 && flowType < IP_TYPE_END && (edge.flowMask & (1u << flowType)); }
+    inline bool hasCredit(const GemDroidFlowEdge &edge) { return edge.depth == 0 || edge.inFlight < edge.depth; }
+
+    int nextStages(int app, int curr_ip, int flowType, int *ips, int maxIPs);
+};
+
+#endif /* GEMDROID_FLOW_HH_ */
@@ -39,15 +39,21 @@ GemDroidIP::GemDroidIP()
 
 }
 
-void GemDroidIP::init(int ip_type, int id, bool isDevice, int ioLatency, int ip_freq, int opt_freq, GemDroid *gemDroid)
+void GemDroidIP::init(const GemDroidIPConfig &cfg, int ip_freq, int opt_freq, GemDroid *gemDroid)
 {
 	this->gemDroid = gemDroid;
-	this->ip_type = ip_type;
-	this->isDevice = isDevice;
+	this->ip_type = cfg.ip_type;
+	this->isDevice = (cfg.kind == IP_KIND_DEVICE);
 	//For DC, it will be 1*100 + 0 or 1*100 +1
 	//this->ip_id = (ip_type*IP_ID_START) + id;
-	this->ip_id = id;
-	this->ioLatency = ioLatency;
+	this->ip_id = cfg.id;
+	// Devices spend processingTime per cache line on I/O; accelerators model it as compute latency
+	this->ioLatency = isDevice ? cfg.processingTime : 0;
+	this->processingTime = cfg.processingTime;
+	this->codingRatio = cfg.codingRatio;
+	this->maxScale = cfg.maxScale;
+	this->m_flowType = -1;
+	this->m_flowId = -1;
 
 	ostringstream oss;
 	oss<<ip_id;
@@ -88,88 +94,17 @@ void GemDroidIP::init(int ip_type, int id, bool isDevice, int ioLatency, int ip_
 	stats_m_memRejected = 0;
 	stats_m_IPMemStalls = 0;
 
-	if(ip_type == IP_TYPE_DC) {
-		ip_static_power = DC_STATIC_PWR; 	//0.40 WATT Samsung S4 (average brightness); 1.3 for full brightness;
-		capacitance = DC_DYNAMIC_PWR_PER_CL;
-        optimal_freq = 0.400;
-	}
-	else if(ip_type == IP_TYPE_SND) {
-		ip_static_power = SND_STATIC_PWR;
-		capacitance = SND_DYNAMIC_PWR_PER_CL;
-        optimal_freq = 0.400;
-	}
-	else if(ip_type == IP_TYPE_MIC) {
-		ip_static_power = MIC_STATIC_PWR;
-		capacitance = MIC_DYNAMIC_PWR_PER_CL;
-        optimal_freq = 0.400;
-	}
-	else if(ip_type == IP_TYPE_NW) {
-		ip_static_power = NW_STATIC_PWR;
-		capacitance = NW_DYNAMIC_PWR_PER_CL;
-        optimal_freq = 0.400;
-	}
-	else if(ip_type == IP_TYPE_CAM) {
-		ip_static_power = CAM_STATIC_PWR;
-		capacitance = CAM_DYNAMIC_PWR_PER_CL;
-        optimal_freq = 0.400;
-	}
-	else if(ip_type == IP_TYPE_MMC_IN) {
-		ip_static_power = MMC_STATIC_PWR;
-		capacitance = MMC_DYNAMIC_PWR_PER_CL;
-        optimal_freq = 0.400;
-	}
-	else if(ip_type == IP_TYPE_MMC_OUT) {
-		ip_static_power = MMC_STATIC_PWR;
-		capacitance = MMC_DYNAMIC_PWR_PER_CL;
-        optimal_freq = 0.400;
-	}
-	else if(ip_type == IP_TYPE_VD) {
-		ip_static_power = VD_STATIC_PWR;
-		capacitance = VD_DYNAMIC_PWR_PER_CL;
-        optimal_freq = 0.300;
-	}
-	else if(ip_type == IP_TYPE_VE) {
-		ip_static_power = VE_STATIC_PWR;
-		capacitance = VE_DYNAMIC_PWR_PER_CL;
-        optimal_freq = 0.300;
-	}
-	else if(ip_type == IP_TYPE_AD) {
-		ip_static_power = AD_STATIC_PWR;
-		capacitance = AD_DYNAMIC_PWR_PER_CL;
-        optimal_freq = 0.400;
-	}
-	else if(ip_type == IP_TYPE_AE) {
-		ip_static_power = AE_STATIC_PWR; 	
-		capacitance = AE_DYNAMIC_PWR_PER_CL;
-        optimal_freq = 0.400;
-	}
-	else if(ip_type == IP_TYPE_IMG) {
-		ip_static_power = IMG_STATIC_PWR; 	
-		capacitance = IMG_DYNAMIC_PWR_PER_CL;
-        optimal_freq = 0.300;
-	}
-	else if(ip_type == IP_TYPE_GPU) {
-		ip_static_power = GPU_STATIC_PWR;
-		capacitance = GPU_DYNAMIC_PWR_PER_CL;
-        optimal_freq = 0.200;
-	}
-	else {
-		assert (1);
-	}
-
     // voltage & freq
-    // voltage_freq_table[0][0] 	= 0.798 ; voltage_freq_table[0][1] 	= 0.100; 
-    voltage_freq_table[0][0] 	= 0.835	; voltage_freq_table[0][1] 	= 0.200; 
-    voltage_freq_table[1][0] 	= 0.872	; voltage_freq_table[1][1] 	= 0.300; 
-    voltage_freq_table[2][0] 	= 0.909	; voltage_freq_table[2][1] 	= 0.400; 
-    voltage_freq_table[3][0] 	= 0.946	; voltage_freq_table[3][1] 	= 0.500; 
-    voltage_freq_table[4][0] 	= 0.983	; voltage_freq_table[4][1] 	= 0.600; 
-    voltage_freq_table[5][0] 	= 1.02	; voltage_freq_table[5][1] 	= 0.700; 
-    voltage_freq_table[6][0] 	= 1.057	; voltage_freq_table[6][1] 	= 0.800; 
-    /* voltage_freq_table[7][0] 	= 1.094	; voltage_freq_table[7][1] 	= 0.900; 
-    voltage_freq_table[8][0] 	= 1.131	; voltage_freq_table[8][1] 	= 1.000; 
-    voltage_freq_table[9][0] 	= 1.168	; voltage_freq_table[9][1]	= 1.100; 
-    voltage_freq_table[10][0] 	= 1.205	; voltage_freq_table[10][1]	= 1.200;  */
+    for(int i=0; i<IP_DVFS_STATES; i++) {
+        voltage_freq_table[i][0] = cfg.voltage_freq_table[i][0];
+        voltage_freq_table[i][1] = cfg.voltage_freq_table[i][1];
+    }
+
+    // Catalog gives dynamic power at the highest V/F point; scale it to CV^2F
+    double vMax = voltage_freq_table[IP_DVFS_STATES-1][0];
+    double fMax = voltage_freq_table[IP_DVFS_STATES-1][1];
+	ip_static_power = cfg.staticPower;
+	capacitance = cfg.dynamicPower / (vMax * vMax * fMax);
 
     // calculate max dynamic values
     for(int i=0; i<IP_DVFS_STATES; i++) {
@@ -188,7 +123,7 @@ void GemDroidIP::init(int ip_type, int id, bool isDevice, int ioLatency, int ip_
 	m_IPLowInLast1us		= 0;
 	m_IPActivityIn1us   	= 0;
 
-	cout<<"Instantiated GemDroidIP type: "<<ipTypeToString(ip_type)<<" Id: "<<id<<endl;
+	cout<<"Instantiated GemDroidIP type: "<<ipTypeToString(ip_type)<<" Id: "<<ip_id<<endl;
 
     cout << ipTypeToString(ip_type) << ": Volt-Freq Table: " << endl;
     printDVFSTable();
@@ -570,32 +505,7 @@ double GemDroidIP::getStaticPower(double activePortion, double lowPortion, doubl
 
 int GemDroidIP::getMaxProcessible()
 {
-	if(ip_type == IP_TYPE_VD)
-	 	return VD_MAX;
-	else if(ip_type == IP_TYPE_VE)
-	 	return VE_MAX;
-	else if(ip_type == IP_TYPE_AD)
-	 	return AD_MAX;
-	else if(ip_type == IP_TYPE_AE)
-	 	return AE_MAX;
-	else if(ip_type == IP_TYPE_IMG)
-	 	return IMG_MAX;
-	else if(ip_type == IP_TYPE_CAM)
-	 	return CAM_MAX;
- 	else if(ip_type == IP_TYPE_SND)
-	 	return SND_MAX;
-  	else if(ip_type == IP_TYPE_DC)
-	 	return DC_MAX;
-  	else if(ip_type == IP_TYPE_NW)
-	 	return NW_MAX;
-  	else if(ip_type == IP_TYPE_MIC)
-	 	return MIC_MAX;
-  	else if(ip_type == IP_TYPE_MMC_IN || ip_type == IP_TYPE_MMC_OUT)
-	 	return MMC_MAX;
-  	else if(ip_type == IP_TYPE_GPU)
-	 	return GPU_MAX;
-
-    return 1;
+	return IPCLOCKS_IN_1MS * maxScale / processingTime;
 }
 
 double GemDroidIP::powerIn1us()
@@ -744,27 +654,9 @@ double GemDroidIP::getLoadInLastDVFSEpoch()
 
 	double ip_util=0;// = (double) m_reqCount / getMaxProcessible();
 
-	/* if (ip_type == IP_TYPE_VD)
-        ip_util = (double) m_reqCount / VD_MAX;
-    else if (ip_type == IP_TYPE_VE)
-        ip_util = (double) m_reqCount / VE_MAX;
-    else if (ip_type == IP_TYPE_AD)
-        ip_util = (double) m_reqCount / AD_MAX;
-    else if (ip_type == IP_TYPE_AE)
-        ip_util = (double) m_reqCount / AE_MAX;
-    else if (ip_type == IP_TYPE_IMG)
-        ip_util = (double) m_reqCount / IMG_MAX; */
-
-    if (ip_type == IP_TYPE_VD)
-        ip_util = (double) m_IPActivityInDVFSEpoch / (VD_MAX*gemDroid->lastTimeTook[ip_type]);
-    else if (ip_type == IP_TYPE_VE)
-        ip_util = (double) m_IPActivityInDVFSEpoch / (VE_MAX*gemDroid->lastTimeTook[ip_type]);
-    else if (ip_type == IP_TYPE_AD)
-        ip_util = (double) m_IPActivityInDVFSEpoch / (AD_MAX*gemDroid->lastTimeTook[ip_type]);
-    else if (ip_type == IP_TYPE_AE)
-        ip_util = (double) m_IPActivityInDVFSEpoch / (AE_MAX*gemDroid->lastTimeTook[ip_type]);
-    else if (ip_type == IP_TYPE_IMG)
-        ip_util = (double) m_IPActivityInDVFSEpoch / (IMG_MAX*gemDroid->lastTimeTook[ip_type]);
+    // Only accelerators report load
+    if (ip_type >= IP_TYPE_VD && ip_type <= IP_TYPE_IMG)
+        ip_util = (double) m_IPActivityInDVFSEpoch / ((IPCLOCKS_IN_1MS * maxScale / processingTime)*gemDroid->lastTimeTook[ip_type]);
 	
     m_IPActivityInDVFSEpoch = 0;
 
@@ -36,7 +36,6 @@
 #include "gemdroid/gemdroid_defines.hh"
 
 #define FRACTION_OF_IFRAMES 10
-#define PROCESSING_CHUNK 16
 
 // enter time 450 microsecs
 #define IPACC_PSTATE_ENTER_TIME (48900*2)
@@ -67,64 +66,9 @@
 #define DC1_ADDR_START 2400000000
 #define GPU_ADDR_START 2420000000
 
-#define DC_PROCESSING_TIME 1   //per cache line @ 400Mhz
-#define NW_PROCESSING_TIME 1   //per cache line @ 400Mhz
-#define SND_PROCESSING_TIME 1  //per cache line @ 400Mhz
-#define MIC_PROCESSING_TIME 1  //per cache line   (2 bytes in 5500th of a second. 64 bytes in 32/5500sec) @ 400Mhz
-#define CAM_PROCESSING_TIME 1  //per cache line 	@ 400Mhz
-#define MMC_PROCESSING_TIME 10  //per cache line  @ 400Mhz
-
-#define VD_PROCESSING_TIME (12)  //per cache line 	@ 800Mhz
-#define VE_PROCESSING_TIME (18)  //per coding_ratio cache lines	@ 800Mhz
-#define IMG_PROCESSING_TIME (16)  //per cache line	@ 800Mhz
-#define AD_PROCESSING_TIME (12)  //per cache line	@ 800Mhz
-#define AE_PROCESSING_TIME (8)  //per coding_ratio cache lines	@ 800Mhz
-
 #define IPCLOCKS_IN_1MS (getIPFreq()*1000000)   //number of IP Clocks in 1msec when running a@ 800Mhz
 #define IPCLOCKS_IN_10MS (10*IPCLOCKS_IN_1MS)
 
-#define VD_MAX  (IPCLOCKS_IN_1MS / VD_PROCESSING_TIME 	)
-#define VE_MAX  (IPCLOCKS_IN_1MS*VID_CODING_RATIO / VE_PROCESSING_TIME 	)	 //49800.0
-//As AD,AE finish before a milli-second.. we need to compare wrt 44KHz of data per sec. Else, utilization is ~0.001to 0.009. For 1 mSec = 44 data chunks to be processed.
-#define AD_MAX  (IPCLOCKS_IN_1MS / (44*AD_PROCESSING_TIME) 	)	 //(1600.0 / AUD_CODING_RATIO)
-#define AE_MAX  (IPCLOCKS_IN_1MS*AUD_CODING_RATIO / (44*AE_PROCESSING_TIME) 	)	 //1600.0
-#define IMG_MAX (IPCLOCKS_IN_1MS / IMG_PROCESSING_TIME 	)	 //13000.0
-#define DC_MAX  (IPCLOCKS_IN_1MS / (DC_PROCESSING_TIME*5))	 //134589.0
-#define CAM_MAX (IPCLOCKS_IN_1MS / CAM_PROCESSING_TIME 	)	 //70000.0
-#define SND_MAX (IPCLOCKS_IN_1MS / SND_PROCESSING_TIME 	)	 //1600.0
-#define NW_MAX  (IPCLOCKS_IN_1MS / NW_PROCESSING_TIME   )	 
-#define MIC_MAX (IPCLOCKS_IN_1MS / MIC_PROCESSING_TIME 	)	 
-#define MMC_MAX (IPCLOCKS_IN_1MS / MMC_PROCESSING_TIME 	)	 
-#define GPU_MAX (IPCLOCKS_IN_1MS / 4.0)
-
-#define DC_STATIC_PWR   0.1
-#define SND_STATIC_PWR  0.05
-#define MIC_STATIC_PWR  0.05
-#define NW_STATIC_PWR   0.05
-#define CAM_STATIC_PWR  0.1
-#define MMC_STATIC_PWR  0.05
-#define VD_STATIC_PWR 	0.1
-#define VE_STATIC_PWR  	0.10
-#define AD_STATIC_PWR 	0.05
-#define AE_STATIC_PWR   0.05
-#define IMG_STATIC_PWR  0.10
-#define GPU_STATIC_PWR  0.35
-
-#define V2F (1.057*1.057*0.8)  // 800Mhz maximum
-
-#define VD_DYNAMIC_PWR_PER_CL 	(1/V2F)
-#define VE_DYNAMIC_PWR_PER_CL 	(1.5/V2F)
-#define AD_DYNAMIC_PWR_PER_CL 	(0.75/V2F)
-#define AE_DYNAMIC_PWR_PER_CL 	(0.75/V2F)
-#define IMG_DYNAMIC_PWR_PER_CL	(1.5/V2F)
-#define DC_DYNAMIC_PWR_PER_CL 	(0.5/V2F)
-#define CAM_DYNAMIC_PWR_PER_CL	(1/V2F)
-#define SND_DYNAMIC_PWR_PER_CL	(0.0/V2F)
-#define NW_DYNAMIC_PWR_PER_CL 	(0.2/V2F)
-#define MIC_DYNAMIC_PWR_PER_CL	(0.0/V2F)
-#define MMC_DYNAMIC_PWR_PER_CL	(0.3/V2F)
-#define GPU_DYNAMIC_PWR_PER_CL	(4.0/V2F)
-
 using namespace std;
 
 class GemDroid;
@@ -143,6 +87,38 @@ enum FrameType
 	B_Frame
 };
 
+enum IP_KIND
+{
+	IP_KIND_DEVICE,		// GemDroidIP
+	IP_KIND_DECODER,	// GemDroidIPDecoder
+	IP_KIND_ENCODER,	// GemDroidIPEncoder
+	IP_KIND_NOCODER,	// GemDroidIPNocoder
+	IP_KIND_GPU,		// GemDroidIPGPU
+	IP_KIND_END
+};
+
+/*
+ * Characteristics of one IP instance, read from the IP catalog file
+ * (see GemDroid::loadIPCatalog).
+ */
+struct GemDroidIPConfig
+{
+	int ip_type;
+	int id;
+	int kind;
+	int freq;				// initial frequency in MHz, 0 for the dev_freq/ip_freq param
+	int processingTime;		// IP cycles per cache line (per coding_ratio lines for encoders)
+	int inBufferSize;		// in cache lines, accelerators only
+	int outBufferSize;
+	int codingRatio;
+	int chunkSize;			// output chunk in cache lines, accelerators only
+	double maxScale;		// cache lines processible in 1 ms = IP clocks in 1 ms * maxScale / processingTime
+	double staticPower;		// W when active
+	double dynamicPower;	// W at the highest V/F point when fully busy
+	bool gpuOnly;			// only instantiated when a GPU trace is given
+	double voltage_freq_table[IP_DVFS_STATES][2]; // voltage, freq in GHz
+};
+
 class GemDroidIP
 {
 protected:
@@ -193,7 +169,9 @@ protected:
 	int  m_IPActivityIn1us;
 
     double voltage_freq_table[IP_DVFS_STATES][3];
-    double optimal_freq;
+    int processingTime;
+    int codingRatio;
+    double maxScale;
 
     // double ipFreq;
     // double ipVoltage;
@@ -217,8 +195,8 @@ protected:
     void printDVFSTable();
 	int nextIPtoCall();
     int getIndexInTable(double freq);
-    double getDynamicPower(double activity);
-    double getStaticPower(double activePortio, double lowPortion, double idlePortion);
+    virtual double getDynamicPower(double activity);
+    virtual double getStaticPower(double activePortio, double lowPortion, double idlePortion);
     int getMaxProcessible();
 	long int m_IPActivityInDVFSEpoch;
 
@@ -229,16 +207,25 @@ private:
 
 public:
 	 GemDroidIP();
-	 void init(int ip_type, int id, bool isDevice, int ioLatency, int ip_freq, int opt_freq, GemDroid *gemDroid);
-	 void regStats();
-	 void resetStats();
-	 void tick();
-	 void printPeriodicStats();
-	 double powerIn1ms(); //Return power consumed in the last 1 ms.
-     double powerIn1us();
-
-	 bool enqueueIPReq(int core_id, uint64_t addr, int size, bool isRead, int frameNum, int flowType, int flowId);
-	 void memResponse(uint64_t addr, bool isRead);
+	 virtual ~GemDroidIP() { }
+	 virtual void init(const GemDroidIPConfig &cfg, int ip_freq, int opt_freq, GemDroid *gemDroid);
+	 virtual void regStats();
+	 virtual void resetStats();
+	 virtual void tick();
+	 virtual void printPeriodicStats();
+	 virtual double powerIn1ms(); //Return power consumed in the last 1 ms.
+     virtual double powerIn1us();
+
+	 virtual bool enqueueIPReq(int core_id, uint64_t addr, int size, bool isRead, int frameNum, int flowType, int flowId);
+	 virtual void memResponse(uint64_t addr, bool isRead);
+
+	 inline int getIPType() { return ip_type; }
+	 inline int getIPId() { return ip_id; }
+	 inline int getProcessingTime() { return processingTime; }
+	 inline int getCodingRatio() { return codingRatio; }
+	 inline int getFlowType() { return m_flowType; }
+	 inline int getFlowId() { return m_flowId; }
+	 inline int getFrameNum() { return m_frameNum; }
 
 	 void wakeUp();  //Wake up by another IP.
 
@@ -261,7 +248,7 @@ public:
     void setOptIPFreq();
     double getLoadInLastDVFSEpoch();
     void updateDVFS();
-    double getPowerEst();
+    virtual double getPowerEst();
     double getFreqForPower(double power);
     double getFreqForSlackOptimal(double prevTime, double &slack);
     double getTimeEst(double oldTime, double oldFreq, double newFreq);
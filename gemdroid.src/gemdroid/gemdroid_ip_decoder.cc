@@ -31,9 +31,9 @@
 #include "gemdroid/gemdroid_ip_decoder.hh"
 #include "gemdroid/gemdroid.hh"
 
-void GemDroidIPDecoder::init(int ip_type, int id, bool isDevice, int computeLatency, int inBufferSize, int outBufferSize, int coding_ratio, int processing_chunk_size,  bool isDecoder, int ip_freq, int opt_freq, GemDroid *gemDroid)
+void GemDroidIPDecoder::init(const GemDroidIPConfig &cfg, int ip_freq, int opt_freq, GemDroid *gemDroid)
 {
-	GemDroidIP::init(ip_type, id, isDevice, 0, ip_freq, opt_freq, gemDroid);
+	GemDroidIP::init(cfg, ip_freq, opt_freq, gemDroid);
 
 	stats_m_IPMemOutStall		= 0;
 	stats_m_IPMemInStalls		= 0;
@@ -45,11 +45,11 @@ void GemDroidIPDecoder::init(int ip_type, int id, bool isDevice, int computeLate
 	m_IPDataReadIntoIP 			= 0;
 	m_IPTrueProcessCycles 		= 0;
 
-	this->computeLatency = computeLatency;
-	this->inBufferSize = inBufferSize;
-	this->outBufferSize = outBufferSize;
-	this->coding_ratio = coding_ratio;
-	this->targetOutputChunkSizeInCL = processing_chunk_size;
+	this->computeLatency = cfg.processingTime;
+	this->inBufferSize = cfg.inBufferSize;
+	this->outBufferSize = cfg.outBufferSize;
+	this->coding_ratio = cfg.codingRatio;
+	this->targetOutputChunkSizeInCL = cfg.chunkSize;
 
 	currInBuffer = 0;
 	currOutBuffer = 0;
@@ -63,10 +63,10 @@ bool GemDroidIPDecoder::updatePower()
 void GemDroidIPDecoder::regStats()
 {
 	GemDroidIP::regStats();
-	m_IPMemOutStall			.name(desc + ".m_IPMemOutStall			").desc("GemDroid: Number of Ip cycles that were stalled by out memory").flags(Stats::display);
-	m_IPMemInStalls			.name(desc + ".m_IPMemInStalls			").desc("GemDroid: Number of Ip cycles that were stalled by in memory").flags(Stats::display);
-	m_IPDataReadIntoIP		.name(desc + ".m_IPDataReadIntoIP		").desc("GemDroid: Number of Ip cycles where daa was read into IP compute units").flags(Stats::display);
-	m_IPTrueProcessCycles	.name(desc + ".m_IPTrueProcessCycles	").desc("GemDroid: Number of Ip cycles that were true process cycles").flags(Stats::display);
+	m_IPMemOutStall			.name(desc + ".m_IPMemOutStall").desc("GemDroid: Number of Ip cycles that were stalled by out memory").flags(Stats::display);
+	m_IPMemInStalls			.name(desc + ".m_IPMemInStalls").desc("GemDroid: Number of Ip cycles that were stalled by in memory").flags(Stats::display);
+	m_IPDataReadIntoIP		.name(desc + ".m_IPDataReadIntoIP").desc("GemDroid: Number of Ip cycles where daa was read into IP compute units").flags(Stats::display);
+	m_IPTrueProcessCycles	.name(desc + ".m_IPTrueProcessCycles").desc("GemDroid: Number of Ip cycles that were true process cycles").flags(Stats::display);
 }
 
 void GemDroidIPDecoder::resetStats()
@@ -72,7 +72,7 @@ private:
 	void requestDependentData();
 
 public:
-	 void init (int ip_type, int id, bool isDevice, int computeLatency, int inBufferSize, int outBufferSize, int ratio, int chunkSize, bool isDecoder, int ip_freq, int opt_freq, GemDroid *gemDroid);
+	 void init(const GemDroidIPConfig &cfg, int ip_freq, int opt_freq, GemDroid *gemDroid);
 	 void tick();
 	 void regStats();
 	 void resetStats();
@@ -31,15 +31,15 @@
 #include "gemdroid/gemdroid_ip_encoder.hh"
 #include "gemdroid/gemdroid.hh"
 
-void GemDroidIPEncoder::init(int ip_type, int id, bool isDevice, int computeLatency, int inBufferSize, int outBufferSize, int coding_ratio, int processing_chunk_size,  bool isDecoder, int ip_freq, int opt_freq, GemDroid *gemDroid)
+void GemDroidIPEncoder::init(const GemDroidIPConfig &cfg, int ip_freq, int opt_freq, GemDroid *gemDroid)
 {
-	GemDroidIP::init(ip_type, id, isDevice, 0, ip_freq, opt_freq, gemDroid);
+	GemDroidIP::init(cfg, ip_freq, opt_freq, gemDroid);
 
-	this->computeLatency = computeLatency;
-	this->inBufferSize = inBufferSize;
-	this->outBufferSize = outBufferSize;
-	this->coding_ratio = coding_ratio;
-	this->targetOutputChunkSizeInCL = processing_chunk_size;
+	this->computeLatency = cfg.processingTime;
+	this->inBufferSize = cfg.inBufferSize;
+	this->outBufferSize = cfg.outBufferSize;
+	this->coding_ratio = cfg.codingRatio;
+	this->targetOutputChunkSizeInCL = cfg.chunkSize;
 
 	cout<<desc<<"inited with:" <<"targetOutputChunkSizeInCL = "<<targetOutputChunkSizeInCL<<" coding_ratio="<<coding_ratio\
 			<<"inBufferSize="<<inBufferSize<<" outBufferSize="<<outBufferSize<<endl;
@@ -49,7 +49,7 @@ private:
 	void requestData();
 
 public:
-	 void init (int ip_type, int id, bool isDevice, int computeLatency, int inBufferSize, int outBufferSize, int ratio, int chunkSize, bool isDecoder, int ip_freq, int opt_freq, GemDroid *gemDroid);
+	 void init(const GemDroidIPConfig &cfg, int ip_freq, int opt_freq, GemDroid *gemDroid);
 	 void tick();
 	 void regStats();
 	 void resetStats();
@@ -31,31 +31,15 @@
 #include "gemdroid/gemdroid_ip_gpu.hh"
 #include "gemdroid/gemdroid.hh"
 
-void GemDroidIPGPU::init(int ip_type, int id, bool isDevice, std::string em_gputrace_file_name, int ip_freq, int opt_freq, GemDroid *gemDroid)
+void GemDroidIPGPU::init(const GemDroidIPConfig &cfg, std::string em_gputrace_file_name, int ip_freq, int opt_freq, GemDroid *gemDroid)
 {
 
-	GemDroidIP::init(ip_type, id, isDevice, 0, ip_freq, opt_freq, gemDroid);
-
-	if(em_gputrace_file_name == "none.txt")
-		return;
-
-	//GPU Trace file - should be enabled or not?
-	em_gputrace_file.open(em_gputrace_file_name, std::iostream::in);
-	if (!em_gputrace_file.is_open()) {
-		inform("Cannot open GPU trace file");
-		assert(0);
-	}
-	else {
-        m_enabled = true;
-		inform("Opened GPUtrace file!");
-    }
-
-	std::cout << em_gputrace_file_name << std::endl;
+	GemDroidIP::init(cfg, ip_freq, opt_freq, gemDroid);
 
+	m_enabled = false;
 	lines_read_gpu = 0;
 	lastDCTick = 0;
 	fpsStalls = 0;
-	power_state = ip_active;
 	writeToDCFlag = false;
 	m_addrToDC = 0;
 
@@ -72,6 +56,24 @@ void GemDroidIPGPU::init(int ip_type, int id, bool isDevice, std::string em_gput
 	stat_m_framesDisplayed = 0;
 	stat_m_framesDropped = 0;
 
+	if(em_gputrace_file_name == "none.txt")
+		return;
+
+	//GPU Trace file - should be enabled or not?
+	em_gputrace_file.open(em_gputrace_file_name, std::iostream::in);
+	if (!em_gputrace_file.is_open()) {
+		inform("Cannot open GPU trace file");
+		assert(0);
+	}
+	else {
+        m_enabled = true;
+		inform("Opened GPUtrace file!");
+    }
+
+	std::cout << em_gputrace_file_name << std::endl;
+
+	power_state = ip_active;
+
 	//m_flowId = gemDroid->getGPUFlowId();
 }
 
@@ -235,7 +237,7 @@ void GemDroidIPGPU::tick()
 		m_addrToDC += CACHE_LINE_SIZE;
 		if(m_addrToDC >= DC1_ADDR_START + FRAME_SIZE) {
 			writeToDCFlag = false;
-			if(!gemDroid->gemdroid_sa.enqueueIPResponse(ip_type, ip_id, 0, m_framesDisplayed.value(), IP_TYPE_DC, 0))
+			if(!gemDroid->gemdroid_sa.enqueueIPResponse(ip_type, ip_id, 0, m_framesDisplayed.value(), IP_TYPE_DC, -1))
 				cout << "Dropper! GPU cannot enqueue DC IP request into SA" << endl;
 			m_framesDisplayed++;
 		}
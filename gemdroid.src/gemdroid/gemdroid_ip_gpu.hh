@@ -61,7 +61,7 @@ private:
 
 public:
 	 void tick();
-	 void init (int ip_type, int id, bool isDevice, std::string em_gputrace_file_name, int ip_freq, int opt_freq, GemDroid *gemDroid);
+	 void init(const GemDroidIPConfig &cfg, std::string em_gputrace_file_name, int ip_freq, int opt_freq, GemDroid *gemDroid);
 	 void regStats();
 	 void resetStats();
 	 inline bool isEnabled() { return m_enabled; }
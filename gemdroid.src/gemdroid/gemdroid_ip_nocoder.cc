@@ -31,15 +31,15 @@
 #include "gemdroid/gemdroid_ip_nocoder.hh"
 #include "gemdroid/gemdroid.hh"
 
-void GemDroidIPNocoder::init(int ip_type, int id, bool isDevice, int computeLatency, int inBufferSize, int outBufferSize, int coding_ratio, int processing_chunk_size,  bool isDecoder, int ip_freq, int opt_freq, GemDroid *gemDroid)
+void GemDroidIPNocoder::init(const GemDroidIPConfig &cfg, int ip_freq, int opt_freq, GemDroid *gemDroid)
 {
-	GemDroidIP::init(ip_type, id, isDevice, 0, ip_freq, opt_freq, gemDroid);
+	GemDroidIP::init(cfg, ip_freq, opt_freq, gemDroid);
 
-	this->computeLatency = computeLatency;
-	this->inBufferSize = inBufferSize;
-	this->outBufferSize = outBufferSize;
-	this->coding_ratio = coding_ratio;
-	this->targetOutputChunkSizeInCL = processing_chunk_size;
+	this->computeLatency = cfg.processingTime;
+	this->inBufferSize = cfg.inBufferSize;
+	this->outBufferSize = cfg.outBufferSize;
+	this->coding_ratio = cfg.codingRatio;
+	this->targetOutputChunkSizeInCL = cfg.chunkSize;
 
 	currInBuffer = 0;
 	currOutBuffer = 0;
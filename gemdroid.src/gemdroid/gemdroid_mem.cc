@@ -32,22 +32,28 @@
 #include "DRAMSim2/Callback.h"
 #include "base/callback.hh"
 #include "gemdroid/gemdroid.hh"
+#include "mem/dram_ctrl.hh"
 
 using namespace std;
 
-GemDroidMemory::GemDroidMemory(int id, string deviceConfigFile, string systemConfigFile, string filePath,
-		string traceFile, long sizeMB, bool perfectMemory, bool enableDebug, GemDroid *gemDroid) :
-		dramWrapper(deviceConfigFile, systemConfigFile, filePath, traceFile, sizeMB, enableDebug)
+GemDroidMemory::GemDroidMemory(int id, const GemDroidParams *p, GemDroid *gemDroid) :
+		dramWrapper(NULL), memPort(NULL), masterId(0), portRangeSize(p->range.size()),
+		portMaxOutstanding(p->mem_port_max_outstanding), portOutstanding(0), retryPkt(NULL),
+		dramCtrl(p->dram_ctrl), portActEnergy(p->mem_port_act_energy),
+		portBurstEnergy(p->mem_port_burst_energy), portBgPower(p->mem_port_bg_power),
+		portBytes(0), portReads(0), portReadLat(0), m_bandwidth(0), m_latency(0)
 {
 	mem_id=id;
 	this->gemDroid = gemDroid;
 	desc="GemDroid.Memory_";
 	desc += (char)(id+'0');
 	ticks = 0;
-	this->perfectMemory = perfectMemory;
+	this->perfectMemory = p->perfect_memory;
 	perfectMemLatency = PEFECT_MEM_LATENCY;
 	m_cyclesToStall = 0;
+	m_freq = MAX_MEM_FREQ;
     m_optMemFreq = 0.8; // 800 MHz
+	m_power = 0;
 
 	// overall_stats
 	m_memCPUReqs = 0;
@@ -58,13 +64,28 @@ GemDroidMemory::GemDroidMemory(int id, string deviceConfigFile, string systemCon
 	stats_m_memIPReqs = 0;
 	stats_m_memRejected = 0;
 
+	if(p->mem_backend == "port") {
+		memPort = new MemPort(p->name + ".mem_port", gemDroid, *this);
+		masterId = p->system->getMasterId(p->name + ".mem_port");
+		bwLast = powerLast = portCounters();
+		cout<<"Instantiated GemDroid::Memory on the gem5 memory port"<<endl;
+		return;
+	}
+	else if(p->mem_backend != "dramsim2") {
+		cout<<"\n Unknown GemDroid memory backend "<<p->mem_backend<<endl;
+		assert(0);
+	}
+
+	dramWrapper = new DRAMSim2Wrapper(p->deviceConfigFile, p->systemConfigFile, p->filePath,
+		p->traceFile, p->range.size() / 1024 / 1024, p->enableDebug);
+
 	DRAMSim::TransactionCompleteCB* read_cb =
 		new DRAMSim::Callback<GemDroidMemory, void, unsigned, uint64_t, uint64_t, int , int>(
 			this, &GemDroidMemory::readComplete);
 	DRAMSim::TransactionCompleteCB* write_cb =
 		new DRAMSim::Callback<GemDroidMemory, void, unsigned, uint64_t, uint64_t, int, int>(
 			this, &GemDroidMemory::writeComplete);
-	dramWrapper.setCallbacks(read_cb, write_cb);
+	dramWrapper->setCallbacks(read_cb, write_cb);
 
 	// Register a callback to compensate for the destructor not
 	// being called. The callback prints the DRAMSim2 stats.
@@ -72,7 +93,21 @@ GemDroidMemory::GemDroidMemory(int id, string deviceConfigFile, string systemCon
 	if(!perfectMemory)
 		registerExitCallback(cb);
 
-    cout<<"Instantiated GemDroid::DRAMSim2 with clock "<<dramWrapper.clockPeriod()<< "ns and queue size "<<dramWrapper.queueSize()<<endl;
+    cout<<"Instantiated GemDroid::DRAMSim2 with clock "<<dramWrapper->clockPeriod()<< "ns and queue size "<<dramWrapper->queueSize()<<endl;
+}
+
+GemDroidMemory::~GemDroidMemory()
+{
+	delete dramWrapper;
+	delete memPort;
+}
+
+void GemDroidMemory::init()
+{
+	if(memPort && !perfectMemory && !memPort->isConnected()) {
+		cout<<"\n "<<desc<<": mem_backend=port but mem_port is not connected"<<endl;
+		assert(0);
+	}
 }
 
 void GemDroidMemory::regStats()
@@ -116,7 +151,10 @@ void GemDroidMemory::printPeriodicStats()
 	stats_m_memIPReqs = m_memIPReqs.value();
 	stats_m_memRejected = m_memRejected.value();
 
-	dramWrapper.printStats(false);
+	if(dramWrapper)
+		dramWrapper->printStats(false);
+	else if(memPort)
+		updatePortStats();
 }
 
 void GemDroidMemory::tick()
@@ -124,7 +162,9 @@ void GemDroidMemory::tick()
 	// To print periodic stats of memory along with other components add 4 everytime
 	ticks++;
 
-	dramWrapper.tick();
+	// The port backend is driven by gem5 events
+	if(dramWrapper)
+		dramWrapper->tick();
 
 /*	if(perfectMemory) {
 		 //Perfect Memory
@@ -151,7 +191,7 @@ void GemDroidMemory::writeComplete(unsigned id, uint64_t addr, uint64_t cycle, i
 //    cout<< ticks <<" Response Write "<<addr<<endl;
 }
 
-// enqueue the memory request to either dramsim2 or ruby
+// enqueue the memory request to either dramsim2 or the memory port
 // return true when successfully enqueued
 bool GemDroidMemory::enqueueMemReq(int type, int id, int core_id, uint64_t addr, bool isRead)
 {
@@ -161,8 +201,20 @@ bool GemDroidMemory::enqueueMemReq(int type, int id, int core_id, uint64_t addr,
 	}
 
 	if(!perfectMemory) {
-		if(dramWrapper.canAccept()) {
+		bool accepted;
+		if(memPort)
+			accepted = sendPortReq(type, id, addr, isRead);
+		else if(dramWrapper->canAccept()) {
+			//DramWrapper expects "isWrite". So, we do !isRead.
+			//cout << "JOOMLA: " << ticks << " : " << type << " : " << isRead << " : " << addr << endl;
+			dramWrapper->enqueue(!isRead,addr, type, id);
+			// cout << "Memory: " << ticks << "  " << id << " enqueued " << isRead << "  " << addr <<endl;
+			accepted = true;
+		}
+		else
+			accepted = false;
 
+		if(accepted) {
 			if (type == IP_TYPE_CPU)
 				m_memCPUReqs++;
 			else
@@ -171,11 +223,6 @@ bool GemDroidMemory::enqueueMemReq(int type, int id, int core_id, uint64_t addr,
 			gemDroid->appMemReqs[core_id]++;
 			gemDroid->ipMemReqs[type]++;
 
-			//DramWrapper expects "isWrite". So, we do !isRead.
-			//cout << "JOOMLA: " << ticks << " : " << type << " : " << isRead << " : " << addr << endl;
-			dramWrapper.enqueue(!isRead,addr, type, id);
-			// cout << "Memory: " << ticks << "  " << id << " enqueued " << isRead << "  " << addr <<endl;
-
 		 	return true;
 		}
 		else {
@@ -193,9 +240,136 @@ bool GemDroidMemory::enqueueMemReq(int type, int id, int core_id, uint64_t addr,
 	}
 }
 
+bool GemDroidMemory::sendPortReq(int type, int id, uint64_t addr, bool isRead)
+{
+	// A packet refused by the memory holds the port until its retry,
+	// and the outstanding cap stands in for the DRAMSim2 queue size
+	if(retryPkt || portOutstanding >= portMaxOutstanding)
+		return false;
+
+	// SA addresses are folded into the range of the memory behind the
+	// port; the response goes back with the original address
+	Addr paddr = (addr % portRangeSize) & ~(Addr)(CACHE_LINE_SIZE - 1);
+	Request *req = new Request(paddr, CACHE_LINE_SIZE, 0, masterId);
+	PacketPtr pkt = new Packet(req, isRead ? MemCmd::ReadReq : MemCmd::WriteReq);
+	uint8_t *data = new uint8_t[CACHE_LINE_SIZE];
+	if(!isRead)
+		memset(data, 0, CACHE_LINE_SIZE);
+	pkt->dataDynamicArray(data);
+	pkt->pushSenderState(new MemSenderState(addr, type, id));
+
+	portOutstanding++;
+	if(!memPort->sendTimingReq(pkt))
+		retryPkt = pkt;
+
+	return true;
+}
+
+void GemDroidMemory::recvRetry()
+{
+	assert(retryPkt);
+	if(memPort->sendTimingReq(retryPkt))
+		retryPkt = NULL;
+}
+
+bool GemDroidMemory::recvTimingResp(PacketPtr pkt)
+{
+	MemSenderState *state = dynamic_cast<MemSenderState *>(pkt->popSenderState());
+	assert(state);
+	bool isRead = pkt->isRead();
+
+	portOutstanding--;
+	portBytes += pkt->getSize();
+	if(isRead) {
+		portReads++;
+		portReadLat += curTick() - state->issued;
+	}
+
+	uint64_t addr = state->addr;
+	int type = state->type;
+	int id = state->id;
+	delete state;
+	delete pkt->req;
+	delete pkt;
+
+	gemDroid->gemdroid_sa.memResponse(addr, isRead, type, id);
+	return true;
+}
+
+GemDroidMemory::PortCounters GemDroidMemory::portCounters() const
+{
+	PortCounters c;
+	c.tick = curTick();
+	if(dramCtrl) {
+		c.bytes = dramCtrl->numBytesRead() + dramCtrl->numBytesWritten();
+		c.bursts = dramCtrl->numReadBursts() + dramCtrl->numWriteBursts();
+		c.rowHits = dramCtrl->numReadRowHits() + dramCtrl->numWriteRowHits();
+		c.readLat = dramCtrl->totalReadLatency();
+		c.reads = dramCtrl->numReadBursts();
+	}
+	else {
+		// Without a controller to ask every access is a burst and a
+		// row miss
+		c.bytes = portBytes;
+		c.bursts = portBytes / CACHE_LINE_SIZE;
+		c.rowHits = 0;
+		c.readLat = portReadLat;
+		c.reads = portReads;
+	}
+	return c;
+}
+
+// DRAMCtrl counters start over when the stats are reset, in which case
+// the window starts from zero
+void GemDroidMemory::portWindow(const PortCounters &now, PortCounters &last,
+		PortCounters &delta)
+{
+	if(now.bytes < last.bytes || now.readLat < last.readLat) {
+		Tick tick = last.tick;
+		last = PortCounters();
+		last.tick = tick;
+	}
+	delta.tick = now.tick - last.tick;
+	delta.bytes = now.bytes - last.bytes;
+	delta.bursts = now.bursts - last.bursts;
+	delta.rowHits = now.rowHits - last.rowHits;
+	delta.readLat = now.readLat - last.readLat;
+	delta.reads = now.reads - last.reads;
+	last = now;
+}
+
+void GemDroidMemory::updatePortStats()
+{
+	PortCounters delta;
+	portWindow(portCounters(), bwLast, delta);
+	if(delta.tick == 0)
+		return;
+
+	double secs = (double)delta.tick / SimClock::Frequency;
+	m_bandwidth = delta.bytes / secs / 1E9;
+	if(delta.reads > 0)
+		m_latency = delta.readLat / delta.reads / SimClock::Int::ns;
+}
+
 double GemDroidMemory::powerIn1ms()
 {
-   double power = dramWrapper.getPower();
+   double power;
+
+   if(memPort) {
+       // Activates, bursts and background power since the last call;
+       // the background part follows the memory frequency
+       PortCounters delta;
+       portWindow(portCounters(), powerLast, delta);
+       if(delta.tick == 0)
+           return m_power;
+
+       double secs = (double)delta.tick / SimClock::Frequency;
+       double energy = ((delta.bursts - delta.rowHits) * portActEnergy +
+                        delta.bursts * portBurstEnergy) * 1E-9;
+       power = energy / secs + portBgPower * m_freq / MAX_MEM_FREQ;
+   }
+   else
+       power = dramWrapper->getPower();
 
    if (std::isnan(power))
        return m_power;
@@ -205,12 +379,23 @@ double GemDroidMemory::powerIn1ms()
    }
 }
 
+void GemDroidMemory::applyMemFreq()
+{
+	if(dramWrapper)
+		dramWrapper->updateFreq(m_freq);
+	else if(dramCtrl) {
+		// DRAMCtrl runs its bus at 1/tCK
+		double nominal = (double)SimClock::Int::ns / dramCtrl->busClockPeriod();
+		dramCtrl->setBusFreqScale(m_freq / nominal);
+	}
+}
+
 void GemDroidMemory::setMemFreq(double freq) //m_freq in Ghz
 {
 	assert (freq >= (MIN_MEM_FREQ-EPSILON) && freq <= (MAX_MEM_FREQ+EPSILON));
 
 	m_freq = freq;
-	dramWrapper.updateFreq(freq);	
+	applyMemFreq();
 }
 
 double GemDroidMemory::getMemFreq() //m_freq in Ghz
@@ -221,19 +406,19 @@ double GemDroidMemory::getMemFreq() //m_freq in Ghz
 void GemDroidMemory::setMinMemFreq() //m_freq in Ghz
 {
 	m_freq = MIN_MEM_FREQ;
-	dramWrapper.updateFreq(m_freq);		
+	applyMemFreq();
 }
 
 void GemDroidMemory::setMaxMemFreq() //m_freq in Ghz
 {
 	m_freq = MAX_MEM_FREQ;
-	dramWrapper.updateFreq(m_freq);		
+	applyMemFreq();
 }
 
 void GemDroidMemory::setOptMemFreq() //m_freq in Ghz
 {
 	m_freq = m_optMemFreq;
-	dramWrapper.updateFreq(m_freq);		
+	applyMemFreq();
 }
 
 void GemDroidMemory::incMemFreq(int steps) //m_freq in Ghz
@@ -244,7 +429,7 @@ void GemDroidMemory::incMemFreq(int steps) //m_freq in Ghz
 	else
 		m_freq = MAX_MEM_FREQ;
 
-	dramWrapper.updateFreq(m_freq);		
+	applyMemFreq();
 }
 
 void GemDroidMemory::decMemFreq(int steps) //m_freq in Ghz
@@ -255,12 +440,14 @@ void GemDroidMemory::decMemFreq(int steps) //m_freq in Ghz
 	else
 		m_freq = MIN_MEM_FREQ;
 
-	dramWrapper.updateFreq(m_freq);	
+	applyMemFreq();
 }
 
 double GemDroidMemory::getBandwidth() //in GBPS
 {
-	return dramWrapper.getBandwidth();
+	if(memPort)
+		return m_bandwidth;
+	return dramWrapper->getBandwidth();
 }
 
 double GemDroidMemory::getMaxBandwidth(double freq) //m_freq in Ghz; function return val in GBPS;
@@ -278,14 +465,18 @@ double GemDroidMemory::getMaxBandwidth() //m_freq in Ghz; function return val in
 	return (64*2*m_freq/8);//64 bytes cache line, DDR=2data transfers per clock, m_frequency, 8=bits to bytes.
 }
 
-double GemDroidMemory::getLastLatency()
+double GemDroidMemory::getLastLatency() //in ns
 {
-	return dramWrapper.getLatency();
+	if(memPort)
+		return m_latency;
+	return dramWrapper->getLatency();
 }
 
 int GemDroidMemory::getNumChannels()
 {
-	return dramWrapper.getNumChannels();
+	if(memPort)
+		return 1;
+	return dramWrapper->getNumChannels();
 }
 
 double GemDroidMemory::getEnergyEst(double currFreq, double currEnergy, double newFreq)
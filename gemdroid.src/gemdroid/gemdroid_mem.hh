@@ -33,16 +33,103 @@
 
 #include "base/statistics.hh"
 #include "mem/dramsim2_wrapper.hh"
+#include "mem/packet.hh"
+#include "mem/port.hh"
+#include "params/GemDroid.hh"
 
 using namespace std;
 
+class DRAMCtrl;
+
 class GemDroidMemory
 {
 private:
 	/**
-	* The actual DRAMSim2 wrapper
+	* Port to a gem5 memory system, used instead of DRAMSim2 with
+	* mem_backend=port. Requests are 64B packets, the sender of each one
+	* rides along in its sender state.
+	*/
+	class MemPort : public MasterPort
+	{
+	  public:
+		MemPort(const string &name, MemObject *owner, GemDroidMemory &mem)
+			: MasterPort(name, owner), mem(mem)
+		{ }
+
+	  protected:
+		bool recvTimingResp(PacketPtr pkt) { return mem.recvTimingResp(pkt); }
+		void recvRetry() { mem.recvRetry(); }
+
+	  private:
+		GemDroidMemory &mem;
+	};
+
+	struct MemSenderState : public Packet::SenderState
+	{
+		MemSenderState(uint64_t addr, int type, int id)
+			: addr(addr), type(type), id(id), issued(curTick())
+		{ }
+
+		uint64_t addr;	// address as the SA knows it
+		int type;
+		int id;
+		Tick issued;
+	};
+
+	/**
+	* The actual DRAMSim2 wrapper, NULL with the port backend
 	*/
-	DRAMSim2Wrapper dramWrapper;
+	DRAMSim2Wrapper *dramWrapper;
+
+	MemPort *memPort;
+	MasterID masterId;
+	uint64_t portRangeSize;
+	int portMaxOutstanding;
+	int portOutstanding;
+	PacketPtr retryPkt;
+
+	/**
+	* Controller behind the port, if any. Bandwidth, latency and power
+	* come from its counters and the memory frequency scales its bus.
+	*/
+	DRAMCtrl *dramCtrl;
+
+	// Port backend energy model: nJ per activate and per burst, W of
+	// background power at MAX_MEM_FREQ
+	double portActEnergy;
+	double portBurstEnergy;
+	double portBgPower;
+
+	// Counters at the end of the last bandwidth and power windows
+	struct PortCounters
+	{
+		Tick tick;
+		double bytes;
+		double bursts;
+		double rowHits;
+		double readLat;
+		double reads;
+	};
+	PortCounters bwLast;
+	PortCounters powerLast;
+	// Port side counts when there is no DRAMCtrl to ask
+	double portBytes;
+	double portReads;
+	double portReadLat;
+	double m_bandwidth;
+	double m_latency;
+
+	PortCounters portCounters() const;
+	/** Counters since last, moving last up to now. */
+	static void portWindow(const PortCounters &now, PortCounters &last,
+		PortCounters &delta);
+	/** Bandwidth and latency of the last stats period. */
+	void updatePortStats();
+	bool sendPortReq(int type, int id, uint64_t addr, bool isRead);
+	bool recvTimingResp(PacketPtr pkt);
+	void recvRetry();
+	void applyMemFreq();
+
 	int mem_id;
 	string desc;
 	GemDroid *gemDroid;
@@ -81,8 +168,11 @@ private:
 	void writeComplete(unsigned id, uint64_t addr, uint64_t cycle, int sender_type, int sender_id);
 
 public:
-	GemDroidMemory(int id, string deviceConfigFile, string systemConfigFile, string filePath,
-		string traceFile, long size, bool perfectMemory, bool enableDebug, GemDroid *gemDroid);
+	GemDroidMemory(int id, const GemDroidParams *p, GemDroid *gemDroid);
+	~GemDroidMemory();
+	void init();
+	BaseMasterPort &getMasterPort() { assert(memPort); return *memPort; }
+	bool usesPort() const { return memPort != NULL; }
 	void regStats();
 	void resetStats();
 	void printPeriodicStats();
@@ -45,6 +45,11 @@ GemDroidSA::GemDroidSA(int id, GemDroid *gemDroid)
 
 	ticks = 0;
 	numRejected = 0;
+	numFlowStalls = 0;
+	numStreamedWrites = 0;
+	numStreamedReads = 0;
+	numStreamSpills = 0;
+	numStreamWaits = 0;
 	numIPReqs = 0;
 	numIPMemReqs = 0;
 	numMemCoreResponse = 0;
@@ -53,6 +58,9 @@ GemDroidSA::GemDroidSA(int id, GemDroid *gemDroid)
 	numCoreMemReqs = 0;
 
 	dynamicActivity = 0;
+	streamBufferLines = 0;
+	streamTileLines = 1;
+	streamLinesUsed = 0;
 	
 	stats_ticks = 0;
 	stats_numCoreMemReqs = 0;
@@ -74,12 +82,22 @@ void GemDroidSA::regStats()
 	numIPCoreResponse.name(desc + ".numIPCoreResponse").desc("GemDroid SA: Number of IP responses to core").flags(Stats::display);
 	numMemIPResponse.name(desc + ".numMemIPResponse").desc("GemDroid SA: Number of memory responses to IP").flags(Stats::display);
 	numRejected.name(desc + ".numRejected").desc("GemDroid SA: Number of IP memory requests rejected by SA").flags(Stats::display);
+	numStreamedWrites.name(desc + ".numStreamedWrites").desc("GemDroid SA: Number of IP output lines kept in the streaming scratchpad").flags(Stats::display);
+	numStreamedReads.name(desc + ".numStreamedReads").desc("GemDroid SA: Number of IP input lines read from the streaming scratchpad").flags(Stats::display);
+	numStreamSpills.name(desc + ".numStreamSpills").desc("GemDroid SA: Number of streamed lines sent to DRAM because the scratchpad was full").flags(Stats::display);
+	numStreamWaits.name(desc + ".numStreamWaits").desc("GemDroid SA: Number of IP reads that waited for the producer to write the line").flags(Stats::display);
+	numFlowStalls.name(desc + ".numFlowStalls").desc("GemDroid SA: Number of frames held back because the next flow stage was full").flags(Stats::display);
 }
 
 void GemDroidSA::resetStats()
 {
 	ticks = 0;
 	numRejected = 0;
+	numFlowStalls = 0;
+	numStreamedWrites = 0;
+	numStreamedReads = 0;
+	numStreamSpills = 0;
+	numStreamWaits = 0;
 	numIPReqs = 0;
 	numIPMemReqs = 0;
 	numMemCoreResponse = 0;
@@ -171,9 +189,18 @@ void GemDroidSA::printPeriodicStats()
 
 void GemDroidSA::sendMemoryRequests()
 {
+	GemDroidSLC &slc = gemDroid->gemdroid_slc;
+
 	if (!coreMemReq.empty()) {
 		GemDroidMemMsg request = coreMemReq.front();
+		if (slc.isEnabled() && slc.access(IP_TYPE_CPU, request.getId(), request.getAddr(), request.getIsRead()) != SLC_MISS) {
+			coreMemReq.pop_front();
+			updateActivityCountIn1Ms();
+			return;
+		}
 		if (gemDroid->gemdroid_memory.enqueueMemReq(IP_TYPE_CPU, request.getId(), request.getCoreId(), request.getAddr(), request.getIsRead())) {
+			if (slc.isEnabled())
+				slc.missIssued(IP_TYPE_CPU, request.getAddr(), request.getIsRead());
 			coreMemReq.pop_front();
 			updateActivityCountIn1Ms();
 			return;
@@ -185,7 +212,14 @@ void GemDroidSA::sendMemoryRequests()
 
 	if (!ipMemReq.empty()) {
 		GemDroidMemMsg request = ipMemReq.front();
+		if (slc.isEnabled() && slc.access(request.getIpType(), request.getId(), request.getAddr(), request.getIsRead()) != SLC_MISS) {
+			ipMemReq.pop_front();
+			updateActivityCountIn1Ms();
+			return;
+		}
 		if (gemDroid->gemdroid_memory.enqueueMemReq(request.getIpType(), request.getId(), request.getCoreId(), request.getAddr(), request.getIsRead())) {
+			if (slc.isEnabled())
+				slc.missIssued(request.getIpType(), request.getAddr(), request.getIsRead());
 			ipMemReq.pop_front();
 			updateActivityCountIn1Ms();
 			return;
@@ -295,6 +329,9 @@ void GemDroidSA::tick()
 
 	totalQueueSize += coreMemReq.size() + ipMemReq.size();
 
+	if (gemDroid->gemdroid_slc.isEnabled())
+		gemDroid->gemdroid_slc.tick();
+
 	process();
 }
 
@@ -369,6 +406,9 @@ bool GemDroidSA::enqueueIPMemRequest(int ip_type, int ip_id, int core_id, uint64
 		return false;
 	}
 
+	if (streamBufferLines > 0 && (isRead ? streamRead(ip_type, ip_id, core_id, addr) : streamWrite(ip_type, ip_id, core_id, addr)))
+		return true;
+
 	numIPMemReqs++;
 
 	GemDroidMemMsg request(ip_type, ip_id, core_id, addr, isRead, false);
@@ -397,86 +437,238 @@ bool GemDroidSA::enqueueIPResponse(int senderIPType, int senderIPId, int receive
 	// if(gemDroid->isIPCallDrop(senderIPType, timeTook))
 		// ; //return true;
 
-    int flows[MAX_FLOWS_IN_APP];
-	gemDroid->flow_identification(receiverCoreId, senderIPType, flows);
-	int flowid1 = flows[0];
-	int flowid2 = flows[1];
-    int ips[MAX_IPS_IN_FLOW];
-
-	if (senderIPType == IP_TYPE_CAM) {
-		gemDroid->nextIPtoCall(senderIPType, receiverCoreId, IP_TYPE_DC, ips);
-		if (ips[0] == IP_TYPE_IMG)
-			if (!enqueueIPIPRequest(senderIPType, senderIPId, receiverCoreId, IP_TYPE_IMG, CAM_ADDR_START, 4*FRAME_SIZE/2, true, frameNum, flowType, flowid1))
-			    cout << "Dropper! CAM IP unable to inject to IMG IP" << endl;
-		gemDroid->nextIPtoCall(senderIPType, receiverCoreId, IP_TYPE_MMC_OUT, ips);
-		if (ips[0] == IP_TYPE_VE)
-			if (!enqueueIPIPRequest(senderIPType, senderIPId, receiverCoreId, IP_TYPE_VE, CAM_ADDR_START, 4*FRAME_SIZE/1, true, frameNum, flowType, flowid2))
-				cout << "Dropper! CAM IP unable to inject to VE IP" << endl;
-		gemDroid->nextIPtoCall(senderIPType, receiverCoreId, IP_TYPE_NW, ips);
-		if (ips[0] == IP_TYPE_VE)
-			if (!enqueueIPIPRequest(senderIPType, senderIPId, receiverCoreId, IP_TYPE_VE, CAM_ADDR_START, 4*FRAME_SIZE/1, true, frameNum, flowType, flowid2))
-				cout << "Dropper! CAM IP unable to inject to VE IP" << endl;
-	} else if (senderIPType == IP_TYPE_MIC) {
-		if (!enqueueIPIPRequest(senderIPType, senderIPId, receiverCoreId, IP_TYPE_AE, MIC_ADDR_START, 4*AUD_FRAME_SIZE, true, frameNum, flowType, flowid1))
-			cout << "Dropper! MIC IP unable to inject to AE IP" << endl;
-	} else if (senderIPType == IP_TYPE_VD) {
-		if (!enqueueIPIPRequest(senderIPType, senderIPId, receiverCoreId, IP_TYPE_DC, VD_ADDR_START + FRAME_SIZE, 4*FRAME_SIZE, true, frameNum, flowType, flowid1))
-			cout << "Dropper! IP VD unable to inject a DC ip request" << endl;
-	} else if (senderIPType == IP_TYPE_AD) {
-		if (!enqueueIPIPRequest(senderIPType, senderIPId, receiverCoreId, IP_TYPE_SND, AD_ADDR_START + AUD_FRAME_SIZE, 4*AUD_FRAME_SIZE, true, frameNum, flowType, flowid1))
-			cout << "Dropper! IP AD unable to inject a SND ip request" << endl;
-	} else if (senderIPType == IP_TYPE_IMG) {
-		if (!enqueueIPIPRequest(senderIPType, senderIPId, receiverCoreId, IP_TYPE_DC, IMG_ADDR_START + FRAME_SIZE, 4*FRAME_SIZE, true, frameNum, flowType, flowid1))
-			cout << "Dropper! IP IMG unable to inject a DC ip request" << endl;
-		//If photocapture, then call MMC as well. Else, move on.
-		// if (gemDroid->nextIPtoCall(senderIPType, receiverCoreId, IP_TYPE_DC, ips) != -1) {
-		gemDroid->nextIPtoCall(senderIPType, receiverCoreId, IP_TYPE_MMC_OUT, ips);
-		if (ips[0] != -1) {
-			if (!enqueueIPIPRequest(senderIPType, senderIPId, receiverCoreId, IP_TYPE_MMC_OUT, IMG_ADDR_START + FRAME_SIZE, FRAME_SIZE, false, frameNum, flowType, flowid2))
-				cout << "Dropper! IP IMG unable to inject a MMC ip request" << endl;
+	int app = gemDroid->getAppId(receiverCoreId);
+
+	// The frame came in over a flow edge: hand its credit back and let a
+	// frame parked behind it on that edge move on
+	if (flowId >= 0 && flowId < gemDroid->gemdroid_flows.numEdges(app)) {
+		GemDroidFlowEdge &in = gemDroid->gemdroid_flows.getEdge(app, flowId);
+		if (in.inFlight > 0)
+			in.inFlight--;
+		if (!in.parked.empty()) {
+			GemDroidFlowFrame frame = in.parked.front();
+			in.parked.pop_front();
+			forwardFrame(app, flowId, frame);
 		}
-	} else if (senderIPType == IP_TYPE_VE) {
-		// int next_ip1 = gemDroid->nextIPtoCall(senderIPType, receiverCoreId, IP_TYPE_VE, ips);
-		gemDroid->nextIPtoCall(senderIPType, receiverCoreId, IP_TYPE_VE, ips);
-		int next_ip1 = ips[0];
-		if(next_ip1 == IP_TYPE_NW)
-			return true;
-
-		if (!enqueueIPIPRequest(senderIPType, senderIPId, receiverCoreId, IP_TYPE_MMC_OUT, VE_ADDR_START + FRAME_SIZE, FRAME_SIZE / (VID_CODING_RATIO), false, frameNum, flowType, flowid1))
-			cout << "Dropper! IP VE unable to inject a MMC ip request" << endl;
-	} else if (senderIPType == IP_TYPE_AE) {
-		// int next_ip1 = gemDroid->nextIPtoCall(senderIPType, receiverCoreId, IP_TYPE_AE, ips);
-		gemDroid->nextIPtoCall(senderIPType, receiverCoreId, IP_TYPE_AE, ips);
-		int next_ip1 = ips[0];
-		if(next_ip1 == IP_TYPE_NW)
-			return true;
-		if (!enqueueIPIPRequest(senderIPType, senderIPId, receiverCoreId, IP_TYPE_MMC_OUT, AE_ADDR_START + AUD_FRAME_SIZE, AUD_FRAME_SIZE / AUD_CODING_RATIO, false, frameNum, flowType, flowid1))
-			cout << "Dropper! IP AE unable to inject a MMC ip request" << endl;
-	} else if (senderIPType == IP_TYPE_MMC_IN) {
-		int next_ip;
-
-        gemDroid->nextIPtoCall(senderIPType, receiverCoreId, flowType, ips);
-
-		next_ip = ips[0];
-
-		if (next_ip == IP_TYPE_AD) {
-			if (!enqueueIPIPRequest(senderIPType, senderIPId, receiverCoreId, IP_TYPE_AD, MMC_IN_ADDR_START, 4*AUD_FRAME_SIZE / AUD_CODING_RATIO, true, frameNum, flowType, flowid1))
-				cout << "Dropper! IP MMC unable to inject a AD ip request" << endl;
-		} else if (next_ip == IP_TYPE_IMG) {
-			if (!enqueueIPIPRequest(senderIPType, senderIPId, receiverCoreId, IP_TYPE_IMG, MMC_IN_ADDR_START, 4*FRAME_SIZE/2, true, frameNum, flowType, flowid1))
-				cout << "Dropper! IP MMC unable to inject a IMG ip request" << endl;
-		} else if (next_ip == IP_TYPE_VD) {
-			if (!enqueueIPIPRequest(senderIPType, senderIPId, receiverCoreId, IP_TYPE_VD, MMC_IN_ADDR_START, 4*FRAME_SIZE / VID_CODING_RATIO, true, frameNum, flowType, flowid1))
-				cout << "Dropper! IP MMC unable to inject a VD ip request" << endl;
+	}
+
+	if (flowId >= 0 && flowId < gemDroid->gemdroid_flows.numEdges(app))
+		streamConsumerDone(app, gemDroid->gemdroid_flows.getEdge(app, flowId));
+
+	// Consumers that were started while this frame was still streaming out are skipped
+	uint32_t started = streamProducerDone(senderIPType);
+
+	const vector<int> &out = gemDroid->gemdroid_flows.getOutEdges(app, senderIPType);
+	for(int i=0; i<out.size(); i++) {
+		GemDroidFlowEdge &edge = gemDroid->gemdroid_flows.getEdge(app, out[i]);
+
+		if (!edge.triggered || !gemDroid->gemdroid_flows.edgeCarries(edge, flowType) || (started & (1u << edge.outPos)))
+			continue;
+
+		dispatchFrame(app, out[i], GemDroidFlowFrame(receiverCoreId, senderIPId, frameNum, flowType));
+	}
+
+	return true;
+}
+
+// Send a frame over a flow edge, or park it at the source while the edge has no credit
+void GemDroidSA::dispatchFrame(int app, int edgeId, const GemDroidFlowFrame &frame)
+{
+	GemDroidFlowEdge &edge = gemDroid->gemdroid_flows.getEdge(app, edgeId);
+
+	if (!gemDroid->gemdroid_flows.hasCredit(edge)) {
+		numFlowStalls++;
+		edge.parked.push_back(frame);
+		return;
+	}
+
+	forwardFrame(app, edgeId, frame);
+}
+
+// Send a finished frame to the next stage over a flow edge; the edge id travels with the request as its flowId
+void GemDroidSA::forwardFrame(int app, int edgeId, const GemDroidFlowFrame &frame)
+{
+	GemDroidFlowEdge &edge = gemDroid->gemdroid_flows.getEdge(app, edgeId);
+
+	if (!enqueueIPIPRequest(edge.src, frame.senderId, frame.coreId, edge.dst, edge.addr, edge.size, edge.isRead, frame.frameNum, frame.flowType, edgeId)) {
+		cout << "Dropper! IP " << ipTypeToString(edge.src) << " unable to inject a " << ipTypeToString(edge.dst) << " ip request" << endl;
+		return;
+	}
+
+	edge.inFlight++;
+}
+
+void GemDroidSA::initStreaming(int bufferLines, int tileLines)
+{
+	streamBufferLines = bufferLines;
+	streamTileLines = tileLines > 0 ? tileLines : 1;
+	streamLinesUsed = 0;
+}
+
+/*
+ * A producer write to the buffer of a triggered out edge stays in the
+ * scratchpad while there is room (one credit per line) and goes to DRAM
+ * otherwise. Consumers start once the first tile is written and read the
+ * lines back from the scratchpad, returning the credit.
+ */
+bool GemDroidSA::streamWrite(int ip_type, int ip_id, int core_id, uint64_t addr)
+{
+	GemDroidIP *inst = gemDroid->ipTable[ip_type][ip_id];
+	int app = gemDroid->getAppId(core_id);
+	const vector<int> &out = gemDroid->gemdroid_flows.getOutEdges(app, ip_type);
+	uint32_t readers = 0;
+
+	for(int i=0; i<out.size(); i++) {
+		GemDroidFlowEdge &edge = gemDroid->gemdroid_flows.getEdge(app, out[i]);
+		if (edge.triggered && gemDroid->gemdroid_flows.edgeCarries(edge, inst->getFlowType()) && addr >= edge.addr && addr < edge.addr + edge.size)
+			readers |= 1u << edge.outPos;
+	}
+
+	if (readers == 0)
+		return false;
+
+	GemDroidFlowStream &stream = streams[ip_type];
+	if (!stream.open) {
+		stream.open = true;
+		stream.app = app;
+		stream.frameNum = inst->getFrameNum();
+		stream.flowType = inst->getFlowType();
+		stream.linesWritten = 0;
+		stream.producedEnd = 0;
+		stream.forwarded = 0;
+	}
+	stream.linesWritten++;
+	stream.producedEnd = max(stream.producedEnd, addr + CACHE_LINE_SIZE);
+
+	// Start the consumers of this line once a full tile is out
+	if (stream.linesWritten >= streamTileLines) {
+		for(int i=0; i<out.size(); i++) {
+			uint32_t bit = 1u << gemDroid->gemdroid_flows.getEdge(app, out[i]).outPos;
+			if ((readers & bit) && !(stream.forwarded & bit)) {
+				stream.forwarded |= bit;
+				dispatchFrame(app, out[i], GemDroidFlowFrame(core_id, ip_id, stream.frameNum, stream.flowType));
+			}
 		}
-	} else if (senderIPType == IP_TYPE_GPU) {
-		if (!enqueueIPIPRequest(senderIPType, senderIPId, receiverCoreId, IP_TYPE_DC, DC1_ADDR_START + FRAME_SIZE, 4*FRAME_SIZE, true, frameNum, flowType, flowid1))
-			cout << "Dropper! IP GPU unable to inject a DC1 ip request" << endl;
 	}
 
+	// Consumers already waiting on this line get it straight from the producer
+	list<GemDroidFlowWaiter>::iterator it = stream.waiting.begin();
+	while (it != stream.waiting.end()) {
+		if (it->addr == addr && (readers & (1u << it->outPos))) {
+			readers &= ~(1u << it->outPos);
+			numStreamedReads++;
+			memResponse(addr, true, it->ipType, it->ipId);
+			it = stream.waiting.erase(it);
+		}
+		else
+			it++;
+	}
+
+	m5::hash_map<uint64_t, uint32_t>::iterator line = stream.lines.find(addr);
+	if (line != stream.lines.end()) {
+		// Same buffer, next frame: the line is overwritten in place
+		if (readers) {
+			line->second = readers;
+		}
+		else {
+			stream.lines.erase(line);
+			streamLinesUsed--;
+		}
+	}
+	else if (readers) {
+		if (streamLinesUsed >= streamBufferLines) {
+			numStreamSpills++;
+			return false;
+		}
+		stream.lines[addr] = readers;
+		streamLinesUsed++;
+	}
+
+	numStreamedWrites++;
+	memResponse(addr, false, ip_type, ip_id);
 	return true;
 }
 
+bool GemDroidSA::streamRead(int ip_type, int ip_id, int core_id, uint64_t addr)
+{
+	GemDroidIP *inst = gemDroid->ipTable[ip_type][ip_id];
+	int app = gemDroid->getAppId(core_id);
+	int edgeId = inst->getFlowId();
+
+	if (edgeId < 0 || edgeId >= gemDroid->gemdroid_flows.numEdges(app))
+		return false;
+
+	GemDroidFlowEdge &edge = gemDroid->gemdroid_flows.getEdge(app, edgeId);
+	if (edge.dst != ip_type || !edge.triggered || addr < edge.addr || addr >= edge.addr + edge.size)
+		return false;
+
+	GemDroidFlowStream &stream = streams[edge.src];
+	uint32_t bit = 1u << edge.outPos;
+
+	m5::hash_map<uint64_t, uint32_t>::iterator line = stream.lines.find(addr);
+	if (line != stream.lines.end() && (line->second & bit)) {
+		line->second &= ~bit;
+		if (line->second == 0) {
+			stream.lines.erase(line);
+			streamLinesUsed--;
+		}
+		numStreamedReads++;
+		memResponse(addr, true, ip_type, ip_id);
+		return true;
+	}
+
+	// Ahead of the producer: wait for the line rather than read it from DRAM
+	if (stream.open && stream.app == app && addr >= stream.producedEnd) {
+		numStreamWaits++;
+		stream.waiting.push_back(GemDroidFlowWaiter(ip_type, ip_id, core_id, addr, edge.outPos));
+		return true;
+	}
+
+	return false;
+}
+
+// Producer finished its frame: reads it never satisfied go to DRAM. Returns the out edges already started.
+uint32_t GemDroidSA::streamProducerDone(int ip_type)
+{
+	GemDroidFlowStream &stream = streams[ip_type];
+	uint32_t started = stream.forwarded;
+
+	if (!stream.open)
+		return 0;
+
+	list<GemDroidFlowWaiter>::iterator it;
+	for(it = stream.waiting.begin(); it != stream.waiting.end(); it++) {
+		numIPMemReqs++;
+		ipMemReq.push_back(GemDroidMemMsg(it->ipType, it->ipId, it->coreId, it->addr, true, false));
+	}
+	stream.waiting.clear();
+	stream.open = false;
+	stream.forwarded = 0;
+
+	return started;
+}
+
+// Consumer finished its frame: lines of this edge it did not read give their credit back
+void GemDroidSA::streamConsumerDone(int app, GemDroidFlowEdge &edge)
+{
+	GemDroidFlowStream &stream = streams[edge.src];
+	uint32_t bit = 1u << edge.outPos;
+
+	if (stream.app != app)
+		return;
+
+	m5::hash_map<uint64_t, uint32_t>::iterator line = stream.lines.begin();
+	while (line != stream.lines.end()) {
+		line->second &= ~bit;
+		if (line->second == 0) {
+			stream.lines.erase(line++);
+			streamLinesUsed--;
+		}
+		else
+			line++;
+	}
+}
+
 void GemDroidSA::memResponse(uint64_t addr, bool isRead, int sender_type, int sender_id)
 {
 	// int ip_type;
@@ -484,6 +676,10 @@ void GemDroidSA::memResponse(uint64_t addr, bool isRead, int sender_type, int se
 
 	GemDroidMemMsg response(sender_type, sender_id, 0, addr, isRead, true);
 
+	// SLC writebacks have no one waiting on them
+	if (sender_type == IP_TYPE_CACHE)
+		return;
+
 	// response for core
 	if (sender_type == IP_TYPE_CPU) {
 		// All CPU addresses are below 2GB
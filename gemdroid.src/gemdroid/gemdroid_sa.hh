@@ -33,6 +33,7 @@
 
 #include "base/statistics.hh"
 #include "gemdroid_request.hh"
+#include "gemdroid/gemdroid_flow.hh"
 
 using namespace std;
 
@@ -59,6 +60,19 @@ private:
 	void sendIPRequests();
 	void sendIPResponses();
 	bool enqueueIPIPRequest(int sendertype, int senderid, int core_id, int iptype, uint64_t addr, int size, bool isRead, int frameNum, int flowType, int flowId);
+	void dispatchFrame(int app, int edgeId, const GemDroidFlowFrame &frame);
+	void forwardFrame(int app, int edgeId, const GemDroidFlowFrame &frame);
+
+	// IP-to-IP streaming through an SA scratchpad, indexed by producer IP type
+	GemDroidFlowStream streams[IP_TYPE_END];
+	int streamBufferLines;	// scratchpad size in cache lines, 0 disables streaming
+	int streamTileLines;	// lines a producer writes before its consumers start
+	int streamLinesUsed;
+
+	bool streamWrite(int ip_type, int ip_id, int core_id, uint64_t addr);
+	bool streamRead(int ip_type, int ip_id, int core_id, uint64_t addr);
+	uint32_t streamProducerDone(int ip_type);
+	void streamConsumerDone(int app, GemDroidFlowEdge &edge);
 	void updateActivityCountIn1Ms(int activity_count = 1);
 	void process();
 	
@@ -79,6 +93,7 @@ public:
 	bool enqueueIPResponse(int senderIPType, int senderIPId, int receiverCoreId, int frameNum, int flowType, int flowId);
 	void memResponse(uint64_t addr, bool isRead, int sender_type, int sender_id);
 	bool isIPReqLimitReached(int ip_type);
+	void initStreaming(int bufferLines, int tileLines);
 
     Stats::Scalar ticks;
     Stats::Scalar numCoreMemReqs;
@@ -88,6 +103,11 @@ public:
     Stats::Scalar numIPCoreResponse;
     Stats::Scalar numMemIPResponse;
     Stats::Scalar numRejected;
+    Stats::Scalar numFlowStalls;
+    Stats::Scalar numStreamedWrites;
+    Stats::Scalar numStreamedReads;
+    Stats::Scalar numStreamSpills;
+    Stats::Scalar numStreamWaits;
 
 	long stats_ticks;
 	long stats_numCoreMemReqs;
@@ -0,0 +1,350 @@
+/**
+ * Copyright (c) 2016 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contact: Shulin Zhao (suz53@cse.psu.edu)
+*/
+
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+
+#include "gemdroid/gemdroid.hh"
+#include "gemdroid/gemdroid_slc.hh"
+
+string ipTypeToString(int type);
+
+GemDroidSLC::GemDroidSLC(GemDroid *gemDroid)
+{
+    this->gemDroid = gemDroid;
+    desc = "GemDroid.SLC";
+    ticks = 0;
+    numSets = 0;
+    numWays = 0;
+    hitLatency = 0;
+    streamThreshold = 0;
+
+    for(int i=0; i<IP_TYPE_END; i++) {
+        wayMask[i] = 0;
+        noAllocate[i] = false;
+        lastMissAddr[i] = 0;
+        seqMisses[i] = 0;
+        recentAccesses[i] = 0;
+        recentHits[i] = 0;
+        hits[i] = 0;
+        misses[i] = 0;
+        bypasses[i] = 0;
+        stats_hits[i] = 0;
+        stats_misses[i] = 0;
+    }
+    numWritebacks = 0;
+    dramAccessesSaved = 0;
+}
+
+void GemDroidSLC::init(int sizeKB, int ways, int hitLatency, string partition, string noAllocateTypes, int streamThreshold)
+{
+    if (sizeKB <= 0)
+        return;
+
+    if (ways <= 0 || ways > 32 || (sizeKB * 1024) % (ways * CACHE_LINE_SIZE) != 0) {
+        cout << "FATAL: SLC of " << sizeKB << "KB cannot be split into " << ways << " ways" << endl;
+        assert(0);
+    }
+
+    numWays = ways;
+    numSets = sizeKB * 1024 / (ways * CACHE_LINE_SIZE);
+    this->hitLatency = hitLatency;
+    this->streamThreshold = streamThreshold;
+
+    GemDroidSLCLine invalid;
+    invalid.tag = 0;
+    invalid.valid = false;
+    invalid.dirty = false;
+    invalid.owner = -1;
+    invalid.lastUse = 0;
+    lines.assign(numSets * numWays, invalid);
+
+    parsePartition(partition);
+    parseNoAllocate(noAllocateTypes);
+
+    cout << "Instantiated " << desc << ": " << sizeKB << "KB, " << numWays << " ways, " << numSets << " sets" << endl;
+}
+
+static int stringToIPType(string name)
+{
+    for(int i=0; i<IP_TYPE_END; i++)
+        if (ipTypeToString(i) == name)
+            return i;
+    return -1;
+}
+
+/*
+ * "GPU:4,DC:2" gives the GPU ways 0-3 and DC ways 4-5 to allocate in; the
+ * rest of the ways are shared by the sender types not listed.
+ */
+void GemDroidSLC::parsePartition(string partition)
+{
+    uint32_t allWays = (numWays == 32) ? 0xffffffff : ((1u << numWays) - 1);
+    uint32_t given = 0;
+    int nextWay = 0;
+    bool listed[IP_TYPE_END];
+
+    for(int i=0; i<IP_TYPE_END; i++)
+        listed[i] = false;
+
+    istringstream iss(partition);
+    string entry;
+    while (getline(iss, entry, ',')) {
+        if (entry == "")
+            continue;
+
+        size_t colon = entry.find(':');
+        int type = stringToIPType(entry.substr(0, colon));
+        int ways = (colon == string::npos) ? 0 : atoi(entry.substr(colon + 1).c_str());
+
+        if (type == -1 || ways <= 0 || nextWay + ways > numWays) {
+            cout << "FATAL: bad SLC way partition entry " << entry << endl;
+            assert(0);
+        }
+
+        wayMask[type] = 0;
+        for(int w=nextWay; w<nextWay+ways; w++)
+            wayMask[type] |= 1u << w;
+        nextWay += ways;
+        given |= wayMask[type];
+        listed[type] = true;
+    }
+
+    for(int i=0; i<IP_TYPE_END; i++) {
+        if (!listed[i])
+            wayMask[i] = allWays & ~given;
+        if (wayMask[i] == 0)
+            noAllocate[i] = true;
+    }
+}
+
+void GemDroidSLC::parseNoAllocate(string types)
+{
+    istringstream iss(types);
+    string name;
+
+    while (getline(iss, name, ',')) {
+        if (name == "")
+            continue;
+
+        int type = stringToIPType(name);
+        if (type == -1) {
+            cout << "FATAL: unknown sender type " << name << " in SLC no-allocate list" << endl;
+            assert(0);
+        }
+        noAllocate[type] = true;
+    }
+}
+
+void GemDroidSLC::regStats()
+{
+    for(int i=0; i<IP_TYPE_END; i++) {
+        string str = desc + "." + ipTypeToString(i);
+        hits[i].name(str + ".hits").desc("GemDroid SLC: Number of accesses that hit in the SLC").flags(Stats::display);
+        misses[i].name(str + ".misses").desc("GemDroid SLC: Number of accesses that went to DRAM").flags(Stats::display);
+        bypasses[i].name(str + ".bypasses").desc("GemDroid SLC: Number of misses not allocated because the sender was streaming").flags(Stats::display);
+    }
+    numWritebacks.name(desc + ".numWritebacks").desc("GemDroid SLC: Number of dirty lines written back to DRAM").flags(Stats::display);
+    dramAccessesSaved.name(desc + ".dramAccessesSaved").desc("GemDroid SLC: DRAM accesses avoided, net of writebacks").flags(Stats::display);
+}
+
+void GemDroidSLC::resetStats()
+{
+    for(int i=0; i<IP_TYPE_END; i++) {
+        hits[i] = 0;
+        misses[i] = 0;
+        bypasses[i] = 0;
+        stats_hits[i] = 0;
+        stats_misses[i] = 0;
+    }
+    numWritebacks = 0;
+    dramAccessesSaved = 0;
+}
+
+void GemDroidSLC::printPeriodicStats()
+{
+    if (!isEnabled())
+        return;
+
+    cout << desc << ".hitRate:";
+    for(int i=0; i<IP_TYPE_DMA; i++) {
+        long h = hits[i].value() - stats_hits[i];
+        long m = misses[i].value() - stats_misses[i];
+        cout << " " << ((h + m) ? (double) h / (h + m) : 0);
+        stats_hits[i] = hits[i].value();
+        stats_misses[i] = misses[i].value();
+    }
+    cout << endl;
+}
+
+int GemDroidSLC::findWay(int set, uint64_t tag)
+{
+    GemDroidSLCLine *way = &lines[set * numWays];
+
+    for(int w=0; w<numWays; w++)
+        if (way[w].valid && way[w].tag == tag)
+            return w;
+    return -1;
+}
+
+void GemDroidSLC::noteAccess(int type, bool hit)
+{
+    recentAccesses[type]++;
+    if (hit)
+        recentHits[type]++;
+
+    // Decay so the hit rate follows the current phase of the sender
+    if (recentAccesses[type] >= 1024) {
+        recentAccesses[type] /= 2;
+        recentHits[type] /= 2;
+    }
+}
+
+/*
+ * Streaming bypass: a sender walking through memory line by line and
+ * getting (almost) no hits is reading a buffer it will not touch again
+ * before it is evicted, so its misses are not allowed to push out lines
+ * other senders are reusing.
+ */
+bool GemDroidSLC::shouldAllocate(int type, uint64_t addr)
+{
+    // A write DRAM turned away comes back with the same address
+    bool retry = (addr == lastMissAddr[type]);
+
+    if (!retry) {
+        if (addr == lastMissAddr[type] + CACHE_LINE_SIZE)
+            seqMisses[type]++;
+        else
+            seqMisses[type] = 0;
+        lastMissAddr[type] = addr;
+    }
+
+    if (noAllocate[type])
+        return false;
+
+    if (streamThreshold > 0 && seqMisses[type] >= streamThreshold && recentHits[type] * 8 < recentAccesses[type]) {
+        if (!retry)
+            bypasses[type]++;
+        return false;
+    }
+
+    return true;
+}
+
+void GemDroidSLC::allocate(int type, uint64_t addr, bool dirty)
+{
+    uint64_t lineAddr = addr / CACHE_LINE_SIZE;
+    int set = lineAddr % numSets;
+    GemDroidSLCLine *way = &lines[set * numWays];
+    int victim = -1;
+
+    for(int w=0; w<numWays; w++) {
+        if (!(wayMask[type] & (1u << w)))
+            continue;
+        if (!way[w].valid) {
+            victim = w;
+            break;
+        }
+        if (victim == -1 || way[w].lastUse < way[victim].lastUse)
+            victim = w;
+    }
+    assert(victim != -1);
+
+    if (way[victim].valid && way[victim].dirty) {
+        writebacks.push_back((way[victim].tag * numSets + set) * CACHE_LINE_SIZE);
+        numWritebacks++;
+        dramAccessesSaved--;
+    }
+
+    way[victim].tag = lineAddr / numSets;
+    way[victim].valid = true;
+    way[victim].dirty = dirty;
+    way[victim].owner = type;
+    way[victim].lastUse = ticks;
+}
+
+int GemDroidSLC::access(int type, int id, uint64_t addr, bool isRead)
+{
+    uint64_t lineAddr = addr / CACHE_LINE_SIZE;
+    int set = lineAddr % numSets;
+    int w = findWay(set, lineAddr / numSets);
+
+    if (w != -1) {
+        GemDroidSLCLine &line = lines[set * numWays + w];
+        line.lastUse = ticks;
+        if (!isRead)
+            line.dirty = true;
+
+        hits[type]++;
+        dramAccessesSaved++;
+        noteAccess(type, true);
+        pendingHits.push_back(GemDroidSLCHit(ticks + hitLatency, type, id, addr, isRead));
+        return SLC_HIT;
+    }
+
+    // Write-allocate without a fill: the whole line is being written
+    if (!isRead && shouldAllocate(type, addr)) {
+        allocate(type, addr, true);
+
+        misses[type]++;
+        dramAccessesSaved++;
+        noteAccess(type, false);
+        pendingHits.push_back(GemDroidSLCHit(ticks + hitLatency, type, id, addr, isRead));
+        return SLC_ABSORBED;
+    }
+
+    return SLC_MISS;
+}
+
+// Reads are filled when the request goes out; the data comes back with the DRAM response
+void GemDroidSLC::missIssued(int type, uint64_t addr, bool isRead)
+{
+    misses[type]++;
+    noteAccess(type, false);
+
+    if (isRead && shouldAllocate(type, addr))
+        allocate(type, addr, false);
+}
+
+void GemDroidSLC::tick()
+{
+    ticks++;
+
+    while (!pendingHits.empty() && pendingHits.front().readyTick <= ticks) {
+        GemDroidSLCHit &hit = pendingHits.front();
+        gemDroid->gemdroid_sa.memResponse(hit.addr, hit.isRead, hit.ipType, hit.ipId);
+        pendingHits.pop_front();
+    }
+
+    if (!writebacks.empty() && gemDroid->gemdroid_memory.enqueueMemReq(IP_TYPE_CACHE, 0, 0, writebacks.front(), false))
+        writebacks.pop_front();
+}
@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2016 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Contact: Shulin Zhao (suz53@cse.psu.edu)
+*/
+
+
+#ifndef GEMDROID_SLC_HH_
+#define GEMDROID_SLC_HH_
+
+#include <stdint.h>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "gemdroid/gemdroid_defines.hh"
+
+using namespace std;
+
+class GemDroid;
+
+enum SLC_RESULT
+{
+    SLC_MISS = 0,
+    SLC_HIT,
+    SLC_ABSORBED    // write miss allocated dirty, DRAM never sees it
+};
+
+struct GemDroidSLCLine
+{
+    uint64_t tag;
+    bool valid;
+    bool dirty;
+    int owner;      // sender type that allocated the line
+    long lastUse;
+};
+
+// A hit waiting out the SLC access latency before it goes back to the SA
+struct GemDroidSLCHit
+{
+    long readyTick;
+    int ipType;
+    int ipId;
+    uint64_t addr;
+    bool isRead;
+
+    GemDroidSLCHit(long readyTick, int ipType, int ipId, uint64_t addr, bool isRead) { this->readyTick = readyTick; this->ipType = ipType; this->ipId = ipId; this->addr = addr; this->isRead = isRead; }
+};
+
+/*
+ * System-level cache shared by the cores and IPs, sitting between the SA
+ * and DRAM. Write-back, LRU within the ways a sender type may allocate in.
+ * Lookups search every way; way partitioning and the allocate policy only
+ * restrict where (and whether) a miss is filled. Dirty victims are written
+ * back to DRAM as IP_TYPE_CACHE requests.
+ */
+class GemDroidSLC
+{
+private:
+    string desc;
+    GemDroid *gemDroid;
+    long ticks;
+
+    int numSets;
+    int numWays;
+    int hitLatency;         // SA cycles
+    int streamThreshold;    // sequential misses before a sender bypasses, 0 = never
+
+    vector<GemDroidSLCLine> lines;
+    uint32_t wayMask[IP_TYPE_END];
+    bool noAllocate[IP_TYPE_END];
+
+    // Streaming-bypass detector, per sender type
+    uint64_t lastMissAddr[IP_TYPE_END];
+    int seqMisses[IP_TYPE_END];
+    int recentAccesses[IP_TYPE_END];
+    int recentHits[IP_TYPE_END];
+
+    list<GemDroidSLCHit> pendingHits;
+    list<uint64_t> writebacks;
+
+    int findWay(int set, uint64_t tag);
+    bool shouldAllocate(int type, uint64_t addr);
+    void allocate(int type, uint64_t addr, bool dirty);
+    void noteAccess(int type, bool hit);
+    void parsePartition(string partition);
+    void parseNoAllocate(string types);
+
+public:
+    GemDroidSLC(GemDroid *gemDroid);
+    void init(int sizeKB, int ways, int hitLatency, string partition, string noAllocateTypes, int streamThreshold);
+    void tick();
+    void regStats();
+    void resetStats();
+    void printPeriodicStats();
+
+    inline bool isEnabled() { return numSets > 0; }
+
+    // SLC_HIT or SLC_ABSORBED: the SLC answers; SLC_MISS: send it to DRAM
+    int access(int type, int id, uint64_t addr, bool isRead);
+    // A miss was accepted by DRAM
+    void missIssued(int type, uint64_t addr, bool isRead);
+
+    Stats::Scalar hits[IP_TYPE_END];
+    Stats::Scalar misses[IP_TYPE_END];
+    Stats::Scalar bypasses[IP_TYPE_END];
+    Stats::Scalar numWritebacks;
+    Stats::Scalar dramAccessesSaved;
+
+    long stats_hits[IP_TYPE_END];
+    long stats_misses[IP_TYPE_END];
+};
+
+#endif /* GEMDROID_SLC_HH_ */
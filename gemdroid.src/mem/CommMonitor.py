@@ -110,3 +110,19 @@ class CommMonitor(MemObject):
     read_addr_mask = Param.Addr(MaxAddr, "Address mask for read address")
     write_addr_mask = Param.Addr(MaxAddr, "Address mask for write address")
     disable_addr_dists = Param.Bool(True, "Disable address distributions")
+
+    # streaming stats for long runs, all in a fixed amount of memory:
+    # read/write latency percentiles from log-linear sketches, the
+    # bandwidth of the most recent sample periods, and the number of
+    # accesses to each of a set of equally sized address regions
+    stream_enable = Param.Bool(False, "Enable the streaming stats")
+    stream_latency_precision = Param.Unsigned(7, "Latency sketch precision " \
+                                                  "in bits, 7 is within 2%")
+    stream_latency_max = Param.Latency('1ms', "Highest latency told apart " \
+                                           "in the sketches")
+    stream_bandwidth_windows = Param.Unsigned(64, "# sample periods in " \
+                                                  "the bandwidth series")
+    stream_heat_map_base = Param.Addr(0, "Start of the heat map regions")
+    stream_heat_map_region_size = Param.MemorySize('1MB', "Size of a heat " \
+                                                       "map region")
+    stream_heat_map_regions = Param.Unsigned(256, "# heat map regions")
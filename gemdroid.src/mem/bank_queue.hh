@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2014 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Per bank index of a memory controller queue for FR-FCFS scheduling.
+ */
+
+#ifndef __MEM_BANK_QUEUE_HH__
+#define __MEM_BANK_QUEUE_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "base/types.hh"
+
+/**
+ * Index of the requests in a memory controller queue by bank and row,
+ * kept next to the queue itself. Every request gets an arrival number,
+ * and each bank keeps its requests in arrival order, overall and per
+ * row. FR-FCFS then only looks at the head of each bank: the oldest
+ * row hit is the oldest request for the open row of some bank, and the
+ * oldest request to a bank that can activate first is the head of that
+ * bank. Picking a request is O(banks) whatever the queue depth.
+ *
+ * The controller tells it the state of the banks through an object
+ * with two methods:
+ *   uint32_t openRow(unsigned bank) const;
+ *   Tick actAt(unsigned bank) const;
+ * where actAt is the tick the bank can issue an activate.
+ *
+ * Nothing in here is specific to the gem5 DRAM controller, the
+ * requests are only stored and returned.
+ */
+template <class T>
+class BankQueue
+{
+  public:
+    BankQueue() : nextSeq(0), entries(0) { }
+
+    void
+    init(unsigned num_banks)
+    {
+        assert(entries == 0);
+        banks.clear();
+        banks.resize(num_banks);
+    }
+
+    unsigned size() const { return entries; }
+    bool empty() const { return entries == 0; }
+
+    /** Requests waiting for a bank. */
+    unsigned
+    bankSize(unsigned bank) const
+    {
+        return banks[bank].all.size();
+    }
+
+    /** Requests waiting for a row of a bank. */
+    unsigned
+    rowSize(unsigned bank, uint32_t row) const
+    {
+        typename RowMap::const_iterator r = banks[bank].rows.find(row);
+        return r == banks[bank].rows.end() ? 0 : r->second.size();
+    }
+
+    /** Add a request at the tail of the queue. */
+    void
+    push(T *t, unsigned bank, uint32_t row)
+    {
+        Entry entry = { nextSeq++, t };
+        banks[bank].all.push_back(entry);
+        banks[bank].rows[row].push_back(entry);
+        ++entries;
+    }
+
+    /** Remove a request, wherever it is in the queue. */
+    void
+    remove(T *t, unsigned bank, uint32_t row)
+    {
+        BankEntries &b = banks[bank];
+        typename RowMap::iterator r = b.rows.find(row);
+        assert(r != b.rows.end());
+
+        erase(b.all, t);
+        erase(r->second, t);
+        if (r->second.empty())
+            b.rows.erase(r);
+        --entries;
+    }
+
+    /**
+     * FR-FCFS: the oldest request that hits in an open row, otherwise
+     * the oldest request to a bank that is ready to activate or is one
+     * of the first ones to be.
+     *
+     * @param state Open rows and activate times of the banks
+     * @param now The current tick
+     * @return The request to serve next, NULL if the queue is empty
+     */
+    template <class BankState>
+    T *
+    selectFRFCFS(const BankState &state, Tick now) const
+    {
+        const Entry *hit = NULL;
+        const Entry *oldest = NULL;
+        Tick min_act_at = MaxTick;
+
+        for (unsigned i = 0; i < banks.size(); ++i) {
+            const BankEntries &b = banks[i];
+            if (b.all.empty())
+                continue;
+
+            if (!oldest || b.all.front().seq < oldest->seq)
+                oldest = &b.all.front();
+
+            typename RowMap::const_iterator r =
+                b.rows.find(state.openRow(i));
+            if (r != b.rows.end() &&
+                (!hit || r->second.front().seq < hit->seq))
+                hit = &r->second.front();
+
+            min_act_at = std::min(min_act_at, state.actAt(i));
+        }
+
+        if (hit)
+            return hit->item;
+        if (!oldest)
+            return NULL;
+
+        // No row hits, go for the first request to a ready bank or to
+        // one of the banks that can activate first
+        const Entry *ready = NULL;
+        for (unsigned i = 0; i < banks.size(); ++i) {
+            const BankEntries &b = banks[i];
+            if (b.all.empty())
+                continue;
+
+            Tick act_at = state.actAt(i);
+            if ((act_at <= now || act_at == min_act_at) &&
+                (!ready || b.all.front().seq < ready->seq))
+                ready = &b.all.front();
+        }
+
+        return ready ? ready->item : oldest->item;
+    }
+
+  private:
+    struct Entry
+    {
+        uint64_t seq;
+        T *item;
+    };
+
+    typedef std::deque<Entry> Entries;
+    typedef std::unordered_map<uint32_t, Entries> RowMap;
+
+    struct BankEntries
+    {
+        /** All requests to the bank, in arrival order. */
+        Entries all;
+        /** The same requests by row. */
+        RowMap rows;
+    };
+
+    static void
+    erase(Entries &list, T *t)
+    {
+        // Requests normally leave from the head
+        for (typename Entries::iterator e = list.begin(); e != list.end();
+             ++e) {
+            if (e->item == t) {
+                list.erase(e);
+                return;
+            }
+        }
+        assert(false);
+    }
+
+    std::vector<BankEntries> banks;
+    uint64_t nextSeq;
+    unsigned entries;
+};
+
+#endif // __MEM_BANK_QUEUE_HH__
@@ -72,3 +72,6 @@ class BaseCache(MemObject):
     sequential_access = Param.Bool(False,
         "Whether to access tags and data sequentially")
     tags = Param.BaseTags(LRU(), "Tag Store for LRU caches")
+    checkpoint_contents = Param.Bool(False,
+        "Save the tags, state and data of the cache in checkpoints, so "
+        "a restored run starts with warm caches")
@@ -1819,7 +1819,8 @@ template<class TagStore>
 void
 Cache<TagStore>::serialize(std::ostream &os)
 {
-    bool dirty(isDirty());
+    // Dirty data is only lost if the tag store does not save it
+    bool dirty(isDirty() && !tags->checkpointsContents());
 
     if (dirty) {
         warn("*** The cache still contains dirty data. ***\n");
@@ -1828,10 +1829,10 @@ Cache<TagStore>::serialize(std::ostream &os)
              "the cache will be lost!\n");
     }
 
-    // Since we don't checkpoint the data in the cache, any dirty data
-    // will be lost when restoring from a checkpoint of a system that
-    // wasn't drained properly. Flag the checkpoint as invalid if the
-    // cache contains dirty data.
+    // Unless checkpoint_contents is set we don't checkpoint the data
+    // in the cache, so any dirty data will be lost when restoring from
+    // a checkpoint of a system that wasn't drained properly. Flag the
+    // checkpoint as invalid if the cache contains dirty data.
     bool bad_checkpoint(dirty);
     SERIALIZE_SCALAR(bad_checkpoint);
 }
@@ -78,6 +78,23 @@ class StridePrefetcher(BasePrefetcher):
     type = 'StridePrefetcher'
     cxx_class = 'StridePrefetcher'
     cxx_header = "mem/cache/prefetch/stride.hh"
+    table_sets = Param.Unsigned(64,
+         "Number of sets of the PC table of each context")
+    table_assoc = Param.Unsigned(4,
+         "Associativity of the PC table of each context")
+
+class SpatialPrefetcher(BasePrefetcher):
+    type = 'SpatialPrefetcher'
+    cxx_class = 'SpatialPrefetcher'
+    cxx_header = "mem/cache/prefetch/spatial.hh"
+    region_size = Param.MemorySize('2kB',
+         "Size of the regions patterns are learnt over (at most 64 blocks)")
+    agt_entries = Param.Unsigned(64,
+         "Number of regions recorded at a time")
+    pht_sets = Param.Unsigned(256,
+         "Number of sets of the pattern history table")
+    pht_assoc = Param.Unsigned(8,
+         "Associativity of the pattern history table")
 
 class TaggedPrefetcher(BasePrefetcher):
     type = 'TaggedPrefetcher'
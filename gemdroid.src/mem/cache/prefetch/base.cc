@@ -238,20 +238,18 @@ BasePrefetcher::notify(PacketPtr &pkt, Tick tick)
         }
 
 
-        std::list<Addr> addresses;
-        std::list<Cycles> delays;
-        calculatePrefetch(pkt, addresses, delays);
+        candidates.clear();
+        calculatePrefetch(pkt, candidates);
 
-        std::list<Addr>::iterator addrIter = addresses.begin();
-        std::list<Cycles>::iterator delayIter = delays.begin();
-        for (; addrIter != addresses.end(); ++addrIter, ++delayIter) {
-            Addr addr = *addrIter;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            Addr addr = candidates[i].addr;
+            Cycles delay = candidates[i].delay;
 
             pfIdentified++;
 
             DPRINTF(HWPrefetch, "Found a pf candidate addr: 0x%x, "
                     "inserting into prefetch queue with delay %d time %d\n",
-                    addr, *delayIter, time);
+                    addr, delay, time);
 
             // Check if it is already in the pf buffer
             if (inPrefetch(addr, is_secure) != pf.end()) {
@@ -261,7 +259,7 @@ BasePrefetcher::notify(PacketPtr &pkt, Tick tick)
             }
 
             // create a prefetch memreq
-            Request *prefetchReq = new Request(*addrIter, blkSize, 0, masterId);
+            Request *prefetchReq = new Request(addr, blkSize, 0, masterId);
             if (is_secure)
                 prefetchReq->setFlags(Request::SECURE);
             prefetchReq->taskId(ContextSwitchTaskId::Prefetcher);
@@ -287,7 +285,7 @@ BasePrefetcher::notify(PacketPtr &pkt, Tick tick)
                 pf.pop_front();
             }
 
-            pf.push_back(DeferredPacket(tick + clockPeriod() * *delayIter,
+            pf.push_back(DeferredPacket(tick + clockPeriod() * delay,
                                         prefetch));
         }
     }
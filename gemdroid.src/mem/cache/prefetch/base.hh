@@ -49,6 +49,7 @@
 #define __MEM_CACHE_PREFETCH_BASE_PREFETCHER_HH__
 
 #include <list>
+#include <vector>
 
 #include "base/statistics.hh"
 #include "mem/packet.hh"
@@ -57,6 +58,36 @@
 
 class BaseCache;
 
+/**
+ * Prefetch candidates found on an access, in the order to issue them.
+ * The prefetcher keeps one and clears it on every access, so after
+ * warm-up adding candidates does not allocate.
+ */
+class PrefetchCandidates
+{
+  public:
+    struct Candidate
+    {
+        Addr addr;
+        Cycles delay;
+    };
+
+    void
+    push_back(Addr addr, Cycles delay)
+    {
+        Candidate c = { addr, delay };
+        entries.push_back(c);
+    }
+
+    void clear() { entries.clear(); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    const Candidate &operator[](size_t i) const { return entries[i]; }
+
+  private:
+    std::vector<Candidate> entries;
+};
+
 class BasePrefetcher : public ClockedObject
 {
   protected:
@@ -118,6 +149,9 @@ class BasePrefetcher : public ClockedObject
     /** Request id for prefetches */
     MasterID masterId;
 
+    /** Candidates of the current access, reused across accesses */
+    PrefetchCandidates candidates;
+
   public:
 
     Stats::Scalar pfIdentified;
@@ -138,7 +172,7 @@ class BasePrefetcher : public ClockedObject
 
     virtual ~BasePrefetcher() {}
 
-    void setCache(BaseCache *_cache);
+    virtual void setCache(BaseCache *_cache);
 
     /**
      * Notify prefetcher of cache access (may be any access or just
@@ -163,9 +197,13 @@ class BasePrefetcher : public ClockedObject
         return pf.empty() ? MaxTick : pf.front().tick;
     }
 
+    /**
+     * Find the addresses to prefetch on an access.
+     * @param pkt The access
+     * @param candidates Empty on entry, filled with the prefetches
+     */
     virtual void calculatePrefetch(PacketPtr &pkt,
-                                   std::list<Addr> &addresses,
-                                   std::list<Cycles> &delays) = 0;
+                                   PrefetchCandidates &candidates) = 0;
 
     std::list<DeferredPacket>::iterator inPrefetch(Addr address, bool is_secure);
 
@@ -51,8 +51,8 @@
 #include "mem/cache/prefetch/ghb.hh"
 
 void
-GHBPrefetcher::calculatePrefetch(PacketPtr &pkt, std::list<Addr> &addresses,
-                                 std::list<Cycles> &delays)
+GHBPrefetcher::calculatePrefetch(PacketPtr &pkt,
+                                 PrefetchCandidates &candidates)
 {
     Addr blk_addr = pkt->getAddr() & ~(Addr)(blkSize-1);
     bool is_secure = pkt->isSecure();
@@ -82,8 +82,7 @@ GHBPrefetcher::calculatePrefetch(PacketPtr &pkt, std::list<Addr> &addresses,
                 pfSpanPage += degree - d + 1;
                 return;
             } else {
-                addresses.push_back(new_addr);
-                delays.push_back(latency);
+                candidates.push_back(new_addr, latency);
             }
         }
     }
@@ -70,8 +70,7 @@ class GHBPrefetcher : public BasePrefetcher
 
     ~GHBPrefetcher() {}
 
-    void calculatePrefetch(PacketPtr &pkt, std::list<Addr> &addresses,
-                           std::list<Cycles> &delays);
+    void calculatePrefetch(PacketPtr &pkt, PrefetchCandidates &candidates);
 };
 
 #endif // __MEM_CACHE_PREFETCH_GHB_PREFETCHER_HH__
@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2014 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Spatial pattern prefetcher definitions.
+ */
+
+#include "base/bitfield.hh"
+#include "base/intmath.hh"
+#include "base/misc.hh"
+#include "base/trace.hh"
+#include "debug/HWPrefetch.hh"
+#include "mem/cache/prefetch/spatial.hh"
+
+SpatialPrefetcher::SpatialPrefetcher(const Params *p)
+    : BasePrefetcher(p), agt(p->agt_entries), pht(p->pht_sets * p->pht_assoc),
+      regionSize(p->region_size), phtSets(p->pht_sets),
+      phtAssoc(p->pht_assoc), regionBlocks(0), useCount(0)
+{
+    fatal_if(!isPowerOf2(regionSize), "%s: region_size must be a power "
+             "of 2\n", name());
+    fatal_if(!isPowerOf2(phtSets), "%s: pht_sets must be a power of 2\n",
+             name());
+    fatal_if(agt.empty() || phtAssoc == 0, "%s: empty tables\n", name());
+
+    for (size_t i = 0; i < agt.size(); i++)
+        agt[i].valid = false;
+    for (size_t i = 0; i < pht.size(); i++)
+        pht[i].valid = false;
+}
+
+void
+SpatialPrefetcher::setCache(BaseCache *_cache)
+{
+    BasePrefetcher::setCache(_cache);
+
+    regionBlocks = regionSize / blkSize;
+    fatal_if(regionBlocks == 0 || regionBlocks > 64,
+             "%s: region of %d bytes has %d blocks, 1 to 64 supported\n",
+             name(), regionSize, regionBlocks);
+}
+
+uint64_t
+SpatialPrefetcher::longEvent(MasterID master_id, Addr pc, Addr addr) const
+{
+    return (pc << 16) ^ (addr / blkSize) ^ ((uint64_t)master_id << 56);
+}
+
+uint64_t
+SpatialPrefetcher::shortEvent(MasterID master_id, Addr pc,
+                              unsigned offset) const
+{
+    return (pc << 6) ^ offset ^ ((uint64_t)master_id << 56);
+}
+
+void
+SpatialPrefetcher::commit(const AGTEntry &entry)
+{
+    // A region with a single block has nothing to prefetch
+    if (popCount(entry.pattern) < 2)
+        return;
+
+    uint64_t short_tag = shortEvent(entry.masterId, entry.pc, entry.offset);
+    uint64_t long_tag = longEvent(entry.masterId, entry.pc,
+                                  entry.region + entry.offset * blkSize);
+    unsigned set = (short_tag ^ (short_tag >> 17)) & (phtSets - 1);
+    PHTEntry *ways = &pht[set * phtAssoc];
+
+    PHTEntry *victim = &ways[0];
+    for (unsigned w = 0; w < phtAssoc; w++) {
+        if (ways[w].valid && ways[w].longTag == long_tag) {
+            victim = &ways[w];
+            break;
+        }
+        if (!ways[w].valid)
+            victim = &ways[w];
+        else if (victim->valid && ways[w].lastUse < victim->lastUse)
+            victim = &ways[w];
+    }
+
+    DPRINTF(HWPrefetch, "pattern %#x of region %x stored for PC %x\n",
+            entry.pattern, entry.region, entry.pc);
+
+    victim->valid = true;
+    victim->longTag = long_tag;
+    victim->shortTag = short_tag;
+    victim->pattern = entry.pattern;
+    victim->lastUse = ++useCount;
+}
+
+uint64_t
+SpatialPrefetcher::predict(MasterID master_id, Addr pc, Addr addr,
+                           unsigned offset)
+{
+    uint64_t short_tag = shortEvent(master_id, pc, offset);
+    uint64_t long_tag = longEvent(master_id, pc, addr);
+    unsigned set = (short_tag ^ (short_tag >> 17)) & (phtSets - 1);
+    PHTEntry *ways = &pht[set * phtAssoc];
+
+    // The exact event wins, otherwise the latest pattern of the PC and
+    // offset
+    PHTEntry *short_match = NULL;
+    for (unsigned w = 0; w < phtAssoc; w++) {
+        if (!ways[w].valid || ways[w].shortTag != short_tag)
+            continue;
+        if (ways[w].longTag == long_tag) {
+            ways[w].lastUse = ++useCount;
+            phtLongHits++;
+            return ways[w].pattern;
+        }
+        if (!short_match || ways[w].lastUse > short_match->lastUse)
+            short_match = &ways[w];
+    }
+
+    if (short_match) {
+        short_match->lastUse = ++useCount;
+        phtShortHits++;
+        return short_match->pattern;
+    }
+
+    phtMisses++;
+    return 0;
+}
+
+void
+SpatialPrefetcher::calculatePrefetch(PacketPtr &pkt,
+                                     PrefetchCandidates &candidates)
+{
+    if (!pkt->req->hasPC()) {
+        DPRINTF(HWPrefetch, "ignoring request with no PC");
+        return;
+    }
+
+    Addr data_addr = pkt->getAddr();
+    bool is_secure = pkt->isSecure();
+    MasterID master_id = useMasterId ? pkt->req->masterId() : 0;
+    Addr pc = pkt->req->getPC();
+
+    Addr region = data_addr & ~(regionSize - 1);
+    unsigned offset = (data_addr - region) / blkSize;
+
+    // Accesses to a live region only add to its pattern
+    AGTEntry *lru = &agt[0];
+    for (size_t i = 0; i < agt.size(); i++) {
+        AGTEntry &entry = agt[i];
+        if (entry.valid && entry.region == region &&
+            entry.isSecure == is_secure) {
+            entry.pattern |= ULL(1) << offset;
+            entry.lastUse = ++useCount;
+            return;
+        }
+        if (!entry.valid)
+            lru = &entry;
+        else if (lru->valid && entry.lastUse < lru->lastUse)
+            lru = &entry;
+    }
+
+    // First access to the region, record it from here on
+    if (lru->valid)
+        commit(*lru);
+
+    lru->valid = true;
+    lru->region = region;
+    lru->isSecure = is_secure;
+    lru->masterId = master_id;
+    lru->pc = pc;
+    lru->offset = offset;
+    lru->pattern = ULL(1) << offset;
+    lru->lastUse = ++useCount;
+
+    uint64_t pattern = predict(master_id, pc, data_addr, offset);
+    pattern &= ~(ULL(1) << offset);
+
+    DPRINTF(HWPrefetch, "trigger: PC %x data_addr %x (%s) pattern %#x\n",
+            pc, data_addr, is_secure ? "s" : "ns", pattern);
+
+    while (pattern) {
+        unsigned blk = findLsbSet(pattern);
+        pattern &= pattern - 1;
+
+        Addr new_addr = region + blk * blkSize;
+        if (pageStop && !samePage(data_addr, new_addr)) {
+            pfSpanPage++;
+            continue;
+        }
+        candidates.push_back(new_addr, latency);
+    }
+}
+
+void
+SpatialPrefetcher::regStats()
+{
+    BasePrefetcher::regStats();
+
+    phtLongHits
+        .name(name() + ".prefetcher.pht_long_hits")
+        .desc("number of triggers matching a PC and address pattern")
+        ;
+
+    phtShortHits
+        .name(name() + ".prefetcher.pht_short_hits")
+        .desc("number of triggers matching a PC and offset pattern")
+        ;
+
+    phtMisses
+        .name(name() + ".prefetcher.pht_misses")
+        .desc("number of triggers without a pattern")
+        ;
+}
+
+
+SpatialPrefetcher*
+SpatialPrefetcherParams::create()
+{
+   return new SpatialPrefetcher(this);
+}
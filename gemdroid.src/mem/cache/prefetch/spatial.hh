@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2014 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * Describes a spatial pattern prefetcher.
+ */
+
+#ifndef __MEM_CACHE_PREFETCH_SPATIAL_PREFETCHER_HH__
+#define __MEM_CACHE_PREFETCH_SPATIAL_PREFETCHER_HH__
+
+#include <vector>
+
+#include "mem/cache/prefetch/base.hh"
+#include "params/SpatialPrefetcher.hh"
+
+/**
+ * Learns which blocks of a memory region are used together and fetches
+ * them all on the first access to the region, in the style of spatial
+ * memory streaming and Bingo.
+ *
+ * While a region is live in the accumulation table it collects a bit
+ * per block touched. When the region leaves the table its pattern is
+ * stored in the pattern history table, under the event that started
+ * it: the PC and the address of the trigger access (long event), and
+ * the PC and the block offset in the region (short event). The next
+ * trigger looks for the long event first, which is exact but rarely
+ * repeats, and falls back to the short event otherwise.
+ */
+class SpatialPrefetcher : public BasePrefetcher
+{
+  protected:
+
+    /** A region being recorded */
+    class AGTEntry
+    {
+      public:
+        Addr region;
+        bool valid;
+        bool isSecure;
+        MasterID masterId;
+        Addr pc;
+        unsigned offset;
+        uint64_t pattern;
+        uint64_t lastUse;
+    };
+
+    /** A learnt pattern */
+    class PHTEntry
+    {
+      public:
+        bool valid;
+        /** PC and trigger address */
+        uint64_t longTag;
+        /** PC and trigger offset, which also gives the set */
+        uint64_t shortTag;
+        uint64_t pattern;
+        uint64_t lastUse;
+    };
+
+    std::vector<AGTEntry> agt;
+
+    /** Pattern history table, set by set */
+    std::vector<PHTEntry> pht;
+
+    const Addr regionSize;
+    const unsigned phtSets;
+    const unsigned phtAssoc;
+
+    /** Blocks per region, known once the cache is */
+    unsigned regionBlocks;
+
+    /** Time stamp for the LRU of both tables */
+    uint64_t useCount;
+
+    uint64_t longEvent(MasterID master_id, Addr pc, Addr addr) const;
+    uint64_t shortEvent(MasterID master_id, Addr pc, unsigned offset) const;
+
+    /** Store the pattern of a region that leaves the AGT */
+    void commit(const AGTEntry &entry);
+
+    /**
+     * Find the pattern for a trigger access.
+     * @return The pattern, 0 if there is none
+     */
+    uint64_t predict(MasterID master_id, Addr pc, Addr addr,
+                     unsigned offset);
+
+    Stats::Scalar phtLongHits;
+    Stats::Scalar phtShortHits;
+    Stats::Scalar phtMisses;
+
+  public:
+    typedef SpatialPrefetcherParams Params;
+
+    SpatialPrefetcher(const Params *p);
+
+    ~SpatialPrefetcher() {}
+
+    void setCache(BaseCache *_cache);
+
+    void regStats();
+
+    void calculatePrefetch(PacketPtr &pkt, PrefetchCandidates &candidates);
+};
+
+#endif // __MEM_CACHE_PREFETCH_SPATIAL_PREFETCHER_HH__
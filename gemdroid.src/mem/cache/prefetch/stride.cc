@@ -46,13 +46,77 @@
  * Stride Prefetcher template instantiations.
  */
 
+#include "base/bitfield.hh"
+#include "base/intmath.hh"
+#include "base/misc.hh"
 #include "base/trace.hh"
 #include "debug/HWPrefetch.hh"
 #include "mem/cache/prefetch/stride.hh"
 
+StridePrefetcher::StridePrefetcher(const Params *p)
+    : BasePrefetcher(p), tables(Max_Contexts, NULL),
+      tableSets(p->table_sets), tableAssoc(p->table_assoc),
+      instTagged(p->inst_tagged)
+{
+    fatal_if(!isPowerOf2(tableSets), "%s: table_sets must be a power of 2\n",
+             name());
+    fatal_if(tableAssoc == 0 || tableAssoc > 64,
+             "%s: table_assoc must be between 1 and 64\n", name());
+}
+
+StridePrefetcher::~StridePrefetcher()
+{
+    for (int i = 0; i < Max_Contexts; i++)
+        delete tables[i];
+}
+
+unsigned
+StridePrefetcher::setBase(Addr pc) const
+{
+    // Fold the upper PC bits in, instructions are at least 2 bytes
+    // apart so the bottom bit carries nothing
+    Addr hash = (pc >> 1) ^ (pc >> 13) ^ (pc >> 25);
+    return (hash & (tableSets - 1)) * tableAssoc;
+}
+
+int
+StridePrefetcher::lookup(const StrideTable &tab, unsigned base, Addr pc,
+                         bool is_secure) const
+{
+    // Compare all the ways without branching, then pick the matches
+    const Addr *pcs = &tab.pcs[base];
+    uint64_t match = 0;
+    for (unsigned w = 0; w < tableAssoc; w++)
+        match |= uint64_t(pcs[w] == pc) << w;
+
+    while (match) {
+        unsigned w = findLsbSet(match);
+        const StrideEntry &entry = tab.entries[base + w];
+        // Entries have to match on the security state as well
+        if (entry.valid && entry.isSecure == is_secure)
+            return base + w;
+        match &= match - 1;
+    }
+
+    return -1;
+}
+
+unsigned
+StridePrefetcher::victim(const StrideTable &tab, unsigned base) const
+{
+    unsigned min_pos = base;
+    for (unsigned i = base; i < base + tableAssoc; i++) {
+        if (!tab.entries[i].valid)
+            return i;
+        if (tab.entries[i].confidence < tab.entries[min_pos].confidence)
+            min_pos = i;
+    }
+    return min_pos;
+}
+
 void
-StridePrefetcher::calculatePrefetch(PacketPtr &pkt, std::list<Addr> &addresses,
-                                    std::list<Cycles> &delays)
+StridePrefetcher::calculatePrefetch(PacketPtr &pkt,
+                                    PrefetchCandidates &candidates)
 {
     if (!pkt->req->hasPC()) {
         DPRINTF(HWPrefetch, "ignoring request with no PC");
@@ -64,7 +128,6 @@ StridePrefetcher::calculatePrefetch(PacketPtr &pkt, std::list<Addr> &addresses,
     MasterID master_id = useMasterId ? pkt->req->masterId() : 0;
     Addr pc = pkt->req->getPC();
     assert(master_id < Max_Contexts);
-    std::list<StrideEntry*> &tab = table[master_id];
 
     // Revert to simple N-block ahead prefetch for instruction fetches
     if (instTagged && pkt->req->isInstFetch()) {
@@ -77,53 +140,51 @@ StridePrefetcher::calculatePrefetch(PacketPtr &pkt, std::list<Addr> &addresses,
             }
             DPRINTF(HWPrefetch, "queuing prefetch to %x @ %d\n",
                     new_addr, latency);
-            addresses.push_back(new_addr);
-            delays.push_back(latency);
+            candidates.push_back(new_addr, latency);
         }
         return;
     }
 
-    /* Scan Table for instAddr Match */
-    std::list<StrideEntry*>::iterator iter;
-    for (iter = tab.begin(); iter != tab.end(); iter++) {
-        // Entries have to match on the security state as well
-        if ((*iter)->instAddr == pc && (*iter)->isSecure == is_secure)
-            break;
-    }
+    if (!tables[master_id])
+        tables[master_id] = new StrideTable(tableSets, tableAssoc);
+    StrideTable &tab = *tables[master_id];
 
-    if (iter != tab.end()) {
+    unsigned base = setBase(pc);
+    int idx = lookup(tab, base, pc, is_secure);
+
+    if (idx >= 0) {
         // Hit in table
+        StrideEntry &entry = tab.entries[idx];
 
-        int new_stride = data_addr - (*iter)->missAddr;
-        bool stride_match = (new_stride == (*iter)->stride);
+        int new_stride = data_addr - entry.missAddr;
+        bool stride_match = (new_stride == entry.stride);
 
         if (stride_match && new_stride != 0) {
-            (*iter)->tolerance = true;
-            if ((*iter)->confidence < Max_Conf)
-                (*iter)->confidence++;
+            entry.tolerance = true;
+            if (entry.confidence < Max_Conf)
+                entry.confidence++;
         } else {
-            if (!((*iter)->tolerance)) {
-                (*iter)->stride = new_stride;
-                if ((*iter)->confidence > Min_Conf)
-                    (*iter)->confidence = 0;
+            if (!entry.tolerance) {
+                entry.stride = new_stride;
+                if (entry.confidence > Min_Conf)
+                    entry.confidence = 0;
             } else {
-                (*iter)->tolerance = false;
+                entry.tolerance = false;
             }
         }
 
         DPRINTF(HWPrefetch, "hit: PC %x data_addr %x (%s) stride %d (%s), "
                 "conf %d\n", pc, data_addr, is_secure ? "s" : "ns", new_stride,
                 stride_match ? "match" : "change",
-                (*iter)->confidence);
+                entry.confidence);
 
-        (*iter)->missAddr = data_addr;
-        (*iter)->isSecure = is_secure;
+        entry.missAddr = data_addr;
 
-        if ((*iter)->confidence <= 0)
+        if (entry.confidence <= 0)
             return;
 
         for (int d = 1; d <= degree; d++) {
-            Addr new_addr = data_addr + d * (*iter)->stride;
+            Addr new_addr = data_addr + d * entry.stride;
             if (pageStop && !samePage(data_addr, new_addr)) {
                 // Spanned the page, so now stop
                 pfSpanPage += degree - d + 1;
@@ -131,42 +192,30 @@ StridePrefetcher::calculatePrefetch(PacketPtr &pkt, std::list<Addr> &addresses,
             } else {
                 DPRINTF(HWPrefetch, "  queuing prefetch to %x (%s) @ %d\n",
                         new_addr, is_secure ? "s" : "ns", latency);
-                addresses.push_back(new_addr);
-                delays.push_back(latency);
+                candidates.push_back(new_addr, latency);
             }
         }
     } else {
         // Miss in table
-        // Find lowest confidence and replace
+        // Find an invalid or the lowest confidence entry and replace
 
         DPRINTF(HWPrefetch, "miss: PC %x data_addr %x (%s)\n", pc, data_addr,
                 is_secure ? "s" : "ns");
 
-        if (tab.size() >= 256) { //set default table size is 256
-            std::list<StrideEntry*>::iterator min_pos = tab.begin();
-            int min_conf = (*min_pos)->confidence;
-            for (iter = min_pos, ++iter; iter != tab.end(); ++iter) {
-                if ((*iter)->confidence < min_conf){
-                    min_pos = iter;
-                    min_conf = (*iter)->confidence;
-                }
-            }
-            DPRINTF(HWPrefetch, "  replacing PC %x (%s)\n",
-                    (*min_pos)->instAddr, (*min_pos)->isSecure ? "s" : "ns");
-
-            // free entry and delete it
-            delete *min_pos;
-            tab.erase(min_pos);
-        }
+        unsigned pos = victim(tab, base);
+        StrideEntry &entry = tab.entries[pos];
 
-        StrideEntry *new_entry = new StrideEntry;
-        new_entry->instAddr = pc;
-        new_entry->missAddr = data_addr;
-        new_entry->isSecure = is_secure;
-        new_entry->stride = 0;
-        new_entry->confidence = 0;
-        new_entry->tolerance = false;
-        tab.push_back(new_entry);
+        if (entry.valid)
+            DPRINTF(HWPrefetch, "  replacing PC %x (%s)\n",
+                    tab.pcs[pos], entry.isSecure ? "s" : "ns");
+
+        tab.pcs[pos] = pc;
+        entry.missAddr = data_addr;
+        entry.valid = true;
+        entry.isSecure = is_secure;
+        entry.stride = 0;
+        entry.confidence = 0;
+        entry.tolerance = false;
     }
 }
 
@@ -49,6 +49,7 @@
 #define __MEM_CACHE_PREFETCH_STRIDE_PREFETCHER_HH__
 
 #include <climits>
+#include <vector>
 
 #include "mem/cache/prefetch/base.hh"
 #include "params/StridePrefetcher.hh"
@@ -67,29 +68,65 @@ class StridePrefetcher : public BasePrefetcher
     class StrideEntry
     {
       public:
-        Addr instAddr;
         Addr missAddr;
+        bool valid;
         bool isSecure;
         int stride;
         int confidence;
         bool tolerance;
     };
 
-    std::list<StrideEntry*> table[Max_Contexts];
+    /**
+     * Set associative table of the PCs of one context. The PCs of a set
+     * are next to each other, apart from the rest of the entries, so
+     * that matching a PC against all the ways is a single pass the
+     * compiler turns into vector compares.
+     */
+    class StrideTable
+    {
+      public:
+        StrideTable(unsigned sets, unsigned assoc)
+            : pcs(sets * assoc, 0), entries(sets * assoc)
+        {
+            for (size_t i = 0; i < entries.size(); ++i)
+                entries[i].valid = false;
+        }
+
+        /** PC of every entry, set by set */
+        std::vector<Addr> pcs;
+        std::vector<StrideEntry> entries;
+    };
+
+    /** Tables of the contexts, allocated on their first access */
+    std::vector<StrideTable*> tables;
+
+    /** Table geometry, the sets are a power of two */
+    const unsigned tableSets;
+    const unsigned tableAssoc;
 
     bool instTagged;
 
+    /** Index of the first entry of the set of a PC */
+    unsigned setBase(Addr pc) const;
+
+    /**
+     * Find the entry of a PC.
+     * @return Index of the entry, or -1 on a miss
+     */
+    int lookup(const StrideTable &tab, unsigned base, Addr pc,
+               bool is_secure) const;
+
+    /** Entry to replace in a set: an invalid one, or lowest confidence */
+    unsigned victim(const StrideTable &tab, unsigned base) const;
+
   public:
+    typedef StridePrefetcherParams Params;
 
-    StridePrefetcher(const Params *p)
-        : BasePrefetcher(p), instTagged(p->inst_tagged)
-    {
-    }
+    StridePrefetcher(const Params *p);
 
-    ~StridePrefetcher() {}
+    ~StridePrefetcher();
 
-    void calculatePrefetch(PacketPtr &pkt, std::list<Addr> &addresses,
-                           std::list<Cycles> &delays);
+    void calculatePrefetch(PacketPtr &pkt, PrefetchCandidates &candidates);
 };
 
 #endif // __MEM_CACHE_PREFETCH_STRIDE_PREFETCHER_HH__
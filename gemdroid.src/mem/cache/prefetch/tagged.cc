@@ -42,8 +42,7 @@ TaggedPrefetcher::TaggedPrefetcher(const Params *p)
 
 void
 TaggedPrefetcher::
-calculatePrefetch(PacketPtr &pkt, std::list<Addr> &addresses,
-                  std::list<Cycles> &delays)
+calculatePrefetch(PacketPtr &pkt, PrefetchCandidates &candidates)
 {
     Addr blkAddr = pkt->getAddr() & ~(Addr)(blkSize-1);
 
@@ -54,8 +53,7 @@ calculatePrefetch(PacketPtr &pkt, std::list<Addr> &addresses,
             pfSpanPage += degree - d + 1;
             return;
         } else {
-            addresses.push_back(newAddr);
-            delays.push_back(latency);
+            candidates.push_back(newAddr, latency);
         }
     }
 }
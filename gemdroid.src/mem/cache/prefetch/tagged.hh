@@ -48,8 +48,7 @@ class TaggedPrefetcher : public BasePrefetcher
 
     ~TaggedPrefetcher() {}
 
-    void calculatePrefetch(PacketPtr &pkt, std::list<Addr> &addresses,
-                           std::list<Cycles> &delays);
+    void calculatePrefetch(PacketPtr &pkt, PrefetchCandidates &candidates);
 };
 
 #endif // __MEM_CACHE_PREFETCH_TAGGED_PREFETCHER_HH__
@@ -53,6 +53,10 @@ class BaseTags(ClockedObject):
     hit_latency = Param.Cycles(Parent.hit_latency,
                                "The hit latency for this cache")
 
+    # Save the tags and data in checkpoints, from the parent (cache)
+    checkpoint_contents = Param.Bool(Parent.checkpoint_contents,
+        "Save and restore the cache contents in checkpoints")
+
 class LRU(BaseTags):
     type = 'LRU'
     cxx_class = 'LRU'
@@ -71,6 +71,9 @@ class BaseTags : public ClockedObject
     /** The hit latency of the cache. */
     const Cycles hitLatency;
 
+    /** Whether the tags and data are saved in checkpoints. */
+    const bool checkpointContents;
+
     /** Pointer to the parent cache. */
     BaseCache *cache;
 
@@ -180,6 +183,12 @@ class BaseTags : public ClockedObject
      * Print all tags used
      */
     virtual std::string print() const = 0;
+
+    /**
+     * Whether the blocks are saved in checkpoints, in which case the
+     * cache may hold dirty data when a checkpoint is taken.
+     */
+    bool checkpointsContents() const { return checkpointContents; }
 };
 
 class BaseTagsCallback : public Callback
@@ -64,6 +64,9 @@ FALRU::FALRU(const Params *p)
         fatal("Access latency in cycles must be at least one cycle");
     if (!isPowerOf2(size))
         fatal("Cache Size must be power of 2 for now");
+    if (checkpointContents)
+        fatal("%s: FALRU caches cannot save their contents in checkpoints",
+              name());
 
     // Track all cache sizes from 128K up by powers of 2
     numCaches = floorLog2(size) - 17;
@@ -46,6 +46,7 @@
  */
 
 #include <string>
+#include <vector>
 
 #include "base/intmath.hh"
 #include "debug/Cache.hh"
@@ -53,6 +54,7 @@
 #include "mem/cache/tags/lru.hh"
 #include "mem/cache/base.hh"
 #include "sim/core.hh"
+#include "sim/serialize.hh"
 
 using namespace std;
 
@@ -331,3 +333,137 @@ LRU::computeStats()
     }
 }
 
+
+void
+LRU::serialize(std::ostream &os)
+{
+    if (!checkpointContents)
+        return;
+
+    bool checkpoint_contents = true;
+    SERIALIZE_SCALAR(checkpoint_contents);
+    SERIALIZE_SCALAR(numSets);
+    SERIALIZE_SCALAR(assoc);
+    SERIALIZE_SCALAR(blkSize);
+
+    // Only the valid blocks, with their position in the MRU order of
+    // their set, so the replacement state comes back as well
+    vector<unsigned> blk_set;
+    vector<unsigned> blk_rank;
+    vector<Addr> blk_tag;
+    vector<unsigned> blk_status;
+    vector<int> blk_master;
+    vector<uint8_t> blk_data;
+
+    for (unsigned i = 0; i < numSets; ++i) {
+        for (unsigned j = 0; j < assoc; ++j) {
+            BlkType *blk = sets[i].blks[j];
+            if (!blk->isValid())
+                continue;
+
+            blk_set.push_back(i);
+            blk_rank.push_back(j);
+            blk_tag.push_back(blk->tag);
+            blk_status.push_back(blk->status);
+            blk_master.push_back(blk->srcMasterId);
+            blk_data.insert(blk_data.end(), blk->data, blk->data + blkSize);
+        }
+    }
+
+    unsigned valid_blks = blk_set.size();
+    SERIALIZE_SCALAR(valid_blks);
+    if (valid_blks == 0)
+        return;
+
+    arrayParamOut(os, "blk_set", blk_set);
+    arrayParamOut(os, "blk_rank", blk_rank);
+    arrayParamOut(os, "blk_tag", blk_tag);
+    arrayParamOut(os, "blk_status", blk_status);
+    arrayParamOut(os, "blk_master", blk_master);
+    arrayParamOut(os, "blk_data", blk_data);
+
+    DPRINTF(Cache, "Saved %d valid blocks\n", valid_blks);
+}
+
+void
+LRU::unserialize(Checkpoint *cp, const std::string &section)
+{
+    // Checkpoints without the contents restore to a cold cache
+    bool checkpoint_contents = false;
+    UNSERIALIZE_OPT_SCALAR(checkpoint_contents);
+    if (!checkpoint_contents)
+        return;
+
+    unsigned num_sets, cpt_assoc, blk_size;
+    paramIn(cp, section, "numSets", num_sets);
+    paramIn(cp, section, "assoc", cpt_assoc);
+    paramIn(cp, section, "blkSize", blk_size);
+    if (num_sets != numSets || cpt_assoc != assoc || blk_size != blkSize) {
+        fatal("%s: checkpoint of a %d set, %d way cache with %d byte "
+              "blocks does not fit this %d set, %d way cache with %d byte "
+              "blocks\n", name(), num_sets, cpt_assoc, blk_size, numSets,
+              assoc, blkSize);
+    }
+
+    unsigned valid_blks;
+    UNSERIALIZE_SCALAR(valid_blks);
+    if (valid_blks == 0)
+        return;
+
+    vector<unsigned> blk_set;
+    vector<unsigned> blk_rank;
+    vector<Addr> blk_tag;
+    vector<unsigned> blk_status;
+    vector<int> blk_master;
+    vector<uint8_t> blk_data;
+
+    arrayParamIn(cp, section, "blk_set", blk_set);
+    arrayParamIn(cp, section, "blk_rank", blk_rank);
+    arrayParamIn(cp, section, "blk_tag", blk_tag);
+    arrayParamIn(cp, section, "blk_status", blk_status);
+    arrayParamIn(cp, section, "blk_master", blk_master);
+    arrayParamIn(cp, section, "blk_data", blk_data);
+
+    if (blk_set.size() != valid_blks || blk_rank.size() != valid_blks ||
+        blk_tag.size() != valid_blks || blk_status.size() != valid_blks ||
+        blk_master.size() != valid_blks ||
+        blk_data.size() != valid_blks * blkSize) {
+        fatal("%s: inconsistent cache contents in checkpoint\n", name());
+    }
+
+    for (unsigned i = 0; i < valid_blks; ++i) {
+        unsigned set = blk_set[i];
+        unsigned rank = blk_rank[i];
+        if (set >= numSets || rank >= assoc)
+            fatal("%s: block %d outside the cache\n", name(), i);
+        if (blk_master[i] < 0 ||
+            blk_master[i] >= cache->system->maxMasters())
+            fatal("%s: block %d from unknown master %d\n", name(), i,
+                  blk_master[i]);
+
+        // The tag store is still empty, so whatever block sits at this
+        // position of the set can take the saved one
+        BlkType *blk = sets[set].blks[rank];
+        assert(!blk->isValid());
+
+        blk->tag = blk_tag[i];
+        blk->status = blk_status[i];
+        blk->srcMasterId = blk_master[i];
+        blk->task_id = ContextSwitchTaskId::Unknown;
+        blk->whenReady = 0;
+        blk->refCount = 0;
+        blk->tickInserted = curTick();
+        memcpy(blk->data, &blk_data[i * blkSize], blkSize);
+
+        blk->isTouched = true;
+        tagsInUse++;
+        occupancies[blk->srcMasterId]++;
+    }
+
+    if (!warmedUp && tagsInUse.value() >= warmupBound) {
+        warmedUp = true;
+        warmupCycle = curTick();
+    }
+
+    DPRINTF(Cache, "Restored %d valid blocks\n", valid_blks);
+}
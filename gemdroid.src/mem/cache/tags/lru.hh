@@ -261,6 +261,18 @@ public:
      */
     virtual void computeStats();
 
+    /**
+     * Save the valid blocks with their tag, state, LRU position and
+     * data when checkpoint_contents is set.
+     */
+    void serialize(std::ostream &os);
+
+    /**
+     * Refill the sets from a checkpoint taken with checkpoint_contents.
+     * Must be called on an empty tag store, before any access.
+     */
+    void unserialize(Checkpoint *cp, const std::string &section);
+
     /**
      * Visit each block in the tag store and apply a visitor to the
      * block.
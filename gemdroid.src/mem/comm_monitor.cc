@@ -54,6 +54,9 @@ CommMonitor::CommMonitor(Params* params)
       samplePeriodTicks(params->sample_period),
       readAddrMask(params->read_addr_mask),
       writeAddrMask(params->write_addr_mask),
+      heatMapBase(params->stream_heat_map_base),
+      heatMapRegionSize(params->stream_heat_map_region_size),
+      heatMapRegions(params->stream_heat_map_regions),
       stats(params),
       traceStream(NULL),
       system(params->system)
@@ -100,11 +103,26 @@ CommMonitor::CommMonitor(Params* params)
     // keep track of the sample period both in ticks and absolute time
     samplePeriod.setTick(params->sample_period);
 
+    if (stats.streamEnable) {
+        fatal_if(params->stream_bandwidth_windows == 0,
+                 "%s: no bandwidth windows to stream\n", name());
+        fatal_if(heatMapRegionSize == 0 || heatMapRegions == 0,
+                 "%s: empty heat map\n", name());
+
+        stats.readLatencySketch.init(params->stream_latency_precision,
+                                     params->stream_latency_max);
+        stats.writeLatencySketch.init(params->stream_latency_precision,
+                                      params->stream_latency_max);
+    }
+
     DPRINTF(CommMonitor,
             "Created monitor %s with sample period %d ticks (%f ms)\n",
             name(), samplePeriodTicks, samplePeriod.msec());
 }
 
+const double CommMonitor::LatencySketch::quantiles[NumQuantiles] =
+    { 0.5, 0.9, 0.99, 0.999 };
+
 void
 CommMonitor::closeStreams()
 {
@@ -197,7 +215,7 @@ CommMonitor::recvTimingReq(PacketPtr pkt)
     // would see a request which needs a response, but this response
     // would be inhibited and not come back from the memory. Therefore
     // we additionally have to check the inhibit flag.
-    if (expects_response && !stats.disableLatencyHists) {
+    if (expects_response && stats.measureLatency()) {
         pkt->pushSenderState(new CommMonitorSenderState(curTick()));
     }
 
@@ -206,7 +224,7 @@ CommMonitor::recvTimingReq(PacketPtr pkt)
     bool successful = masterPort.sendTimingReq(pkt);
 
     // If not successful, restore the sender state
-    if (!successful && expects_response && !stats.disableLatencyHists) {
+    if (!successful && expects_response && stats.measureLatency()) {
         delete pkt->popSenderState();
     }
 
@@ -242,6 +260,10 @@ CommMonitor::recvTimingReq(PacketPtr pkt)
             stats.readAddrDist.sample(addr & readAddrMask);
         }
 
+        if (stats.streamEnable) {
+            ++stats.readRegionHeat[heatRegion(addr)];
+        }
+
         // If it needs a response increment number of outstanding read
         // requests
         if (!stats.disableOutstandingHists && expects_response) {
@@ -274,7 +296,7 @@ CommMonitor::recvTimingReq(PacketPtr pkt)
         }
 
         // Update the bandwidth stats on the request
-        if (!stats.disableBandwidthHists) {
+        if (stats.countBytes()) {
             stats.writtenBytes += size;
             stats.totalWrittenBytes += size;
         }
@@ -284,6 +306,10 @@ CommMonitor::recvTimingReq(PacketPtr pkt)
             stats.writeAddrDist.sample(addr & writeAddrMask);
         }
 
+        if (stats.streamEnable) {
+            ++stats.writeRegionHeat[heatRegion(addr)];
+        }
+
         if (!stats.disableOutstandingHists && expects_response) {
             ++stats.outstandingWriteReqs;
         }
@@ -323,7 +349,7 @@ CommMonitor::recvTimingResp(PacketPtr pkt)
     CommMonitorSenderState* received_state =
         dynamic_cast<CommMonitorSenderState*>(pkt->senderState);
 
-    if (!stats.disableLatencyHists) {
+    if (stats.measureLatency()) {
         // Restore initial sender state
         if (received_state == NULL)
             panic("Monitor got a response without monitor sender state\n");
@@ -335,7 +361,7 @@ CommMonitor::recvTimingResp(PacketPtr pkt)
     // Attempt to send the packet
     bool successful = slavePort.sendTimingResp(pkt);
 
-    if (!stats.disableLatencyHists) {
+    if (stats.measureLatency()) {
         // If packet successfully send, sample value of latency,
         // afterwards delete sender state, otherwise restore state
         if (successful) {
@@ -361,8 +387,12 @@ CommMonitor::recvTimingResp(PacketPtr pkt)
             stats.readLatencyHist.sample(latency);
         }
 
+        if (stats.streamEnable) {
+            stats.readLatencySketch.sample(latency);
+        }
+
         // Update the bandwidth stats based on responses for reads
-        if (!stats.disableBandwidthHists) {
+        if (stats.countBytes()) {
             stats.readBytes += size;
             stats.totalReadBytes += size;
         }
@@ -378,12 +408,26 @@ CommMonitor::recvTimingResp(PacketPtr pkt)
         if (!stats.disableLatencyHists) {
             stats.writeLatencyHist.sample(latency);
         }
+
+        if (stats.streamEnable) {
+            stats.writeLatencySketch.sample(latency);
+        }
     } else if (successful) {
         DPRINTF(CommMonitor, "Received non read/write response\n");
     }
     return successful;
 }
 
+unsigned
+CommMonitor::heatRegion(Addr addr) const
+{
+    if (addr < heatMapBase)
+        return heatMapRegions;
+
+    Addr region = (addr - heatMapBase) / heatMapRegionSize;
+    return region < heatMapRegions ? region : heatMapRegions;
+}
+
 void
 CommMonitor::recvTimingSnoopReq(PacketPtr pkt)
 {
@@ -552,6 +596,89 @@ CommMonitor::regStats()
         .name(name() + ".writeAddrDist")
         .desc("Write address distribution")
         .flags(stats.disableAddrDists ? nozero : pdf);
+
+    bool no_stream = !stats.streamEnable;
+
+    stats.readLatencySketch.regStats(name() + ".readLatency",
+                                     "Read request-response latency",
+                                     no_stream);
+
+    stats.writeLatencySketch.regStats(name() + ".writeLatency",
+                                      "Write request-response latency",
+                                      no_stream);
+
+    unsigned windows = params()->stream_bandwidth_windows;
+
+    stats.readBandwidthSeries
+        .init(no_stream ? 1 : windows)
+        .name(name() + ".readBandwidthSeries")
+        .desc("Read bandwidth of the latest sample periods, latest first "
+              "(bytes/s)")
+        .flags(no_stream ? nozero : none);
+
+    stats.writeBandwidthSeries
+        .init(no_stream ? 1 : windows)
+        .name(name() + ".writeBandwidthSeries")
+        .desc("Write bandwidth of the latest sample periods, latest first "
+              "(bytes/s)")
+        .flags(no_stream ? nozero : none);
+
+    stats.readRegionHeat
+        .init(no_stream ? 1 : heatMapRegions + 1)
+        .name(name() + ".readRegionHeat")
+        .desc("Read requests per address region")
+        .flags(no_stream ? nozero : pdf);
+
+    stats.writeRegionHeat
+        .init(no_stream ? 1 : heatMapRegions + 1)
+        .name(name() + ".writeRegionHeat")
+        .desc("Write requests per address region")
+        .flags(no_stream ? nozero : pdf);
+
+    if (!no_stream) {
+        for (unsigned i = 0; i < heatMapRegions; ++i) {
+            std::string region = csprintf("%#x", heatMapBase +
+                                          i * heatMapRegionSize);
+            stats.readRegionHeat.subname(i, region);
+            stats.writeRegionHeat.subname(i, region);
+        }
+        stats.readRegionHeat.subname(heatMapRegions, "outside");
+        stats.writeRegionHeat.subname(heatMapRegions, "outside");
+    }
+}
+
+void
+CommMonitor::LatencySketch::regStats(const std::string &name,
+                                     const std::string &desc,
+                                     bool disabled)
+{
+    using namespace Stats;
+
+    for (int i = 0; i <= NumQuantiles; ++i) {
+        functors[i].hist = &hist;
+        functors[i].q = i < NumQuantiles ? quantiles[i] : 1;
+
+        std::string suffix = i < NumQuantiles ?
+            csprintf("P%g", quantiles[i] * 100) : std::string("Max");
+        std::string what = i < NumQuantiles ?
+            csprintf("%g percentile", quantiles[i] * 100) :
+            std::string("maximum");
+
+        values[i]
+            .functor(functors[i])
+            .name(name + suffix)
+            .desc(desc + ", " + what + " (ticks)")
+            .flags(disabled ? nozero : none);
+    }
+}
+
+void
+CommMonitor::resetStats()
+{
+    MemObject::resetStats();
+
+    stats.readLatencySketch.reset();
+    stats.writeLatencySketch.reset();
 }
 
 void
@@ -582,6 +709,24 @@ CommMonitor::samplePeriodic()
         }
     }
 
+    // the bandwidth series keeps going across stats resets, the
+    // periods are all whole ones
+    if (stats.streamEnable) {
+        unsigned windows = stats.readBandwidthWindows.size();
+        unsigned head = stats.bandwidthWindowHead;
+        stats.readBandwidthWindows[head] = stats.readBytes / samplePeriod;
+        stats.writeBandwidthWindows[head] = stats.writtenBytes / samplePeriod;
+        stats.bandwidthWindowHead = (head + 1) % windows;
+        if (stats.bandwidthWindowsFilled < windows)
+            ++stats.bandwidthWindowsFilled;
+
+        for (unsigned i = 0; i < stats.bandwidthWindowsFilled; ++i) {
+            unsigned w = (head + windows - i) % windows;
+            stats.readBandwidthSeries[i] = stats.readBandwidthWindows[w];
+            stats.writeBandwidthSeries[i] = stats.writeBandwidthWindows[w];
+        }
+    }
+
     // reset the sampled values
     stats.readTrans = 0;
     stats.writeTrans = 0;
@@ -41,6 +41,9 @@
 #ifndef __MEM_COMM_MONITOR_HH__
 #define __MEM_COMM_MONITOR_HH__
 
+#include <vector>
+
+#include "base/hdr_histogram.hh"
 #include "base/statistics.hh"
 #include "base/time.hh"
 #include "mem/mem_object.hh"
@@ -58,6 +61,12 @@
  * (read-read, write-write, read/write-read/write). Furthermore it allows
  * to capture the number of accesses to an address over time ("heat map").
  * All stats can be disabled from Python.
+ *
+ * For long runs there is also a streaming mode, where everything is kept
+ * in a fixed amount of memory: latency percentiles from log-linear
+ * sketches, the bandwidth of the most recent sample periods, and access
+ * counts over a fixed set of address regions. They go out with the
+ * regular stats dumps, and are reset with the other stats.
  */
 class CommMonitor : public MemObject
 {
@@ -96,6 +105,9 @@ class CommMonitor : public MemObject
     /** Register statistics */
     void regStats();
 
+    /** Clear the latency sketches along with the stats */
+    void resetStats();
+
   private:
 
     /**
@@ -270,6 +282,54 @@ class CommMonitor : public MemObject
 
     void periodicTraceDump();
 
+    /**
+     * Latency percentiles of a sketch as stats. The percentiles are
+     * only looked up when the stats are dumped.
+     */
+    class LatencySketch
+    {
+
+      public:
+
+        /** Percentiles reported, besides the maximum */
+        static const int NumQuantiles = 4;
+        static const double quantiles[NumQuantiles];
+
+        void init(unsigned precision, Tick max_latency)
+        { hist.init(precision, max_latency); }
+
+        void sample(Tick latency) { hist.sample(latency); }
+
+        void reset() { hist.reset(); }
+
+        void regStats(const std::string &name, const std::string &desc,
+                      bool disabled);
+
+      private:
+
+        /** Stats::Value functor for one percentile */
+        class Quantile
+        {
+          public:
+            const HdrHistogram *hist;
+            double q;
+
+            Counter
+            operator()() const
+            {
+                return q < 1 ? hist->quantile(q) : hist->max();
+            }
+        };
+
+        HdrHistogram hist;
+        Quantile functors[NumQuantiles + 1];
+        Stats::Value values[NumQuantiles + 1];
+
+    };
+
+    /** Index of an address in the region heat map */
+    unsigned heatRegion(Addr addr) const;
+
     /** Stats declarations, all in a struct for convenience. */
     struct MonitorStats
     {
@@ -374,6 +434,40 @@ class CommMonitor : public MemObject
          */
         Stats::SparseHistogram writeAddrDist;
 
+        /** Enable flag for the streaming stats. */
+        bool streamEnable;
+
+        /** Fixed size read and write latency sketches */
+        LatencySketch readLatencySketch;
+        LatencySketch writeLatencySketch;
+
+        /**
+         * Bandwidth of the most recent sample periods, oldest to be
+         * overwritten next, and the same as stats with the latest
+         * period first.
+         */
+        std::vector<double> readBandwidthWindows;
+        std::vector<double> writeBandwidthWindows;
+        unsigned bandwidthWindowHead;
+        unsigned bandwidthWindowsFilled;
+        Stats::Vector readBandwidthSeries;
+        Stats::Vector writeBandwidthSeries;
+
+        /**
+         * Accesses per address region, with a last bucket for the
+         * addresses outside all of them.
+         */
+        Stats::Vector readRegionHeat;
+        Stats::Vector writeRegionHeat;
+
+        /** Latency is measured for the histograms or the sketches */
+        bool measureLatency() const
+        { return !disableLatencyHists || streamEnable; }
+
+        /** Bytes are counted for the histograms or the series */
+        bool countBytes() const
+        { return !disableBandwidthHists || streamEnable; }
+
         /**
          * Create the monitor stats and initialise all the members
          * that are not statistics themselves, but used to control the
@@ -390,7 +484,11 @@ class CommMonitor : public MemObject
             outstandingReadReqs(0), outstandingWriteReqs(0),
             disableTransactionHists(params->disable_transaction_hists),
             readTrans(0), writeTrans(0),
-            disableAddrDists(params->disable_addr_dists)
+            disableAddrDists(params->disable_addr_dists),
+            streamEnable(params->stream_enable),
+            readBandwidthWindows(params->stream_bandwidth_windows, 0),
+            writeBandwidthWindows(params->stream_bandwidth_windows, 0),
+            bandwidthWindowHead(0), bandwidthWindowsFilled(0)
         { }
 
     };
@@ -414,6 +512,11 @@ class CommMonitor : public MemObject
     /** Address mask for sources of write accesses to be captured */
     Addr writeAddrMask;
 
+    /** Address regions of the streaming heat map */
+    Addr heatMapBase;
+    Addr heatMapRegionSize;
+    unsigned heatMapRegions;
+
     /** Instantiate stats */
     MonitorStats stats;
 
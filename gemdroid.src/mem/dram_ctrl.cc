@@ -42,6 +42,8 @@
  *          Neha Agarwal
  */
 
+#include <algorithm>
+
 #include "base/bitfield.hh"
 #include "base/trace.hh"
 #include "debug/DRAM.hh"
@@ -78,6 +80,7 @@ DRAMCtrl::DRAMCtrl(const DRAMCtrlParams* p) :
     tRCD(p->tRCD), tCL(p->tCL), tRP(p->tRP), tRAS(p->tRAS), tWR(p->tWR),
     tRTP(p->tRTP), tRFC(p->tRFC), tREFI(p->tREFI), tRRD(p->tRRD),
     tXAW(p->tXAW), activationLimit(p->activation_limit),
+    nominalBURST(p->tBURST),
     memSchedPolicy(p->mem_sched_policy), addrMapping(p->addr_mapping),
     pageMgmt(p->page_policy),
     maxAccessesPerRow(p->max_accesses_per_row),
@@ -95,6 +98,8 @@ DRAMCtrl::DRAMCtrl(const DRAMCtrlParams* p) :
         banks[c].resize(banksPerRank);
         actTicks[c].resize(activationLimit, 0);
     }
+    readBanks.init(ranksPerChannel * banksPerRank);
+    writeBanks.init(ranksPerChannel * banksPerRank);
 
     // perform a basic check of the write thresholds
     if (p->write_low_thresh_perc >= p->write_high_thresh_perc)
@@ -170,6 +175,18 @@ DRAMCtrl::startup()
     schedule(refreshEvent, curTick() + tREFI - tRP);
 }
 
+void
+DRAMCtrl::setBusFreqScale(double scale)
+{
+    assert(scale > 0);
+
+    // bursts already on the bus keep their timing, the new burst time
+    // applies from the next access on
+    tBURST = std::max(Tick(1), Tick(nominalBURST / scale));
+
+    DPRINTF(DRAM, "Bus frequency scaled by %f, tBURST %d\n", scale, tBURST);
+}
+
 Tick
 DRAMCtrl::recvAtomic(PacketPtr pkt)
 {
@@ -367,7 +384,7 @@ DRAMCtrl::addToReadQueue(PacketPtr pkt, unsigned int pktCount)
 
             DPRINTF(DRAM, "Adding to read queue\n");
 
-            readQueue.push_back(dram_pkt);
+            enqueue(readQueue, readBanks, dram_pkt);
 
             // Update stats
             avgRdQLen = readQueue.size() + respQueue.size();
@@ -480,7 +497,7 @@ DRAMCtrl::addToWriteQueue(PacketPtr pkt, unsigned int pktCount)
 
             DPRINTF(DRAM, "Adding to write queue\n");
 
-            writeQueue.push_back(dram_pkt);
+            enqueue(writeQueue, writeBanks, dram_pkt);
 
             // Update stats
             avgWrQLen = writeQueue.size();
@@ -647,7 +664,16 @@ DRAMCtrl::processRespondEvent()
 }
 
 void
-DRAMCtrl::chooseNext(std::deque<DRAMPacket*>& queue)
+DRAMCtrl::enqueue(std::deque<DRAMPacket*>& queue,
+                  BankQueue<DRAMPacket>& bank_queue, DRAMPacket* dram_pkt)
+{
+    queue.push_back(dram_pkt);
+    bank_queue.push(dram_pkt, dram_pkt->bankId, dram_pkt->row);
+}
+
+void
+DRAMCtrl::chooseNext(std::deque<DRAMPacket*>& queue,
+                     const BankQueue<DRAMPacket>& bank_queue)
 {
     // This method does the arbitration between requests. The chosen
     // packet is simply moved to the head of the queue. The other
@@ -663,56 +689,30 @@ DRAMCtrl::chooseNext(std::deque<DRAMPacket*>& queue)
     if (memSchedPolicy == Enums::fcfs) {
         // Do nothing, since the correct request is already head
     } else if (memSchedPolicy == Enums::frfcfs) {
-        reorderQueue(queue);
+        reorderQueue(queue, bank_queue);
     } else
         panic("No scheduling policy chosen\n");
 }
 
 void
-DRAMCtrl::reorderQueue(std::deque<DRAMPacket*>& queue)
+DRAMCtrl::reorderQueue(std::deque<DRAMPacket*>& queue,
+                       const BankQueue<DRAMPacket>& bank_queue)
 {
-    // Only determine this when needed
-    uint64_t earliest_banks = 0;
-
-    // Search for row hits first, if no row hit is found then schedule the
-    // packet to one of the earliest banks available
-    bool found_earliest_pkt = false;
-    auto selected_pkt_it = queue.begin();
-
-    for (auto i = queue.begin(); i != queue.end() ; ++i) {
-        DRAMPacket* dram_pkt = *i;
-        const Bank& bank = dram_pkt->bankRef;
-        // Check if it is a row hit
-        if (bank.openRow == dram_pkt->row) {
-            // FCFS within the hits
-            DPRINTF(DRAM, "Row buffer hit\n");
-            selected_pkt_it = i;
-            break;
-        } else if (!found_earliest_pkt) {
-            // No row hit, go for first ready
-            if (earliest_banks == 0)
-                earliest_banks = minBankActAt(queue);
-
-            // simplistic approximation of when the bank can issue an
-            // activate, this is calculated in minBankActAt and could
-            // be cached
-            Tick act_at = bank.openRow == Bank::NO_ROW ?
-                bank.actAllowedAt :
-                std::max(bank.preAllowedAt, curTick()) + tRP;
-
-            // Bank is ready or is the first available bank
-            if (act_at <= curTick() ||
-                bits(earliest_banks, dram_pkt->bankId, dram_pkt->bankId)) {
-                // Remember the packet to be scheduled to one of the earliest
-                // banks available, FCFS amongst the earliest banks
-                selected_pkt_it = i;
-                found_earliest_pkt = true;
-            }
-        }
-    }
+    // Row hits first, if no row hit is found then schedule the packet
+    // to one of the earliest banks available, FCFS within both. The
+    // bank index only looks at the oldest packets of every bank.
+    assert(bank_queue.size() == queue.size());
+    DRAMPacket* selected_pkt =
+        bank_queue.selectFRFCFS(BankTiming(*this), curTick());
+    assert(selected_pkt);
+
+    if (selected_pkt->bankRef.openRow == selected_pkt->row)
+        DPRINTF(DRAM, "Row buffer hit\n");
+
+    if (selected_pkt == queue.front())
+        return;
 
-    DRAMPacket* selected_pkt = *selected_pkt_it;
-    queue.erase(selected_pkt_it);
+    queue.erase(std::find(queue.begin(), queue.end(), selected_pkt));
     queue.push_front(selected_pkt);
 }
 
@@ -968,29 +968,17 @@ DRAMCtrl::doDRAMAccess(DRAMPacket* dram_pkt)
         // page, but closes it only if there are no row hits in the queue.
         // In this case, only force an auto precharge when there
         // are no same page hits in the queue
-        bool got_more_hits = false;
-        bool got_bank_conflict = false;
-
-        // either look at the read queue or write queue
-        const deque<DRAMPacket*>& queue = dram_pkt->isRead ? readQueue :
-            writeQueue;
-        auto p = queue.begin();
-        // make sure we are not considering the packet that we are
-        // currently dealing with (which is the head of the queue)
-        ++p;
-
-        // keep on looking until we have found required condition or
-        // reached the end
-        while (!(got_more_hits &&
-                 (got_bank_conflict || pageMgmt == Enums::close_adaptive)) &&
-               p != queue.end()) {
-            bool same_rank_bank = (dram_pkt->rank == (*p)->rank) &&
-                (dram_pkt->bank == (*p)->bank);
-            bool same_row = dram_pkt->row == (*p)->row;
-            got_more_hits |= same_rank_bank && same_row;
-            got_bank_conflict |= same_rank_bank && !same_row;
-            ++p;
-        }
+        // either look at the read queue or write queue, the bank index
+        // has the counts per bank and row; make sure we are not
+        // considering the packet that we are currently dealing with
+        // (which is the head of the queue)
+        const BankQueue<DRAMPacket>& bank_queue = dram_pkt->isRead ?
+            readBanks : writeBanks;
+        unsigned same_bank = bank_queue.bankSize(dram_pkt->bankId) - 1;
+        unsigned same_row =
+            bank_queue.rowSize(dram_pkt->bankId, dram_pkt->row) - 1;
+        bool got_more_hits = same_row > 0;
+        bool got_bank_conflict = same_bank > same_row;
 
         // auto pre-charge when either
         // 1) open_adaptive policy, we have not got any more hits, and
@@ -1109,7 +1097,7 @@ DRAMCtrl::processNextReqEvent()
         } else {
             // Figure out which read request goes next, and move it to the
             // front of the read queue
-            chooseNext(readQueue);
+            chooseNext(readQueue, readBanks);
 
             DRAMPacket* dram_pkt = readQueue.front();
 
@@ -1117,6 +1105,7 @@ DRAMCtrl::processNextReqEvent()
 
             // At this point we're done dealing with the request
             readQueue.pop_front();
+            readBanks.remove(dram_pkt, dram_pkt->bankId, dram_pkt->row);
 
             // sanity check
             assert(dram_pkt->size <= burstSize);
@@ -1157,13 +1146,14 @@ DRAMCtrl::processNextReqEvent()
             nextReqTime = busBusyUntil - (tRP + tRCD + tCL);
         }
     } else {
-        chooseNext(writeQueue);
+        chooseNext(writeQueue, writeBanks);
         DRAMPacket* dram_pkt = writeQueue.front();
         // sanity check
         assert(dram_pkt->size <= burstSize);
         doDRAMAccess(dram_pkt);
 
         writeQueue.pop_front();
+        writeBanks.remove(dram_pkt, dram_pkt->bankId, dram_pkt->row);
         delete dram_pkt;
 
         // If we emptied the write queue, or got sufficiently below the
@@ -1207,48 +1197,6 @@ DRAMCtrl::processNextReqEvent()
     }
 }
 
-uint64_t
-DRAMCtrl::minBankActAt(const deque<DRAMPacket*>& queue) const
-{
-    uint64_t bank_mask = 0;
-    Tick min_act_at = MaxTick;
-
-    // deterimne if we have queued transactions targetting a
-    // bank in question
-    vector<bool> got_waiting(ranksPerChannel * banksPerRank, false);
-    for (auto p = queue.begin(); p != queue.end(); ++p) {
-        got_waiting[(*p)->bankId] = true;
-    }
-
-    for (int i = 0; i < ranksPerChannel; i++) {
-        for (int j = 0; j < banksPerRank; j++) {
-            uint8_t bank_id = i * banksPerRank + j;
-
-            // if we have waiting requests for the bank, and it is
-            // amongst the first available, update the mask
-            if (got_waiting[bank_id]) {
-                // simplistic approximation of when the bank can issue
-                // an activate, ignoring any rank-to-rank switching
-                // cost
-                Tick act_at = banks[i][j].openRow == Bank::NO_ROW ?
-                    banks[i][j].actAllowedAt :
-                    std::max(banks[i][j].preAllowedAt, curTick()) + tRP;
-
-                if (act_at <= min_act_at) {
-                    // reset bank mask if new minimum is found
-                    if (act_at < min_act_at)
-                        bank_mask = 0;
-                    // set the bit corresponding to the available bank
-                    replaceBits(bank_mask, bank_id, bank_id, 1);
-                    min_act_at = act_at;
-                }
-            }
-        }
-    }
-
-    return bank_mask;
-}
-
 void
 DRAMCtrl::processRefreshEvent()
 {
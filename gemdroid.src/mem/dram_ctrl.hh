@@ -57,6 +57,7 @@
 #include "enums/MemSched.hh"
 #include "enums/PageManage.hh"
 #include "mem/abstract_mem.hh"
+#include "mem/bank_queue.hh"
 #include "mem/qport.hh"
 #include "params/DRAMCtrl.hh"
 #include "sim/eventq.hh"
@@ -364,22 +365,51 @@ class DRAMCtrl : public AbstractMemory
      * go next, based on the specified policy such as FCFS or FR-FCFS
      * and moves it to the head of the queue.
      */
-    void chooseNext(std::deque<DRAMPacket*>& queue);
+    void chooseNext(std::deque<DRAMPacket*>& queue,
+                    const BankQueue<DRAMPacket>& bank_queue);
 
     /**
      * For FR-FCFS policy reorder the read/write queue depending on row buffer
      * hits and earliest banks available in DRAM
      */
-    void reorderQueue(std::deque<DRAMPacket*>& queue);
+    void reorderQueue(std::deque<DRAMPacket*>& queue,
+                      const BankQueue<DRAMPacket>& bank_queue);
 
     /**
-     * Find which are the earliest banks ready to issue an activate
-     * for the enqueued requests. Assumes maximum of 64 banks per DIMM
-     *
-     * @param Queued requests to consider
-     * @return One-hot encoded mask of bank indices
+     * Bank state as seen by the FR-FCFS selection of a BankQueue.
      */
-    uint64_t minBankActAt(const std::deque<DRAMPacket*>& queue) const;
+    class BankTiming
+    {
+      public:
+        BankTiming(const DRAMCtrl& _ctrl) : ctrl(_ctrl) { }
+
+        uint32_t openRow(unsigned bank_id) const
+        { return bank(bank_id).openRow; }
+
+        /**
+         * Simplistic approximation of when the bank can issue an
+         * activate, ignoring any rank-to-rank switching cost
+         */
+        Tick actAt(unsigned bank_id) const
+        {
+            const Bank& b = bank(bank_id);
+            return b.openRow == Bank::NO_ROW ? b.actAllowedAt :
+                std::max(b.preAllowedAt, curTick()) + ctrl.tRP;
+        }
+
+      private:
+        const Bank& bank(unsigned bank_id) const
+        {
+            return ctrl.banks[bank_id / ctrl.banksPerRank]
+                [bank_id % ctrl.banksPerRank];
+        }
+
+        const DRAMCtrl& ctrl;
+    };
+
+    /** Add a request to a queue and its bank index. */
+    void enqueue(std::deque<DRAMPacket*>& queue,
+                 BankQueue<DRAMPacket>& bank_queue, DRAMPacket* dram_pkt);
 
     /**
      * Keep track of when row activations happen, in order to enforce
@@ -417,6 +447,13 @@ class DRAMCtrl : public AbstractMemory
     std::deque<DRAMPacket*> readQueue;
     std::deque<DRAMPacket*> writeQueue;
 
+    /**
+     * The same requests indexed by bank and row, for FR-FCFS and the
+     * adaptive page policies
+     */
+    BankQueue<DRAMPacket> readBanks;
+    BankQueue<DRAMPacket> writeBanks;
+
     /**
      * Response queue where read packets wait after we're done working
      * with them, but it's not time to send the response yet. The
@@ -471,7 +508,7 @@ class DRAMCtrl : public AbstractMemory
     const Tick tCK;
     const Tick tWTR;
     const Tick tRTW;
-    const Tick tBURST;
+    Tick tBURST;
     const Tick tRCD;
     const Tick tCL;
     const Tick tRP;
@@ -484,6 +521,12 @@ class DRAMCtrl : public AbstractMemory
     const Tick tXAW;
     const uint32_t activationLimit;
 
+    /**
+     * Burst time at the configured bus clock, tBURST follows the clock
+     * when it is scaled.
+     */
+    const Tick nominalBURST;
+
     /**
      * Memory controller configuration initialized based on parameter
      * values.
@@ -680,6 +723,32 @@ class DRAMCtrl : public AbstractMemory
     virtual void init();
     virtual void startup();
 
+    /**
+     * Scale the data bus clock relative to the configured one, e.g. for
+     * a DVFS governor driving the controller. Only the burst time
+     * follows the clock; the core timings are set in ns by the device.
+     *
+     * @param scale New bus frequency over the configured one
+     */
+    void setBusFreqScale(double scale);
+
+    /** Configured bus clock period. */
+    Tick busClockPeriod() const { return tCK; }
+
+    /**
+     * Activity counters since the stats were last reset, for power
+     * models and governors outside the controller.
+     */
+    Counter numReadBursts() const { return readBursts.value(); }
+    Counter numWriteBursts() const { return writeBursts.value(); }
+    Counter numReadRowHits() const { return readRowHits.value(); }
+    Counter numWriteRowHits() const { return writeRowHits.value(); }
+    Counter numBytesRead() const { return bytesReadDRAM.value(); }
+    Counter numBytesWritten() const { return bytesWritten.value(); }
+
+    /** Summed latency of the reads serviced by the DRAM. */
+    Counter totalReadLatency() const { return totMemAccLat.value(); }
+
   protected:
 
     Tick recvAtomic(PacketPtr pkt);
@@ -38,18 +38,25 @@
  */
 
 #include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/user.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <zlib.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <climits>
 #include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <thread>
 
+#include "base/intmath.hh"
 #include "base/trace.hh"
 #include "debug/BusAddrRanges.hh"
 #include "debug/Checkpoint.hh"
@@ -58,9 +65,161 @@
 
 using namespace std;
 
+namespace {
+
+/**
+ * Threads used to compress and decompress checkpoint chunks, and to
+ * fault in backing stores.
+ */
+unsigned
+hostThreads()
+{
+    unsigned threads = std::thread::hardware_concurrency();
+    return std::max(1u, std::min(threads, 16u));
+}
+
+/**
+ * Call f(i) for i in [0, n) from up to the given number of threads,
+ * the calling thread included. Returns false if any call did.
+ */
+template <class F>
+bool
+parallelFor(uint64_t n, unsigned threads, F f)
+{
+    std::atomic<uint64_t> next(0);
+    std::atomic<bool> ok(true);
+
+    auto work = [&]() {
+        uint64_t i;
+        while ((i = next++) < n) {
+            if (!f(i))
+                ok = false;
+        }
+    };
+
+    vector<std::thread> workers;
+    for (unsigned t = 1; t < threads && t < n; ++t)
+        workers.push_back(std::thread(work));
+    work();
+    for (int t = 0; t < workers.size(); ++t)
+        workers[t].join();
+
+    return ok;
+}
+
+/**
+ * Default huge page size of the host, from /proc/meminfo, or 2 MB if
+ * it does not say.
+ */
+uint64_t
+hostHugePageBytes()
+{
+    ifstream meminfo("/proc/meminfo");
+    string key;
+    while (meminfo >> key) {
+        if (key == "Hugepagesize:") {
+            uint64_t kbytes;
+            if (meminfo >> kbytes && kbytes)
+                return kbytes * 1024;
+            break;
+        }
+        meminfo.ignore(numeric_limits<streamsize>::max(), '\n');
+    }
+    return 2 * 1024 * 1024;
+}
+
+/**
+ * Anonymous mapping starting on a multiple of align, which is what
+ * lets the kernel use transparent huge pages from the first byte.
+ */
+uint8_t*
+mmapAligned(uint64_t size, uint64_t align)
+{
+    int map_flags = MAP_ANON | MAP_PRIVATE;
+    uint8_t* map = (uint8_t*) mmap(NULL, size + align,
+                                   PROT_READ | PROT_WRITE,
+                                   map_flags, -1, 0);
+    if (map == (uint8_t*) MAP_FAILED || align == 0)
+        return map;
+
+    // give back the slack on either side
+    uint8_t* start = (uint8_t*) roundUp((uintptr_t) map, align);
+    if (start != map)
+        munmap(map, start - map);
+    if (start + size != map + size + align)
+        munmap(start + size, map + align - start);
+    return start;
+}
+
+/** NUMA node of the CPU the calling thread runs on. */
+int
+currentNumaNode()
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu, node;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) == 0)
+        return node;
+#endif
+    return 0;
+}
+
+/**
+ * Allocate the pages of a range on one NUMA node, as mbind with
+ * MPOL_BIND. Done with the system call directly so as not to depend
+ * on libnuma.
+ */
+bool
+bindToNumaNode(uint8_t* addr, uint64_t size, int node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    const int mpol_bind = 2;
+    const unsigned long bits = sizeof(unsigned long) * CHAR_BIT;
+    vector<unsigned long> mask(node / bits + 1, 0);
+    mask[node / bits] |= 1UL << (node % bits);
+    // the kernel ignores the last bit of the node count
+    return syscall(SYS_mbind, addr, size, mpol_bind, &mask[0],
+                   mask.size() * bits + 1, 0) == 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Write to every page of a range so that the host allocates it now.
+ * Without a NUMA binding this stays on the calling thread, or first
+ * touch would spread the pages over the nodes of the helper threads.
+ */
+void
+prefaultRange(uint8_t* addr, uint64_t size, bool parallel)
+{
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(addr, size, MADV_POPULATE_WRITE) == 0)
+        return;
+#endif
+
+    const uint64_t page_bytes = sysconf(_SC_PAGESIZE);
+    const uint64_t chunk_bytes = 64 * 1024 * 1024;
+    uint64_t nbr_of_chunks = divCeil(size, chunk_bytes);
+
+    parallelFor(nbr_of_chunks, parallel ? hostThreads() : 1,
+                [&](uint64_t i) {
+        volatile uint8_t* chunk = addr + i * chunk_bytes;
+        uint64_t len = min(chunk_bytes, size - i * chunk_bytes);
+        for (uint64_t offset = 0; offset < len; offset += page_bytes)
+            chunk[offset] = 0;
+        return true;
+    });
+}
+
+} // anonymous namespace
+
 PhysicalMemory::PhysicalMemory(const string& _name,
-                               const vector<AbstractMemory*>& _memories) :
-    _name(_name), size(0)
+                               const vector<AbstractMemory*>& _memories,
+                               Enums::BackingPages backing_pages,
+                               const vector<int>& numa_nodes,
+                               bool prefault) :
+    _name(_name), size(0), backingPages(backing_pages),
+    numaNodes(numa_nodes), prefault(prefault)
 {
     // add the memories from the system to the address map as
     // appropriate
@@ -146,20 +305,31 @@ PhysicalMemory::createBackingStore(AddrRange range,
     // perform the actual mmap
     DPRINTF(BusAddrRanges, "Creating backing store for range %s with size %d\n",
             range.to_string(), range.size());
-    int map_flags = MAP_ANON | MAP_PRIVATE;
-    uint8_t* pmem = (uint8_t*) mmap(NULL, range.size(),
-                                    PROT_READ | PROT_WRITE,
-                                    map_flags, -1, 0);
+    uint64_t map_size;
+    uint8_t* pmem = mapBackingStore(range, map_size);
+
+    // the policy has to be in place before the pages are touched
+    if (!numaNodes.empty()) {
+        int node = numaNodes[backingStore.size() % numaNodes.size()];
+        if (node < 0)
+            node = currentNumaNode();
+        DPRINTF(BusAddrRanges, "Binding backing store for range %s to "
+                "NUMA node %d\n", range.to_string(), node);
+        if (!bindToNumaNode(pmem, map_size, node))
+            warn("Could not bind backing store for range %s to NUMA node "
+                 "%d\n", range.to_string(), node);
+    }
 
-    if (pmem == (uint8_t*) MAP_FAILED) {
-        perror("mmap");
-        fatal("Could not mmap %d bytes for range %s!\n", range.size(),
-              range.to_string());
+    if (prefault) {
+        DPRINTF(BusAddrRanges, "Faulting in backing store for range %s\n",
+                range.to_string());
+        prefaultRange(pmem, map_size, !numaNodes.empty());
     }
 
     // remember this backing store so we can checkpoint it and unmap
     // it appropriately
     backingStore.push_back(make_pair(range, pmem));
+    backingStoreMapSize.push_back(map_size);
 
     // point the memories to their backing store
     for (vector<AbstractMemory*>::const_iterator m = _memories.begin();
@@ -170,12 +340,54 @@ PhysicalMemory::createBackingStore(AddrRange range,
     }
 }
 
+uint8_t*
+PhysicalMemory::mapBackingStore(AddrRange range, uint64_t& map_size)
+{
+    uint64_t huge_bytes = hostHugePageBytes();
+    uint8_t* pmem = (uint8_t*) MAP_FAILED;
+
+    if (backingPages == Enums::explicit_huge_pages) {
+#ifdef MAP_HUGETLB
+        // hugetlbfs pages are set aside by the host beforehand, and
+        // the mapping has to be a whole number of them
+        map_size = roundUp(range.size(), huge_bytes);
+        pmem = (uint8_t*) mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+                               MAP_ANON | MAP_PRIVATE | MAP_HUGETLB, -1, 0);
+#endif
+        if (pmem == (uint8_t*) MAP_FAILED)
+            warn("Could not get huge pages for range %s, using transparent "
+                 "huge pages instead (see /proc/sys/vm/nr_hugepages)\n",
+                 range.to_string());
+        else
+            return pmem;
+    }
+
+    bool transparent = backingPages != Enums::small_pages;
+    map_size = range.size();
+    pmem = mmapAligned(map_size, transparent ? huge_bytes : 0);
+
+    if (pmem == (uint8_t*) MAP_FAILED) {
+        perror("mmap");
+        fatal("Could not mmap %d bytes for range %s!\n", range.size(),
+              range.to_string());
+    }
+
+    if (transparent) {
+#ifdef MADV_HUGEPAGE
+        if (madvise(pmem, map_size, MADV_HUGEPAGE) != 0)
+#endif
+            warn("Transparent huge pages are not available for range %s\n",
+                 range.to_string());
+    }
+
+    return pmem;
+}
+
 PhysicalMemory::~PhysicalMemory()
 {
     // unmap the backing store
-    for (vector<pair<AddrRange, uint8_t*> >::iterator s = backingStore.begin();
-         s != backingStore.end(); ++s)
-        munmap((char*)s->second, s->first.size());
+    for (int i = 0; i < backingStore.size(); ++i)
+        munmap((char*)backingStore[i].second, backingStoreMapSize[i]);
 }
 
 bool
@@ -289,6 +501,118 @@ PhysicalMemory::serialize(ostream& os)
     }
 }
 
+namespace {
+
+/** Bytes of the page bitmap in front of every chunk in the file. */
+const uint64_t chunkBitmapBytes = 256 / 8;
+
+bool
+isZero(const uint8_t* data, uint64_t len)
+{
+    const uint64_t* words = reinterpret_cast<const uint64_t*>(data);
+    uint64_t nbr_of_words = len / sizeof(uint64_t);
+    for (uint64_t i = 0; i < nbr_of_words; ++i)
+        if (words[i])
+            return false;
+    for (uint64_t i = nbr_of_words * sizeof(uint64_t); i < len; ++i)
+        if (data[i])
+            return false;
+    return true;
+}
+
+/**
+ * Pack one chunk of a backing store as the bitmap of its non-zero
+ * pages followed by those pages compressed with zlib. A chunk with
+ * only zero pages packs to nothing.
+ */
+bool
+packChunk(const uint8_t* pmem, uint64_t range_size, uint64_t page_bytes,
+          uint64_t chunk_pages, uint64_t chunk, vector<uint8_t>& out)
+{
+    uint64_t start = chunk * chunk_pages * page_bytes;
+    uint64_t end = std::min(start + chunk_pages * page_bytes, range_size);
+
+    out.assign(chunkBitmapBytes, 0);
+    vector<uint8_t> raw;
+    for (uint64_t p = 0; start + p * page_bytes < end; ++p) {
+        const uint8_t* page = pmem + start + p * page_bytes;
+        uint64_t len = std::min(page_bytes, end - (start + p * page_bytes));
+        if (!isZero(page, len)) {
+            out[p / 8] |= 1 << (p % 8);
+            raw.insert(raw.end(), page, page + len);
+        }
+    }
+
+    if (raw.empty()) {
+        out.clear();
+        return true;
+    }
+
+    uLongf compressed_size = compressBound(raw.size());
+    out.resize(chunkBitmapBytes + compressed_size);
+    if (compress2(&out[chunkBitmapBytes], &compressed_size, &raw[0],
+                  raw.size(), Z_BEST_SPEED) != Z_OK)
+        return false;
+    out.resize(chunkBitmapBytes + compressed_size);
+    return true;
+}
+
+/**
+ * Read back a chunk written by packChunk and scatter its non-zero
+ * pages into the backing store. The zero pages are not touched, so
+ * the host only commits memory for the pages that hold data.
+ */
+bool
+unpackChunk(int fd, uint8_t* pmem, uint64_t range_size, uint64_t page_bytes,
+            uint64_t chunk_pages, uint64_t chunk, uint64_t offset,
+            uint64_t packed_size)
+{
+    if (packed_size == 0)
+        return true;
+    if (packed_size < chunkBitmapBytes)
+        return false;
+
+    vector<uint8_t> packed(packed_size);
+    for (uint64_t done = 0; done < packed_size; ) {
+        ssize_t bytes = pread(fd, &packed[done], packed_size - done,
+                              offset + done);
+        if (bytes <= 0)
+            return false;
+        done += bytes;
+    }
+
+    uint64_t start = chunk * chunk_pages * page_bytes;
+    uint64_t end = std::min(start + chunk_pages * page_bytes, range_size);
+
+    uint64_t raw_size = 0;
+    for (uint64_t p = 0; start + p * page_bytes < end; ++p) {
+        if (packed[p / 8] & (1 << (p % 8)))
+            raw_size += std::min(page_bytes,
+                                 end - (start + p * page_bytes));
+    }
+
+    vector<uint8_t> raw(raw_size);
+    uLongf uncompressed_size = raw_size;
+    if (uncompress(&raw[0], &uncompressed_size, &packed[chunkBitmapBytes],
+                   packed_size - chunkBitmapBytes) != Z_OK ||
+        uncompressed_size != raw_size)
+        return false;
+
+    uint64_t raw_offset = 0;
+    for (uint64_t p = 0; start + p * page_bytes < end; ++p) {
+        if (packed[p / 8] & (1 << (p % 8))) {
+            uint64_t len = std::min(page_bytes,
+                                    end - (start + p * page_bytes));
+            memcpy(pmem + start + p * page_bytes, &raw[raw_offset], len);
+            raw_offset += len;
+        }
+    }
+
+    return true;
+}
+
+} // anonymous namespace
+
 void
 PhysicalMemory::serializeStore(ostream& os, unsigned int store_id,
                                AddrRange range, uint8_t* pmem)
@@ -305,6 +629,11 @@ PhysicalMemory::serializeStore(ostream& os, unsigned int store_id,
     SERIALIZE_SCALAR(filename);
     SERIALIZE_SCALAR(range_size);
 
+    uint64_t page_bytes = ckptPageBytes;
+    uint64_t chunk_pages = ckptChunkPages;
+    SERIALIZE_SCALAR(page_bytes);
+    SERIALIZE_SCALAR(chunk_pages);
+
     // write memory file
     string filepath = Checkpoint::dir() + "/" + filename.c_str();
     int fd = creat(filepath.c_str(), 0664);
@@ -314,32 +643,54 @@ PhysicalMemory::serializeStore(ostream& os, unsigned int store_id,
               filename);
     }
 
-    gzFile compressed_mem = gzdopen(fd, "wb");
-    if (compressed_mem == NULL)
-        fatal("Insufficient memory to allocate compression state for %s\n",
-              filename);
-
-    uint64_t pass_size = 0;
-
-    // gzwrite fails if (int)len < 0 (gzwrite returns int)
-    for (uint64_t written = 0; written < range.size();
-         written += pass_size) {
-        pass_size = (uint64_t)INT_MAX < (range.size() - written) ?
-            (uint64_t)INT_MAX : (range.size() - written);
-
-        if (gzwrite(compressed_mem, pmem + written,
-                    (unsigned int) pass_size) != (int) pass_size) {
-            fatal("Write failed on physical memory checkpoint file '%s'\n",
-                  filename);
+    uint64_t nbr_of_chunks = divCeil(range.size(), page_bytes * chunk_pages);
+    vector<uint64_t> chunk_offset(nbr_of_chunks, 0);
+    vector<uint64_t> chunk_size(nbr_of_chunks, 0);
+
+    // Compress a window of chunks in parallel, then append them to the
+    // file in order, so only the window is held in host memory
+    unsigned threads = hostThreads();
+    uint64_t window = threads * 4;
+    vector<vector<uint8_t> > packed(window);
+    uint64_t file_offset = 0;
+
+    for (uint64_t first = 0; first < nbr_of_chunks; first += window) {
+        uint64_t n = std::min(window, nbr_of_chunks - first);
+        bool ok = parallelFor(n, threads, [&](uint64_t i) {
+            return packChunk(pmem, range.size(), page_bytes, chunk_pages,
+                             first + i, packed[i]);
+        });
+        if (!ok)
+            fatal("Compression failed for physical memory checkpoint "
+                  "file '%s'\n", filename);
+
+        for (uint64_t i = 0; i < n; ++i) {
+            chunk_offset[first + i] = file_offset;
+            chunk_size[first + i] = packed[i].size();
+
+            for (uint64_t done = 0; done < packed[i].size(); ) {
+                ssize_t bytes = write(fd, &packed[i][done],
+                                      packed[i].size() - done);
+                if (bytes < 0) {
+                    perror("write");
+                    fatal("Write failed on physical memory checkpoint "
+                          "file '%s'\n", filename);
+                }
+                done += bytes;
+            }
+            file_offset += packed[i].size();
         }
     }
 
-    // close the compressed stream and check that the exit status
-    // is zero
-    if (gzclose(compressed_mem))
+    if (close(fd))
         fatal("Close failed on physical memory checkpoint file '%s'\n",
               filename);
 
+    arrayParamOut(os, "chunk_offset", chunk_offset);
+    arrayParamOut(os, "chunk_size", chunk_size);
+
+    DPRINTF(Checkpoint, "Wrote %d chunks, %d bytes\n", nbr_of_chunks,
+            file_offset);
 }
 
 void
@@ -370,8 +721,6 @@ PhysicalMemory::unserialize(Checkpoint* cp, const string& section)
 void
 PhysicalMemory::unserializeStore(Checkpoint* cp, const string& section)
 {
-    const uint32_t chunk_size = 16384;
-
     unsigned int store_id;
     UNSERIALIZE_SCALAR(store_id);
 
@@ -386,11 +735,6 @@ PhysicalMemory::unserializeStore(Checkpoint* cp, const string& section)
         fatal("Can't open physical memory checkpoint file '%s'", filename);
     }
 
-    gzFile compressed_mem = gzdopen(fd, "rb");
-    if (compressed_mem == NULL)
-        fatal("Insufficient memory to allocate compression state for %s\n",
-              filename);
-
     // we've already got the actual backing store mapped
     uint8_t* pmem = backingStore[store_id].second;
     AddrRange range = backingStore[store_id].first;
@@ -405,11 +749,61 @@ PhysicalMemory::unserializeStore(Checkpoint* cp, const string& section)
         fatal("Memory range size has changed! Saw %lld, expected %lld\n",
               range_size, range.size());
 
+    // checkpoints taken before the chunked format are one gzip stream
+    uint64_t chunk_pages;
+    if (!UNSERIALIZE_OPT_SCALAR(chunk_pages)) {
+        unserializeGzStore(fd, filename, pmem, range_size);
+        return;
+    }
+
+    uint64_t page_bytes;
+    UNSERIALIZE_SCALAR(page_bytes);
+    if (page_bytes == 0 || chunk_pages == 0 ||
+        chunk_pages > chunkBitmapBytes * 8)
+        fatal("Bad chunk geometry in physical memory checkpoint '%s'\n",
+              filename);
+
+    vector<uint64_t> chunk_offset;
+    vector<uint64_t> chunk_size;
+    arrayParamIn(cp, section, "chunk_offset", chunk_offset);
+    arrayParamIn(cp, section, "chunk_size", chunk_size);
+
+    uint64_t nbr_of_chunks = divCeil(range.size(), page_bytes * chunk_pages);
+    if (chunk_offset.size() != nbr_of_chunks ||
+        chunk_size.size() != nbr_of_chunks)
+        fatal("Physical memory checkpoint '%s' has %d chunks, expected "
+              "%d\n", filename, chunk_offset.size(), nbr_of_chunks);
+
+    bool ok = parallelFor(nbr_of_chunks, hostThreads(),
+                          [&](uint64_t i) {
+        return unpackChunk(fd, pmem, range.size(), page_bytes, chunk_pages,
+                           i, chunk_offset[i], chunk_size[i]);
+    });
+    if (!ok)
+        fatal("Read failed on physical memory checkpoint file '%s'\n",
+              filename);
+
+    if (close(fd))
+        fatal("Close failed on physical memory checkpoint file '%s'\n",
+              filename);
+}
+
+void
+PhysicalMemory::unserializeGzStore(int fd, const string& filename,
+                                   uint8_t* pmem, uint64_t range_size)
+{
+    const uint32_t chunk_size = 16384;
+
+    gzFile compressed_mem = gzdopen(fd, "rb");
+    if (compressed_mem == NULL)
+        fatal("Insufficient memory to allocate compression state for %s\n",
+              filename);
+
     uint64_t curr_size = 0;
     long* temp_page = new long[chunk_size];
     long* pmem_current;
     uint32_t bytes_read;
-    while (curr_size < range.size()) {
+    while (curr_size < range_size) {
         bytes_read = gzread(compressed_mem, temp_page, chunk_size);
         if (bytes_read == 0)
             break;
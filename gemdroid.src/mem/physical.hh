@@ -41,6 +41,7 @@
 #define __PHYSICAL_MEMORY_HH__
 
 #include "base/addr_range_map.hh"
+#include "enums/BackingPages.hh"
 #include "mem/port.hh"
 
 /**
@@ -63,6 +64,11 @@ class AbstractMemory;
  * mapping in the guest system. This enables us to arbitrarily change
  * the number of memory controllers, and their address mapping, as
  * long as the ranges stay the same.
+ *
+ * How the host provides the backing store is up to the system: it
+ * can be backed by transparent or hugetlbfs huge pages to cut down on
+ * host TLB misses, bound to host NUMA nodes, and faulted in up front
+ * rather than on first touch.
  */
 class PhysicalMemory : public Serializable
 {
@@ -88,6 +94,20 @@ class PhysicalMemory : public Serializable
     // system
     std::vector<std::pair<AddrRange, uint8_t*> > backingStore;
 
+    // The size of each backing store mapping, rounded up to whole
+    // huge pages when using hugetlbfs
+    std::vector<uint64_t> backingStoreMapSize;
+
+    // Host pages to back the memory with
+    const Enums::BackingPages backingPages;
+
+    // Host NUMA nodes the backing stores are bound to in turn, -1 is
+    // the node of the thread creating them; empty for no binding
+    const std::vector<int> numaNodes;
+
+    // Fault in the backing store when creating it
+    const bool prefault;
+
     // Prevent copying
     PhysicalMemory(const PhysicalMemory&);
 
@@ -105,13 +125,45 @@ class PhysicalMemory : public Serializable
     void createBackingStore(AddrRange range,
                             const std::vector<AbstractMemory*>& _memories);
 
+    /**
+     * Map the host memory for a backing store, with the huge pages
+     * asked for if the host has them.
+     *
+     * @param range The address range covered
+     * @param map_size Bytes actually mapped, to unmap them later
+     * @return The backing store
+     */
+    uint8_t* mapBackingStore(AddrRange range, uint64_t& map_size);
+
+    /**
+     * Checkpoints split each backing store in chunks of this many
+     * pages. The chunks are compressed independently, so they can be
+     * written and read by several threads, and the pages that are all
+     * zero are left out of the file altogether.
+     */
+    static const uint64_t ckptPageBytes = 4096;
+    static const uint64_t ckptChunkPages = 256;
+
+    /**
+     * Restore a backing store saved as a single gzip stream, the
+     * format used before chunked checkpoints.
+     */
+    void unserializeGzStore(int fd, const std::string& filename,
+                            uint8_t* pmem, uint64_t range_size);
+
   public:
 
     /**
      * Create a physical memory object, wrapping a number of memories.
+     *
+     * @param backing_pages Host pages to back the memory with
+     * @param numa_nodes Host NUMA nodes to bind the backing stores to
+     * @param prefault Fault the backing stores in up front
      */
     PhysicalMemory(const std::string& _name,
-                   const std::vector<AbstractMemory*>& _memories);
+                   const std::vector<AbstractMemory*>& _memories,
+                   Enums::BackingPages backing_pages,
+                   const std::vector<int>& numa_nodes, bool prefault);
 
     /**
      * Unmap all the backing store we have used.
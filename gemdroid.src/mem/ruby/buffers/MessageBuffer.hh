@@ -44,6 +44,7 @@
 #include "mem/packet.hh"
 #include "mem/ruby/buffers/MessageBufferNode.hh"
 #include "mem/ruby/common/Address.hh"
+#include "mem/ruby/common/AddressMap.hh"
 #include "mem/ruby/common/Consumer.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 
@@ -170,9 +171,9 @@ class MessageBuffer
     Consumer* m_consumer;
     std::vector<MessageBufferNode> m_prio_heap;
 
-    // use a std::map for the stalled messages as this container is
-    // sorted and ensures a well-defined iteration order
-    typedef std::map< Address, std::list<MsgPtr> > StallMsgMapType;
+    // stalled messages by address; the map is walked in hash slot
+    // order, which is not sorted but is deterministic from run to run
+    typedef AddressMap< std::list<MsgPtr> > StallMsgMapType;
 
     StallMsgMapType m_stall_msg_map;
     std::string m_name;
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 1999 Mark D. Hill and David A. Wood
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// An open-addressing hash map keyed by Address for the Ruby lookup
+// tables that sit on the access path (cache tag index, sequencer request
+// tables, message buffer stall map). Entries live in one flat array
+// probed linearly from a multiplicative hash, so a hit touches one or
+// two cache lines and an insert allocates only when the table grows.
+// Erase shifts the following entries of the probe run back instead of
+// leaving tombstones, so lookups never slow down as the table churns.
+//
+// The interface is the subset of std::map/m5::hash_map those tables
+// use. Iteration order is the slot order, and any insert or erase
+// invalidates iterators.
+
+#ifndef __MEM_RUBY_COMMON_ADDRESSMAP_HH__
+#define __MEM_RUBY_COMMON_ADDRESSMAP_HH__
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "mem/ruby/common/Address.hh"
+
+template <class T>
+class AddressMap
+{
+  public:
+    typedef Address key_type;
+    typedef T mapped_type;
+    typedef std::pair<Address, T> value_type;
+
+  private:
+    template <class Map, class Value>
+    class IteratorBase
+    {
+      public:
+        IteratorBase() : m_map(NULL), m_slot(0) { }
+        IteratorBase(Map *map, size_t slot) : m_map(map), m_slot(slot) { }
+
+        // iterator -> const_iterator
+        template <class M, class V>
+        IteratorBase(const IteratorBase<M, V> &other)
+            : m_map(other.m_map), m_slot(other.m_slot) { }
+
+        Value &operator*() const { return m_map->m_slots[m_slot]; }
+        Value *operator->() const { return &m_map->m_slots[m_slot]; }
+
+        IteratorBase &
+        operator++()
+        {
+            m_slot = m_map->nextUsed(m_slot + 1);
+            return *this;
+        }
+
+        bool
+        operator==(const IteratorBase &other) const
+        { return m_slot == other.m_slot; }
+
+        bool
+        operator!=(const IteratorBase &other) const
+        { return m_slot != other.m_slot; }
+
+      private:
+        Map *m_map;
+        size_t m_slot;
+
+        template <class M, class V> friend class IteratorBase;
+        friend class AddressMap;
+    };
+
+  public:
+    typedef IteratorBase<AddressMap, value_type> iterator;
+    typedef IteratorBase<const AddressMap, const value_type> const_iterator;
+
+    AddressMap() : m_size(0) { rehash(MIN_CAPACITY); }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    iterator begin() { return iterator(this, nextUsed(0)); }
+    iterator end() { return iterator(this, m_slots.size()); }
+    const_iterator begin() const { return const_iterator(this, nextUsed(0)); }
+    const_iterator end() const
+    { return const_iterator(this, m_slots.size()); }
+
+    iterator
+    find(const Address &key)
+    {
+        return iterator(this, lookup(key));
+    }
+
+    const_iterator
+    find(const Address &key) const
+    {
+        return const_iterator(this, lookup(key));
+    }
+
+    size_t count(const Address &key) const
+    { return lookup(key) != m_slots.size(); }
+
+    std::pair<iterator, bool>
+    insert(const value_type &entry)
+    {
+        size_t slot = lookup(entry.first);
+        if (slot != m_slots.size())
+            return std::make_pair(iterator(this, slot), false);
+
+        slot = place(entry.first);
+        m_slots[slot].second = entry.second;
+        return std::make_pair(iterator(this, slot), true);
+    }
+
+    T &
+    operator[](const Address &key)
+    {
+        size_t slot = lookup(key);
+        if (slot == m_slots.size())
+            slot = place(key);
+        return m_slots[slot].second;
+    }
+
+    size_t
+    erase(const Address &key)
+    {
+        size_t slot = lookup(key);
+        if (slot == m_slots.size())
+            return 0;
+        eraseSlot(slot);
+        return 1;
+    }
+
+    void
+    erase(iterator it)
+    {
+        assert(it.m_map == this && m_used[it.m_slot]);
+        eraseSlot(it.m_slot);
+    }
+
+    void
+    clear()
+    {
+        for (size_t i = 0; i < m_slots.size(); i++) {
+            if (m_used[i]) {
+                m_used[i] = false;
+                m_slots[i].second = T();
+            }
+        }
+        m_size = 0;
+    }
+
+  private:
+    static const size_t MIN_CAPACITY = 16;
+
+    std::vector<value_type> m_slots;
+    std::vector<bool> m_used;
+    size_t m_size;
+    size_t m_mask;
+    int m_shift;
+
+    // Fibonacci hashing: the top bits of the product depend on every
+    // address bit, so line-aligned keys still spread over the table
+    size_t
+    home(const Address &key) const
+    {
+        return (size_t)((key.getAddress() * 0x9E3779B97F4A7C15ULL)
+                        >> m_shift);
+    }
+
+    size_t
+    nextUsed(size_t slot) const
+    {
+        while (slot < m_slots.size() && !m_used[slot])
+            slot++;
+        return slot;
+    }
+
+    // Slot holding key, or m_slots.size() if absent
+    size_t
+    lookup(const Address &key) const
+    {
+        for (size_t i = home(key); m_used[i]; i = (i + 1) & m_mask) {
+            if (m_slots[i].first == key)
+                return i;
+        }
+        return m_slots.size();
+    }
+
+    // Claims a free slot for a key known to be absent
+    size_t
+    place(const Address &key)
+    {
+        // keep the load factor at or below 3/4
+        if ((m_size + 1) * 4 > m_slots.size() * 3)
+            rehash(m_slots.size() * 2);
+
+        size_t i = home(key);
+        while (m_used[i])
+            i = (i + 1) & m_mask;
+        m_used[i] = true;
+        m_slots[i].first = key;
+        m_size++;
+        return i;
+    }
+
+    void
+    eraseSlot(size_t hole)
+    {
+        // Walk the rest of the probe run and pull back every entry whose
+        // home is not between the hole and its current slot, so no
+        // lookup ever has to step over an empty slot to reach its key.
+        for (size_t j = (hole + 1) & m_mask; m_used[j]; j = (j + 1) & m_mask) {
+            size_t dist_home = (j - home(m_slots[j].first)) & m_mask;
+            size_t dist_hole = (j - hole) & m_mask;
+            if (dist_home >= dist_hole) {
+                std::swap(m_slots[hole], m_slots[j]);
+                hole = j;
+            }
+        }
+        m_used[hole] = false;
+        m_slots[hole].second = T();
+        m_size--;
+    }
+
+    void
+    rehash(size_t capacity)
+    {
+        std::vector<value_type> old_slots(capacity);
+        std::vector<bool> old_used(capacity, false);
+        old_slots.swap(m_slots);
+        old_used.swap(m_used);
+
+        m_mask = capacity - 1;
+        m_shift = 64;
+        for (size_t c = capacity; c > 1; c >>= 1)
+            m_shift--;
+
+        for (size_t i = 0; i < old_slots.size(); i++) {
+            if (!old_used[i])
+                continue;
+            size_t j = home(old_slots[i].first);
+            while (m_used[j])
+                j = (j + 1) & m_mask;
+            m_used[j] = true;
+            std::swap(m_slots[j], old_slots[i]);
+        }
+    }
+};
+
+template <class T>
+inline std::ostream &
+operator<<(std::ostream &out, const AddressMap<T> &map)
+{
+    typename AddressMap<T>::const_iterator i = map.begin();
+    typename AddressMap<T>::const_iterator end = map.end();
+
+    out << "[";
+    for (; i != end; ++i)
+        out << " " << i->first << "=" << i->second;
+    out << " ]";
+
+    return out;
+}
+
+#endif // __MEM_RUBY_COMMON_ADDRESSMAP_HH__
@@ -70,6 +70,8 @@ class Consumer
 
     void scheduleEventAbsolute(Tick timeAbs);
 
+    EventQueue *getEventQueue() const { return em->eventQueue(); }
+
   protected:
     void scheduleEvent(Cycles timeDelta);
 
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 1999-2008 Mark D. Hill and David A. Wood
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// A bit vector whose width is fixed at compile time. The words live
+// inline, so copying one is a plain memcpy and no operation allocates.
+// The whole-set operations walk a constant number of 64-bit words,
+// which the compiler unrolls and vectorizes, and counting and bit
+// search go through the popcount/ctz builtins. They also take the
+// number of words to look at, for callers that know all bits past
+// those words are clear and would otherwise walk mostly empty words.
+
+#ifndef __MEM_RUBY_COMMON_FIXEDBITSET_HH__
+#define __MEM_RUBY_COMMON_FIXEDBITSET_HH__
+
+#include <stdint.h>
+
+#include <cassert>
+
+#include "base/bitfield.hh"
+
+template <int MaxBits>
+class FixedBitSet
+{
+  public:
+    static const int WORD_BITS = 64;
+    static const int WORD_SHIFT = 6;
+    static const int WORD_MASK = WORD_BITS - 1;
+    static const int NUM_WORDS = (MaxBits + WORD_BITS - 1) / WORD_BITS;
+    static const int MAX_BITS = NUM_WORDS * WORD_BITS;
+
+    FixedBitSet() { clear(); }
+
+    void
+    clear()
+    {
+        for (int i = 0; i < NUM_WORDS; i++)
+            m_words[i] = 0;
+    }
+
+    void
+    set(int index)
+    {
+        assert(index >= 0 && index < MAX_BITS);
+        m_words[index >> WORD_SHIFT] |= bit(index);
+    }
+
+    void
+    reset(int index)
+    {
+        assert(index >= 0 && index < MAX_BITS);
+        m_words[index >> WORD_SHIFT] &= ~bit(index);
+    }
+
+    bool
+    test(int index) const
+    {
+        assert(index >= 0 && index < MAX_BITS);
+        return (m_words[index >> WORD_SHIFT] & bit(index)) != 0;
+    }
+
+    // Sets bits [lo, hi)
+    void
+    setRange(int lo, int hi)
+    {
+        assert(lo >= 0 && lo <= hi && hi <= MAX_BITS);
+        for (int i = 0; i < NUM_WORDS; i++)
+            m_words[i] |= rangeMask(i, lo, hi);
+    }
+
+    // Clears bits [lo, hi)
+    void
+    resetRange(int lo, int hi)
+    {
+        assert(lo >= 0 && lo <= hi && hi <= MAX_BITS);
+        for (int i = 0; i < NUM_WORDS; i++)
+            m_words[i] &= ~rangeMask(i, lo, hi);
+    }
+
+    // True iff every bit in [lo, hi) is set
+    bool
+    allInRange(int lo, int hi) const
+    {
+        assert(lo >= 0 && lo <= hi && hi <= MAX_BITS);
+        uint64_t missing = 0;
+        for (int i = 0; i < NUM_WORDS; i++)
+            missing |= rangeMask(i, lo, hi) & ~m_words[i];
+        return missing == 0;
+    }
+
+    // Number of set bits in [lo, hi)
+    int
+    countRange(int lo, int hi) const
+    {
+        assert(lo >= 0 && lo <= hi && hi <= MAX_BITS);
+        int counter = 0;
+        for (int i = 0; i < NUM_WORDS; i++)
+            counter += popCount(m_words[i] & rangeMask(i, lo, hi));
+        return counter;
+    }
+
+    void
+    orWith(const FixedBitSet& other, int words = NUM_WORDS)
+    {
+        for (int i = 0; i < words; i++)
+            m_words[i] |= other.m_words[i];
+    }
+
+    void
+    andWith(const FixedBitSet& other, int words = NUM_WORDS)
+    {
+        for (int i = 0; i < words; i++)
+            m_words[i] &= other.m_words[i];
+    }
+
+    void
+    andNotWith(const FixedBitSet& other, int words = NUM_WORDS)
+    {
+        for (int i = 0; i < words; i++)
+            m_words[i] &= ~other.m_words[i];
+    }
+
+    // The reductions below OR/AND every word together instead of
+    // returning early, so the loops stay branch free and vectorize.
+    bool
+    intersects(const FixedBitSet& other, int words = NUM_WORDS) const
+    {
+        uint64_t common = 0;
+        for (int i = 0; i < words; i++)
+            common |= m_words[i] & other.m_words[i];
+        return common != 0;
+    }
+
+    bool
+    isSupersetOf(const FixedBitSet& other, int words = NUM_WORDS) const
+    {
+        uint64_t missing = 0;
+        for (int i = 0; i < words; i++)
+            missing |= other.m_words[i] & ~m_words[i];
+        return missing == 0;
+    }
+
+    bool
+    equals(const FixedBitSet& other, int words = NUM_WORDS) const
+    {
+        uint64_t diff = 0;
+        for (int i = 0; i < words; i++)
+            diff |= m_words[i] ^ other.m_words[i];
+        return diff == 0;
+    }
+
+    bool
+    none(int words = NUM_WORDS) const
+    {
+        uint64_t any = 0;
+        for (int i = 0; i < words; i++)
+            any |= m_words[i];
+        return any == 0;
+    }
+
+    int
+    count(int words = NUM_WORDS) const
+    {
+        int counter = 0;
+        for (int i = 0; i < words; i++)
+            counter += popCount(m_words[i]);
+        return counter;
+    }
+
+    // Index of the lowest set bit at or above start, or -1 if none
+    int
+    findNext(int start) const
+    {
+        if (start >= MAX_BITS)
+            return -1;
+        int i = start >> WORD_SHIFT;
+        uint64_t w = m_words[i] & (~(uint64_t)0 << (start & WORD_MASK));
+        while (true) {
+            if (w)
+                return (i << WORD_SHIFT) + findLsbSet(w);
+            if (++i == NUM_WORDS)
+                return -1;
+            w = m_words[i];
+        }
+    }
+
+    int findFirst() const { return findNext(0); }
+
+    uint64_t getWord(int i) const { return m_words[i]; }
+    void setWord(int i, uint64_t w) { m_words[i] = w; }
+
+  private:
+    static uint64_t bit(int index)
+    { return (uint64_t)1 << (index & WORD_MASK); }
+
+    // The part of [lo, hi) that falls in word i
+    static uint64_t
+    rangeMask(int i, int lo, int hi)
+    {
+        int base = i * WORD_BITS;
+        int l = lo - base;
+        int h = hi - base;
+        if (l < 0)
+            l = 0;
+        if (h > WORD_BITS)
+            h = WORD_BITS;
+        if (l >= h)
+            return 0;
+        uint64_t upper = (h == WORD_BITS) ? ~(uint64_t)0
+                                          : (((uint64_t)1 << h) - 1);
+        return upper & (~(uint64_t)0 << l);
+    }
+
+    uint64_t m_words[NUM_WORDS];
+};
+
+#endif // __MEM_RUBY_COMMON_FIXEDBITSET_HH__
@@ -28,8 +28,11 @@
 
 #include <algorithm>
 
+#include "base/misc.hh"
 #include "mem/ruby/common/NetDest.hh"
 
+int NetDest::s_words = 0;
+
 NetDest::NetDest()
 {
   resize();
@@ -38,74 +41,77 @@ NetDest::NetDest()
 void
 NetDest::add(MachineID newElement)
 {
-    assert(bitIndex(newElement.num) < m_bits[vecIndex(newElement)].getSize());
-    m_bits[vecIndex(newElement)].add(bitIndex(newElement.num));
+    int index = bitIndex(newElement);
+    useBits(index + 1);
+    m_bits.set(index);
 }
 
 void
 NetDest::addNetDest(const NetDest& netDest)
 {
-    assert(m_bits.size() == netDest.getSize());
-    for (int i = 0; i < m_bits.size(); i++) {
-        m_bits[i].addSet(netDest.m_bits[i]);
-    }
+    m_bits.orWith(netDest.m_bits, s_words);
 }
 
 void
 NetDest::addRandom()
 {
-    int i = random()%m_bits.size();
-    m_bits[i].addRandom();
+    MachineType machine = (MachineType)(random() % MachineType_NUM);
+    int base = MachineType_base_number(machine);
+    useBits(base + MachineType_base_count(machine));
+    for (int j = 0; j < MachineType_base_count(machine); j++) {
+        if (random() & 1)
+            m_bits.set(base + j);
+    }
 }
 
 void
 NetDest::setNetDest(MachineType machine, const Set& set)
 {
-    // assure that there is only one set of destinations for this machine
-    assert(MachineType_base_level((MachineType)(machine + 1)) -
-           MachineType_base_level(machine) == 1);
-    m_bits[MachineType_base_level(machine)] = set;
+    int base = MachineType_base_number(machine);
+    int size = MachineType_base_count(machine);
+    assert(set.getSize() <= size);
+
+    useBits(base + size);
+    m_bits.resetRange(base, base + size);
+    for (int j = 0; j < set.getSize(); j++) {
+        if (set.isElement(j))
+            m_bits.set(base + j);
+    }
 }
 
 void
 NetDest::remove(MachineID oldElement)
 {
-    m_bits[vecIndex(oldElement)].remove(bitIndex(oldElement.num));
+    m_bits.reset(bitIndex(oldElement));
 }
 
 void
 NetDest::removeNetDest(const NetDest& netDest)
 {
-    assert(m_bits.size() == netDest.getSize());
-    for (int i = 0; i < m_bits.size(); i++) {
-        m_bits[i].removeSet(netDest.m_bits[i]);
-    }
+    m_bits.andNotWith(netDest.m_bits, s_words);
 }
 
 void
 NetDest::clear()
 {
-    for (int i = 0; i < m_bits.size(); i++) {
-        m_bits[i].clear();
-    }
+    m_bits.clear();
 }
 
 void
 NetDest::broadcast()
 {
-    for (MachineType machine = MachineType_FIRST;
-         machine < MachineType_NUM; ++machine) {
-        broadcast(machine);
-    }
+    int machines = MachineType_base_number(MachineType_NUM);
+    useBits(machines);
+    m_bits.setRange(0, machines);
 }
 
 void
 NetDest::broadcast(MachineType machineType)
 {
-    for (NodeID i = 0; i < MachineType_base_count(machineType); i++) {
-        MachineID mach = {machineType, i};
-        add(mach);
-    }
+    int base = MachineType_base_number(machineType);
+    int end = base + MachineType_base_count(machineType);
+    useBits(end);
+    m_bits.setRange(base, end);
 }
 
 //For Princeton Network
@@ -113,96 +119,71 @@ std::vector<NodeID>
 NetDest::getAllDest()
 {
     std::vector<NodeID> dest;
-    dest.clear();
-    for (int i = 0; i < m_bits.size(); i++) {
-        for (int j = 0; j < m_bits[i].getSize(); j++) {
-            if (m_bits[i].isElement(j)) {
-                int id = MachineType_base_number((MachineType)i) + j;
-                dest.push_back((NodeID)id);
-            }
-        }
-    }
+    for (int id = m_bits.findFirst(); id >= 0; id = m_bits.findNext(id + 1))
+        dest.push_back((NodeID)id);
     return dest;
 }
 
 int
 NetDest::count() const
 {
-    int counter = 0;
-    for (int i = 0; i < m_bits.size(); i++) {
-        counter += m_bits[i].count();
-    }
-    return counter;
+    return m_bits.count(s_words);
 }
 
 NodeID
 NetDest::elementAt(MachineID index)
 {
-    return m_bits[vecIndex(index)].elementAt(bitIndex(index.num));
+    return m_bits.test(bitIndex(index)) ? (NodeID)true : 0;
 }
 
 MachineID
 NetDest::smallestElement() const
 {
-    assert(count() > 0);
-    for (int i = 0; i < m_bits.size(); i++) {
-        for (NodeID j = 0; j < m_bits[i].getSize(); j++) {
-            if (m_bits[i].isElement(j)) {
-                MachineID mach = {MachineType_from_base_level(i), j};
-                return mach;
-            }
-        }
-    }
-    panic("No smallest element of an empty set.");
+    int first = m_bits.findFirst();
+    if (first < 0)
+        panic("No smallest element of an empty set.");
+
+    MachineType machine = MachineType_FIRST;
+    while (first >= MachineType_base_number((MachineType)(machine + 1)))
+        ++machine;
+
+    MachineID mach = {machine,
+                      (NodeID)(first - MachineType_base_number(machine))};
+    return mach;
 }
 
 MachineID
 NetDest::smallestElement(MachineType machine) const
 {
-    int size = m_bits[MachineType_base_level(machine)].getSize();
-    for (NodeID j = 0; j < size; j++) {
-        if (m_bits[MachineType_base_level(machine)].isElement(j)) {
-            MachineID mach = {machine, j};
-            return mach;
-        }
-    }
+    int base = MachineType_base_number(machine);
+    int first = m_bits.findNext(base);
+    if (first < 0 || first >= base + MachineType_base_count(machine))
+        panic("No smallest element of given MachineType.");
 
-    panic("No smallest element of given MachineType.");
+    MachineID mach = {machine, (NodeID)(first - base)};
+    return mach;
 }
 
 // Returns true iff all bits are set
 bool
 NetDest::isBroadcast() const
 {
-    for (int i = 0; i < m_bits.size(); i++) {
-        if (!m_bits[i].isBroadcast()) {
-            return false;
-        }
-    }
-    return true;
+    return m_bits.allInRange(0, MachineType_base_number(MachineType_NUM));
 }
 
 // Returns true iff no bits are set
 bool
 NetDest::isEmpty() const
 {
-    for (int i = 0; i < m_bits.size(); i++) {
-        if (!m_bits[i].isEmpty()) {
-            return false;
-        }
-    }
-    return true;
+    return m_bits.none(s_words);
 }
 
 // returns the logical OR of "this" set and orNetDest
 NetDest
 NetDest::OR(const NetDest& orNetDest) const
 {
-    assert(m_bits.size() == orNetDest.getSize());
-    NetDest result;
-    for (int i = 0; i < m_bits.size(); i++) {
-        result.m_bits[i] = m_bits[i].OR(orNetDest.m_bits[i]);
-    }
+    NetDest result(*this);
+    result.m_bits.orWith(orNetDest.m_bits, s_words);
     return result;
 }
 
@@ -210,11 +191,8 @@ NetDest::OR(const NetDest& orNetDest) const
 NetDest
 NetDest::AND(const NetDest& andNetDest) const
 {
-    assert(m_bits.size() == andNetDest.getSize());
-    NetDest result;
-    for (int i = 0; i < m_bits.size(); i++) {
-        result.m_bits[i] = m_bits[i].AND(andNetDest.m_bits[i]);
-    }
+    NetDest result(*this);
+    result.m_bits.andWith(andNetDest.m_bits, s_words);
     return result;
 }
 
@@ -222,53 +200,44 @@ NetDest::AND(const NetDest& andNetDest) const
 bool
 NetDest::intersectionIsNotEmpty(const NetDest& other_netDest) const
 {
-    assert(m_bits.size() == other_netDest.getSize());
-    for (int i = 0; i < m_bits.size(); i++) {
-        if (!m_bits[i].intersectionIsEmpty(other_netDest.m_bits[i])) {
-            return true;
-        }
-    }
-    return false;
+    return m_bits.intersects(other_netDest.m_bits, s_words);
 }
 
 bool
 NetDest::isSuperset(const NetDest& test) const
 {
-    assert(m_bits.size() == test.getSize());
-
-    for (int i = 0; i < m_bits.size(); i++) {
-        if (!m_bits[i].isSuperset(test.m_bits[i])) {
-            return false;
-        }
-    }
-    return true;
+    return m_bits.isSupersetOf(test.m_bits, s_words);
 }
 
 bool
 NetDest::isElement(MachineID element) const
 {
-    return ((m_bits[vecIndex(element)])).isElement(bitIndex(element.num));
+    return m_bits.test(bitIndex(element));
 }
 
 void
 NetDest::resize()
 {
-    m_bits.resize(MachineType_base_level(MachineType_NUM));
-    assert(m_bits.size() == MachineType_NUM);
+    int machines = MachineType_base_number(MachineType_NUM);
+    if (machines > NETDEST_MAX_MACHINES)
+        fatal("%d machines exceed the %d a NetDest can hold; "
+              "raise NETDEST_MAX_MACHINES in NetDest.hh\n",
+              machines, NETDEST_MAX_MACHINES);
 
-    for (int i = 0; i < m_bits.size(); i++) {
-        m_bits[i].setSize(MachineType_base_count((MachineType)i));
-    }
+    useBits(machines);
+    m_bits.clear();
 }
 
 void
 NetDest::print(std::ostream& out) const
 {
-    out << "[NetDest (" << m_bits.size() << ") ";
+    out << "[NetDest (" << MachineType_NUM << ") ";
 
-    for (int i = 0; i < m_bits.size(); i++) {
-        for (int j = 0; j < m_bits[i].getSize(); j++) {
-            out << (bool) m_bits[i].isElement(j) << " ";
+    for (MachineType machine = MachineType_FIRST;
+         machine < MachineType_NUM; ++machine) {
+        int base = MachineType_base_number(machine);
+        for (int j = 0; j < MachineType_base_count(machine); j++) {
+            out << (bool) m_bits.test(base + j) << " ";
         }
         out << " - ";
     }
@@ -278,10 +247,5 @@ NetDest::print(std::ostream& out) const
 bool
 NetDest::isEqual(const NetDest& n) const
 {
-    assert(m_bits.size() == n.m_bits.size());
-    for (unsigned int i = 0; i < m_bits.size(); ++i) {
-        if (!m_bits[i].isEqual(n.m_bits[i]))
-            return false;
-    }
-    return true;
+    return m_bits.equals(n.m_bits, s_words);
 }
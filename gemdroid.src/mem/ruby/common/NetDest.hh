@@ -37,9 +37,14 @@
 #include <iostream>
 #include <vector>
 
+#include "mem/ruby/common/FixedBitSet.hh"
 #include "mem/ruby/common/Set.hh"
 #include "mem/ruby/system/MachineID.hh"
 
+// Upper bound on the machines (controllers of all types) in the system.
+// Every NetDest carries this many bits inline.
+const int NETDEST_MAX_MACHINES = 512;
+
 class NetDest
 {
   public:
@@ -75,7 +80,11 @@ class NetDest
     bool intersectionIsNotEmpty(const NetDest& other_netDest) const;
 
     // Returns true if the intersection of the two netDests is empty
-    bool intersectionIsEmpty(const NetDest& other_netDest) const;
+    bool
+    intersectionIsEmpty(const NetDest& other_netDest) const
+    {
+        return !intersectionIsNotEmpty(other_netDest);
+    }
 
     bool isSuperset(const NetDest& test) const;
     bool isSubset(const NetDest& test) const { return test.isSuperset(*this); }
@@ -90,7 +99,7 @@ class NetDest
     MachineID smallestElement(MachineType machine) const;
 
     void resize();
-    int getSize() const { return m_bits.size(); }
+    int getSize() const { return MachineType_NUM; }
 
     // get element for a index
     NodeID elementAt(MachineID index);
@@ -98,19 +107,33 @@ class NetDest
     void print(std::ostream& out) const;
 
   private:
-    // returns a value >= MachineType_base_level("this machine")
-    // and < MachineType_base_level("next highest machine")
+    // The destinations are one flat bit vector. The machines of each
+    // type occupy the bits [MachineType_base_number(type),
+    // MachineType_base_number(type + 1)), so a MachineID maps to the same
+    // index the networks use for it (see getAllDest()).
     int
-    vecIndex(MachineID m) const
+    bitIndex(MachineID m) const
+    {
+        assert((int)m.num < MachineType_base_count(m.type));
+        return MachineType_base_number(m.type) + m.num;
+    }
+
+    // Records that bits below hi may be set. The whole-set operations
+    // only walk the words up to the highest bit any NetDest can have
+    // set, which covers the machines in the system rather than all
+    // NETDEST_MAX_MACHINES bits.
+    static void
+    useBits(int hi)
     {
-        int vec_index = MachineType_base_level(m.type);
-        assert(vec_index < m_bits.size());
-        return vec_index;
+        const int word_bits = FixedBitSet<NETDEST_MAX_MACHINES>::WORD_BITS;
+        int words = (hi + word_bits - 1) / word_bits;
+        if (words > s_words)
+            s_words = words;
     }
 
-    NodeID bitIndex(NodeID index) const { return index; }
+    static int s_words;
 
-    std::vector<Set> m_bits;  // a vector of bit vectors - i.e. Sets
+    FixedBitSet<NETDEST_MAX_MACHINES> m_bits;
 };
 
 inline std::ostream&
@@ -33,57 +33,35 @@
 #define __MEM_RUBY_COMMON_SET_HH__
 
 #include <iostream>
-#include <limits>
 
+#include "mem/ruby/common/FixedBitSet.hh"
 #include "mem/ruby/common/TypeDefines.hh"
 
 /*
- * This defines the number of longs (32-bits on 32 bit machines,
- * 64-bit on 64-bit AMD machines) to use to hold the set...
- * the default is 4, allowing 128 or 256 different members
- * of the set.
- *
- * This should never need to be changed for correctness reasons,
- * though increasing it will increase performance for larger
- * set sizes at the cost of a (much) larger memory footprint
- *
+ * This defines the number of 64-bit words used to hold the set, i.e.
+ * the largest set is 64 * NUMBER_WORDS_PER_SET members. The words are
+ * held inline in every Set, so there is no heap allocation on copy;
+ * sizing a Set beyond this is a fatal error rather than a slow path.
  */
-const int NUMBER_WORDS_PER_SET = 1;
+const int NUMBER_WORDS_PER_SET = 4;
 
 class Set
 {
   private:
-    int m_nSize;              // the number of bits in this set
-    int m_nArrayLen;          // the number of 32-bit words that are
-                              // held in the array
-
-    // Changed 5/24/05 for static allocation of array
-    // note that "long" corresponds to 32 bits on a 32-bit machine,
-    // 64 bits if the -m64 parameter is passed to g++, which it is
-    // for an AMD opteron under our configuration
-
-    long *m_p_nArray;      // an word array to hold the bits in the set
-    long m_p_nArray_Static[NUMBER_WORDS_PER_SET];
-
-    static const int LONG_BITS = std::numeric_limits<long>::digits + 1;
-    static const int INDEX_SHIFT = LONG_BITS == 64 ? 6 : 5;
-    static const int INDEX_MASK = (1 << INDEX_SHIFT) - 1;
+    typedef FixedBitSet<64 * NUMBER_WORDS_PER_SET> Bits;
 
-    void clearExcess();
+    int m_nSize;              // the number of bits in this set
+    Bits m_bits;              // bits at or above m_nSize are always 0
 
   public:
     Set();
     Set(int size);
-    Set(const Set& obj);
-    ~Set();
-
-    Set& operator=(const Set& obj);
 
     void
     add(NodeID index)
     {
-        m_p_nArray[index >> INDEX_SHIFT] |=
-            (((unsigned long) 1) << (index & INDEX_MASK));
+        assert((int)index < m_nSize);
+        m_bits.set(index);
     }
 
     void addSet(const Set& set);
@@ -92,21 +70,16 @@ class Set
     void
     remove(NodeID index)
     {
-        m_p_nArray[index >> INDEX_SHIFT] &=
-            ~(((unsigned long)1) << (index & INDEX_MASK));
+        assert((int)index < m_nSize);
+        m_bits.reset(index);
     }
 
     void removeSet(const Set& set);
 
-    void
-    clear()
-    {
-        for (int i = 0; i < m_nArrayLen; i++)
-            m_p_nArray[i] = 0;
-    }
+    void clear() { m_bits.clear(); }
 
     void broadcast();
-    int count() const;
+    int count() const { return m_bits.count(); }
     bool isEqual(const Set& set) const;
 
     // return the logical OR of this set and orSet
@@ -119,10 +92,7 @@ class Set
     bool
     intersectionIsEmpty(const Set& other_set) const
     {
-        for (int i = 0; i < m_nArrayLen; i++)
-            if (m_p_nArray[i] & other_set.m_p_nArray[i])
-                return false;
-        return true;
+        return !m_bits.intersects(other_set.m_bits);
     }
 
     bool isSuperset(const Set& test) const;
@@ -131,12 +101,11 @@ class Set
     bool
     isElement(NodeID element) const
     {
-        return (m_p_nArray[element>>INDEX_SHIFT] &
-            (((unsigned long)1) << (element & INDEX_MASK))) != 0;
+        return (int)element < m_nSize && m_bits.test(element);
     }
 
-    bool isBroadcast() const;
-    bool isEmpty() const;
+    bool isBroadcast() const { return m_bits.allInRange(0, m_nSize); }
+    bool isEmpty() const { return m_bits.none(); }
 
     NodeID smallestElement() const;
 
@@ -31,6 +31,8 @@
 #ifndef __MEM_RUBY_NETWORK_GARNET_NETWORKHEADER_HH__
 #define __MEM_RUBY_NETWORK_GARNET_NETWORKHEADER_HH__
 
+#include <stdint.h>
+
 enum flit_type {HEAD_, BODY_, TAIL_, HEAD_TAIL_, NUM_FLIT_TYPE_};
 enum VC_state_type {IDLE_, VC_AB_, ACTIVE_, NUM_VC_STATE_TYPE_};
 enum VNET_type {CTRL_VNET_, DATA_VNET_, NULL_VNET_, NUM_VNET_TYPE_};
@@ -38,4 +40,24 @@ enum flit_stage {I_, VA_, SA_, ST_, LT_, NUM_FLIT_STAGE_};
 
 #define INFINITE_ 10000
 
+// Per-port VC and port sets are kept as 64-bit masks
+#define MAX_VCS_PER_PORT_ 64
+
+// Mask with the low n bits set
+inline uint64_t
+lowBitsMask(int n)
+{
+    return (n >= 64) ? ~0ULL : ((1ULL << n) - 1);
+}
+
+// Rotate the low width bits of mask right so that bit start becomes bit 0;
+// walking the result from its LSB visits start, start+1, ... round robin.
+inline uint64_t
+rotateMask(uint64_t mask, int start, int width)
+{
+    if (start == 0)
+        return mask;
+    return ((mask >> start) | (mask << (width - start))) & lowBitsMask(width);
+}
+
 #endif // __MEM_RUBY_NETWORK_GARNET_NETWORKHEADER_HH__
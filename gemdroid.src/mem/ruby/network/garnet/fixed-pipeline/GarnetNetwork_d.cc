@@ -29,8 +29,11 @@
  */
 
 #include <cassert>
+#include <numeric>
 
 #include "base/cast.hh"
+#include "base/misc.hh"
+#include "base/output.hh"
 #include "base/stl_helpers.hh"
 #include "mem/ruby/common/Global.hh"
 #include "mem/ruby/common/NetDest.hh"
@@ -45,10 +48,16 @@ using namespace std;
 using m5::stl_helpers::deletePointers;
 
 GarnetNetwork_d::GarnetNetwork_d(const Params *p)
-    : BaseGarnetNetwork(p)
+    : BaseGarnetNetwork(p), m_power_trace_event(this)
 {
     m_buffers_per_data_vc = p->buffers_per_data_vc;
     m_buffers_per_ctrl_vc = p->buffers_per_ctrl_vc;
+    m_num_partitions = p->num_partitions;
+    m_orion_freq_Hz = 0;
+    m_static_power = 0;
+    m_power_trace_cycles = p->power_trace_cycles;
+    m_power_trace = NULL;
+    m_trace_energy = 0;
 
     m_vnet_type.resize(m_virtual_networks);
     for (int i = 0; i < m_vnet_type.size(); i++) {
@@ -83,6 +92,9 @@ GarnetNetwork_d::init()
         m_nis[i]->addNode(m_toNetQueues[i], m_fromNetQueues[i]);
     }
 
+    if (m_num_partitions > 1)
+        partitionRouters();
+
     // The topology pointer should have already been initialized in the
     // parent network constructor
     assert(m_topology_ptr != NULL);
@@ -106,6 +118,26 @@ GarnetNetwork_d::init()
     }
 }
 
+void
+GarnetNetwork_d::startup()
+{
+    BaseGarnetNetwork::startup();
+
+    if (m_power_trace_cycles == 0)
+        return;
+
+    // The counters of other partitions are only consistent at quantum
+    // boundaries, which the trace does not line up with
+    fatal_if(m_num_partitions > 1,
+             "%s: the power trace needs num_partitions = 1\n", name());
+
+    m_power_trace = simout.create("noc_power.trace");
+    *m_power_trace << "# cycle dynamic_W static_W" << endl;
+    m_trace_cycle = curCycle();
+    m_trace_energy = get_dynamic_energy();
+    schedule(m_power_trace_event, clockEdge(m_power_trace_cycles));
+}
+
 GarnetNetwork_d::~GarnetNetwork_d()
 {
     for (int i = 0; i < m_nodes; i++) {
@@ -140,6 +172,11 @@ GarnetNetwork_d::makeInLink(NodeID src, SwitchID dest, BasicLink* link,
     m_links.push_back(net_link);
     m_creditlinks.push_back(credit_link);
 
+    placeLink(net_link, m_nis[src]->eventQueue(),
+              m_routers[dest]->eventQueue());
+    placeLink(credit_link, m_routers[dest]->eventQueue(),
+              m_nis[src]->eventQueue());
+
     m_routers[dest]->addInPort(net_link, credit_link);
     m_nis[src]->addOutPort(net_link, credit_link);
 }
@@ -166,6 +203,11 @@ GarnetNetwork_d::makeOutLink(SwitchID src, NodeID dest, BasicLink* link,
     m_links.push_back(net_link);
     m_creditlinks.push_back(credit_link);
 
+    placeLink(net_link, m_routers[src]->eventQueue(),
+              m_nis[dest]->eventQueue());
+    placeLink(credit_link, m_nis[dest]->eventQueue(),
+              m_routers[src]->eventQueue());
+
     m_routers[src]->addOutPort(net_link, routing_table_entry,
                                          link->m_weight, credit_link);
     m_nis[dest]->addInPort(net_link, credit_link);
@@ -187,11 +229,75 @@ GarnetNetwork_d::makeInternalLink(SwitchID src, SwitchID dest, BasicLink* link,
     m_links.push_back(net_link);
     m_creditlinks.push_back(credit_link);
 
+    placeLink(net_link, m_routers[src]->eventQueue(),
+              m_routers[dest]->eventQueue());
+    placeLink(credit_link, m_routers[dest]->eventQueue(),
+              m_routers[src]->eventQueue());
+
     m_routers[dest]->addInPort(net_link, credit_link);
     m_routers[src]->addOutPort(net_link, routing_table_entry,
                                          link->m_weight, credit_link);
 }
 
+/*
+ * Split the routers into m_num_partitions regions, each simulated on its
+ * own event queue (and so its own thread). Routers are numbered row by
+ * row in a mesh, so consecutive ids form bands of rows and only the
+ * links between two bands cross partitions. Region 0 stays on the
+ * network's queue together with the NIs and the controllers they feed;
+ * every cross-partition hop is a link of at least one cycle, which is
+ * the lookahead the simulation quantum is set to.
+ */
+void
+GarnetNetwork_d::partitionRouters()
+{
+    int num_routers = m_routers.size();
+    uint32_t base = 0;
+
+    while (base < numMainEventQueues && mainEventQueue[base] != eventQueue())
+        base++;
+    assert(base < numMainEventQueues);
+
+    fatal_if(m_num_partitions > num_routers,
+             "%d garnet partitions for %d routers\n", m_num_partitions,
+             num_routers);
+
+    for (int i = 0; i < num_routers; i++) {
+        int region = i * m_num_partitions / num_routers;
+        if (region > 0)
+            m_routers[i]->setEventQueue(getEventQueue(base + region));
+    }
+
+    Tick period = m_routers[0]->clockPeriod();
+    if (simQuantum == 0)
+        simQuantum = period;
+    fatal_if(simQuantum > period,
+             "sim_quantum %d is longer than a router cycle (%d); garnet "
+             "partitions need a quantum of at most one cycle\n",
+             simQuantum, period);
+
+    inform("garnet: %d routers in %d partitions\n", num_routers,
+           m_num_partitions);
+}
+
+/*
+ * A link runs on the queue of the side that writes into it, so only the
+ * flits it hands across are shared with the other queue.
+ */
+void
+GarnetNetwork_d::placeLink(NetworkLink_d *link, EventQueue *src_queue,
+                           EventQueue *dest_queue)
+{
+    link->setEventQueue(src_queue);
+
+    if (src_queue != dest_queue) {
+        fatal_if(link->get_latency() < 1,
+                 "garnet link %d crosses partitions with zero latency\n",
+                 link->get_id());
+        link->setCrossPartition();
+    }
+}
+
 void
 GarnetNetwork_d::checkNetworkAllocation(NodeID id, bool ordered,
                                         int network_num,
@@ -291,6 +397,62 @@ GarnetNetwork_d::collatePowerStats()
     }
 }
 
+void
+GarnetNetwork_d::initPowerModel()
+{
+    for (int i = 0; i < m_routers.size(); i++) {
+        const OrionRouterEnergy *e = m_routers[i]->get_energy();
+        m_router_event_offset.push_back(m_event_energy.size());
+        m_event_energy.insert(m_event_energy.end(), e->event_energy.begin(),
+                              e->event_energy.end());
+        m_static_power += e->static_power + e->clk_power;
+        m_orion_freq_Hz = e->freq_Hz;
+    }
+
+    for (int i = 0; i < m_links.size(); i++) {
+        const OrionLinkEnergy *e = m_links[i]->get_energy();
+        m_event_energy.push_back(e->traversal_energy);
+        m_static_power += e->static_power;
+        m_orion_freq_Hz = e->freq_Hz;
+    }
+
+    m_event_activity.resize(m_event_energy.size());
+}
+
+double
+GarnetNetwork_d::get_dynamic_energy()
+{
+    if (m_event_energy.empty())
+        initPowerModel();
+
+    for (int i = 0; i < m_routers.size(); i++)
+        m_routers[i]->get_power_activity(
+            &m_event_activity[m_router_event_offset[i]]);
+
+    int link_offset = m_event_activity.size() - m_links.size();
+    for (int i = 0; i < m_links.size(); i++)
+        m_event_activity[link_offset + i] = m_links[i]->getLinkUtilization();
+
+    return inner_product(m_event_activity.begin(), m_event_activity.end(),
+                         m_event_energy.begin(), 0.0);
+}
+
+void
+GarnetNetwork_d::tracePower()
+{
+    double energy = get_dynamic_energy();
+    Cycles now = curCycle();
+
+    double dynamic_power = (energy - m_trace_energy) /
+        double(now - m_trace_cycle) * m_orion_freq_Hz;
+    *m_power_trace << now << " " << dynamic_power << " "
+                   << m_static_power << endl;
+
+    m_trace_energy = energy;
+    m_trace_cycle = now;
+    schedule(m_power_trace_event, clockEdge(m_power_trace_cycles));
+}
+
 void
 GarnetNetwork_d::print(ostream& out) const
 {
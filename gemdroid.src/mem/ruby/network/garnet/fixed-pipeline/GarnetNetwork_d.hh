@@ -54,6 +54,7 @@ class GarnetNetwork_d : public BaseGarnetNetwork
     ~GarnetNetwork_d();
 
     void init();
+    void startup();
 
     int getNumNodes() { return m_nodes; }
 
@@ -86,10 +87,17 @@ class GarnetNetwork_d : public BaseGarnetNetwork
     //! indicates the number of messages that were written.
     uint32_t functionalWrite(Packet *pkt);
 
+    // Dynamic energy (J) spent by all routers and links so far
+    double get_dynamic_energy();
+
   private:
     void checkNetworkAllocation(NodeID id, bool ordered, int network_num,
                                 std::string vnet_type);
 
+    void partitionRouters();
+    void placeLink(NetworkLink_d *link, EventQueue *src_queue,
+                   EventQueue *dest_queue);
+
     GarnetNetwork_d(const GarnetNetwork_d& obj);
     GarnetNetwork_d& operator=(const GarnetNetwork_d& obj);
 
@@ -98,6 +106,9 @@ class GarnetNetwork_d : public BaseGarnetNetwork
     void regLinkStats();
     void regPowerStats();
 
+    void initPowerModel();
+    void tracePower();
+
     std::vector<VNET_type > m_vnet_type;
 
     std::vector<Router_d *> m_routers;   // All Routers in Network
@@ -107,6 +118,24 @@ class GarnetNetwork_d : public BaseGarnetNetwork
 
     int m_buffers_per_data_vc;
     int m_buffers_per_ctrl_vc;
+    int m_num_partitions;
+
+    // Cached Orion energy of every router event type and link traversal
+    // in the network, and the matching activity counts, so the network's
+    // dynamic energy is a single dot product. Routers come first
+    // (m_router_event_offset), then one entry per link.
+    std::vector<double> m_event_energy;
+    std::vector<double> m_event_activity;
+    std::vector<int> m_router_event_offset;
+    double m_orion_freq_Hz;
+    double m_static_power;  // routers, router clocks and links
+
+    Cycles m_power_trace_cycles;
+    std::ostream *m_power_trace;
+    double m_trace_energy;
+    Cycles m_trace_cycle;
+    EventWrapper<GarnetNetwork_d, &GarnetNetwork_d::tracePower>
+        m_power_trace_event;
 
     // Statistical variables for power
     Stats::Scalar m_dynamic_link_power;
@@ -59,3 +59,7 @@ class GarnetNetwork_d(BaseGarnetNetwork):
     cxx_header = "mem/ruby/network/garnet/fixed-pipeline/GarnetNetwork_d.hh"
     buffers_per_data_vc = Param.UInt32(4, "buffers per data virtual channel");
     buffers_per_ctrl_vc = Param.UInt32(1, "buffers per ctrl virtual channel");
+    num_partitions = Param.UInt32(1,
+        "mesh regions whose routers run on separate event queues");
+    power_trace_cycles = Param.Cycles(0,
+        "cycles between noc_power.trace samples, 0 disables the trace");
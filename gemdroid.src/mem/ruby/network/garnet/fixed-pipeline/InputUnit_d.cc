@@ -28,6 +28,7 @@
  * Authors: Niket Agarwal
  */
 
+#include "base/misc.hh"
 #include "base/stl_helpers.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/InputUnit_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/Router_d.hh"
@@ -49,6 +50,10 @@ InputUnit_d::InputUnit_d(int id, Router_d *router) : Consumer(router)
         m_num_buffer_writes[i] = 0;
     }
 
+    fatal_if(m_num_vcs > MAX_VCS_PER_PORT_,
+             "Garnet supports at most %d VCs per port\n", MAX_VCS_PER_PORT_);
+    m_busy_vcs = 0;
+
     creditQueue = new flitBuffer_d();
     // Instantiating the virtual channels
     m_vcs.resize(m_num_vcs);
@@ -86,6 +91,7 @@ InputUnit_d::wakeup()
         }
         // write flit into input buffer
         m_vcs[vc]->insertFlit(t_flit);
+        m_busy_vcs |= 1ULL << vc;
 
         int vnet = vc/m_vc_per_vnet;
         // number of writes same as reads
@@ -121,9 +121,15 @@ class InputUnit_d : public Consumer
     inline flit_d*
     getTopFlit(int vc)
     {
-        return m_vcs[vc]->getTopFlit();
+        flit_d *t_flit = m_vcs[vc]->getTopFlit();
+        if (m_vcs[vc]->isEmpty())
+            m_busy_vcs &= ~(1ULL << vc);
+        return t_flit;
     }
 
+    // VCs holding at least one flit; the allocators only look at these
+    inline uint64_t get_busy_vcs() { return m_busy_vcs; }
+
     inline bool
     need_stage(int vc, VC_state_type state, flit_stage stage, Cycles cTime)
     {
@@ -173,6 +179,7 @@ class InputUnit_d : public Consumer
 
     // Virtual channels
     std::vector<VirtualChannel_d *> m_vcs;
+    uint64_t m_busy_vcs;
 
     // Statistical variables
     std::vector<double> m_num_buffer_writes;
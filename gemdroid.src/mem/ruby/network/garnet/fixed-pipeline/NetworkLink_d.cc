@@ -39,6 +39,8 @@ NetworkLink_d::NetworkLink_d(const Params *p)
     m_id = p->link_id;
     linkBuffer = new flitBuffer_d();
     m_link_utilized = 0;
+    m_cross_partition = false;
+    m_energy = NULL;
     m_vc_load.resize(p->vcs_per_vnet * p->virt_nets);
 
     for (int i = 0; i < (p->vcs_per_vnet * p->virt_nets); i++) {
@@ -69,8 +71,17 @@ NetworkLink_d::wakeup()
     if (link_srcQueue->isReady(curCycle())) {
         flit_d *t_flit = link_srcQueue->getTopFlit();
         t_flit->set_time(curCycle() + m_latency);
-        linkBuffer->insert(t_flit);
-        link_consumer->scheduleEventAbsolute(clockEdge(m_latency));
+
+        if (m_cross_partition) {
+            BufferLock lock(this);
+            linkBuffer->insert(t_flit);
+            // Lands on the consumer's queue at the next quantum boundary
+            link_consumer->getEventQueue()->schedule(
+                new ConsumerWakeupEvent(link_consumer), clockEdge(m_latency));
+        } else {
+            linkBuffer->insert(t_flit);
+            link_consumer->scheduleEventAbsolute(clockEdge(m_latency));
+        }
         m_link_utilized++;
         m_vc_load[t_flit->get_vc()]++;
     }
@@ -91,5 +102,6 @@ CreditLink_dParams::create()
 uint32_t
 NetworkLink_d::functionalWrite(Packet *pkt)
 {
+    BufferLock lock(this);
     return linkBuffer->functionalWrite(pkt);
 }
@@ -32,6 +32,7 @@
 #define __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_NETWORK_LINK_D_HH__
 
 #include <iostream>
+#include <mutex>
 #include <vector>
 
 #include "mem/ruby/common/Consumer.hh"
@@ -42,6 +43,7 @@
 #include "sim/clocked_object.hh"
 
 class GarnetNetwork_d;
+struct OrionLinkEnergy;
 
 class NetworkLink_d : public ClockedObject, public Consumer
 {
@@ -52,11 +54,14 @@ class NetworkLink_d : public ClockedObject, public Consumer
 
     void setLinkConsumer(Consumer *consumer);
     void setSourceQueue(flitBuffer_d *srcQueue);
+    void setCrossPartition() { m_cross_partition = true; }
+    Cycles get_latency() const { return m_latency; }
     void print(std::ostream& out) const{}
     int get_id(){return m_id;}
     void wakeup();
 
     void calculate_power(double);
+    const OrionLinkEnergy *get_energy();
     double get_dynamic_power() const { return m_power_dyn; }
     double get_static_power()const { return m_power_sta; }
 
@@ -64,17 +69,50 @@ class NetworkLink_d : public ClockedObject, public Consumer
     const std::vector<unsigned int> & getVcLoad() const { return m_vc_load; }
 
     inline bool isReady(Cycles curTime)
-    { return linkBuffer->isReady(curTime); }
+    { BufferLock lock(this); return linkBuffer->isReady(curTime); }
 
-    inline flit_d* peekLink()       { return linkBuffer->peekTopFlit(); }
-    inline flit_d* consumeLink()    { return linkBuffer->getTopFlit(); }
+    inline flit_d* peekLink()
+    { BufferLock lock(this); return linkBuffer->peekTopFlit(); }
+    inline flit_d* consumeLink()
+    { BufferLock lock(this); return linkBuffer->getTopFlit(); }
 
     uint32_t functionalWrite(Packet *);
 
   private:
+    /*
+     * A link whose two ends are simulated on different event queues.
+     * The source side fills linkBuffer while the destination drains it,
+     * so the buffer is locked; a flit only becomes ready m_latency
+     * cycles after it is written, which the quantum (at most one cycle)
+     * never lets the destination reach early.
+     */
+    class BufferLock
+    {
+      public:
+        BufferLock(NetworkLink_d *link) : m_link(link)
+        { if (m_link->m_cross_partition) m_link->m_buffer_mutex.lock(); }
+        ~BufferLock()
+        { if (m_link->m_cross_partition) m_link->m_buffer_mutex.unlock(); }
+      private:
+        NetworkLink_d *m_link;
+    };
+
+    // Wakes the consumer from its own event queue
+    class ConsumerWakeupEvent : public Event
+    {
+      public:
+        ConsumerWakeupEvent(Consumer *consumer)
+            : Event(Default_Pri, AutoDelete), m_consumer(consumer) {}
+        void process() { m_consumer->scheduleEventAbsolute(curTick()); }
+      private:
+        Consumer *m_consumer;
+    };
+
     int m_id;
     Cycles m_latency;
     int channel_width;
+    bool m_cross_partition;
+    std::mutex m_buffer_mutex;
 
     flitBuffer_d *linkBuffer;
     Consumer *link_consumer;
@@ -87,6 +125,7 @@ class NetworkLink_d : public ClockedObject, public Consumer
 
     double m_power_dyn;
     double m_power_sta;
+    const OrionLinkEnergy *m_energy;
 };
 
 #endif // __MEM_RUBY_NETWORK_GARNET_FIXED_PIPELINE_NETWORK_LINK_D_HH__
@@ -58,6 +58,8 @@ Router_d::Router_d(const Params *p)
     m_input_unit.clear();
     m_output_unit.clear();
 
+    m_energy = NULL;
+
     crossbar_count = 0;
     sw_local_arbit_count = 0;
     sw_global_arbit_count = 0;
@@ -161,6 +163,9 @@ void
 Router_d::calculate_performance_numbers()
 {
     for (int j = 0; j < m_virtual_networks; j++) {
+        // the input units count from the start of the run
+        buf_read_count[j] = 0;
+        buf_write_count[j] = 0;
         for (int i = 0; i < m_input_unit.size(); i++) {
             buf_read_count[j] += m_input_unit[i]->get_buf_read_count(j);
             buf_write_count[j] += m_input_unit[i]->get_buf_write_count(j);
@@ -51,6 +51,7 @@ class VCallocator_d;
 class SWallocator_d;
 class Switch_d;
 class FaultModel;
+struct OrionRouterEnergy;
 
 class Router_d : public BasicRouter
 {
@@ -91,6 +92,8 @@ class Router_d : public BasicRouter
 
     void calculate_power();
     void calculate_performance_numbers();
+    const OrionRouterEnergy *get_energy();
+    void get_power_activity(double *activity);
     double get_dynamic_power() const { return m_power_dyn; }
     double get_static_power() const { return m_power_sta; }
     double get_clk_power() const { return m_clk_power; }
@@ -124,6 +127,8 @@ class Router_d : public BasicRouter
     double m_power_dyn;
     double m_power_sta;
     double m_clk_power;
+    const OrionRouterEnergy *m_energy;
+    std::vector<int> m_power_vnets;     // vnets in the Orion model
 
     // Statistical variables for performance
     std::vector<double> buf_read_count;
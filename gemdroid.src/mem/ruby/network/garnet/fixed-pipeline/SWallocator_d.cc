@@ -28,6 +28,8 @@
  * Authors: Niket Agarwal
  */
 
+#include "base/bitfield.hh"
+#include "base/misc.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/GarnetNetwork_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/InputUnit_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/OutputUnit_d.hh"
@@ -58,19 +60,25 @@ SWallocator_d::init()
     m_port_req.resize(m_num_outports);
     m_vc_winners.resize(m_num_outports);
 
+    fatal_if(m_num_inports > MAX_VCS_PER_PORT_,
+             "Garnet supports at most %d inports per router\n",
+             MAX_VCS_PER_PORT_);
+
     for (int i = 0; i < m_num_inports; i++) {
         m_round_robin_inport[i] = 0;
     }
 
     for (int i = 0; i < m_num_outports; i++) {
-        m_port_req[i].resize(m_num_inports);
         m_vc_winners[i].resize(m_num_inports);
 
         m_round_robin_outport[i] = 0;
+        m_port_req[i] = 0; // inports requesting this outport
+    }
 
-        for (int j = 0; j < m_num_inports; j++) {
-            m_port_req[i][j] = false; // [outport][inport]
-        }
+    m_valid_vcs = 0;
+    for (int vc = 0; vc < m_num_vcs; vc++) {
+        if ((m_router->get_net_ptr())->validVirtualNetwork(get_vnet(vc)))
+            m_valid_vcs |= 1ULL << vc;
     }
 }
 
@@ -99,19 +107,20 @@ SWallocator_d::arbitrate_inports()
 
             if (next_round_robin_invc >= m_num_vcs)
                 next_round_robin_invc = 0;
-        } while (!((m_router->get_net_ptr())->validVirtualNetwork(
-                    get_vnet(next_round_robin_invc))));
+        } while (!(m_valid_vcs & (1ULL << next_round_robin_invc)));
 
         m_round_robin_inport[inport] = next_round_robin_invc;
 
-        for (int invc_iter = 0; invc_iter < m_num_vcs; invc_iter++) {
-            invc++;
-            if (invc >= m_num_vcs)
-                invc = 0;
+        // Only VCs holding a flit can want the switch; walk them in
+        // round robin order from the pointer
+        int start = (invc + 1 >= m_num_vcs) ? 0 : invc + 1;
+        uint64_t busy = m_input_unit[inport]->get_busy_vcs() & m_valid_vcs;
 
-            if (!((m_router->get_net_ptr())->validVirtualNetwork(
-                get_vnet(invc))))
-                continue;
+        for (uint64_t vcs = rotateMask(busy, start, m_num_vcs); vcs;
+             vcs &= vcs - 1) {
+            invc = findLsbSet(vcs) + start;
+            if (invc >= m_num_vcs)
+                invc -= m_num_vcs;
 
             if (m_input_unit[inport]->need_stage(invc, ACTIVE_, SA_,
                                                  m_router->curCycle()) &&
@@ -120,7 +129,7 @@ SWallocator_d::arbitrate_inports()
                 if (is_candidate_inport(inport, invc)) {
                     int outport = m_input_unit[inport]->get_route(invc);
                     m_local_arbiter_activity++;
-                    m_port_req[outport][inport] = true;
+                    m_port_req[outport] |= 1ULL << inport;
                     m_vc_winners[outport][inport]= invc;
                     break; // got one vc winner for this port
                 }
@@ -165,52 +174,52 @@ SWallocator_d::arbitrate_outports()
         if (m_round_robin_outport[outport] >= m_num_outports)
             m_round_robin_outport[outport] = 0;
 
-        for (int inport_iter = 0; inport_iter < m_num_inports; inport_iter++) {
-            inport++;
-            if (inport >= m_num_inports)
-                inport = 0;
-
-            // inport has a request this cycle for outport:
-            if (m_port_req[outport][inport]) {
-                m_port_req[outport][inport] = false;
-                int invc = m_vc_winners[outport][inport];
-                int outvc = m_input_unit[inport]->get_outvc(invc);
-
-                // remove flit from Input Unit
-                flit_d *t_flit = m_input_unit[inport]->getTopFlit(invc);
-                t_flit->advance_stage(ST_, m_router->curCycle());
-                t_flit->set_vc(outvc);
-                t_flit->set_outport(outport);
-                t_flit->set_time(m_router->curCycle() + Cycles(1));
-
-                m_output_unit[outport]->decrement_credit(outvc);
-                m_router->update_sw_winner(inport, t_flit);
-                m_global_arbiter_activity++;
-
-                if ((t_flit->get_type() == TAIL_) ||
-                    t_flit->get_type() == HEAD_TAIL_) {
-
-                    // Send a credit back
-                    // along with the information that this VC is now idle
-                    m_input_unit[inport]->increment_credit(invc, true,
-                        m_router->curCycle());
-
-                    // This Input VC should now be empty
-                    assert(m_input_unit[inport]->isReady(invc,
-                        m_router->curCycle()) == false);
-
-                    m_input_unit[inport]->set_vc_state(IDLE_, invc,
-                        m_router->curCycle());
-                    m_input_unit[inport]->set_enqueue_time(invc,
-                        Cycles(INFINITE_));
-                } else {
-                    // Send a credit back
-                    // but do not indicate that the VC is idle
-                    m_input_unit[inport]->increment_credit(invc, false,
-                        m_router->curCycle());
-                }
-                break; // got a in request for this outport
-            }
+        if (!m_port_req[outport])
+            continue;
+
+        int start = (inport + 1 >= m_num_inports) ? 0 : inport + 1;
+        uint64_t reqs = rotateMask(m_port_req[outport], start, m_num_inports);
+
+        // first inport after the round robin pointer with a request
+        inport = findLsbSet(reqs) + start;
+        if (inport >= m_num_inports)
+            inport -= m_num_inports;
+
+        int invc = m_vc_winners[outport][inport];
+        int outvc = m_input_unit[inport]->get_outvc(invc);
+
+        // remove flit from Input Unit
+        flit_d *t_flit = m_input_unit[inport]->getTopFlit(invc);
+        t_flit->advance_stage(ST_, m_router->curCycle());
+        t_flit->set_vc(outvc);
+        t_flit->set_outport(outport);
+        t_flit->set_time(m_router->curCycle() + Cycles(1));
+
+        m_output_unit[outport]->decrement_credit(outvc);
+        m_router->update_sw_winner(inport, t_flit);
+        m_global_arbiter_activity++;
+
+        if ((t_flit->get_type() == TAIL_) ||
+            t_flit->get_type() == HEAD_TAIL_) {
+
+            // Send a credit back
+            // along with the information that this VC is now idle
+            m_input_unit[inport]->increment_credit(invc, true,
+                m_router->curCycle());
+
+            // This Input VC should now be empty
+            assert(m_input_unit[inport]->isReady(invc,
+                m_router->curCycle()) == false);
+
+            m_input_unit[inport]->set_vc_state(IDLE_, invc,
+                m_router->curCycle());
+            m_input_unit[inport]->set_enqueue_time(invc,
+                Cycles(INFINITE_));
+        } else {
+            // Send a credit back
+            // but do not indicate that the VC is idle
+            m_input_unit[inport]->increment_credit(invc, false,
+                m_router->curCycle());
         }
     }
 }
@@ -220,9 +229,12 @@ SWallocator_d::check_for_wakeup()
 {
     Cycles nextCycle = m_router->curCycle() + Cycles(1);
 
+    // A router with no buffered flits sleeps until a link wakes it
     for (int i = 0; i < m_num_inports; i++) {
-        for (int j = 0; j < m_num_vcs; j++) {
-            if (m_input_unit[i]->need_stage(j, ACTIVE_, SA_, nextCycle)) {
+        for (uint64_t vcs = m_input_unit[i]->get_busy_vcs(); vcs;
+             vcs &= vcs - 1) {
+            if (m_input_unit[i]->need_stage(findLsbSet(vcs), ACTIVE_, SA_,
+                                            nextCycle)) {
                 scheduleEvent(Cycles(1));
                 return;
             }
@@ -242,8 +254,6 @@ void
 SWallocator_d::clear_request_vector()
 {
     for (int i = 0; i < m_num_outports; i++) {
-        for (int j = 0; j < m_num_inports; j++) {
-            m_port_req[i][j] = false;
-        }
+        m_port_req[i] = 0;
     }
 }
@@ -69,13 +69,14 @@ class SWallocator_d : public Consumer
   private:
     int m_num_inports, m_num_outports;
     int m_num_vcs, m_vc_per_vnet;
+    uint64_t m_valid_vcs; // VCs of the vnets in use
 
     double m_local_arbiter_activity, m_global_arbiter_activity;
 
     Router_d *m_router;
     std::vector<int> m_round_robin_outport;
     std::vector<int> m_round_robin_inport;
-    std::vector<std::vector<bool> > m_port_req;
+    std::vector<uint64_t> m_port_req; // [outport] mask of requesting inports
     std::vector<std::vector<int> > m_vc_winners; // a list for each outport
     std::vector<InputUnit_d *> m_input_unit;
     std::vector<OutputUnit_d *> m_output_unit;
@@ -28,6 +28,7 @@
  * Authors: Niket Agarwal
  */
 
+#include "base/bitfield.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/GarnetNetwork_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/InputUnit_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/OutputUnit_d.hh"
@@ -73,39 +74,39 @@ VCallocator_d::init()
     for (int i = 0; i < m_num_outports; i++) {
         m_round_robin_outvc[i].resize(m_num_vcs);
         m_outvc_req[i].resize(m_num_vcs);
-        m_outvc_is_req[i].resize(m_num_vcs);
+        m_outvc_is_req[i] = 0;
 
         for (int j = 0; j < m_num_vcs; j++) {
             m_round_robin_outvc[i][j].first = 0;
             m_round_robin_outvc[i][j].second = 0;
-            m_outvc_is_req[i][j] = false;
 
             m_outvc_req[i][j].resize(m_num_inports);
 
             for (int k = 0; k < m_num_inports; k++) {
-                m_outvc_req[i][j][k].resize(m_num_vcs);
-                for (int l = 0; l < m_num_vcs; l++) {
-                    m_outvc_req[i][j][k][l] = false;
-                }
+                m_outvc_req[i][j][k] = 0;
             }
         }
     }
+
+    m_valid_vcs = 0;
+    for (int vc = 0; vc < m_num_vcs; vc++) {
+        if ((m_router->get_net_ptr())->validVirtualNetwork(get_vnet(vc)))
+            m_valid_vcs |= 1ULL << vc;
+    }
 }
 
 void
 VCallocator_d::clear_request_vector()
 {
     for (int i = 0; i < m_num_outports; i++) {
-        for (int j = 0; j < m_num_vcs; j++) {
-            if (!m_outvc_is_req[i][j])
-                continue;
-            m_outvc_is_req[i][j] = false;
+        for (uint64_t outvcs = m_outvc_is_req[i]; outvcs;
+             outvcs &= outvcs - 1) {
+            int j = findLsbSet(outvcs);
             for (int k = 0; k < m_num_inports; k++) {
-                for (int l = 0; l < m_num_vcs; l++) {
-                    m_outvc_req[i][j][k][l] = false;
-                }
+                m_outvc_req[i][j][k] = 0;
             }
         }
+        m_outvc_is_req[i] = 0;
     }
 }
 
@@ -166,9 +167,8 @@ VCallocator_d::select_outvc(int inport_iter, int invc_iter)
         int outvc = outvc_base + outvc_offset;
         if (m_output_unit[outport]->is_vc_idle(outvc, m_router->curCycle())) {
             m_local_arbiter_activity[vnet]++;
-            m_outvc_req[outport][outvc][inport_iter][invc_iter] = true;
-            if (!m_outvc_is_req[outport][outvc])
-                m_outvc_is_req[outport][outvc] = true;
+            m_outvc_req[outport][outvc][inport_iter] |= 1ULL << invc_iter;
+            m_outvc_is_req[outport] |= 1ULL << outvc;
             return; // out vc acquired
         }
     }
@@ -178,10 +178,12 @@ void
 VCallocator_d::arbitrate_invcs()
 {
     for (int inport_iter = 0; inport_iter < m_num_inports; inport_iter++) {
-        for (int invc_iter = 0; invc_iter < m_num_vcs; invc_iter++) {
-            if (!((m_router->get_net_ptr())->validVirtualNetwork(
-                get_vnet(invc_iter))))
-                continue;
+        // Only VCs holding a flit can be waiting for an output VC
+        uint64_t busy = m_input_unit[inport_iter]->get_busy_vcs() &
+            m_valid_vcs;
+
+        for (; busy; busy &= busy - 1) {
+            int invc_iter = findLsbSet(busy);
 
             if (m_input_unit[inport_iter]->need_stage(invc_iter, VC_AB_,
                     VA_, m_router->curCycle())) {
@@ -198,11 +200,10 @@ void
 VCallocator_d::arbitrate_outvcs()
 {
     for (int outport_iter = 0; outport_iter < m_num_outports; outport_iter++) {
-        for (int outvc_iter = 0; outvc_iter < m_num_vcs; outvc_iter++) {
-            if (!m_outvc_is_req[outport_iter][outvc_iter]) {
-                // No requests for this outvc in this cycle
-                continue;
-            }
+        // Only the outvcs requested this cycle
+        for (uint64_t outvcs = m_outvc_is_req[outport_iter]; outvcs;
+             outvcs &= outvcs - 1) {
+            int outvc_iter = findLsbSet(outvcs);
 
             int inport = m_round_robin_outvc[outport_iter][outvc_iter].first;
             int invc_offset =
@@ -220,25 +221,35 @@ VCallocator_d::arbitrate_outvcs()
                    m_num_inports)
                     m_round_robin_outvc[outport_iter][outvc_iter].first = 0;
             }
-            for (int in_iter = 0; in_iter < m_num_inports*num_vcs_per_vnet;
-                    in_iter++) {
-                invc_offset++;
-                if (invc_offset >= num_vcs_per_vnet) {
-                    invc_offset = 0;
+
+            // Round robin over (inport, invc) starting after the pointer:
+            // the rest of the pointer's inport, every other inport, then
+            // the pointer's inport up to and including the pointer
+            uint64_t vnet_vcs = lowBitsMask(num_vcs_per_vnet);
+            for (int in_iter = 0; in_iter <= m_num_inports; in_iter++) {
+                uint64_t reqs =
+                    (m_outvc_req[outport_iter][outvc_iter][inport] >>
+                     invc_base) & vnet_vcs;
+                if (in_iter == 0)
+                    reqs &= ~lowBitsMask(invc_offset + 1);
+                else if (in_iter == m_num_inports)
+                    reqs &= lowBitsMask(invc_offset + 1);
+
+                if (!reqs) {
                     inport++;
                     if (inport >= m_num_inports)
                         inport = 0;
+                    continue;
                 }
-                int invc = invc_base + invc_offset;
-                if (m_outvc_req[outport_iter][outvc_iter][inport][invc]) {
-                    m_global_arbiter_activity[vnet]++;
-                    m_input_unit[inport]->grant_vc(invc, outvc_iter,
-                        m_router->curCycle());
-                    m_output_unit[outport_iter]->update_vc(
-                        outvc_iter, inport, invc);
-                    m_router->swarb_req();
-                    break;
-                }
+
+                int invc = invc_base + findLsbSet(reqs);
+                m_global_arbiter_activity[vnet]++;
+                m_input_unit[inport]->grant_vc(invc, outvc_iter,
+                    m_router->curCycle());
+                m_output_unit[outport_iter]->update_vc(
+                    outvc_iter, inport, invc);
+                m_router->swarb_req();
+                break;
             }
         }
     }
@@ -259,8 +270,10 @@ VCallocator_d::check_for_wakeup()
     Cycles nextCycle = m_router->curCycle() + Cycles(1);
 
     for (int i = 0; i < m_num_inports; i++) {
-        for (int j = 0; j < m_num_vcs; j++) {
-            if (m_input_unit[i]->need_stage(j, VC_AB_, VA_, nextCycle)) {
+        for (uint64_t vcs = m_input_unit[i]->get_busy_vcs(); vcs;
+             vcs &= vcs - 1) {
+            if (m_input_unit[i]->need_stage(findLsbSet(vcs), VC_AB_, VA_,
+                                            nextCycle)) {
                 scheduleEvent(Cycles(1));
                 return;
             }
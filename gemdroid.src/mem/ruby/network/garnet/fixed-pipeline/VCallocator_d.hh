@@ -77,11 +77,14 @@ class VCallocator_d : public Consumer
     // Arbiter for every output vc
     std::vector<std::vector<std::pair<int, int> > > m_round_robin_outvc;
 
-    // [outport][outvc][inport][invc]
-    // set true in the first phase of allocation
-    std::vector<std::vector<std::vector<std::vector<bool> > > > m_outvc_req;
+    // [outport][outvc][inport] mask of invcs
+    // set in the first phase of allocation
+    std::vector<std::vector<std::vector<uint64_t> > > m_outvc_req;
 
-    std::vector<std::vector<bool> > m_outvc_is_req;
+    // [outport] mask of outvcs with at least one request
+    std::vector<uint64_t> m_outvc_is_req;
+
+    uint64_t m_valid_vcs; // VCs of the vnets in use
 
     std::vector<InputUnit_d *> m_input_unit;
     std::vector<OutputUnit_d *> m_output_unit;
@@ -55,6 +55,8 @@ class VirtualChannel_d
     inline void update_credit(int credit)   { m_credit_count = credit; }
     inline void increment_credit()          { m_credit_count++; }
 
+    inline bool isEmpty()                   { return m_input_buffer->isEmpty(); }
+
     inline bool isReady(Cycles curTime)
     {
         return m_input_buffer->isReady(curTime);
@@ -29,78 +29,54 @@
  *          Tushar Krishna
  */
 
+#include <map>
+#include <numeric>
+
 #include "mem/ruby/common/Global.hh"
 #include "mem/ruby/network/orion/NetworkPower.hh"
 #include "mem/ruby/network/orion/OrionConfig.hh"
 #include "mem/ruby/network/orion/OrionLink.hh"
 #include "mem/ruby/network/orion/OrionRouter.hh"
 
-void
-Router_d::calculate_power()
-{
-    //Network Activities from garnet
-    calculate_performance_numbers();
-    double sim_cycles = curCycle() - g_ruby_start;
-
-    // Number of virtual networks/message classes declared in Ruby
-    // maybe greater than active virtual networks.
-    // Estimate active virtual networks for correct power estimates
-    int num_active_vclass = 0;
-    std::vector<bool > active_vclass_ary;
-    active_vclass_ary.resize(m_virtual_networks);
-
-    std::vector<double > vc_local_arbit_count_active;
-    std::vector<double > vc_global_arbit_count_active;
-    std::vector<double > buf_read_count_active;
-    std::vector<double > buf_write_count_active;
-
-    for (int i =0; i < m_virtual_networks; i++) {
-
-        active_vclass_ary[i] = (get_net_ptr())->validVirtualNetwork(i);
-        if (active_vclass_ary[i]) {
-            num_active_vclass++;
-            vc_local_arbit_count_active.push_back(vc_local_arbit_count[i]);
-            vc_global_arbit_count_active.push_back(vc_global_arbit_count[i]);
-            buf_read_count_active.push_back(buf_read_count[i]);
-            buf_write_count_active.push_back(buf_write_count[i]);
-        }
-        else {
-            // Inactive vclass
-            assert(vc_global_arbit_count[i] == 0);
-            assert(vc_local_arbit_count[i] == 0);
-        }
-    }
-
-    // Orion Initialization
-    OrionConfig* orion_cfg_ptr;
-    OrionRouter* orion_rtr_ptr;
-    static double freq_Hz;
-
-    const string cfg_fn = "src/mem/ruby/network/orion/router.cfg";
-    orion_cfg_ptr = new OrionConfig(cfg_fn);
-    freq_Hz = orion_cfg_ptr->get<double>("FREQUENCY");
-
-    uint32_t num_in_port = m_input_unit.size();
-    uint32_t num_out_port = m_output_unit.size();
-    uint32_t num_vclass = num_active_vclass;
-    std::vector<uint32_t > vclass_type_ary;
-
-    for (int i = 0; i < m_virtual_networks; i++) {
-        if (active_vclass_ary[i]) {
-            int temp_vc = i*m_vc_per_vnet;
-            vclass_type_ary.push_back((uint32_t) 
-                m_network_ptr->get_vnet_type(temp_vc));
-        }
-    }
-    assert(vclass_type_ary.size() == num_active_vclass);
+using namespace std;
 
-    uint32_t num_vc_per_vclass = m_vc_per_vnet;
-    uint32_t in_buf_per_data_vc = m_network_ptr->getBuffersPerDataVC();
-    uint32_t in_buf_per_ctrl_vc = m_network_ptr->getBuffersPerCtrlVC();
-    //flit width in bits
-    uint32_t flit_width_bits = m_network_ptr->getNiFlitSize() * 8;
+// Base technology configuration, parsed once per run
+static const OrionConfig *
+orion_base_config()
+{
+    static OrionConfig *cfg = NULL;
+    if (cfg == NULL)
+        cfg = new OrionConfig("src/mem/ruby/network/orion/router.cfg");
+    return cfg;
+}
 
-    orion_rtr_ptr = new OrionRouter(
+const OrionRouterEnergy *
+orion_router_energy(uint32_t num_in_port, uint32_t num_out_port,
+                    const vector<uint32_t>& vclass_type_ary,
+                    uint32_t num_vc_per_vclass,
+                    uint32_t in_buf_per_data_vc,
+                    uint32_t in_buf_per_ctrl_vc,
+                    uint32_t flit_width_bits)
+{
+    static map<vector<uint32_t>, OrionRouterEnergy> cache;
+
+    vector<uint32_t> key;
+    key.push_back(num_in_port);
+    key.push_back(num_out_port);
+    key.push_back(num_vc_per_vclass);
+    key.push_back(in_buf_per_data_vc);
+    key.push_back(in_buf_per_ctrl_vc);
+    key.push_back(flit_width_bits);
+    key.insert(key.end(), vclass_type_ary.begin(), vclass_type_ary.end());
+
+    map<vector<uint32_t>, OrionRouterEnergy>::iterator it = cache.find(key);
+    if (it != cache.end())
+        return &it->second;
+
+    // OrionRouter rewrites the configuration it is handed
+    OrionConfig orion_cfg(*orion_base_config());
+    uint32_t num_vclass = vclass_type_ary.size();
+    OrionRouter orion_rtr(
         num_in_port,
         num_out_port,
         num_vclass,
@@ -109,143 +85,196 @@ Router_d::calculate_power()
         in_buf_per_data_vc,
         in_buf_per_ctrl_vc,
         flit_width_bits,
-        orion_cfg_ptr
+        &orion_cfg
     );
 
-
-    //Power Calculation
-    double Pbuf_wr_dyn = 0.0;
-    double Pbuf_rd_dyn = 0.0;
-    double Pvc_arb_local_dyn = 0.0;
-    double Pvc_arb_global_dyn = 0.0;
-    double Psw_arb_local_dyn = 0.0;
-    double Psw_arb_global_dyn = 0.0;
-    double Pxbar_dyn = 0.0;
-
-    double Pbuf_sta = 0.0;
-    double Pvc_arb_sta = 0.0;
-    double Psw_arb_sta = 0.0;
-    double Pxbar_sta = 0.0;
-
-    //Dynamic Power
+    OrionRouterEnergy &e = cache[key];
+    e.freq_Hz = orion_cfg.get<double>("FREQUENCY");
 
     // Note: For each active arbiter in vc_arb or sw_arb of size T:1,
     // assuming half the requests (T/2) are high on average.
     // TODO: estimate expected value of requests from simulation.
-
     for (int i = 0; i < num_vclass; i++) {
         // Buffer Write
-        Pbuf_wr_dyn +=
-            orion_rtr_ptr->calc_dynamic_energy_buf(i, WRITE_MODE, false)*
-                (buf_write_count_active[i]/sim_cycles)*freq_Hz;
+        e.event_energy.push_back(
+            orion_rtr.calc_dynamic_energy_buf(i, WRITE_MODE, false));
 
         // Buffer Read
-        Pbuf_rd_dyn +=
-            orion_rtr_ptr->calc_dynamic_energy_buf(i, READ_MODE, false)*
-                (buf_read_count_active[i]/sim_cycles)*freq_Hz;
+        e.event_energy.push_back(
+            orion_rtr.calc_dynamic_energy_buf(i, READ_MODE, false));
 
         // VC arbitration local
         // Each input VC arbitrates for one output VC (in its vclass)
         // at its output port.
         // Arbiter size: num_vc_per_vclass:1
-        Pvc_arb_local_dyn +=
-            orion_rtr_ptr->calc_dynamic_energy_local_vc_arb(i,
-                num_vc_per_vclass/2, false)*
-                    (vc_local_arbit_count_active[i]/sim_cycles)*
-                    freq_Hz;
+        e.event_energy.push_back(
+            orion_rtr.calc_dynamic_energy_local_vc_arb(i,
+                num_vc_per_vclass/2, false));
 
         // VC arbitration global
-        // Each output VC chooses one input VC out of all possible requesting
-        // VCs (within vclass) at all input ports
+        // Each output VC chooses one input VC out of all possible
+        // requesting VCs (within vclass) at all input ports
         // Arbiter size: num_in_port*num_vc_per_vclass:1
         // Round-robin at each input VC for outvcs in the local stage will
         // try to keep outvc conflicts to the minimum.
         // Assuming conflicts due to request for same outvc from
         // num_in_port/2 requests.
         // TODO: use garnet to estimate this
-        Pvc_arb_global_dyn +=
-            orion_rtr_ptr->calc_dynamic_energy_global_vc_arb(i,
-                num_in_port/2, false)*
-                    (vc_global_arbit_count_active[i]/sim_cycles)*
-                    freq_Hz;
+        e.event_energy.push_back(
+            orion_rtr.calc_dynamic_energy_global_vc_arb(i,
+                num_in_port/2, false));
     }
 
     // Switch Allocation Local
     // Each input port chooses one input VC as requestor
     // Arbiter size: num_vclass*num_vc_per_vclass:1
-    Psw_arb_local_dyn =
-        orion_rtr_ptr->calc_dynamic_energy_local_sw_arb(
-            num_vclass*num_vc_per_vclass/2, false)*
-            (sw_local_arbit_count/sim_cycles)*
-            freq_Hz;
+    e.event_energy.push_back(
+        orion_rtr.calc_dynamic_energy_local_sw_arb(
+            num_vclass*num_vc_per_vclass/2, false));
 
     // Switch Allocation Global
     // Each output port chooses one input port as winner
     // Arbiter size: num_in_port:1
-    Psw_arb_global_dyn =
-        orion_rtr_ptr->calc_dynamic_energy_global_sw_arb(
-            num_in_port/2, false)*
-                (sw_global_arbit_count/sim_cycles)*
-                freq_Hz;
+    e.event_energy.push_back(
+        orion_rtr.calc_dynamic_energy_global_sw_arb(num_in_port/2, false));
 
     // Crossbar
-    Pxbar_dyn =
-        orion_rtr_ptr->calc_dynamic_energy_xbar(false)*
-            (crossbar_count/sim_cycles)*freq_Hz;
-
-    // Total
-    m_power_dyn = Pbuf_wr_dyn + Pbuf_rd_dyn +
-                  Pvc_arb_local_dyn + Pvc_arb_global_dyn +
-                  Psw_arb_local_dyn + Psw_arb_global_dyn +
-                  Pxbar_dyn;
+    e.event_energy.push_back(orion_rtr.calc_dynamic_energy_xbar(false));
 
     // Clock Power
-    m_clk_power = orion_rtr_ptr->calc_dynamic_energy_clock()*freq_Hz;
+    e.clk_power = orion_rtr.calc_dynamic_energy_clock()*e.freq_Hz;
 
     // Static Power
-    Pbuf_sta = orion_rtr_ptr->get_static_power_buf();
-    Pvc_arb_sta = orion_rtr_ptr->get_static_power_va();
-    Psw_arb_sta = orion_rtr_ptr->get_static_power_sa();
-    Pxbar_sta = orion_rtr_ptr->get_static_power_xbar();
+    e.static_power = orion_rtr.get_static_power_buf() +
+                     orion_rtr.get_static_power_va() +
+                     orion_rtr.get_static_power_sa() +
+                     orion_rtr.get_static_power_xbar();
 
-    m_power_sta =  Pbuf_sta + Pvc_arb_sta + Psw_arb_sta + Pxbar_sta;
+    return &e;
 }
 
+const OrionLinkEnergy *
+orion_link_energy(uint32_t channel_width_bits)
+{
+    static map<uint32_t, OrionLinkEnergy> cache;
+
+    map<uint32_t, OrionLinkEnergy>::iterator it =
+        cache.find(channel_width_bits);
+    if (it != cache.end())
+        return &it->second;
+
+    const OrionConfig *orion_cfg_ptr = orion_base_config();
+    OrionLink orion_link(orion_cfg_ptr->get<double>("LINK_LENGTH"),
+                         channel_width_bits, orion_cfg_ptr);
+
+    OrionLinkEnergy &e = cache[channel_width_bits];
+    e.freq_Hz = orion_cfg_ptr->get<double>("FREQUENCY");
+
+    // Assume half the bits flipped on every link activity
+    e.traversal_energy =
+        orion_link.calc_dynamic_energy(channel_width_bits/2);
+
+    // Calculates number of repeaters needed in link, and their static power
+    // For short links, like 1mm, no repeaters are needed so static power is 0
+    e.static_power = orion_link.get_static_power();
+
+    return &e;
+}
+
+// Looks up the router's Orion energies on first use. Virtual networks
+// that carry no traffic are left out of the model.
+const OrionRouterEnergy *
+Router_d::get_energy()
+{
+    if (m_energy != NULL)
+        return m_energy;
+
+    vector<uint32_t> vclass_type_ary;
+    for (int i = 0; i < m_virtual_networks; i++) {
+        if ((get_net_ptr())->validVirtualNetwork(i)) {
+            m_power_vnets.push_back(i);
+            int temp_vc = i*m_vc_per_vnet;
+            vclass_type_ary.push_back((uint32_t)
+                m_network_ptr->get_vnet_type(temp_vc));
+        }
+    }
+
+    m_energy = orion_router_energy(
+        m_input_unit.size(),
+        m_output_unit.size(),
+        vclass_type_ary,
+        m_vc_per_vnet,
+        m_network_ptr->getBuffersPerDataVC(),
+        m_network_ptr->getBuffersPerCtrlVC(),
+        //flit width in bits
+        m_network_ptr->getNiFlitSize() * 8);
+
+    return m_energy;
+}
+
+// Writes this router's event counts in the order of
+// OrionRouterEnergy::event_energy
 void
-NetworkLink_d::calculate_power(double sim_cycles)
+Router_d::get_power_activity(double *activity)
 {
-    OrionConfig* orion_cfg_ptr;
-    OrionLink* orion_link_ptr;
-    static double freq_Hz;
-    double link_length;
+    get_energy();
 
-    // Initialization
-    const string cfg_fn = "src/mem/ruby/network/orion/router.cfg";
-    orion_cfg_ptr = new OrionConfig(cfg_fn);
-    freq_Hz = orion_cfg_ptr->get<double>("FREQUENCY");
+    //Network Activities from garnet
+    calculate_performance_numbers();
 
-    link_length = orion_cfg_ptr->get<double>("LINK_LENGTH");
+    for (int i = 0; i < m_virtual_networks; i++) {
+        if (!(get_net_ptr())->validVirtualNetwork(i)) {
+            // Inactive vclass
+            assert(vc_global_arbit_count[i] == 0);
+            assert(vc_local_arbit_count[i] == 0);
+        }
+    }
 
-    int channel_width_bits = channel_width*8;
+    for (int i = 0; i < m_power_vnets.size(); i++) {
+        int vnet = m_power_vnets[i];
+        *activity++ = buf_write_count[vnet];
+        *activity++ = buf_read_count[vnet];
+        *activity++ = vc_local_arbit_count[vnet];
+        *activity++ = vc_global_arbit_count[vnet];
+    }
+    *activity++ = sw_local_arbit_count;
+    *activity++ = sw_global_arbit_count;
+    *activity++ = crossbar_count;
+}
+
+void
+Router_d::calculate_power()
+{
+    double sim_cycles = curCycle() - g_ruby_start;
+    const OrionRouterEnergy *e = get_energy();
 
-    orion_link_ptr = new OrionLink(
-        link_length,
-        channel_width_bits,
-        orion_cfg_ptr);
+    vector<double> activity(e->event_energy.size());
+    get_power_activity(&activity[0]);
 
-    // Dynamic Power
-    // Assume half the bits flipped on every link activity
-    double link_dynamic_energy =
-        orion_link_ptr->calc_dynamic_energy(channel_width_bits/2);
-    m_power_dyn = link_dynamic_energy * (m_link_utilized  / sim_cycles) *
-                  freq_Hz;
+    m_power_dyn = inner_product(activity.begin(), activity.end(),
+                                e->event_energy.begin(), 0.0) /
+                  sim_cycles * e->freq_Hz;
+    m_clk_power = e->clk_power;
+    m_power_sta = e->static_power;
+}
+
+void
+NetworkLink_d::calculate_power(double sim_cycles)
+{
+    const OrionLinkEnergy *e = get_energy();
 
+    // Dynamic Power
+    m_power_dyn = e->traversal_energy * (m_link_utilized / sim_cycles) *
+                  e->freq_Hz;
 
     // Static Power
-    // Calculates number of repeaters needed in link, and their static power
-    // For short links, like 1mm, no repeaters are needed so static power is 0
-    m_power_sta = orion_link_ptr->get_static_power();
+    m_power_sta = e->static_power;
+}
 
-    delete orion_link_ptr;
-    delete orion_cfg_ptr;
+const OrionLinkEnergy *
+NetworkLink_d::get_energy()
+{
+    if (m_energy == NULL)
+        m_energy = orion_link_energy(channel_width*8);
+    return m_energy;
 }
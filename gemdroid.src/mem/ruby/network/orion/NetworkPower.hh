@@ -35,6 +35,7 @@
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
+#include <vector>
 
 #include "mem/ruby/network/garnet/fixed-pipeline/GarnetNetwork_d.hh"
 #include "mem/ruby/network/garnet/fixed-pipeline/NetworkLink_d.hh"
@@ -44,4 +45,37 @@
 #define READ_MODE 0
 #define WRITE_MODE 1
 
+// Orion results for one router configuration. The technology model is
+// only evaluated the first time a configuration is seen; routers and
+// links with the same parameters share the cached result.
+struct OrionRouterEnergy
+{
+    double freq_Hz;
+    // Energy (J) of one event, in the order Router_d reports activity:
+    // for each active vclass a buffer write, buffer read, local and
+    // global VC arbitration; then local and global switch arbitration
+    // and a crossbar traversal
+    std::vector<double> event_energy;
+    double clk_power;
+    double static_power;
+};
+
+struct OrionLinkEnergy
+{
+    double freq_Hz;
+    double traversal_energy;    // J per flit, half the wires toggling
+    double static_power;
+};
+
+const OrionRouterEnergy *orion_router_energy(
+    uint32_t num_in_port,
+    uint32_t num_out_port,
+    const std::vector<uint32_t>& vclass_type_ary,
+    uint32_t num_vc_per_vclass,
+    uint32_t in_buf_per_data_vc,
+    uint32_t in_buf_per_ctrl_vc,
+    uint32_t flit_width_bits);
+
+const OrionLinkEnergy *orion_link_energy(uint32_t channel_width_bits);
+
 #endif
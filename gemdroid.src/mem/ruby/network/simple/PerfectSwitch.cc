@@ -54,6 +54,7 @@ PerfectSwitch::PerfectSwitch(SwitchID sid, Switch *sw, uint32_t virt_nets)
     m_round_robin_start = 0;
     m_wakeups_wo_switch = 0;
     m_virtual_networks = virt_nets;
+    m_pending_port_count.resize(virt_nets);
 }
 
 void
@@ -74,6 +75,9 @@ PerfectSwitch::addInPort(const vector<MessageBuffer*>& in)
     NodeID port = m_in.size();
     m_in.push_back(in);
 
+    for (int j = 0; j < m_virtual_networks; j++)
+        m_pending_port_count[j].push_back(0);
+
     for (int j = 0; j < m_virtual_networks; j++) {
         m_in[port][j]->setConsumer(this);
 
@@ -81,7 +85,9 @@ PerfectSwitch::addInPort(const vector<MessageBuffer*>& in)
             to_string(m_switch_id), to_string(port), to_string(j));
         m_in[port][j]->setDescription(desc);
         m_in[port][j]->setIncomingLink(port);
-        m_in[port][j]->setVnet(j);
+        // The buffer reports its vnet id through storeEventInfo(), so
+        // give it one that also identifies the port
+        m_in[port][j]->setVnet(port * m_virtual_networks + j);
     }
 }
 
@@ -100,6 +106,11 @@ PerfectSwitch::addOutPort(const vector<MessageBuffer*>& out,
     // Add to routing table
     m_out.push_back(out);
     m_routing_table.push_back(routing_table_entry);
+
+    NetDest owned = routing_table_entry;
+    owned.removeNetDest(m_routed);
+    m_link_owned.push_back(owned);
+    m_routed.addNetDest(routing_table_entry);
 }
 
 PerfectSwitch::~PerfectSwitch()
@@ -147,9 +158,8 @@ PerfectSwitch::wakeup()
                     incoming = 0;
                 }
 
-                // temporary vectors to store the routing results
-                vector<LinkID> output_links;
-                vector<NetDest> output_link_destinations;
+                if (m_pending_port_count[vnet][incoming] == 0)
+                    continue;
 
                 // Is there a message waiting?
                 while (m_in[incoming][vnet]->isReady()) {
@@ -160,9 +170,7 @@ PerfectSwitch::wakeup()
                     net_msg_ptr = safe_cast<NetworkMessage*>(msg_ptr.get());
                     DPRINTF(RubyNetwork, "Message: %s\n", (*net_msg_ptr));
 
-                    output_links.clear();
-                    output_link_destinations.clear();
-                    NetDest msg_dsts =
+                    const NetDest &msg_dsts =
                         net_msg_ptr->getInternalDestination();
 
                     // Unfortunately, the token-protocol sends some
@@ -172,58 +180,32 @@ PerfectSwitch::wakeup()
                     assert(m_link_order.size() == m_routing_table.size());
                     assert(m_link_order.size() == m_out.size());
 
-                    if (m_network_ptr->getAdaptiveRouting()) {
-                        if (m_network_ptr->isVNetOrdered(vnet)) {
-                            // Don't adaptively route
-                            for (int out = 0; out < m_out.size(); out++) {
-                                m_link_order[out].m_link = out;
-                                m_link_order[out].m_value = 0;
-                            }
-                        } else {
-                            // Find how clogged each link is
-                            for (int out = 0; out < m_out.size(); out++) {
-                                int out_queue_length = 0;
-                                for (int v = 0; v < m_virtual_networks; v++) {
-                                    out_queue_length += m_out[out][v]->getSize();
-                                }
-                                int value =
-                                    (out_queue_length << 8) | (random() & 0xff);
-                                m_link_order[out].m_link = out;
-                                m_link_order[out].m_value = value;
+                    if (m_network_ptr->getAdaptiveRouting() &&
+                        !m_network_ptr->isVNetOrdered(vnet)) {
+                        // Find how clogged each link is
+                        for (int out = 0; out < m_out.size(); out++) {
+                            int out_queue_length = 0;
+                            for (int v = 0; v < m_virtual_networks; v++) {
+                                out_queue_length += m_out[out][v]->getSize();
                             }
-
-                            // Look at the most empty link first
-                            sort(m_link_order.begin(), m_link_order.end());
+                            int value =
+                                (out_queue_length << 8) | (random() & 0xff);
+                            m_link_order[out].m_link = out;
+                            m_link_order[out].m_value = value;
                         }
-                    }
 
-                    for (int i = 0; i < m_routing_table.size(); i++) {
-                        // pick the next link to look at
-                        int link = m_link_order[i].m_link;
-                        NetDest dst = m_routing_table[link];
-                        DPRINTF(RubyNetwork, "dst: %s\n", dst);
-
-                        if (!msg_dsts.intersectionIsNotEmpty(dst))
-                            continue;
-
-                        // Remember what link we're using
-                        output_links.push_back(link);
-
-                        // Need to remember which destinations need this
-                        // message in another vector.  This Set is the
-                        // intersection of the routing_table entry and the
-                        // current destination set.  The intersection must
-                        // not be empty, since we are inside "if"
-                        output_link_destinations.push_back(msg_dsts.AND(dst));
-
-                        // Next, we update the msg_destination not to
-                        // include those nodes that were already handled
-                        // by this link
-                        msg_dsts.removeNetDest(dst);
+                        // Look at the most empty link first
+                        sort(m_link_order.begin(), m_link_order.end());
+                        routeByLinkOrder(msg_dsts);
+                    } else {
+                        // Links are tried in index order, so every
+                        // destination goes out its precomputed link
+                        routeByOwnedMasks(msg_dsts);
                     }
 
-                    assert(msg_dsts.count() == 0);
-                    //assert(output_links.size() > 0);
+                    vector<LinkID> &output_links = m_output_links;
+                    vector<NetDest> &output_link_destinations =
+                        m_output_link_destinations;
 
                     // Check for resources - for all outgoing queues
                     bool enough = true;
@@ -263,6 +245,7 @@ PerfectSwitch::wakeup()
                     // Dequeue msg
                     m_in[incoming][vnet]->dequeue();
                     m_pending_message_count[vnet]--;
+                    m_pending_port_count[vnet][incoming]--;
 
                     // Enqueue it - for all outgoing queues
                     for (int i=0; i<output_links.size(); i++) {
@@ -294,10 +277,69 @@ PerfectSwitch::wakeup()
     }
 }
 
+// Splits msg_dsts over the out links in m_link_order: each link takes
+// the remaining destinations its routing table entry covers.
+void
+PerfectSwitch::routeByLinkOrder(NetDest msg_dsts)
+{
+    m_output_links.clear();
+    m_output_link_destinations.clear();
+
+    for (int i = 0; i < m_routing_table.size(); i++) {
+        // pick the next link to look at
+        int link = m_link_order[i].m_link;
+        const NetDest &dst = m_routing_table[link];
+        DPRINTF(RubyNetwork, "dst: %s\n", dst);
+
+        if (!msg_dsts.intersectionIsNotEmpty(dst))
+            continue;
+
+        // Remember what link we're using
+        m_output_links.push_back(link);
+
+        // Need to remember which destinations need this message in
+        // another vector.  This Set is the intersection of the
+        // routing_table entry and the current destination set.  The
+        // intersection must not be empty, since we are inside "if"
+        m_output_link_destinations.push_back(msg_dsts.AND(dst));
+
+        // Next, we update the msg_destination not to include those
+        // nodes that were already handled by this link
+        msg_dsts.removeNetDest(dst);
+    }
+
+    assert(msg_dsts.count() == 0);
+}
+
+// Same split as routeByLinkOrder() with links in index order, done with
+// one intersection per link against the masks built in addOutPort().
+void
+PerfectSwitch::routeByOwnedMasks(const NetDest& msg_dsts)
+{
+    m_output_links.clear();
+    m_output_link_destinations.clear();
+
+    assert(m_routed.isSuperset(msg_dsts));
+
+    for (int link = 0; link < m_link_owned.size(); link++) {
+        if (!msg_dsts.intersectionIsNotEmpty(m_link_owned[link]))
+            continue;
+
+        m_output_links.push_back(link);
+        m_output_link_destinations.push_back(
+            msg_dsts.AND(m_link_owned[link]));
+    }
+}
+
 void
 PerfectSwitch::storeEventInfo(int info)
 {
-    m_pending_message_count[info]++;
+    // info is port * m_virtual_networks + vnet, see addInPort()
+    int vnet = info % m_virtual_networks;
+    int port = info / m_virtual_networks;
+
+    m_pending_message_count[vnet]++;
+    m_pending_port_count[vnet][port]++;
 }
 
 void
@@ -41,9 +41,9 @@
 #include <vector>
 
 #include "mem/ruby/common/Consumer.hh"
+#include "mem/ruby/common/NetDest.hh"
 
 class MessageBuffer;
-class NetDest;
 class SimpleNetwork;
 class Switch;
 
@@ -91,12 +91,27 @@ class PerfectSwitch : public Consumer
     std::vector<NetDest> m_routing_table;
     std::vector<LinkOrder> m_link_order;
 
+    // Destinations each out link serves when links are tried in index
+    // order: its routing table entry minus those of all lower links.
+    // Used to split a message without walking m_routing_table.
+    std::vector<NetDest> m_link_owned;
+    NetDest m_routed;
+
+    // routing results of the message being switched
+    std::vector<LinkID> m_output_links;
+    std::vector<NetDest> m_output_link_destinations;
+
     uint32_t m_virtual_networks;
     int m_round_robin_start;
     int m_wakeups_wo_switch;
 
     SimpleNetwork* m_network_ptr;
     std::vector<int> m_pending_message_count;
+    // [vnet][in port], lets wakeup() skip ports with nothing queued
+    std::vector<std::vector<int> > m_pending_port_count;
+
+    void routeByLinkOrder(NetDest msg_dsts);
+    void routeByOwnedMasks(const NetDest& msg_dsts);
 };
 
 inline std::ostream&
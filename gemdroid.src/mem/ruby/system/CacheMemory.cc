@@ -119,7 +119,7 @@ CacheMemory::findTagInSet(Index cacheSet, const Address& tag) const
 {
     assert(tag == line_address(tag));
     // search the set for the tags
-    m5::hash_map<Address, int>::const_iterator it = m_tag_index.find(tag);
+    AddressMap<int>::const_iterator it = m_tag_index.find(tag);
     if (it != m_tag_index.end())
         if (m_cache[cacheSet][it->second]->m_Permission !=
             AccessPermission_NotPresent)
@@ -135,7 +135,7 @@ CacheMemory::findTagInSetIgnorePermissions(Index cacheSet,
 {
     assert(tag == line_address(tag));
     // search the set for the tags
-    m5::hash_map<Address, int>::const_iterator it = m_tag_index.find(tag);
+    AddressMap<int>::const_iterator it = m_tag_index.find(tag);
     if (it != m_tag_index.end())
         return it->second;
     return -1; // Not found
@@ -706,21 +706,6 @@ Sequencer::issueRequest(PacketPtr pkt, RubyRequestType secondary_type)
     m_mandatory_q_ptr->enqueue(msg, latency);
 }
 
-template <class KEY, class VALUE>
-std::ostream &
-operator<<(ostream &out, const m5::hash_map<KEY, VALUE> &map)
-{
-    typename m5::hash_map<KEY, VALUE>::const_iterator i = map.begin();
-    typename m5::hash_map<KEY, VALUE>::const_iterator end = map.end();
-
-    out << "[";
-    for (; i != end; ++i)
-        out << " " << i->first << "=" << i->second;
-    out << " ]";
-
-    return out;
-}
-
 void
 Sequencer::print(ostream& out) const
 {
@@ -38,6 +38,13 @@ from SimpleMemory import *
 class MemoryMode(Enum): vals = ['invalid', 'atomic', 'timing',
                                 'atomic_noncaching']
 
+# Host pages backing the simulated memory. Huge pages cut the host TLB
+# misses on large memories; hugetlbfs pages have to be reserved on the
+# host (vm.nr_hugepages), and if they are not there the memory falls
+# back to transparent huge pages.
+class BackingPages(Enum): vals = ['small_pages', 'transparent_huge_pages',
+                                  'explicit_huge_pages']
+
 class System(MemObject):
     type = 'System'
     cxx_header = "sim/system.hh"
@@ -58,6 +65,15 @@ class System(MemObject):
                                           "All memories in the system")
     mem_mode = Param.MemoryMode('atomic', "The mode the memory system is in")
 
+    # Host side of the memory backing store
+    mem_backing_pages = Param.BackingPages('small_pages',
+        "Host pages backing the simulated memory")
+    mem_numa_nodes = VectorParam.Int([],
+        "Host NUMA nodes the backing stores are bound to in turn, -1 for "
+        "the node of the simulator thread (empty for no binding)")
+    mem_prefault = Param.Bool(False,
+        "Fault in the backing store at startup rather than on first use")
+
     # The memory ranges are to be populated when creating the system
     # such that these can be passed from the I/O subsystem through an
     # I/O bridge or cache
@@ -470,30 +470,66 @@ Event::dump() const
     }
 }
 
+static bool
+eventBefore(const Event *a, const Event *b)
+{
+    return *a < *b;
+}
+
 EventQueue::EventQueue(const string &n)
-    : objName(n), head(NULL), _curTick(0),
-    async_queue_mutex(new std::mutex())
+    : objName(n), head(NULL), _curTick(0), async_queue(NULL)
 {
 }
 
 void
 EventQueue::asyncInsert(Event *event)
 {
-    async_queue_mutex->lock();
-    async_queue.push_back(event);
-    async_queue_mutex->unlock();
+    // Push on the async stack, the owner only ever takes the whole stack
+    // so there is no ABA problem
+    Event *top = async_queue.load(std::memory_order_relaxed);
+    do {
+        event->nextBin = top;
+    } while (!async_queue.compare_exchange_weak(top, event,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed));
 }
 
 void
 EventQueue::handleAsyncInsertions()
 {
     assert(this == curEventQueue());
-    async_queue_mutex->lock();
 
-    while (!async_queue.empty()) {
-        insert(async_queue.front());
-        async_queue.pop_front();
+    // Only read the shared pointer when there is nothing to do
+    if (!async_queue.load(std::memory_order_relaxed))
+        return;
+
+    Event *pending = async_queue.exchange(NULL, std::memory_order_acquire);
+    for (; pending; pending = pending->nextBin)
+        async_batch.push_back(pending);
+
+    // Back to the order the events were added in, and then by time and
+    // priority. The sort is stable so that the main queue ends up as if
+    // the events had been inserted one by one.
+    std::reverse(async_batch.begin(), async_batch.end());
+    std::stable_sort(async_batch.begin(), async_batch.end(), eventBefore);
+
+    // Each event goes at or after the bin the previous one went to, so
+    // the main queue is only walked once
+    Event *prev = NULL;
+    for (size_t i = 0; i < async_batch.size(); ++i) {
+        Event *event = async_batch[i];
+        Event *curr = prev ? prev->nextBin : head;
+        while (curr && *curr < *event) {
+            prev = curr;
+            curr = curr->nextBin;
+        }
+
+        Event *top = Event::insertBefore(event, curr);
+        if (prev)
+            prev->nextBin = top;
+        else
+            head = top;
     }
 
-    async_queue_mutex->unlock();
+    async_batch.clear();
 }
@@ -39,11 +39,13 @@
 #define __SIM_EVENTQ_HH__
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <climits>
 #include <iosfwd>
 #include <mutex>
 #include <string>
+#include <vector>
 
 #include "base/flags.hh"
 #include "base/misc.hh"
@@ -443,7 +445,10 @@ operator!=(const Event &l, const Event &r)
  * deterministic. This causes the event to be inserted in a separate
  * queue of asynchronous events (async_queue), which is merged main
  * event queue at the end of each simulation quantum (by calling the
- * handleAsyncInsertions() method). Note that this implies that such
+ * handleAsyncInsertions() method). The async queue is lock free, any
+ * number of threads can add events to it while the owning thread takes
+ * them all in one go and merges them in a single pass over the main
+ * queue. Note that this implies that such
  * events must happen at least one simulation quantum into the future,
  * otherwise they risk being scheduled in the past by
  * handleAsyncInsertions().
@@ -455,11 +460,13 @@ class EventQueue : public Serializable
     Event *head;
     Tick _curTick;
 
-    //! Mutex to protect async queue.
-    std::mutex *async_queue_mutex;
+    //! Events added by other threads to this event queue, most recent
+    //! first and linked through nextBin, which is free until the event
+    //! is in the main queue.
+    std::atomic<Event *> async_queue;
 
-    //! List of events added by other threads to this event queue.
-    std::list<Event*> async_queue;
+    //! Events being merged from the async queue, kept to reuse its memory.
+    std::vector<Event *> async_batch;
 
     /**
      * Lock protecting event handling.
@@ -664,6 +671,16 @@ class EventManager
         return eventq;
     }
 
+    /**
+     * Move the object to another event queue. Only safe before the
+     * object has scheduled anything, i.e. during init().
+     */
+    void
+    setEventQueue(EventQueue *eq)
+    {
+        eventq = eq;
+    }
+
     void
     schedule(Event &event, Tick when)
     {
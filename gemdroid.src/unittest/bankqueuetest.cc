@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2014 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Checks the bank indexed FR-FCFS selection against the scan over the
+ * whole queue the DRAM controller used to do, with random requests,
+ * open rows and bank timings.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+#include "mem/bank_queue.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+using UnitTest::setCase;
+
+const unsigned BANKS = 16;
+const unsigned ROWS = 4;
+const uint32_t NO_ROW = -1;
+
+struct Req
+{
+    unsigned bank;
+    uint32_t row;
+};
+
+struct Banks
+{
+    vector<uint32_t> open;
+    vector<Tick> act;
+
+    uint32_t openRow(unsigned bank) const { return open[bank]; }
+    Tick actAt(unsigned bank) const { return act[bank]; }
+};
+
+// The queue scan from DRAMCtrl::reorderQueue and minBankActAt
+static Req *
+scanFRFCFS(const deque<Req *> &queue, const Banks &banks, Tick now)
+{
+    uint64_t earliest_banks = 0;
+    Tick min_act_at = MaxTick;
+    for (unsigned b = 0; b < BANKS; ++b) {
+        bool waiting = false;
+        for (int i = 0; i < queue.size(); ++i)
+            waiting |= queue[i]->bank == b;
+        if (waiting && banks.act[b] <= min_act_at) {
+            if (banks.act[b] < min_act_at)
+                earliest_banks = 0;
+            earliest_banks |= 1ULL << b;
+            min_act_at = banks.act[b];
+        }
+    }
+
+    bool found_earliest = false;
+    Req *selected = queue.front();
+    for (int i = 0; i < queue.size(); ++i) {
+        Req *req = queue[i];
+        if (banks.open[req->bank] == req->row)
+            return req;
+        if (!found_earliest &&
+            (banks.act[req->bank] <= now ||
+             (earliest_banks & (1ULL << req->bank)))) {
+            selected = req;
+            found_earliest = true;
+        }
+    }
+    return selected;
+}
+
+int
+main()
+{
+    srandom(1);
+
+    setCase("Row hits first");
+    BankQueue<Req> index;
+    index.init(BANKS);
+    EXPECT_TRUE(index.empty());
+
+    Banks banks;
+    banks.open.assign(BANKS, NO_ROW);
+    banks.act.assign(BANKS, 100);
+
+    Req a = { 0, 1 }, b = { 1, 2 }, c = { 0, 2 };
+    index.push(&a, a.bank, a.row);
+    index.push(&b, b.bank, b.row);
+    index.push(&c, c.bank, c.row);
+    EXPECT_EQ(index.size(), 3);
+    EXPECT_EQ(index.bankSize(0), 2);
+    EXPECT_EQ(index.rowSize(0, 2), 1);
+
+    // no hits, all banks equally far: oldest
+    EXPECT_EQ(index.selectFRFCFS(banks, 0), &a);
+    // a hit in bank 0 beats the older request
+    banks.open[0] = 2;
+    EXPECT_EQ(index.selectFRFCFS(banks, 0), &c);
+    // no hits, bank 1 activates first
+    banks.open[0] = 3;
+    banks.act[1] = 50;
+    EXPECT_EQ(index.selectFRFCFS(banks, 0), &b);
+
+    index.remove(&b, b.bank, b.row);
+    index.remove(&a, a.bank, a.row);
+    EXPECT_EQ(index.selectFRFCFS(banks, 0), &c);
+    index.remove(&c, c.bank, c.row);
+    EXPECT_TRUE(index.empty());
+    EXPECT_EQ(index.selectFRFCFS(banks, 0), (Req *)NULL);
+
+    setCase("Against the queue scan");
+    vector<Req> pool(64);
+    vector<Req *> free_reqs;
+    for (int i = 0; i < pool.size(); ++i)
+        free_reqs.push_back(&pool[i]);
+
+    deque<Req *> queue;
+    int mismatches = 0;
+    for (int step = 0; step < 50000; ++step) {
+        // keep the queue between empty and full
+        int arrivals = random() % 3;
+        for (int i = 0; i < arrivals && !free_reqs.empty(); ++i) {
+            Req *req = free_reqs.back();
+            free_reqs.pop_back();
+            req->bank = random() % BANKS;
+            req->row = random() % ROWS;
+            queue.push_back(req);
+            index.push(req, req->bank, req->row);
+        }
+        if (queue.empty())
+            continue;
+
+        Tick now = 1000;
+        for (unsigned b = 0; b < BANKS; ++b) {
+            banks.open[b] = random() % 4 ? random() % (ROWS + 2) : NO_ROW;
+            banks.act[b] = now - 50 + random() % 8 * 25;
+        }
+
+        Req *expected = scanFRFCFS(queue, banks, now);
+        Req *selected = index.selectFRFCFS(banks, now);
+        if (expected != selected)
+            ++mismatches;
+
+        queue.erase(find(queue.begin(), queue.end(), expected));
+        index.remove(expected, expected->bank, expected->row);
+        free_reqs.push_back(expected);
+    }
+
+    EXPECT_EQ(mismatches, 0);
+    EXPECT_EQ(index.size(), queue.size());
+
+    return UnitTest::printResults();
+}
@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2014 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Checks FixedBitSet and the Ruby Set built on it against a vector<bool>
+ * reference, then times the operations the coherence protocols issue on
+ * every broadcast (isElement, addNetDest, intersectionIsNotEmpty, count)
+ * for a flat destination set against the one-Set-per-machine-type layout
+ * NetDest used to have.
+ */
+
+#include <sys/time.h>
+
+#include <cstdlib>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "mem/ruby/common/FixedBitSet.hh"
+#include "mem/ruby/common/Set.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+using UnitTest::setCase;
+
+// 64 cores worth of L1, L2, directory and DMA controllers
+const int MACHINE_TYPES = 4;
+const int PER_TYPE = 64;
+const int MACHINES = MACHINE_TYPES * PER_TYPE;
+// The words NetDest walks, those that hold machines
+const int USED_WORDS = (MACHINES + 63) / 64;
+const int ITERATIONS = 2000000;
+
+typedef FixedBitSet<512> Flat;
+
+static double
+now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static void
+report(const char *what, double start, long sink)
+{
+    cprintf("%-28s %7.2f ns/op (%d)\n", what,
+            (now() - start) * 1e9 / ITERATIONS, sink);
+}
+
+int
+main()
+{
+    srandom(1);
+
+    setCase("FixedBitSet against vector<bool>");
+    Flat a, b;
+    vector<bool> ra(Flat::MAX_BITS), rb(Flat::MAX_BITS);
+    for (int i = 0; i < 300; i++) {
+        int x = random() % Flat::MAX_BITS;
+        int y = random() % Flat::MAX_BITS;
+        a.set(x);
+        ra[x] = true;
+        b.set(y);
+        rb[y] = true;
+    }
+    int ref_count = 0, ref_first = -1;
+    bool ref_common = false, ref_super = true;
+    for (int i = 0; i < Flat::MAX_BITS; i++) {
+        EXPECT_EQ(a.test(i), (bool)ra[i]);
+        ref_count += ra[i];
+        if (ra[i] && ref_first < 0)
+            ref_first = i;
+        ref_common |= ra[i] && rb[i];
+        if (rb[i] && !ra[i])
+            ref_super = false;
+    }
+    EXPECT_EQ(a.count(), ref_count);
+    EXPECT_EQ(a.findFirst(), ref_first);
+    EXPECT_EQ(a.intersects(b), ref_common);
+    EXPECT_EQ(a.isSupersetOf(b), ref_super);
+
+    // Only the low words, with nothing set above them
+    Flat lo_a, lo_b;
+    for (int i = 0; i < MACHINES; i += 5)
+        lo_a.set(i);
+    lo_b.set(MACHINES - 1);
+    EXPECT_EQ(lo_a.count(USED_WORDS), lo_a.count());
+    EXPECT_EQ(lo_a.intersects(lo_b, USED_WORDS), lo_a.intersects(lo_b));
+    EXPECT_FALSE(lo_b.none(USED_WORDS));
+
+    Flat c = a;
+    c.orWith(b);
+    EXPECT_TRUE(c.isSupersetOf(a));
+    EXPECT_TRUE(c.isSupersetOf(b));
+    c.andNotWith(b);
+    EXPECT_FALSE(c.intersects(b));
+
+    int walked = 0;
+    for (int i = a.findFirst(); i >= 0; i = a.findNext(i + 1))
+        walked++;
+    EXPECT_EQ(walked, ref_count);
+
+    setCase("FixedBitSet ranges");
+    Flat r;
+    r.setRange(60, 130);
+    EXPECT_EQ(r.count(), 70);
+    EXPECT_TRUE(r.allInRange(60, 130));
+    EXPECT_FALSE(r.allInRange(59, 130));
+    EXPECT_EQ(r.countRange(0, 64), 4);
+    EXPECT_EQ(r.findFirst(), 60);
+    r.resetRange(64, 128);
+    EXPECT_EQ(r.count(), 6);
+    EXPECT_EQ(r.findNext(64), 128);
+    r.clear();
+    EXPECT_TRUE(r.none());
+    EXPECT_EQ(r.findFirst(), -1);
+
+    setCase("Set");
+    Set s(200), t(200);
+    s.add(3);
+    s.add(130);
+    t.add(130);
+    EXPECT_EQ(s.count(), 2);
+    EXPECT_EQ(s.smallestElement(), 3);
+    EXPECT_TRUE(s.isSuperset(t));
+    EXPECT_FALSE(s.intersectionIsEmpty(t));
+    s.removeSet(t);
+    EXPECT_TRUE(s.intersectionIsEmpty(t));
+    s.broadcast();
+    EXPECT_TRUE(s.isBroadcast());
+    EXPECT_EQ(s.count(), 200);
+    s.addRandom();
+    EXPECT_EQ(s.count(), 200);
+    s.remove(199);
+    EXPECT_FALSE(s.isBroadcast());
+
+    setCase("Broadcast-path microbenchmark");
+    // The old layout: one Set per machine type
+    vector<Set> per_type_a(MACHINE_TYPES, Set(PER_TYPE));
+    vector<Set> per_type_b(MACHINE_TYPES, Set(PER_TYPE));
+    Flat flat_a, flat_b;
+    for (int i = 0; i < MACHINES; i += 3) {
+        per_type_a[i / PER_TYPE].add(i % PER_TYPE);
+        flat_a.set(i);
+    }
+    for (int i = 0; i < MACHINES; i += 7) {
+        per_type_b[i / PER_TYPE].add(i % PER_TYPE);
+        flat_b.set(i);
+    }
+
+    long sink = 0;
+    double start = now();
+    for (int n = 0; n < ITERATIONS; n++) {
+        int m = n % MACHINES;
+        sink += per_type_a[m / PER_TYPE].isElement(m % PER_TYPE);
+    }
+    report("per-type isElement", start, sink);
+
+    sink = 0;
+    start = now();
+    for (int n = 0; n < ITERATIONS; n++)
+        sink += flat_a.test(n % MACHINES);
+    report("flat isElement", start, sink);
+
+    sink = 0;
+    start = now();
+    for (int n = 0; n < ITERATIONS; n++) {
+        for (int i = 0; i < MACHINE_TYPES; i++) {
+            if (!per_type_a[i].intersectionIsEmpty(per_type_b[i])) {
+                sink++;
+                break;
+            }
+        }
+    }
+    report("per-type intersection", start, sink);
+
+    sink = 0;
+    start = now();
+    for (int n = 0; n < ITERATIONS; n++)
+        sink += flat_a.intersects(flat_b);
+    report("flat intersection", start, sink);
+
+    sink = 0;
+    start = now();
+    for (int n = 0; n < ITERATIONS; n++)
+        sink += flat_a.intersects(flat_b, USED_WORDS);
+    report("flat intersection, used", start, sink);
+
+    sink = 0;
+    start = now();
+    for (int n = 0; n < ITERATIONS; n++) {
+        vector<Set> dest(per_type_a);
+        for (int i = 0; i < MACHINE_TYPES; i++)
+            dest[i].addSet(per_type_b[i]);
+        for (int i = 0; i < MACHINE_TYPES; i++)
+            sink += dest[i].count();
+    }
+    report("per-type copy+add+count", start, sink);
+
+    sink = 0;
+    start = now();
+    for (int n = 0; n < ITERATIONS; n++) {
+        Flat dest(flat_a);
+        dest.orWith(flat_b);
+        sink += dest.count();
+    }
+    report("flat copy+add+count", start, sink);
+
+    sink = 0;
+    start = now();
+    for (int n = 0; n < ITERATIONS; n++) {
+        Flat dest(flat_a);
+        dest.orWith(flat_b, USED_WORDS);
+        sink += dest.count(USED_WORDS);
+    }
+    report("flat copy+add+count, used", start, sink);
+
+    return UnitTest::printResults();
+}
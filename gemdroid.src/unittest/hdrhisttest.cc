@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2014 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Checks the quantiles of the HdrHistogram against the exact ones of
+ * sorted samples, and its handling of small and out of range values.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "base/hdr_histogram.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+using UnitTest::setCase;
+
+static uint64_t
+exactQuantile(const vector<uint64_t> &sorted, double q)
+{
+    size_t rank = max((size_t)ceil(q * sorted.size()), (size_t)1);
+    return sorted[rank - 1];
+}
+
+int
+main()
+{
+    srandom(1);
+
+    setCase("Empty");
+    HdrHistogram hist;
+    hist.init(7, 1000000);
+    EXPECT_EQ(hist.count(), 0);
+    EXPECT_EQ(hist.quantile(0.99), 0);
+    EXPECT_EQ(hist.min(), 0);
+    EXPECT_EQ(hist.max(), 0);
+
+    setCase("Small values are exact");
+    for (uint64_t v = 0; v < 100; ++v)
+        hist.sample(v);
+    EXPECT_EQ(hist.count(), 100);
+    EXPECT_EQ(hist.quantile(0.5), 49);
+    EXPECT_EQ(hist.quantile(0.99), 98);
+    EXPECT_EQ(hist.quantile(1.0), 99);
+    EXPECT_EQ(hist.min(), 0);
+    EXPECT_EQ(hist.max(), 99);
+    EXPECT_TRUE(fabs(hist.mean() - 49.5) < 1e-9);
+
+    setCase("Beyond the highest value");
+    hist.reset();
+    hist.sample(10);
+    hist.sample(5000000);
+    EXPECT_EQ(hist.count(), 2);
+    EXPECT_EQ(hist.max(), 5000000);
+    // the top bucket still reports the exact maximum
+    EXPECT_EQ(hist.quantile(1.0), 5000000);
+    EXPECT_EQ(hist.quantile(0.5), 10);
+
+    setCase("Relative error of the quantiles");
+    const unsigned bits = 7;
+    const double bound = 1.0 / (1 << (bits - 1));
+    HdrHistogram lat;
+    lat.init(bits, ULL(1) << 40);
+    vector<uint64_t> samples;
+    for (int i = 0; i < 100000; ++i) {
+        // a long tail over several orders of magnitude
+        uint64_t v = (random() % 1000) + 1;
+        if (random() % 100 == 0)
+            v *= random() % 100000 + 1;
+        samples.push_back(v);
+        lat.sample(v);
+    }
+    sort(samples.begin(), samples.end());
+
+    const double qs[] = { 0.0, 0.25, 0.5, 0.9, 0.99, 0.999, 0.9999, 1.0 };
+    const int num_qs = sizeof(qs) / sizeof(qs[0]);
+    int outside = 0;
+    for (int i = 0; i < num_qs; ++i) {
+        double exact = exactQuantile(samples, qs[i]);
+        double approx = lat.quantile(qs[i]);
+        if (approx < exact || approx > exact * (1 + bound))
+            ++outside;
+    }
+    EXPECT_EQ(outside, 0);
+    EXPECT_EQ(lat.min(), samples.front());
+    EXPECT_EQ(lat.max(), samples.back());
+    EXPECT_EQ(lat.quantile(1.0), samples.back());
+
+    // A few thousand buckets cover 40 bits
+    EXPECT_TRUE(lat.size() < 3000);
+
+    setCase("Reset");
+    lat.reset();
+    EXPECT_EQ(lat.count(), 0);
+    lat.sample(12345);
+    EXPECT_EQ(lat.min(), 12345);
+    EXPECT_TRUE(lat.quantile(0.5) >= 12345);
+
+    return UnitTest::printResults();
+}
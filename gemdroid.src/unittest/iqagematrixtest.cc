@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2014 The Pennsylvania State University
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Drives the age matrix ready list and a copy of the per op class heaps
+ * and age order list the O3 IQ uses by default with the same random
+ * wakeups, squashes and busy FUs, and checks that both issue the same
+ * instructions in the same order every cycle.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <list>
+#include <queue>
+#include <vector>
+
+#include "cpu/o3/iq_age_matrix.hh"
+#include "unittest/unittest.hh"
+
+using namespace std;
+using UnitTest::setCase;
+
+const int IQ_ENTRIES = 64;
+const int ISSUE_WIDTH = 8;
+const int CYCLES = 20000;
+
+struct Inst
+{
+    InstSeqNum seqNum;
+    OpClass opClass;
+    bool squashed;
+};
+
+typedef Inst *InstPtr;
+
+// The list based ready queues, as in InstructionQueue
+class HeapReadyList
+{
+  public:
+    HeapReadyList()
+    {
+        for (int i = 0; i < Num_OpClasses; ++i) {
+            queueOnList[i] = false;
+            readyIt[i] = listOrder.end();
+        }
+    }
+
+    void
+    push(InstPtr inst)
+    {
+        OpClass op_class = inst->opClass;
+        readyInsts[op_class].push(inst);
+        if (!queueOnList[op_class]) {
+            addToOrderList(op_class);
+        } else if (readyInsts[op_class].top()->seqNum <
+                   (*readyIt[op_class]).oldestInst) {
+            listOrder.erase(readyIt[op_class]);
+            addToOrderList(op_class);
+        }
+    }
+
+    // Returns the instructions looked at, in order; busy classes are
+    // refused an FU
+    vector<InstPtr>
+    schedule(const vector<bool> &busy, vector<InstPtr> &issued)
+    {
+        vector<InstPtr> seen;
+        ListOrderIt order_it = listOrder.begin();
+        int total_issued = 0;
+
+        while (total_issued < ISSUE_WIDTH && order_it != listOrder.end()) {
+            OpClass op_class = (*order_it).queueType;
+            InstPtr inst = readyInsts[op_class].top();
+            seen.push_back(inst);
+
+            if (inst->squashed || !busy[op_class]) {
+                readyInsts[op_class].pop();
+                if (!readyInsts[op_class].empty()) {
+                    moveToYoungerInst(order_it);
+                } else {
+                    readyIt[op_class] = listOrder.end();
+                    queueOnList[op_class] = false;
+                }
+                listOrder.erase(order_it++);
+                if (!inst->squashed) {
+                    issued.push_back(inst);
+                    ++total_issued;
+                }
+            } else {
+                ++order_it;
+            }
+        }
+        return seen;
+    }
+
+    bool empty() const { return listOrder.empty(); }
+
+  private:
+    struct pqCompare {
+        bool operator() (const InstPtr &lhs, const InstPtr &rhs) const
+        { return lhs->seqNum > rhs->seqNum; }
+    };
+
+    struct ListOrderEntry {
+        OpClass queueType;
+        InstSeqNum oldestInst;
+    };
+
+    typedef list<ListOrderEntry>::iterator ListOrderIt;
+
+    void
+    addToOrderList(OpClass op_class)
+    {
+        ListOrderEntry entry;
+        entry.queueType = op_class;
+        entry.oldestInst = readyInsts[op_class].top()->seqNum;
+        ListOrderIt it = listOrder.begin();
+        while (it != listOrder.end() && (*it).oldestInst <= entry.oldestInst)
+            ++it;
+        readyIt[op_class] = listOrder.insert(it, entry);
+        queueOnList[op_class] = true;
+    }
+
+    void
+    moveToYoungerInst(ListOrderIt it)
+    {
+        ListOrderEntry entry;
+        entry.queueType = (*it).queueType;
+        entry.oldestInst = readyInsts[entry.queueType].top()->seqNum;
+        ++it;
+        while (it != listOrder.end() && (*it).oldestInst < entry.oldestInst)
+            ++it;
+        readyIt[entry.queueType] = listOrder.insert(it, entry);
+    }
+
+    priority_queue<InstPtr, vector<InstPtr>, pqCompare>
+        readyInsts[Num_OpClasses];
+    list<ListOrderEntry> listOrder;
+    bool queueOnList[Num_OpClasses];
+    ListOrderIt readyIt[Num_OpClasses];
+};
+
+static vector<InstPtr>
+scheduleMatrix(IQAgeMatrix<InstPtr> &matrix, const vector<bool> &busy,
+               vector<InstPtr> &issued)
+{
+    vector<InstPtr> seen;
+    int total_issued = 0;
+    int slot;
+
+    matrix.beginSelect();
+    while (total_issued < ISSUE_WIDTH &&
+           (slot = matrix.selectOldest()) != -1) {
+        InstPtr inst = matrix.inst(slot);
+        seen.push_back(inst);
+
+        if (inst->squashed || !busy[inst->opClass]) {
+            matrix.remove(slot);
+            if (!inst->squashed) {
+                issued.push_back(inst);
+                ++total_issued;
+            }
+        } else {
+            matrix.block(inst->opClass);
+        }
+    }
+    return seen;
+}
+
+int
+main()
+{
+    srandom(1);
+
+    setCase("Select order");
+    IQAgeMatrix<InstPtr> matrix;
+    matrix.init(IQ_ENTRIES);
+    EXPECT_TRUE(matrix.empty());
+    EXPECT_EQ(matrix.selectOldest(), -1);
+
+    Inst a = { 7, IntAluOp, false };
+    Inst b = { 3, FloatAddOp, false };
+    Inst c = { 5, IntAluOp, false };
+    matrix.push(&a, a.opClass);
+    matrix.push(&b, b.opClass);
+    matrix.push(&c, c.opClass);
+    EXPECT_EQ(matrix.size(IntAluOp), 2);
+    matrix.beginSelect();
+    int slot = matrix.selectOldest();
+    EXPECT_EQ(matrix.inst(slot), &b);
+    matrix.block(FloatAddOp);
+    slot = matrix.selectOldest();
+    EXPECT_EQ(matrix.inst(slot), &c);
+    matrix.remove(slot);
+    slot = matrix.selectOldest();
+    EXPECT_EQ(matrix.inst(slot), &a);
+    matrix.block(IntAluOp);
+    EXPECT_EQ(matrix.selectOldest(), -1);
+    matrix.clear();
+    EXPECT_TRUE(matrix.empty());
+
+    setCase("Against the heaps and age order list");
+    // Wake up instructions out of order, leave some of them squashed on
+    // the ready list past the IQ size, and refuse FUs at random.
+    vector<Inst> pool(4 * IQ_ENTRIES);
+    vector<InstPtr> free_insts;
+    for (int i = 0; i < pool.size(); ++i)
+        free_insts.push_back(&pool[i]);
+
+    const OpClass classes[] = { IntAluOp, IntMultOp, FloatAddOp,
+                                MemReadOp, MemWriteOp, No_OpClass };
+    const int num_classes = sizeof(classes) / sizeof(classes[0]);
+
+    HeapReadyList heaps;
+    matrix.init(IQ_ENTRIES);
+    InstSeqNum next_seq = 1;
+    int mismatches = 0;
+    long total_issued = 0;
+
+    for (int cycle = 0; cycle < CYCLES; ++cycle) {
+        int wakeups = random() % (ISSUE_WIDTH + 3);
+        vector<InstPtr> woken;
+        // Older instructions can become ready after younger ones
+        vector<int> order(16);
+        for (int i = 0; i < order.size(); ++i)
+            order[i] = i;
+        for (int i = order.size() - 1; i > 0; --i)
+            swap(order[i], order[random() % (i + 1)]);
+        for (int i = 0; i < wakeups && !free_insts.empty(); ++i) {
+            InstPtr inst = free_insts.back();
+            free_insts.pop_back();
+            inst->seqNum = next_seq + order[i];
+            inst->opClass = classes[random() % num_classes];
+            inst->squashed = false;
+            woken.push_back(inst);
+        }
+        next_seq += 16;
+
+        for (int i = 0; i < woken.size(); ++i) {
+            heaps.push(woken[i]);
+            matrix.push(woken[i], woken[i]->opClass);
+        }
+
+        if (random() % 50 == 0) {
+            for (int i = 0; i < pool.size(); ++i)
+                if (random() % 2)
+                    pool[i].squashed = true;
+        }
+
+        vector<bool> busy(Num_OpClasses);
+        for (int i = 0; i < Num_OpClasses; ++i)
+            busy[i] = (random() % 4 == 0);
+        busy[No_OpClass] = false;
+
+        vector<InstPtr> heap_issued, matrix_issued;
+        vector<InstPtr> heap_seen = heaps.schedule(busy, heap_issued);
+        vector<InstPtr> matrix_seen = scheduleMatrix(matrix, busy,
+                                                     matrix_issued);
+        if (heap_seen != matrix_seen)
+            ++mismatches;
+
+        // Both removed the same instructions from their lists
+        for (int i = 0; i < heap_seen.size(); ++i) {
+            InstPtr inst = heap_seen[i];
+            if (inst->squashed || !busy[inst->opClass]) {
+                free_insts.push_back(inst);
+            }
+        }
+        total_issued += heap_issued.size();
+    }
+
+    EXPECT_EQ(mismatches, 0);
+    EXPECT_EQ(heaps.empty(), matrix.empty());
+    EXPECT_TRUE(total_issued > CYCLES);
+
+    return UnitTest::printResults();
+}
@@ -31,6 +31,7 @@
 #include <cassert>
 #include <iostream>
 #include <list>
+#include <utility>
 
 #include "base/cprintf.hh"
 #include "base/refcnt.hh"
@@ -148,6 +149,29 @@ main()
     assignmentTarget = NULL;
     EXPECT_EQ(liveChange(), -1);
 
+    // Test moving a Ptr, which hands over the reference.
+    setCase("move construction and assignment");
+    Ptr moveSource(new TestRC("move source"));
+    EXPECT_EQ(liveChange(), 1);
+    TestRC *moveObject = moveSource.get();
+    Ptr moveTarget(std::move(moveSource));
+    EXPECT_EQ(moveSource.get(), NULL);
+    EXPECT_TRUE(moveTarget == moveObject);
+    EXPECT_EQ(liveChange(), 0);
+    Ptr moveAssigned(new TestRC("move assigned"));
+    EXPECT_EQ(liveChange(), 1);
+    moveAssigned = std::move(moveTarget);
+    EXPECT_EQ(liveChange(), -1);
+    EXPECT_EQ(moveTarget.get(), NULL);
+    EXPECT_TRUE(moveAssigned == moveObject);
+    list<Ptr> moveList;
+    moveList.push_back(std::move(moveAssigned));
+    EXPECT_EQ(moveAssigned.get(), NULL);
+    EXPECT_TRUE(moveList.front() == moveObject);
+    EXPECT_EQ(liveChange(), 0);
+    moveList.clear();
+    EXPECT_EQ(liveChange(), -1);
+
     // Test access to members of the pointed to class and dereferencing.
     setCase("access to members");
     TestRC *accessTest = new TestRC("access test");